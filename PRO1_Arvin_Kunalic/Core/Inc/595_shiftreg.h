@@ -30,6 +30,8 @@
 #include "stm32l4xx_hal.h"
 #include <stdbool.h>
 
+#include "ctrl_state.h"
+
 /* Exported constants -------------------------------------------------------*/
 
 /* Buffer Size */
@@ -75,18 +77,7 @@
 extern uint8_t shiftreg_buffer[SHIFTREG_BUFFER_SIZE];
 extern const uint32_t init_state;
 
-extern volatile bool crosswalk1_green;
-extern volatile bool crosswalk1_red;
-extern volatile bool crosswalk2_green;
-extern volatile bool crosswalk2_red;
-
-extern volatile bool PL1_SW_HIT;
-extern volatile bool PL2_SW_HIT;
-
-extern volatile bool intersection1_green;
-extern volatile bool intersection1_red;
-extern volatile bool intersection2_green;
-extern volatile bool intersection2_red;
+/* Light and request flags: see ctrl_state.h */
 
 /* Exported functions -------------------------------------------------------*/
 void reset_595register(void);
@@ -103,4 +94,8 @@ void stop_pedestrian(uint8_t crosswalk);
 void go_intersection(uint8_t intersection);
 void stop_intersection(uint8_t intersection);
 
+void lamp_test(uint32_t pattern, uint16_t duration_ms);
+void lamp_test_service(void);
+bool lamp_test_running(void);
+
 #endif
@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ * @file     assets.h
+ * @brief    Fonts and bitmaps of the OLED, generated from Assets/assets.txt.
+ *
+ * @details  Generated by Tools/font_convert.py, do not edit. Rerun the script
+ *           after changing an asset or the list.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef ASSETS_H
+#define ASSETS_H
+
+/* Includes -----------------------------------------------------------------*/
+#include "glyph.h"
+
+/* Exported variables -------------------------------------------------------*/
+extern const font_t font_large;              /* 24 rows, rle */
+extern const font_t font_small;              /* 8 rows, raw */
+extern const bitmap_t icon_car;              /* 16x8, raw */
+extern const bitmap_t icon_pedestrian;       /* 8x16, raw */
+extern const font_t font_signal;             /* 17 rows, packed */
+extern const bitmap_t junction;              /* 128x64, rle */
+
+#endif
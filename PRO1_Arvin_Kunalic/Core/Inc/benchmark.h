@@ -0,0 +1,74 @@
+/**************************************************************************//**
+ * @file     benchmark.h
+ * @brief    Header for benchmark.c file
+ *
+ * @details  Latency and duration benchmarks of the hot paths, run on the
+ *           board instead of the traffic light program. Build with
+ *           BENCHMARK_ENABLED set to 1 (here or with -DBENCHMARK_ENABLED=1),
+ *           main calls Benchmark() instead of Traffic().
+ *
+ *           The results are printed as one JSON object per line on the
+ *           USART2 telemetry stream, see Tools/bench_report.py.
+ *
+ *           The EXTI and timer callbacks call the BENCH_HOOK macros first.
+ *           While the suite runs they take the stamps and keep the traffic
+ *           light logic out of the way. Without BENCHMARK_ENABLED they are
+ *           empty.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 1 to build the benchmark firmware */
+#ifndef BENCHMARK_ENABLED
+#define BENCHMARK_ENABLED   0
+#endif
+
+/* Samples per benchmark */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    256
+#endif
+
+/* Macros -------------------------------------------------------------------*/
+#if BENCHMARK_ENABLED
+#define BENCH_HOOK_EXTI(pin)                                  \
+  do {                                                        \
+    const uint32_t bench_now_ = DWT->CYCCNT;                  \
+    if (bench_exti_hook((pin), bench_now_)) {                 \
+      return;                                                 \
+    }                                                         \
+  } while (0)
+#define BENCH_HOOK_TIMER(htim)                                \
+  do {                                                        \
+    const uint32_t bench_now_ = DWT->CYCCNT;                  \
+    if (bench_timer_hook((htim), bench_now_)) {               \
+      return;                                                 \
+    }                                                         \
+  } while (0)
+#else
+#define BENCH_HOOK_EXTI(pin)    do { } while (0)
+#define BENCH_HOOK_TIMER(htim)  do { } while (0)
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+#if BENCHMARK_ENABLED
+void Benchmark(void);
+bool bench_exti_hook(uint16_t pin, uint32_t now);
+bool bench_timer_hook(TIM_HandleTypeDef *htim, uint32_t now);
+#endif
+
+#endif
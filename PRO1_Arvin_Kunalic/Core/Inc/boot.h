@@ -0,0 +1,70 @@
+/**************************************************************************//**
+ * @file     boot.h
+ * @brief    Header for boot.c file
+ *
+ * @details  Fast boot path. boot_latch is the first call in main: it sets up
+ *           only the shift register pins and SPI3 and latches the safe lamp
+ *           state (init_state), before the clock is switched to the PLL and
+ *           before any other peripheral. Until then the 595 outputs are off
+ *           (OE high). The OLED is brought up afterwards by display_service
+ *           in the main loop (see ssd1306_config.h), it no longer holds up
+ *           the start.
+ *
+ *           The start-up code starts the DWT cycle counter on the reset
+ *           vector. boot_stamp records the count at three points:
+ *
+ *             BOOT_LATCH   safe lamp state latched
+ *             BOOT_CLOCK   SystemClock_Config done (80 MHz)
+ *             BOOT_FRAME   first complete frame sent to the OLED
+ *
+ *           and boot_service prints the times since the reset vector once,
+ *           as a TELEMETRY_TEXT line:
+ *
+ *             boot: latch <t> us, clock <t> us, first frame <t> us
+ *
+ *           The core runs at 4 MHz (MSI) until SystemClock_Config, the
+ *           conversion to microseconds uses the clock that was set at the
+ *           start of each interval.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef BOOT_H
+#define BOOT_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to compile the boot time measurement out */
+#ifndef BOOT_TIMING_ENABLED
+#define BOOT_TIMING_ENABLED     1
+#endif
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  BOOT_LATCH,
+  BOOT_CLOCK,
+  BOOT_FRAME,
+  BOOT_POINTS
+} boot_point_t;
+
+/* Exported functions -------------------------------------------------------*/
+void boot_latch(void);
+
+#if BOOT_TIMING_ENABLED
+void boot_stamp(boot_point_t point);
+uint32_t boot_time_us(boot_point_t point);
+void boot_service(void);
+#else
+#define boot_stamp(point)       do { } while (0)
+#define boot_service()          do { } while (0)
+#endif
+
+#endif
@@ -36,5 +36,6 @@
 /* Exported variables -------------------------------------------------------*/
 
 /* Exported functions -------------------------------------------------------*/
+void SystemClock_Config(void);
 
 #endif
\ No newline at end of file
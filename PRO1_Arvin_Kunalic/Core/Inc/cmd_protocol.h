@@ -0,0 +1,131 @@
+/**************************************************************************//**
+ * @file     cmd_protocol.h
+ * @brief    Header for cmd_protocol.c file
+ *
+ * @details  Binary request/response protocol on USART2, used to inspect and
+ *           reconfigure the running firmware.
+ *
+ *           Requests (host -> board) are COBS encoded frames, terminated by
+ *           a 0x00 byte:
+ *
+ *             COBS( | seq | cmd | args ... | crc16 (LE) | ) 0x00
+ *
+ *           Responses (board -> host) share the USART2 telemetry stream and
+ *           are sent as TELEMETRY_RESPONSE records, the record header takes
+ *           the place of the COBS delimiter:
+ *
+ *             | 0xA5 | 0x06 | len | seq | cmd | status | data ... | crc16 (LE) |
+ *
+ *           The CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over
+ *           every byte before it. 'seq' is chosen by the host and echoed.
+ *           Frames with a bad CRC are counted and not answered.
+ *
+ *           All multi-byte values are little endian.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      Tools/traffic_cli.py, Tools/cmd_standin.py
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef CMD_PROTOCOL_H
+#define CMD_PROTOCOL_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32l4xx_hal.h"
+#include "profile.h"
+#include "mem_monitor.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+#define CMD_PROTOCOL_VERSION    1
+
+/* Size of the USART2 DMA receive ring in bytes */
+#define CMD_RX_BUFFER_SIZE      128
+
+/* Longest encoded request frame, without the 0x00 delimiter */
+#define CMD_FRAME_MAX           64
+
+/* Commands                        args                      -> data */
+#define CMD_PING            0x01 // -                        -> cmd_ping_t
+#define CMD_STATUS          0x02 // -                        -> cmd_status_t
+#define CMD_COUNTERS        0x03 // -                        -> cmd_counters_t
+#define CMD_GET_PARAM       0x04 // id (1)                   -> cmd_param_t
+#define CMD_SET_PARAM       0x05 // id (1), value (2)        -> cmd_param_t
+#define CMD_RESET_PARAMS    0x06 // -                        -> -
+#define CMD_LAMP_TEST       0x07 // pattern (4), time ms (2) -> -
+#define CMD_HIL_MODE        0x08 // enable (1), speed-up (1) -> cmd_hil_t
+#define CMD_INJECT          0x09 // pin (2), level (1)       -> -
+#define CMD_PROFILE         0x0A // probe (1), action (1)     -> cmd_profile_t
+#define CMD_MEMORY          0x0B // -                        -> mem_usage_t
+
+/* CMD_PROFILE actions */
+#define CMD_PROFILE_READ    0x00 // Statistics of the probe
+#define CMD_PROFILE_RESET   0x01 // Statistics, then start the probe over
+#define CMD_PROFILE_SHOW    0x02 // Statistics, and every probe on the OLED
+
+/* Response status */
+#define CMD_OK              0x00
+#define CMD_ERR_UNKNOWN     0x01 // Unknown command (or compiled out)
+#define CMD_ERR_LENGTH      0x02 // Wrong argument length
+#define CMD_ERR_PARAM       0x03 // Unknown parameter id or input pin
+#define CMD_ERR_RANGE       0x04 // Value rejected by timer_param_set
+#define CMD_ERR_STATE       0x05 // Not possible right now (e.g. HIL mode off)
+
+/* Exported types -----------------------------------------------------------*/
+
+typedef struct __attribute__((packed)) {
+  uint8_t version;      // CMD_PROTOCOL_VERSION
+  uint32_t tick;        // HAL tick (ms)
+} cmd_ping_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t state;        // Intersection1, Intersection2, Wait20s, Wait30s
+  uint8_t inputs;       // bit 0-3 = car1-4, bit 4-5 = PL1/PL2 request
+  uint8_t flags;        // bit 0-3 = TL1/TL2/PL1/PL2 green, bit 4 = lamp test, bit 5 = HIL
+  uint32_t lamps;       // Shift register output word
+  uint32_t tick;        // HAL tick (ms)
+} cmd_status_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t frames;          // Valid requests
+  uint32_t crc_errors;      // Requests dropped because of a bad CRC
+  uint32_t frame_errors;    // Invalid COBS data or too long frames
+  uint32_t uart_errors;     // USART2 receive errors (overrun, noise, ...)
+  uint32_t telemetry_dropped;
+  uint32_t stdio_dropped;
+  uint32_t phase_changes;
+} cmd_counters_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t id;           // timer_param_t
+  uint16_t value;       // Current value (timer ticks)
+  uint16_t min;
+  uint16_t max;
+} cmd_param_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t enabled;      // 1 in HIL mode
+  uint8_t speedup;      // Timer speed-up factor
+} cmd_hil_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t probe;        // profile_probe_t
+  uint32_t core_hz;     // Cycle counter frequency
+  uint32_t count;
+  uint32_t min;         // Cycles, UINT32_MAX before the first pass
+  uint32_t max;
+  uint64_t total;
+  uint32_t histogram[PROFILE_BUCKETS];  // Bucket n = 2^n to 2^(n+1)-1 cycles
+} cmd_profile_t;
+
+/* Exported functions -------------------------------------------------------*/
+void cmd_protocol_init(void);
+void cmd_protocol_rx_error(UART_HandleTypeDef *huart);
+
+#endif
@@ -0,0 +1,98 @@
+/**************************************************************************//**
+ * @file     crash_dump.h
+ * @brief    Header for crash_dump.c file
+ *
+ * @details  Post-mortem crash dumps. The fault handlers (HardFault,
+ *           MemManage, BusFault, UsageFault) and Error_Handler save the
+ *           stacked registers, the fault status registers, a backtrace and
+ *           the last CRASH_EVENTS telemetry events in a RAM section that the
+ *           start-up code leaves alone (.noinit), then reset the MCU right
+ *           away. Early on the next boot crash_dump_report sends the dump on
+ *           the USART2 telemetry stream as TELEMETRY_CRASH records:
+ *
+ *             | offset (2) | dump bytes ... |
+ *
+ *           Tools/crash_decode.py puts the records back together and
+ *           symbolizes the addresses with the firmware ELF file.
+ *
+ *           CubeMX must not generate the fault handlers, "Generate IRQ
+ *           handler" is unchecked for them in the .ioc file.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef CRASH_DUMP_H
+#define CRASH_DUMP_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to leave the faults to Default_Handler of the startup code (spins) */
+#ifndef CRASH_DUMP_ENABLED
+#define CRASH_DUMP_ENABLED      1
+#endif
+
+#define CRASH_MAGIC             0xDEADC0DEu
+
+/* Return addresses kept, the first two are the stacked PC and LR */
+#define CRASH_BACKTRACE_DEPTH   8
+
+/* Telemetry events kept (PHASE, INPUT, LAMPS and TRACE records) */
+#define CRASH_EVENTS            16
+
+/* Payload bytes kept per event, a TRACE record keeps its first 4 arguments */
+#define CRASH_EVENT_SIZE        22
+
+/* Dump bytes per TELEMETRY_CRASH record */
+#define CRASH_CHUNK_SIZE        200
+
+/* Reasons, the fault reasons are the exception numbers */
+#define CRASH_HARDFAULT         3
+#define CRASH_MEMMANAGE         4
+#define CRASH_BUSFAULT          5
+#define CRASH_USAGEFAULT        6
+#define CRASH_ERROR_HANDLER     0x80    // pc = caller of Error_Handler
+
+/* Exported types -----------------------------------------------------------*/
+typedef struct __attribute__((packed)) {
+  uint8_t type;                       // TELEMETRY_x, 0 for an unused entry
+  uint8_t len;                        // Payload bytes kept
+  uint8_t payload[CRASH_EVENT_SIZE];
+} crash_event_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;                     // CRASH_MAGIC while a dump is pending
+  uint16_t size;                      // sizeof(crash_dump_t)
+  uint8_t reason;                     // CRASH_x
+  uint8_t events;                     // Used entries of 'event', oldest first
+  uint32_t tick;                      // HAL tick (ms) of the crash
+  uint32_t r0, r1, r2, r3, r12;       // Stacked by the exception entry
+  uint32_t lr, pc, xpsr;
+  uint32_t sp;                        // SP before the exception entry
+  uint32_t exc_return;                // LR in the handler, 0 for Error_Handler
+  uint32_t cfsr, hfsr, mmfar, bfar;   // SCB fault status and address registers
+  uint32_t backtrace[CRASH_BACKTRACE_DEPTH];
+  crash_event_t event[CRASH_EVENTS];
+  uint32_t check;                     // Checksum of every byte before it
+} crash_dump_t;
+
+/* Exported functions -------------------------------------------------------*/
+#if CRASH_DUMP_ENABLED
+void crash_dump_init(void);
+void crash_dump_report(void);
+void crash_dump_event(uint8_t type, const void *payload, uint8_t len);
+void crash_error(uint32_t caller) __attribute__((noreturn));
+#else
+#define crash_dump_init()                     do { } while (0)
+#define crash_dump_report()                   do { } while (0)
+#define crash_dump_event(type, payload, len)  do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+/**************************************************************************//**
+ * @file     ctrl_state.h
+ * @brief    Header for ctrl_state.c file
+ *
+ * @details  The state shared by the state machine, the lamp functions and
+ *           the interrupts, in one block (ctrl_state) instead of a byte per
+ *           flag and function statics spread over the modules.
+ *
+ *           The flags are bits of one word. Interrupts and the main loop
+ *           change different bits of it, so a bit is never written with a
+ *           read-modify-write of the word: with BITBAND_ENABLED each bit is
+ *           one word of the SRAM1 bit-band alias (ctrl_state_bb, defined by
+ *           the linker script), one load or store per access. Without it
+ *           (host build) the bits are changed with atomic operations.
+ *
+ *           Bit 0-5 are the inputs and bit 6-9 the green lights in the order
+ *           of the telemetry input event and the status response.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef CTRL_STATE_H
+#define CTRL_STATE_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to change the flags with atomic operations instead */
+#ifndef BITBAND_ENABLED
+#define BITBAND_ENABLED     1
+#endif
+
+#define CTRL_INPUTS_MASK    0x3Fu                       // Bit 0-5 of the flags
+#define CTRL_GREENS_SHIFT   FLAG_INTERSECTION1_GREEN    // 4 bits from here
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  FLAG_CAR1_ACTIVE,             // Car sensors, 1 = car waiting
+  FLAG_CAR2_ACTIVE,
+  FLAG_CAR3_ACTIVE,
+  FLAG_CAR4_ACTIVE,
+  FLAG_PL1_SW_HIT,              // Pedestrian button pressed, not served yet
+  FLAG_PL2_SW_HIT,
+  FLAG_INTERSECTION1_GREEN,
+  FLAG_INTERSECTION2_GREEN,
+  FLAG_CROSSWALK1_GREEN,
+  FLAG_CROSSWALK2_GREEN,
+  FLAG_INTERSECTION1_RED,
+  FLAG_INTERSECTION2_RED,
+  FLAG_CROSSWALK1_RED,
+  FLAG_CROSSWALK2_RED,
+  FLAG_GO_YELLOW,               // go_intersection in its yellow stage
+  FLAG_STOP_YELLOW,             // stop_intersection in its yellow stage
+  FLAG_BLUE_ON,                 // toggle_pedestrian, indicator lit
+  FLAG_LAMP_TEST_PENDING,
+  FLAG_LAMP_TEST_ACTIVE,
+  FLAG_COUNT
+} ctrl_flag_t;
+
+_Static_assert(FLAG_COUNT <= 32, "the flags have to fit in one word");
+
+typedef struct {
+  volatile uint32_t flags;      // Bit per ctrl_flag_t, first for ctrl_state_bb
+  uint8_t state;                // State machine state (traffic.c)
+  uint8_t next_state;
+  uint8_t stage[2];             // Traffic_step stage of Intersection1/2
+} ctrl_state_t;
+
+/* Exported variables -------------------------------------------------------*/
+extern ctrl_state_t ctrl_state;
+
+#if BITBAND_ENABLED
+/* Bit-band alias of ctrl_state.flags, word n is bit n */
+extern volatile uint32_t ctrl_state_bb[32];
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+#if BITBAND_ENABLED
+
+/**************************************************************************//**
+ * @brief   Reads a flag, one load from the bit-band alias.
+ * @version 1.0
+ * @param   ctrl_flag_t flag, The flag.
+ * @return  boolean, The flag.
+ *****************************************************************************/
+static inline bool flag_get(ctrl_flag_t flag) {
+  return ctrl_state_bb[flag] != 0u;
+}
+
+/**************************************************************************//**
+ * @brief   Writes a flag, one store to the bit-band alias. Safe against
+ *          interrupts changing other flags.
+ * @version 1.0
+ * @param   ctrl_flag_t flag, The flag.
+ * @param   bool value, The new value.
+ * @return  None
+ *****************************************************************************/
+static inline void flag_write(ctrl_flag_t flag, bool value) {
+  ctrl_state_bb[flag] = value;
+}
+
+#else
+
+static inline bool flag_get(ctrl_flag_t flag) {
+  return (__atomic_load_n(&ctrl_state.flags, __ATOMIC_RELAXED) >> flag) & 1u;
+}
+
+static inline void flag_write(ctrl_flag_t flag, bool value) {
+  if (value) {
+    __atomic_fetch_or(&ctrl_state.flags, 1u << flag, __ATOMIC_RELAXED);
+  } else {
+    __atomic_fetch_and(&ctrl_state.flags, ~(1u << flag), __ATOMIC_RELAXED);
+  }
+}
+
+#endif
+
+/* Shorthands of flag_write */
+static inline void flag_set(ctrl_flag_t flag) {
+  flag_write(flag, 1);
+}
+
+static inline void flag_clear(ctrl_flag_t flag) {
+  flag_write(flag, 0);
+}
+
+/**************************************************************************//**
+ * @brief   Returns the inputs, bit 0-3 = car1-4, bit 4-5 = PL1/PL2 request.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, The input word of the telemetry input event.
+ *****************************************************************************/
+static inline uint32_t ctrl_inputs(void) {
+  return ctrl_state.flags & CTRL_INPUTS_MASK;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the green lights, bit 0-1 = intersection1/2, bit 2-3 =
+ *          crosswalk1/2.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, The green lights.
+ *****************************************************************************/
+static inline uint32_t ctrl_greens(void) {
+  return (ctrl_state.flags >> CTRL_GREENS_SHIFT) & 0x0Fu;
+}
+
+#endif
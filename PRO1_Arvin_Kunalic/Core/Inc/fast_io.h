@@ -0,0 +1,96 @@
+/**************************************************************************//**
+ * @file     fast_io.h
+ * @brief    Register-level GPIO and SPI access for the output hot paths.
+ *
+ * @details  The OLED (SPI2) and shift register (SPI3) transfers call these
+ *           instead of HAL_GPIO_WritePin and HAL_SPI_Transmit. With
+ *           FAST_IO_ENABLED they are inline register accesses:
+ *
+ *           - The pin macros of gpio_pins.h: one store to BSRR/BRR.
+ *           - fast_spi_send: bytes written to DR as soon as TXE is set, then
+ *             waits until the last bit is out (FTLVL empty, BSY clear) and
+ *             discards the received bytes of the full-duplex link.
+ *
+ *           HAL_SPI_Transmit instead locks the handle, checks its state,
+ *           polls with a timeout against HAL_GetTick and clears the overrun
+ *           flag on every call. The peripherals are still set up by the HAL
+ *           (MX_SPIx_Init, MX_GPIO_Init); the SPI is enabled on first use.
+ *
+ *           With FAST_IO_ENABLED set to 0 the functions map to the HAL
+ *           calls, e.g. to compare both with the benchmark suite (see
+ *           benchmark.h) or for the host build, whose simulated HAL only
+ *           sees HAL calls.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef FAST_IO_H
+#define FAST_IO_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to use the HAL for every transfer */
+#ifndef FAST_IO_ENABLED
+#define FAST_IO_ENABLED     1
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+#if FAST_IO_ENABLED
+
+/**************************************************************************//**
+ * @brief   Sends bytes on an SPI master and waits until they are out.
+ * @details DR is written as a byte, a 16-bit write would pack two frames.
+ *          Unlike HAL_SPI_Transmit there is no lock, a caller that can be
+ *          interrupted by another sender on the same SPI has to disable
+ *          interrupts around the call.
+ * @version 1.1
+ * @param   SPI_HandleTypeDef *hspi, The SPI (set up by the HAL).
+ * @param   const uint8_t *data, The bytes.
+ * @param   uint16_t len, Number of bytes.
+ * @return  None
+ *****************************************************************************/
+static inline void fast_spi_send(SPI_HandleTypeDef *hspi, const uint8_t *data, uint16_t len) {
+  SPI_TypeDef *spi = hspi->Instance;
+
+  if (!(spi->CR1 & SPI_CR1_SPE)) {
+    spi->CR1 |= SPI_CR1_SPE;
+  }
+
+  while (len--) {
+    while (!(spi->SR & SPI_SR_TXE)) {
+    }
+    *(__IO uint8_t *)&spi->DR = *data++;
+  }
+
+  /* The chip select or latch may only change after the last bit */
+  while (spi->SR & SPI_SR_FTLVL) {
+  }
+  while (spi->SR & SPI_SR_BSY) {
+  }
+
+  /* Nothing is read on MISO, empty the receive FIFO and clear the overrun */
+  while (spi->SR & SPI_SR_FRLVL) {
+    (void)*(__IO uint8_t *)&spi->DR;
+  }
+  (void)spi->SR;
+}
+
+#else
+
+static inline void fast_spi_send(SPI_HandleTypeDef *hspi, const uint8_t *data, uint16_t len) {
+  HAL_SPI_Transmit(hspi, data, len, HAL_MAX_DELAY);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+/**************************************************************************//**
+ * @file     fmt.h
+ * @brief    Header for fmt.c file
+ *
+ * @details  Number formatting for the OLED, instead of snprintf: unsigned
+ *           and signed decimal, hexadecimal and decimal fixed point, right-
+ *           aligned in a minimum width. The text is written into a buffer
+ *           of the caller (usually on the stack) and null-terminated, ready
+ *           for draw_string or draw_text_aligned.
+ *
+ *           The functions keep no state and take no locks, so they can be
+ *           called from the main loop and from interrupts alike. Nothing is
+ *           allocated.
+ *
+ *           A number longer than the width is written whole; the buffer has
+ *           to hold the longer of the width and FMT_..._SIZE, both with the
+ *           null.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef FMT_H
+#define FMT_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Longest text of each function, with the null */
+#define FMT_U32_SIZE        11      // "4294967295"
+#define FMT_I32_SIZE        12      // "-2147483648"
+#define FMT_HEX_SIZE        9       // "FFFFFFFF"
+#define FMT_FIXED_SIZE      13      // "-2147483.648", "-0.000000001"
+
+#define FMT_MAX_DECIMALS    9
+
+/* Exported functions -------------------------------------------------------*/
+uint8_t fmt_u32(char *buf, uint32_t value, uint8_t width, char pad);
+uint8_t fmt_i32(char *buf, int32_t value, uint8_t width, char pad);
+uint8_t fmt_hex(char *buf, uint32_t value, uint8_t digits);
+uint8_t fmt_fixed(char *buf, int32_t value, uint8_t decimals, uint8_t width, char pad);
+
+#endif
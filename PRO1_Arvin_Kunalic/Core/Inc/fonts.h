@@ -10,10 +10,14 @@
  *           It also includes standard library headers required for font usage 
  *           in graphical applications. The font array is defined in the 
  *           corresponding source file, `fonts.c`.
+ *
+ *           The array is const and stays in flash. font_5x7 describes the
+ *           same data for draw_text (glyph.h); fonts of other sizes are
+ *           generated into assets.h.
  * 
  ****************************************************************************** 
  * @author   Arvin Kunalic
- * @version  1.0
+ * @version  1.1
  * @date     20-December-2024
  * 
  * @note     Ensure that the corresponding `fonts.c` file is included in the 
@@ -31,7 +35,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "glyph.h"
+
 /* Exported variables -------------------------------------------------------*/
-extern uint8_t Font5x7[][5];
+extern const uint8_t Font5x7[][5];
+extern const font_t font_5x7;
 
 #endif
\ No newline at end of file
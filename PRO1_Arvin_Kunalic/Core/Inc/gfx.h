@@ -0,0 +1,55 @@
+/**************************************************************************//**
+ * @file     gfx.h
+ * @brief    Header for gfx.c file
+ *
+ * @details  Drawing primitives for the OLED framebuffer: pixels, horizontal
+ *           and vertical lines, lines at any angle, filled and outlined
+ *           rectangles, progress bars and sprites. Everything is clipped to
+ *           the screen, so coordinates may be partly off-screen.
+ *
+ *           The framebuffer is page-organized (see ssd1306_config.h): one
+ *           byte holds 8 rows of a column. A rectangle is therefore one
+ *           8-bit row mask per page, applied to a run of bytes; the run is
+ *           written a 32-bit word at a time with the mask repeated in all
+ *           four bytes. A full-width fill reads and writes each page byte
+ *           once, 32 words per page.
+ *
+ *           Each primitive takes a gfx_color_t: set (lit), clear (dark) or
+ *           invert. Like the text functions they only change the
+ *           framebuffer and mark the pages, display_service sends them.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef GFX_H
+#define GFX_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "glyph.h"
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  GFX_CLEAR,
+  GFX_SET,
+  GFX_INVERT,
+} gfx_color_t;
+
+/* Exported functions -------------------------------------------------------*/
+void draw_pixel(int16_t x, int16_t y, gfx_color_t color);
+void draw_hline(int16_t x, int16_t y, int16_t width, gfx_color_t color);
+void draw_vline(int16_t x, int16_t y, int16_t height, gfx_color_t color);
+void draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, gfx_color_t color);
+void fill_rect(int16_t x, int16_t y, int16_t width, int16_t height, gfx_color_t color);
+void draw_rect(int16_t x, int16_t y, int16_t width, int16_t height, gfx_color_t color);
+void draw_progress(int16_t x, int16_t y, int16_t width, int16_t height,
+                   uint32_t value, uint32_t max);
+void blit_sprite(int16_t x, int16_t y, const bitmap_t *sprite, gfx_color_t color);
+
+#endif
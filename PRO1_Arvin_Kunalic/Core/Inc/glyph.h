@@ -0,0 +1,97 @@
+/**************************************************************************//**
+ * @file     glyph.h
+ * @brief    Header for glyph.c file
+ *
+ * @details  Flash-resident fonts and bitmaps for the OLED, and the decoder
+ *           that draws them into the framebuffer.
+ *
+ *           A glyph or bitmap is a block of pixel columns, bit 0 of a column
+ *           is its top row. The data is stored in one of three encodings:
+ *
+ *           - GLYPH_RAW:    The framebuffer layout, one byte per 8 rows and
+ *                           column, the rows 0-7 of every column first, then
+ *                           rows 8-15 and so on.
+ *           - GLYPH_PACKED: Column after column, 'height' bits each, without
+ *                           padding. Saves the unused bits of the last page
+ *                           when the height is not a multiple of 8.
+ *           - GLYPH_RLE:    The GLYPH_RAW bytes, run-length coded. A control
+ *                           byte c < 0x80 is followed by c + 1 bytes as they
+ *                           are, c >= 0x80 by one byte repeated c - 0x7E
+ *                           times. Pays off for large glyphs with empty rows.
+ *
+ *           The decoder never expands a glyph into a buffer: it reads the
+ *           data once and writes each 8-row strip straight into the
+ *           framebuffer, at any row, clipped to the screen.
+ *
+ *           A font has a fixed width (glyphs NULL) or a width per glyph, and
+ *           any height up to the screen. There is no kerning: the advance of
+ *           a glyph is its width plus the font spacing, so text_width needs
+ *           only the widths and draw_text_aligned lays a line out without
+ *           decoding anything twice.
+ *
+ *           Tools/font_convert.py generates the tables (assets.h) from BDF
+ *           fonts and PBM bitmaps. Font5x7 (fonts.h) is a GLYPH_RAW font of
+ *           fixed width and is also available as font_5x7.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef GLYPH_H
+#define GLYPH_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  GLYPH_RAW,
+  GLYPH_PACKED,
+  GLYPH_RLE,
+} glyph_encoding_t;
+
+typedef struct {
+  uint16_t offset;              // First byte in the font data
+  uint8_t width;                // Columns, also the advance
+} glyph_t;
+
+typedef struct {
+  const uint8_t *data;
+  const glyph_t *glyphs;        // NULL: every glyph 'width' columns, back to back
+  uint8_t first;                // First and last character in the font
+  uint8_t last;
+  uint8_t width;                // Of every glyph if 'glyphs' is NULL, else the widest
+  uint8_t height;               // Rows
+  uint8_t spacing;              // Empty columns after each glyph
+  uint8_t encoding;             // glyph_encoding_t
+} font_t;
+
+typedef struct {
+  const uint8_t *data;
+  uint8_t width;
+  uint8_t height;
+  uint8_t encoding;             // glyph_encoding_t
+} bitmap_t;
+
+typedef enum {
+  TEXT_LEFT,
+  TEXT_CENTER,
+  TEXT_RIGHT,
+} text_align_t;
+
+/* Exported functions -------------------------------------------------------*/
+uint8_t draw_glyph(int16_t x, int16_t y, const font_t *font, char c);
+int16_t draw_text(int16_t x, int16_t y, const font_t *font, const char *str);
+void draw_text_aligned(int16_t x, int16_t y, uint8_t width,
+                       const font_t *font, const char *str,
+                       text_align_t align);
+uint16_t text_width(const font_t *font, const char *str);
+void draw_bitmap(int16_t x, int16_t y, const bitmap_t *bitmap);
+void clear_area(int16_t x, int16_t y, int16_t width, uint8_t height);
+
+#endif
@@ -0,0 +1,125 @@
+/**************************************************************************//**
+ * @file     gpio_pins.h
+ * @brief    Compile-time GPIO pins, generated from PRO1_Arvin_Kunalic.ioc.
+ *
+ * @details  Generated by Tools/gen_pins.py, do not edit. Rerun the script
+ *           after changing pins in CubeMX.
+ *
+ *           A pin is named by its CubeMX label, e.g. PIN_SET(Disp_CS). The
+ *           port and mask are constants, so with FAST_IO_ENABLED (see
+ *           fast_io.h) every macro is one store to BSRR/BRR or one load of
+ *           IDR. PIN_WRITE2 and PIN_WRITE3 set and clear pins of the same
+ *           port in one BSRR store, pins on different ports do not compile.
+ *
+ *           With FAST_IO_ENABLED set to 0 the macros call the HAL instead,
+ *           one call per pin.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef GPIO_PINS_H
+#define GPIO_PINS_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "main.h"
+#include "fast_io.h"
+
+/* Exported constants -------------------------------------------------------*/
+/* Labelled GPIO pins, by port and pin number */
+#define PIN_LD2_PORT                     GPIOA
+#define PIN_LD2_PORT_ID                  0
+#define PIN_LD2_MASK                     (1u << 5)
+#define PIN__595_Reset_PORT              GPIOA
+#define PIN__595_Reset_PORT_ID           0
+#define PIN__595_Reset_MASK              (1u << 9)
+#define PIN_TL4_Car_PORT                 GPIOA
+#define PIN_TL4_Car_PORT_ID              0
+#define PIN_TL4_Car_MASK                 (1u << 10)
+#define PIN_PL1_Switch_PORT              GPIOA
+#define PIN_PL1_Switch_PORT_ID           0
+#define PIN_PL1_Switch_MASK              (1u << 15)
+#define PIN_Disp_Reset_PORT              GPIOB
+#define PIN_Disp_Reset_PORT_ID           1
+#define PIN_Disp_Reset_MASK              (1u << 6)
+#define PIN_PL2_Switch_PORT              GPIOB
+#define PIN_PL2_Switch_PORT_ID           1
+#define PIN_PL2_Switch_MASK              (1u << 7)
+#define PIN__595_STCP_PORT               GPIOB
+#define PIN__595_STCP_PORT_ID            1
+#define PIN__595_STCP_MASK               (1u << 12)
+#define PIN_TL2_Car_PORT                 GPIOB
+#define PIN_TL2_Car_PORT_ID              1
+#define PIN_TL2_Car_MASK                 (1u << 13)
+#define PIN_TL3_Car_PORT                 GPIOB
+#define PIN_TL3_Car_PORT_ID              1
+#define PIN_TL3_Car_MASK                 (1u << 14)
+#define PIN_TL1_Car_PORT                 GPIOC
+#define PIN_TL1_Car_PORT_ID              2
+#define PIN_TL1_Car_MASK                 (1u << 4)
+#define PIN__595_Enable_PORT             GPIOC
+#define PIN__595_Enable_PORT_ID          2
+#define PIN__595_Enable_MASK             (1u << 7)
+#define PIN_Disp_Data_Instr_PORT         GPIOC
+#define PIN_Disp_Data_Instr_PORT_ID      2
+#define PIN_Disp_Data_Instr_MASK         (1u << 9)
+#define PIN_Disp_CS_PORT                 GPIOC
+#define PIN_Disp_CS_PORT_ID              2
+#define PIN_Disp_CS_MASK                 (1u << 11)
+
+/* Exported macros ----------------------------------------------------------*/
+
+/* BSRR word that sets (value != 0) or clears a pin */
+#define PIN_BSRR(p, value)      ((value) ? PIN_##p##_MASK : PIN_##p##_MASK << 16)
+
+#define PIN_SAME_PORT(a, b) \
+  _Static_assert(PIN_##a##_PORT_ID == PIN_##b##_PORT_ID, #a " and " #b " are on different ports")
+
+#if FAST_IO_ENABLED
+
+#define PIN_SET(p)              (PIN_##p##_PORT->BSRR = PIN_##p##_MASK)
+#define PIN_RESET(p)            (PIN_##p##_PORT->BRR = PIN_##p##_MASK)
+#define PIN_WRITE(p, value)     (PIN_##p##_PORT->BSRR = PIN_BSRR(p, value))
+#define PIN_READ(p)             ((PIN_##p##_PORT->IDR & PIN_##p##_MASK) != 0u)
+
+#define PIN_WRITE2(a, va, b, vb) do { \
+    PIN_SAME_PORT(a, b); \
+    PIN_##a##_PORT->BSRR = PIN_BSRR(a, va) | PIN_BSRR(b, vb); \
+  } while (0)
+
+#define PIN_WRITE3(a, va, b, vb, c, vc) do { \
+    PIN_SAME_PORT(a, b); \
+    PIN_SAME_PORT(a, c); \
+    PIN_##a##_PORT->BSRR = PIN_BSRR(a, va) | PIN_BSRR(b, vb) | PIN_BSRR(c, vc); \
+  } while (0)
+
+#else
+
+#define PIN_SET(p)              HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, GPIO_PIN_SET)
+#define PIN_RESET(p)            HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, GPIO_PIN_RESET)
+#define PIN_WRITE(p, value) \
+  HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, (value) ? GPIO_PIN_SET : GPIO_PIN_RESET)
+#define PIN_READ(p)             (HAL_GPIO_ReadPin(PIN_##p##_PORT, PIN_##p##_MASK) == GPIO_PIN_SET)
+
+#define PIN_WRITE2(a, va, b, vb) do { \
+    PIN_SAME_PORT(a, b); \
+    PIN_WRITE(a, va); \
+    PIN_WRITE(b, vb); \
+  } while (0)
+
+#define PIN_WRITE3(a, va, b, vb, c, vc) do { \
+    PIN_SAME_PORT(a, b); \
+    PIN_SAME_PORT(a, c); \
+    PIN_WRITE(a, va); \
+    PIN_WRITE(b, vb); \
+    PIN_WRITE(c, vc); \
+  } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * @file     hil.h
+ * @brief    Header for hil.c file
+ *
+ * @details  Hardware-in-the-loop input injection. In HIL mode the physical
+ *           buttons and car sensors are ignored and their events are sent
+ *           over USART2 instead (see cmd_protocol.h, CMD_HIL_MODE and
+ *           CMD_INJECT). An injected event is raised as a software EXTI
+ *           interrupt, so it runs through exactly the same interrupt and
+ *           HAL_GPIO_EXTI_Callback path as a real edge.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      Tools/hil_standin.py
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef HIL_H
+#define HIL_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Inputs that can be injected, one EXTI line each */
+#define HIL_CAR_PINS        (TL1_Car_Pin | TL2_Car_Pin | TL3_Car_Pin | TL4_Car_Pin)
+#define HIL_INPUT_PINS      (PL1_Switch_Pin | PL2_Switch_Pin | HIL_CAR_PINS)
+
+/* Exported functions -------------------------------------------------------*/
+void hil_set_mode(bool enable);
+bool hil_enabled(void);
+bool hil_inject(uint16_t pin, GPIO_PinState level);
+GPIO_PinState hil_read_pin(GPIO_TypeDef *port, uint16_t pin);
+
+#endif
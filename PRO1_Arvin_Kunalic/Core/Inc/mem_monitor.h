@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     mem_monitor.h
+ * @brief    Header for mem_monitor.c file
+ *
+ * @details  Stack and heap high-water marks. At start-up the free RAM
+ *           between the heap and the main stack (MSP) is painted with
+ *           MEM_PAINT_PATTERN. The deepest stack use is the lowest word that
+ *           no longer holds the pattern, so it includes every ISR, nested
+ *           ones as well: without an RTOS all of them run on the MSP.
+ *
+ *             _end        heap end                       low mark    _estack
+ *               | heap     |  painted, never used          | used stack |
+ *
+ *           The heap use is counted by _sbrk (sysmem.c).
+ *
+ *           mem_monitor_service runs from the main loop, rescans every
+ *           MEM_MONITOR_PERIOD_MS and sends a TELEMETRY_MEMORY record when a
+ *           mark grew or a limit was crossed. CMD_MEMORY (cmd_protocol.h)
+ *           reads the same numbers on request.
+ *
+ *           mem_paint/mem_unused also work on any other stack, e.g. the
+ *           stack of an RTOS task.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef MEM_MONITOR_H
+#define MEM_MONITOR_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to leave the RAM unpainted and compile the monitor out */
+#ifndef MEM_MONITOR_ENABLED
+#define MEM_MONITOR_ENABLED     1
+#endif
+
+/* Fill of the unused stack */
+#define MEM_PAINT_PATTERN       0xC5C5C5C5u
+
+/* Rescan period of mem_monitor_service */
+#define MEM_MONITOR_PERIOD_MS   1000
+
+/* Free bytes between heap and stack below which MEM_FLAG_GUARD is set */
+#define MEM_GUARD_SIZE          64
+
+/* mem_usage_t flags */
+#define MEM_FLAG_STACK_RESERVE  0x01    // Stack grew past _Min_Stack_Size
+#define MEM_FLAG_HEAP_RESERVE   0x02    // Heap grew past _Min_Heap_Size
+#define MEM_FLAG_GUARD          0x04    // Less than MEM_GUARD_SIZE between heap and stack
+#define MEM_FLAG_SBRK_FAILED    0x08    // _sbrk refused an allocation
+
+/* Exported types -----------------------------------------------------------*/
+
+/* Payload of TELEMETRY_MEMORY records and CMD_MEMORY responses */
+typedef struct __attribute__((packed)) {
+  uint32_t tick;            // HAL tick (ms) of the scan
+  uint32_t stack_reserve;   // _Min_Stack_Size
+  uint32_t stack_peak;      // Deepest MSP use since start-up
+  uint32_t heap_reserve;    // _Min_Heap_Size
+  uint32_t heap_used;       // Bytes handed out by _sbrk
+  uint32_t free;            // Never used bytes between heap and stack
+  uint16_t sbrk_failures;
+  uint8_t flags;            // MEM_FLAG_x
+} mem_usage_t;
+
+/* Exported functions -------------------------------------------------------*/
+void mem_paint(uint32_t *start, uint32_t *end);
+size_t mem_unused(const uint32_t *start, const uint32_t *end);
+
+uint32_t sysmem_heap_used(void);
+uint32_t sysmem_sbrk_failures(void);
+
+#if MEM_MONITOR_ENABLED
+void mem_monitor_init(void);
+void mem_monitor_service(void);
+void mem_monitor_usage(mem_usage_t *usage);
+#else
+#define mem_monitor_init()      do { } while (0)
+#define mem_monitor_service()   do { } while (0)
+#endif
+
+#endif
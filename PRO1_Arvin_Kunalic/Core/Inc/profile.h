@@ -0,0 +1,124 @@
+/**************************************************************************//**
+ * @file     profile.h
+ * @brief    Header for profile.c file
+ *
+ * @details  Cycle-accurate execution time profiling with the DWT cycle
+ *           counter (CYCCNT) of the Cortex-M4. A measured section is
+ *           enclosed in
+ *
+ *             PROFILE_BEGIN();
+ *             ...
+ *             PROFILE_END(PROFILE_EXTI);
+ *
+ *           and every pass adds its cycle count to the statistics of the
+ *           probe: count, min, max, total (for the mean) and a histogram
+ *           with log2 buckets, bucket n counts passes of 2^n to 2^(n+1)-1
+ *           cycles. Recording is inline, about 15 cycles, of which the
+ *           constant part is measured at start-up and subtracted.
+ *
+ *           Every probe is only recorded from one context (its ISR or the
+ *           main loop), so no locking is needed. Times include interrupts
+ *           that preempt the section.
+ *
+ *           The statistics are read over USART2 (CMD_PROFILE, see
+ *           cmd_protocol.h, and 'traffic_cli.py profile') or shown on the
+ *           OLED with profile_show. Requests over USART2 only set a flag,
+ *           the table is drawn in the main loop (profile_service).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "main.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to compile every probe out */
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED     1
+#endif
+
+#define PROFILE_BUCKETS     32
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  PROFILE_EXTI,           // HAL_GPIO_EXTI_Callback
+  PROFILE_TIM3,           // TIM3 branch of HAL_TIM_PeriodElapsedCallback
+  PROFILE_TIM5,           // TIM5 branch of HAL_TIM_PeriodElapsedCallback
+  PROFILE_TRAFFIC_STEP,   // One pass of the state machine (Traffic_step)
+  PROFILE_STATUS_PAGE,    // One refresh of the OLED status page
+  PROFILE_COUNT
+} profile_probe_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint32_t histogram[PROFILE_BUCKETS];
+} profile_stats_t;
+
+/* Macros -------------------------------------------------------------------*/
+#if PROFILE_ENABLED
+#define PROFILE_BEGIN()     const uint32_t profile_start_ = DWT->CYCCNT
+#define PROFILE_END(probe)  profile_record((probe), DWT->CYCCNT - profile_start_)
+#else
+#define PROFILE_BEGIN()     do { } while (0)
+#define PROFILE_END(probe)  do { } while (0)
+#endif
+
+#if PROFILE_ENABLED
+
+/* Exported variables -------------------------------------------------------*/
+extern profile_stats_t profile_stats[PROFILE_COUNT];
+extern uint32_t profile_overhead;
+
+/* Exported functions -------------------------------------------------------*/
+void profile_init(void);
+void profile_snapshot(profile_probe_t probe, profile_stats_t *stats);
+void profile_reset(profile_probe_t probe);
+void profile_show(void);
+void profile_request_show(void);
+void profile_service(void);
+
+/**************************************************************************//**
+ * @brief   Adds one measurement to the statistics of a probe.
+ * @details Should not be called directly, use PROFILE_BEGIN/PROFILE_END.
+ * @version 1.0
+ * @param   profile_probe_t probe, The measured section.
+ * @param   uint32_t cycles, Raw cycle count, including the overhead.
+ * @return  None
+ *****************************************************************************/
+static inline void profile_record(profile_probe_t probe, uint32_t cycles) {
+  profile_stats_t *stats = &profile_stats[probe];
+
+  cycles = (cycles > profile_overhead) ? cycles - profile_overhead : 0;
+  stats->count++;
+  stats->total += cycles;
+  if (cycles < stats->min) {
+    stats->min = cycles;
+  }
+  if (cycles > stats->max) {
+    stats->max = cycles;
+  }
+  stats->histogram[31 - __CLZ(cycles | 1)]++;
+}
+
+#else
+
+#define profile_init()      do { } while (0)
+#define profile_service()   do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/**************************************************************************//**
+ * @file     ramfunc.h
+ * @brief    Placement of hot functions and large buffers in SRAM2.
+ *
+ * @details  At 80 MHz the flash needs 4 wait states (FLASH_LATENCY_4). The
+ *           ART accelerator hides them for straight code, but a taken branch
+ *           to a line that is not in its cache costs the full latency. Code
+ *           in SRAM2, executed through the ICode/DCode bus at 0x10000000,
+ *           runs without wait states.
+ *
+ *           Functions marked RAMFUNC go to the .ramfunc section, which the
+ *           linker script places in RAM2 with its load image in flash. The
+ *           start-up code copies it before main (startup_stm32l476rgtx.s).
+ *           The CubeMX interrupt handlers and the HAL interrupt dispatchers
+ *           they call can't be marked, the linker script moves them by name.
+ *
+ *           Calls between flash and SRAM2 are too far for a BL instruction,
+ *           the linker inserts a veneer (a few cycles). A RAM function should
+ *           therefore keep its inner loop free of calls into flash.
+ *
+ *           Set RAMFUNC_ENABLED to 0 to leave the marked functions in flash,
+ *           e.g. to compare both with the benchmark suite (see benchmark.h).
+ *           Tools/map_report.py shows what landed where.
+ *
+ *           RAM2_BSS places a zero-initialized variable in the .ram2_bss
+ *           section after the RAM functions, e.g. the OLED framebuffer. It
+ *           keeps large buffers out of SRAM1, where the stack, the heap and
+ *           the bit-band addressed state (ctrl_state.h) are. The start-up
+ *           code clears the section like .bss. It does not depend on
+ *           RAMFUNC_ENABLED.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.1
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to keep every function in flash */
+#ifndef RAMFUNC_ENABLED
+#define RAMFUNC_ENABLED     1
+#endif
+
+/* Exported macros ----------------------------------------------------------*/
+#if RAMFUNC_ENABLED
+#define RAMFUNC             __attribute__((section(".ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+#define RAM2_BSS            __attribute__((section(".ram2_bss")))
+
+#endif
@@ -45,10 +45,14 @@
 extern uint8_t OLED_framebuffer[OLED_BUFFER_SIZE];
 
 /* Exported functions -------------------------------------------------------*/
-void reset_OLED(void);
 void send_command_OLED(uint8_t command);
 void send_data_OLED(uint8_t data);
 void init_OLED(void);
+void display_start(void);
+void display_service(void);
+bool display_ready(void);
+uint32_t display_frames(void);
+void display_mark_rows(int16_t y, int16_t height);
 void update_screen(void);
 void clear_screen(void);
 void draw_char(uint8_t x, uint8_t y, char c);
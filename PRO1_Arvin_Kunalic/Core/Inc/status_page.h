@@ -0,0 +1,73 @@
+/**************************************************************************//**
+ * @file     status_page.h
+ * @brief    Header for status_page.c file
+ *
+ * @details  Graphical status page of the OLED, in place of the text lines
+ *           the state machine and the interrupts used to write:
+ *
+ *           - Left half: a schematic of the junction with the four car
+ *             signal heads and the two pedestrian heads, drawn lamp by lamp
+ *             from the lamps that are lit (filled = lit, ring = dark), a car
+ *             icon on every approach with a car waiting and a pedestrian
+ *             icon at every crosswalk with a pedestrian waiting.
+ *           - Right half: the state, the seconds left in the current phase
+ *             in large digits, what happens when they run out and a
+ *             progress bar of the phase.
+ *
+ *           status_page_service runs in the main loop and refreshes the page
+ *           every STATUS_PAGE_PERIOD_MS. A refresh compares the inputs of
+ *           every element with what it drew last time and redraws only the
+ *           elements that changed; display_service then sends only the
+ *           pages they touched. A refresh without changes reads a few
+ *           registers and draws nothing.
+ *
+ *           The text messages are kept for STATUS_PAGE_ENABLED = 0, through
+ *           STATUS_TEXT.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef STATUS_PAGE_H
+#define STATUS_PAGE_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ssd1306_config.h"
+#include "profile.h"
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 for the text messages instead of the status page */
+#ifndef STATUS_PAGE_ENABLED
+#define STATUS_PAGE_ENABLED     1
+#endif
+
+#define STATUS_PAGE_PERIOD_MS   80      // 12.5 refreshes per second
+#define STATUS_PAGE_HOLD_MS     5000    // Time another screen stays up
+
+/* Macros -------------------------------------------------------------------*/
+
+/* A text message of the state machine, only shown without the status page */
+#if STATUS_PAGE_ENABLED
+#define STATUS_TEXT(x, y, str)  do { } while (0)
+#else
+#define STATUS_TEXT(x, y, str)  draw_string((x), (y), (str))
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+#if STATUS_PAGE_ENABLED
+void status_page_service(void);
+void status_page_refresh(void);
+void status_page_hold(void);
+#else
+#define status_page_service()   profile_service()
+#define status_page_hold()      do { } while (0)
+#endif
+
+#endif
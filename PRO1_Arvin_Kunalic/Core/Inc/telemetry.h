@@ -0,0 +1,69 @@
+/**************************************************************************//**
+ * @file     telemetry.h
+ * @brief    Header for telemetry.c file
+ *
+ * @details  This file declares the record types and functions of the USART2
+ *           telemetry stream. Records are appended to a lock-free ring buffer
+ *           by ISRs and the main loop, and drained to USART2 by DMA.
+ *
+ *           Every record on the wire has the following layout:
+ *
+ *             | 0xA5 | type | len | payload (len bytes) |
+ *
+ *           Event records (phase changes, inputs, lamp words) carry a
+ *           'telemetry_event_t' as payload. Trace records are described
+ *           in trace.h.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Ring buffer size in bytes, must be a power of two */
+#define TELEMETRY_BUFFER_SIZE   1024
+
+/* Largest single DMA burst (bytes) */
+#define TELEMETRY_MAX_BURST     256
+
+/* Record framing */
+#define TELEMETRY_SYNC          0xA5
+#define TELEMETRY_HEADER_SIZE   3
+
+/* Record types */
+#define TELEMETRY_PHASE         0x01    // FSM state change, id = new state, value = old state
+#define TELEMETRY_INPUT         0x02    // Button/sensor edge, id = GPIO pin, value = input bitmask
+#define TELEMETRY_LAMPS         0x03    // Shift register output word on change, value = 24-bit word, id = 1 for a lamp test
+#define TELEMETRY_TRACE         0x04    // Tokenized log message, see trace.h
+#define TELEMETRY_TEXT          0x05    // stdout/stderr text, see uart_stdio.h
+#define TELEMETRY_RESPONSE      0x06    // Command response, see cmd_protocol.h
+#define TELEMETRY_MEMORY        0x07    // Stack/heap high-water marks, see mem_monitor.h
+#define TELEMETRY_CRASH         0x08    // Part of the dump of the last crash, see crash_dump.h
+
+/* Exported types -----------------------------------------------------------*/
+
+/* Payload of the event record types */
+typedef struct __attribute__((packed)) {
+  uint32_t tick;    // HAL tick (ms) when the event was logged
+  uint32_t value;
+  uint16_t id;
+} telemetry_event_t;
+
+/* Exported functions -------------------------------------------------------*/
+void telemetry_init(void);
+bool telemetry_write(uint8_t type, const void *payload, uint8_t len);
+bool telemetry_event(uint8_t type, uint16_t id, uint32_t value);
+void telemetry_kick(void);
+uint32_t telemetry_dropped(void);
+
+#endif
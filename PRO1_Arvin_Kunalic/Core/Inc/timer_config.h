@@ -30,6 +30,11 @@
  *                               Which in turn means, I do not really need to have a timer capable of 30s
  *                               time-keeping, but I find this solution easier to understand for someone
  *                               not completely familiar with the project task.
+ *
+ *      The delays below are only the defaults. The state machine reads the values
+ *      from 'timer_params', which can be changed at runtime with the USART2 command
+ *      protocol (see cmd_protocol.h) without reflashing. New values take effect the
+ *      next time the state machine compares a timer against them.
  * 
  ******************************************************************************
  * @author   Arvin Kunalic
@@ -41,24 +46,93 @@
 #ifndef TIMER_CONFIG_H
 #define TIMER_CONFIG_H
 
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
 
 /* Exported constants -------------------------------------------------------*/
 
+/* Prescaler division of TIM3, TIM4, TIM5 and TIM15 (tim.c) */
+#define TIMER_PRESCALER     40000
+
+/* Highest time speed-up for hardware-in-the-loop runs (see timer_set_speedup).
+ * The TIM3 interrupt takes over 10ms (buffer_to_SPI), its default 125ms
+ * period must stay above that or the main loop never runs again. */
+#define TIMER_SPEEDUP_MAX   10
+
+/* Shortest real TIM3 period in ticks, (toggle_Freq + 1) / speed-up. Below
+ * it the TIM3 interrupt is pending again before it returns, and neither the
+ * main loop nor the command protocol gets to run. 25 ticks (12.5ms) is the
+ * default period at TIMER_SPEEDUP_MAX. */
+#define TIM3_PERIOD_MIN     25
+
+/* Auto-Reload values of the timers the delays are compared against (tim.c) */
+#define TIM4_PERIOD         (10000 - 1)
+#define TIM15_PERIOD        (60000 - 1)
+
+/* Highest Auto-Reload value of TIM5, the walk time is written to it. TIM5
+ * has a 32-bit counter, so the 16-bit parameter is the limit (~32s). */
+#define TIM5_PERIOD_MAX     UINT16_MAX
+
+/* Ticks TIM4 has to count past the pedestrian delay before it wraps. The
+ * state machine only sees the delay reached inside that window, a pass of
+ * the main loop that comes later misses it for good. The defaults leave
+ * 201 ticks (~100ms). */
+#define TIM4_MARGIN         201
+
+/* Ticks TIM15 has to count past the Wait20s/Wait30s delays before it wraps,
+ * for the same reason. TIM15 runs without an interrupt and is only polled
+ * by the main loop, which the 10ms latch delay of buffer_to_SPI holds up
+ * for 200 ticks at TIMER_SPEEDUP_MAX. */
+#define TIM15_MARGIN        201
+
 /* -100 for some margin of error */
-#define TIMER_2s            (3999 - 100) // 2s Delay
+#define TIMER_2s_DEFAULT    (3999 - 100) // 2s Delay
 #define TIMER_5s            (9999 - 100) // 5s Delay
 
-#define toggle_Freq         249     // = 125ms (TIM3) 
+#define toggle_Freq_DEFAULT 249     // = 125ms (TIM3) 
+#define walk_Time_DEFAULT   29999   // = 15s (TIM5)
 
-#define orange_Delay        (5999 - 100)    // 3s delay (TIM4)
-#define pedestrian_Delay    (orange_Delay + TIMER_2s)  // ~ 5s (TIM4)
+#define orange_Delay_DEFAULT (5999 - 100)   // 3s delay (TIM4)
 
 /* 
 * When these constants are used, they will result in 20 and 30s delays, 
 * but the constants themselves are in fact 5s and 15s.
 */
 #define transition_Time     30000   // 15s to transition from one intersection to another
-#define red_delay_Max       (((40000 - transition_Time) - 1) - 100)   // ~ 20s total (TIM15)
-#define green_Delay         (((60000 - transition_Time) - 1) - 100)   // ~ 30s total (TIM15) 
+#define red_delay_Max_DEFAULT (((40000 - transition_Time) - 1) - 100)   // ~ 20s total (TIM15)
+#define green_Delay_DEFAULT   (((60000 - transition_Time) - 1) - 100)   // ~ 30s total (TIM15) 
+
+/* Exported types -----------------------------------------------------------*/
+
+/* Timing parameters that can be changed at runtime */
+typedef enum {
+  PARAM_STEP_DELAY = 0,     // TIMER_2s, red/green off to yellow (TIM4)
+  PARAM_ORANGE_DELAY,       // orange_Delay, yellow to green/red (TIM4)
+  PARAM_RED_DELAY_MAX,      // red_delay_Max (TIM15)
+  PARAM_GREEN_DELAY,        // green_Delay (TIM15)
+  PARAM_TOGGLE_FREQ,        // toggle_Freq, blue light period (TIM3 ARR)
+  PARAM_WALK_TIME,          // walk_Time, pedestrian green time (TIM5 ARR)
+  TIMER_PARAM_COUNT
+} timer_param_t;
+
+/* Exported variables -------------------------------------------------------*/
+extern volatile uint16_t timer_params[TIMER_PARAM_COUNT];
+
+/* Runtime values, used exactly like the former constants */
+#define TIMER_2s            (timer_params[PARAM_STEP_DELAY])
+#define orange_Delay        (timer_params[PARAM_ORANGE_DELAY])
+#define pedestrian_Delay    (orange_Delay + TIMER_2s)  // ~ 5s (TIM4)
+#define red_delay_Max       (timer_params[PARAM_RED_DELAY_MAX])
+#define green_Delay         (timer_params[PARAM_GREEN_DELAY])
+#define toggle_Freq         (timer_params[PARAM_TOGGLE_FREQ])
+#define walk_Time           (timer_params[PARAM_WALK_TIME])
+
+/* Exported functions -------------------------------------------------------*/
+void timer_params_reset(void);
+bool timer_param_set(uint8_t id, uint16_t value);
+bool timer_param_limits(uint8_t id, uint16_t *min, uint16_t *max);
+bool timer_set_speedup(uint8_t factor);
+uint8_t timer_speedup(void);
 
-#endif
\ No newline at end of file
+#endif
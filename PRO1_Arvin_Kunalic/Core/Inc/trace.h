@@ -0,0 +1,65 @@
+/**************************************************************************//**
+ * @file     trace.h
+ * @brief    Header for trace.c file
+ *
+ * @details  Tokenized (deferred formatting) logging. A call such as
+ *
+ *             TRACE("Car%u active, crosswalk red = %u", 1, flag_get(FLAG_CROSSWALK1_RED));
+ *
+ *           does not format anything on the MCU. The format string is placed
+ *           in the '.trace_fmt' section, which is kept in the ELF file but
+ *           never loaded into flash, and its offset in that section is used
+ *           as the message ID. Only the ID, a time stamp and the raw 32-bit
+ *           arguments are written to the telemetry ring:
+ *
+ *             | tick (4) | id (2) | arg0 (4) | ... | argN (4) |
+ *
+ *           Tools/trace_decode.py looks the ID up in the ELF file (or in an
+ *           exported side table) and prints the formatted message.
+ *
+ *           Arguments are passed as 32-bit integers, so only integer
+ *           conversions (%d %i %u %x %X %o %c) are supported. At most
+ *           TRACE_MAX_ARGS arguments can be passed.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Set to 0 to compile every TRACE call out */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED       1
+#endif
+
+#define TRACE_MAX_ARGS      8
+
+/* Macros -------------------------------------------------------------------*/
+#if TRACE_ENABLED
+#define TRACE(fmt, ...)                                                           \
+  do {                                                                            \
+    static const char trace_fmt_[] __attribute__((section(".trace_fmt"), used)) = fmt; \
+    const uint32_t trace_args_[] = {0, ##__VA_ARGS__};                            \
+    _Static_assert(sizeof(trace_args_) / sizeof(uint32_t) - 1 <= TRACE_MAX_ARGS,   \
+                   "Too many TRACE arguments");                                   \
+    trace_emit((uint16_t)(uintptr_t)trace_fmt_,                                   \
+               sizeof(trace_args_) / sizeof(uint32_t) - 1, &trace_args_[1]);      \
+  } while (0)
+#else
+#define TRACE(fmt, ...) do { } while (0)
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+void trace_emit(uint16_t id, uint8_t argc, const uint32_t *argv);
+
+#endif
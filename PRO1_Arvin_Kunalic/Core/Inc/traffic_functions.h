@@ -35,14 +35,7 @@
 #include "fonts.h"
 #include <stm32l476xx.h>
 #include "clock.h"
-
-/* Exported variables -------------------------------------------------------*/
-
-/* Active car indicators, 0 = car not active, 1 = active car */
-extern volatile bool car1_active;
-extern volatile bool car2_active;
-extern volatile bool car3_active;
-extern volatile bool car4_active;
+#include "ctrl_state.h"
 
 /* Exported functions -------------------------------------------------------*/
 
@@ -51,4 +44,11 @@ void stop_and_resetTimer(TIM_HandleTypeDef *htim_x);
 bool no_active_cars(void);
 bool active_cars_at(uint8_t intersection);
 
+/* traffic.c */
+void Traffic(void);
+void Traffic_init(void);
+void Traffic_step(void);
+uint8_t traffic_state(void);
+uint32_t traffic_phase_changes(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+/**************************************************************************//**
+ * @file     uart_stdio.h
+ * @brief    Header for uart_stdio.c file
+ *
+ * @details  Retargets stdout/stderr (printf, puts, ...) to the USART2
+ *           telemetry stream. Text is batched per line and sent as
+ *           TELEMETRY_TEXT records, so it interleaves cleanly with the
+ *           other telemetry records.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef UART_STDIO_H
+#define UART_STDIO_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Longest line that is batched into a single record */
+#define UART_STDIO_LINE_SIZE    128
+
+/* Overflow policies, what happens when the telemetry ring is full */
+#define UART_STDIO_DROP         0   // Discard the text (never waits)
+#define UART_STDIO_BLOCK        1   // Wait for the DMA to free space (thread mode only)
+
+#ifndef UART_STDIO_OVERFLOW
+#define UART_STDIO_OVERFLOW     UART_STDIO_DROP
+#endif
+
+/* Exported functions -------------------------------------------------------*/
+void uart_stdio_init(void);
+void uart_stdio_set_overflow(uint8_t policy);
+void uart_stdio_flush(void);
+uint32_t uart_stdio_dropped(void);
+
+#endif
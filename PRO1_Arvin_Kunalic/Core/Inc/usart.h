@@ -34,6 +34,10 @@ extern "C" {
 
 extern UART_HandleTypeDef huart2;
 
+extern DMA_HandleTypeDef hdma_usart2_rx;
+
+extern DMA_HandleTypeDef hdma_usart2_tx;
+
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
@@ -28,26 +28,23 @@
 #include "spi.h"
 #include "usart.h"
 #include "gpio.h"
+#include "telemetry.h"
+#include "fast_io.h"
+#include "gpio_pins.h"
+#include "status_page.h"
 
 /* Variables ----------------------------------------------------------------*/
 uint8_t shiftreg_buffer[SHIFTREG_BUFFER_SIZE] = {0x00, 0x00, 0x00};
 const uint32_t init_state = ((TL2_Green | TL4_Green) | PL2_Red) | ((TL1_Red | TL3_Red) | PL1_Green);
 
-/* Initial start values per requirements R1.1 and R2.8 */
-volatile bool crosswalk1_green = 1;
-volatile bool crosswalk1_red = 0;
+/* Lamp test, requested over USART2 (see cmd_protocol.c). Pending and active
+ * are flags of ctrl_state. */
+static volatile uint32_t lamp_test_pattern;
+static volatile uint16_t lamp_test_duration;
+static uint32_t lamp_test_start;
 
-volatile bool crosswalk2_green = 0;
-volatile bool crosswalk2_red = 1;
-
-volatile bool PL1_SW_HIT = 0;
-volatile bool PL2_SW_HIT = 0;
-
-volatile bool intersection1_green = 0;
-volatile bool intersection1_red = 1;
-
-volatile bool intersection2_green = 1;
-volatile bool intersection2_red = 0;
+/* Last lamp word reported over telemetry */
+static uint32_t lamps_reported = 0xFFFFFFFF;
 
 /* Functions ---------------------------------------------------------------*/
 
@@ -60,27 +57,61 @@ volatile bool intersection2_red = 0;
  * @return  None
  *****************************************************************************/
 void reset_595register(void) {
-    HAL_GPIO_WritePin(_595_Reset_GPIO_Port, _595_Reset_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(_595_STCP_GPIO_Port, _595_STCP_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(_595_STCP_GPIO_Port, _595_STCP_Pin, GPIO_PIN_SET);
+    PIN_RESET(_595_Reset);
+    PIN_RESET(_595_STCP);
+    PIN_SET(_595_STCP);
+    HAL_Delay(10);
+    PIN_SET(_595_Reset);
+}
+
+/**************************************************************************//**
+ * @brief   Shifts three bytes out to the shift registers and latches them.
+ * @details Called from the main loop and from the TIM3 interrupt. The bytes
+ *          are sent with interrupts disabled (a few us), so an update from
+ *          the interrupt can not be shifted in between them. An update
+ *          during the delay sends and latches all three bytes itself, the
+ *          latch after it then repeats the same word.
+ * @version 1.1
+ * @param   uint8_t *data, The bytes to send, in `shiftreg_buffer` order.
+ * @return  None
+ *****************************************************************************/
+static void shift_out(uint8_t *data) {
+    const uint32_t primask = __get_PRIMASK();
+
+    PIN_RESET(_595_STCP);
+    __disable_irq();
+    fast_spi_send(&hspi3, data, SHIFTREG_BUFFER_SIZE);
+    __set_PRIMASK(primask);
     HAL_Delay(10);
-    HAL_GPIO_WritePin(_595_Reset_GPIO_Port, _595_Reset_Pin, GPIO_PIN_SET);
+    PIN_SET(_595_STCP);
 }
 
 /**************************************************************************//**
  * @brief   Transmits the contents of the `shiftreg_buffer` to the shift registers.
  * @details Sends the buffer data using SPI and latches the data to update
  *          the physical outputs of the 74HC595D shift registers.
- * @version 1.0
+ *          While a lamp test is running only the buffer is kept up to date,
+ *          it is sent when the test ends. Changes of the lamp word are
+ *          reported as TELEMETRY_LAMPS events.
+ * @version 1.2
  * @param   None
  * @return  None
  * @note    Make sure 'shiftreg_buffer` is updated before calling this function.
  *****************************************************************************/
 void buffer_to_SPI(void) {
-    HAL_GPIO_WritePin(_595_STCP_GPIO_Port, _595_STCP_Pin, GPIO_PIN_RESET);
-    HAL_SPI_Transmit(&hspi3, shiftreg_buffer, SHIFTREG_BUFFER_SIZE, HAL_MAX_DELAY);
-    HAL_Delay(10);
-    HAL_GPIO_WritePin(_595_STCP_GPIO_Port, _595_STCP_Pin, GPIO_PIN_SET);
+    if (flag_get(FLAG_LAMP_TEST_ACTIVE)) {
+        return;
+    }
+
+    shift_out(shiftreg_buffer);
+
+    uint32_t lamps = (shiftreg_buffer[U1] << 16)
+                   | (shiftreg_buffer[U2] << 8)
+                   | (shiftreg_buffer[U3]);
+    if (lamps != lamps_reported) {
+        lamps_reported = lamps;
+        telemetry_event(TELEMETRY_LAMPS, 0, lamps);
+    }
 }
 
 /**************************************************************************//**
@@ -150,7 +181,7 @@ void clear_pin(uint32_t pins) {
  * @brief   Flashes the pedestrian blue light to indicate a waiting pedestrian.
  * @details Activates the blue light of the specified crosswalk in a
  *          blinking pattern for a duration defined by `Pedestrian_Delay`.
- * @version 2.0
+ * @version 2.1
  * @param   uint8_t crosswalk, The crosswalk identifier (1 or 2).
  * @return  None
  * @note    This function only works properly if the identifier is 1 or 2.
@@ -159,20 +190,18 @@ void clear_pin(uint32_t pins) {
  * @see     set_pin, clear_pin, HAL_TIM_PeriodElapsedCallback (ISR for timer 3)
  *****************************************************************************/
 void toggle_pedestrian(uint8_t crosswalk) {
-    static uint32_t pin;
-    static bool toggle = 0;
+    const uint32_t pin = (crosswalk == 1) ? PL1_Blue : PL2_Blue;
+    const bool lit = flag_get(FLAG_BLUE_ON);
 
-    (crosswalk == 1) ? (pin = PL1_Blue) : (pin = PL2_Blue);
+    (lit) ? (clear_pin(pin)) : (set_pin(pin));
 
-    (toggle) ? (clear_pin(pin)) : (set_pin(pin));
-
-    toggle = !toggle;
+    flag_write(FLAG_BLUE_ON, !lit);
 }
 
 /**************************************************************************//**
  * @brief   Activates the green pedestrian light and disables red light.
  * @details Changes the state of the pedestrian lights from green to red.
- * @version 2.0
+ * @version 2.2
  * @param   uint8_t crosswalk, The crosswalk identifier (1 or 2).
  * @return  None
  * @note    This function only works properly if the identifier is 1 or 2.
@@ -181,22 +210,22 @@ void toggle_pedestrian(uint8_t crosswalk) {
  * @see     toggle_pedestrian, stop_pedestrian, set_pin, clear_pin
  *****************************************************************************/
 void go_pedestrian(uint8_t crosswalk) {
-    static uint32_t pin_red, pin_green;
+    uint32_t pin_red, pin_green;
 
     if (crosswalk == 1) {
         pin_red = PL1_Red;
         pin_green = PL1_Green;
-        crosswalk1_green = 1;
-        crosswalk1_red = 0;
-        draw_string(0, 0, "Pedestrians can    ");
-        draw_string(0, 8, "     cross lane 1!");
+        flag_set(FLAG_CROSSWALK1_GREEN);
+        flag_clear(FLAG_CROSSWALK1_RED);
+        STATUS_TEXT(0, 0, "Pedestrians can    ");
+        STATUS_TEXT(0, 8, "     cross lane 1!");
     } else if (crosswalk == 2) {
         pin_red = PL2_Red;
         pin_green = PL2_Green;
-        crosswalk2_green = 1;
-        crosswalk2_red = 0;
-        draw_string(0, 0, "Pedestrians can    ");
-        draw_string(0, 8, "     cross lane 2!");
+        flag_set(FLAG_CROSSWALK2_GREEN);
+        flag_clear(FLAG_CROSSWALK2_RED);
+        STATUS_TEXT(0, 0, "Pedestrians can    ");
+        STATUS_TEXT(0, 8, "     cross lane 2!");
     } else {
         return; // Invalid intersection
     }
@@ -208,7 +237,7 @@ void go_pedestrian(uint8_t crosswalk) {
     *   If 'go_pedestrian' is called after a pedestrian button-press, make
     *   sure 'walking_Delay' time is met.
     */
-    if (PL1_SW_HIT || PL2_SW_HIT) {
+    if (flag_get(FLAG_PL1_SW_HIT) || flag_get(FLAG_PL2_SW_HIT)) {
 
     /* Start pedestrian_Delay timer making sure R1.3 is met */
     HAL_TIM_Base_Start_IT(&htim5); 
@@ -219,7 +248,7 @@ void go_pedestrian(uint8_t crosswalk) {
 /**************************************************************************//**
  * @brief   Activates the red pedestrian light and disables the green light.
  * @details Changes the state of the pedestrian lights from green to red.
- * @version 1.2
+ * @version 1.4
  * @param   uint8_t crosswalk, The crosswalk identifier (1 or 2).
  * @return  None
  * @note    This function only works properly if the identifier is 1 or 2.
@@ -228,22 +257,22 @@ void go_pedestrian(uint8_t crosswalk) {
  * @see     toggle_pedestrian, go_pedestrian, set_pin, clear_pin
 *****************************************************************************/
 void stop_pedestrian(uint8_t crosswalk) {
-    static uint32_t pin_green, pin_red;
+    uint32_t pin_green, pin_red;
 
     if (crosswalk == 1) {
         pin_green = PL1_Green;
         pin_red = PL1_Red;
-        crosswalk1_green = 0;
-        crosswalk1_red = 1;
-        draw_string(0, 0, "Pedestrians cannot ");
-        draw_string(0, 8, "     cross lane 1..");
+        flag_clear(FLAG_CROSSWALK1_GREEN);
+        flag_set(FLAG_CROSSWALK1_RED);
+        STATUS_TEXT(0, 0, "Pedestrians cannot ");
+        STATUS_TEXT(0, 8, "     cross lane 1..");
     } else if (crosswalk == 2) {
         pin_green = PL2_Green;
         pin_red = PL2_Red;
-        crosswalk2_green = 0;
-        crosswalk2_red = 1;
-        draw_string(0, 0, "Pedestrians cannot ");
-        draw_string(0, 8, "     cross lane 2..");
+        flag_clear(FLAG_CROSSWALK2_GREEN);
+        flag_set(FLAG_CROSSWALK2_RED);
+        STATUS_TEXT(0, 0, "Pedestrians cannot ");
+        STATUS_TEXT(0, 8, "     cross lane 2..");
     } else {
         return; // Invalid intersection
     }
@@ -258,7 +287,7 @@ void stop_pedestrian(uint8_t crosswalk) {
  *          emulating realistic traffic light behavior. The full transition
  *          takes 5 seconds, with the yellow light active for 'orange_Delay' ticks
  *          (1 tick = 0.5 ms).  
- * @version 3.0
+ * @version 3.1
  * @param   uint8_t intersection, The intersection identifier (1 or 2).
  * @return  None
  * @note    - This function only works properly if the identifier is 1 or 2.
@@ -273,21 +302,21 @@ void stop_pedestrian(uint8_t crosswalk) {
  * @see     stop_intersection, set_pin, clear_pin
  *****************************************************************************/
 void go_intersection(uint8_t intersection) {
-    static uint32_t greens, yellows, reds;
-    static bool stage = 0;
-
-    if (stage == 0) {
-        if (intersection == 1) {
-            greens = (TL1_Green | TL3_Green);
-            yellows = (TL1_Yellow | TL3_Yellow);
-            reds = (TL1_Red | TL3_Red);
-        } else if (intersection == 2) {
-            greens = (TL2_Green | TL4_Green);
-            yellows = (TL2_Yellow | TL4_Yellow);
-            reds = (TL2_Red | TL4_Red);
-        } else {
-            return; // Invalid intersection
-        }
+    uint32_t greens, yellows, reds;
+
+    if (intersection == 1) {
+        greens = (TL1_Green | TL3_Green);
+        yellows = (TL1_Yellow | TL3_Yellow);
+        reds = (TL1_Red | TL3_Red);
+    } else if (intersection == 2) {
+        greens = (TL2_Green | TL4_Green);
+        yellows = (TL2_Yellow | TL4_Yellow);
+        reds = (TL2_Red | TL4_Red);
+    } else {
+        return; // Invalid intersection
+    }
+
+    if (!flag_get(FLAG_GO_YELLOW)) {
 
         if (__HAL_TIM_GetCounter(&htim4) >= TIMER_2s) { // Turn red light off after 2s
             HAL_TIM_Base_Stop(&htim4);
@@ -295,22 +324,22 @@ void go_intersection(uint8_t intersection) {
             clear_pin(reds);
             set_pin(yellows);
             HAL_TIM_Base_Start(&htim4);
-            (intersection == 1) ? (intersection1_red = 0) : (intersection2_red = 0);
-            stage = 1;
+            flag_write((intersection == 1) ? FLAG_INTERSECTION1_RED : FLAG_INTERSECTION2_RED, 0);
+            flag_set(FLAG_GO_YELLOW);
             return;
         } else {
             return;
         }
     }
 
-    if (stage == 1) {
+    if (flag_get(FLAG_GO_YELLOW)) {
         if (__HAL_TIM_GetCounter(&htim4) >= orange_Delay) {
             HAL_TIM_Base_Stop(&htim4);
             __HAL_TIM_SetCounter(&htim4, 0);
             clear_pin(yellows);
             set_pin(greens);
-            (intersection == 1) ? (intersection1_green = 1) : (intersection2_green = 1);
-            stage = 0;
+            flag_write((intersection == 1) ? FLAG_INTERSECTION1_GREEN : FLAG_INTERSECTION2_GREEN, 1);
+            flag_clear(FLAG_GO_YELLOW);
             return;
         } else {
             return;
@@ -324,7 +353,7 @@ void go_intersection(uint8_t intersection) {
  *          emulating realistic traffic light behavior. The full transition
  *          takes 5 seconds, with the yellow light active for 'orange_Delay' ticks
  *          (1 tick = 0.5 ms).  
- * @version 3.0
+ * @version 3.1
  * @param   uint8_t intersection, The intersection identifier (1 or 2).
  * @return  None
  * @note    - This function only works properly if the identifier is 1 or 2.
@@ -339,47 +368,116 @@ void go_intersection(uint8_t intersection) {
  * @see     go_intersection, set_pin, clear_pin
  *****************************************************************************/
 void stop_intersection(uint8_t intersection) {
-    static uint32_t greens, yellows, reds;
-    static bool stage = 0;
-
-    if (stage == 0) {
-        if (intersection == 1) {
-            greens = (TL1_Green | TL3_Green);
-            yellows = (TL1_Yellow | TL3_Yellow);
-            reds = (TL1_Red | TL3_Red);
-        } else if (intersection == 2) {
-            greens = (TL2_Green | TL4_Green);
-            yellows = (TL2_Yellow | TL4_Yellow);
-            reds = (TL2_Red | TL4_Red);
-        } else {
-            return; // Invalid intersection
-        }
+    uint32_t greens, yellows, reds;
+
+    if (intersection == 1) {
+        greens = (TL1_Green | TL3_Green);
+        yellows = (TL1_Yellow | TL3_Yellow);
+        reds = (TL1_Red | TL3_Red);
+    } else if (intersection == 2) {
+        greens = (TL2_Green | TL4_Green);
+        yellows = (TL2_Yellow | TL4_Yellow);
+        reds = (TL2_Red | TL4_Red);
+    } else {
+        return; // Invalid intersection
+    }
+
+    if (!flag_get(FLAG_STOP_YELLOW)) {
         if (__HAL_TIM_GetCounter(&htim4) >= (TIMER_2s)) { // Turn green light off after 2s
             HAL_TIM_Base_Stop(&htim4);
             __HAL_TIM_SetCounter(&htim4, 0);
             clear_pin(greens);
             set_pin(yellows);
             HAL_TIM_Base_Start(&htim4);
-            (intersection == 1) ? (intersection1_green = 0) : (intersection2_green = 0);
-            stage = 1;
+            flag_write((intersection == 1) ? FLAG_INTERSECTION1_GREEN : FLAG_INTERSECTION2_GREEN, 0);
+            flag_set(FLAG_STOP_YELLOW);
             return;
         } else {
             return;
         }
     }
 
-    if (stage == 1) {
+    if (flag_get(FLAG_STOP_YELLOW)) {
         if (__HAL_TIM_GetCounter(&htim4) >= orange_Delay) { 
             HAL_TIM_Base_Stop(&htim4);
             __HAL_TIM_SetCounter(&htim4, 0);
             clear_pin(yellows);
             set_pin(reds);
             HAL_TIM_Base_Start(&htim4);
-            (intersection == 1) ? (intersection1_red = 1) : (intersection2_red = 1);
-            stage = 0;
+            flag_write((intersection == 1) ? FLAG_INTERSECTION1_RED : FLAG_INTERSECTION2_RED, 1);
+            flag_clear(FLAG_STOP_YELLOW);
             return;
         } else {
             return;
         }
     }
 }
+
+/**************************************************************************//**
+ * @brief   Requests a lamp test.
+ * @details The pattern is shown for the given time, then the lamps return to
+ *          the state the traffic light state machine has set in the meantime.
+ *          The state machine itself keeps running and is not affected.
+ *          Safe to call from an ISR, the test is carried out by
+ *          lamp_test_service in the main loop.
+ * @version 1.0
+ * @param   uint32_t pattern, 24-bit lamp mask to show (TL1_Red | ...).
+ * @param   uint16_t duration_ms, How long to show it, 0 ends a running test.
+ * @return  None
+ * @see     lamp_test_service
+ *****************************************************************************/
+void lamp_test(uint32_t pattern, uint16_t duration_ms) {
+    lamp_test_pattern = pattern;
+    lamp_test_duration = duration_ms;
+    flag_set(FLAG_LAMP_TEST_PENDING);
+}
+
+/**************************************************************************//**
+ * @brief   Starts and ends requested lamp tests.
+ * @details Has to be called regularly from the main loop.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ * @see     lamp_test
+ *****************************************************************************/
+void lamp_test_service(void) {
+    if (flag_get(FLAG_LAMP_TEST_PENDING)) {
+        flag_clear(FLAG_LAMP_TEST_PENDING);
+
+        if (lamp_test_duration == 0) {
+            if (flag_get(FLAG_LAMP_TEST_ACTIVE)) {
+                flag_clear(FLAG_LAMP_TEST_ACTIVE);
+                buffer_to_SPI();
+            }
+            return;
+        }
+
+        uint32_t pattern = lamp_test_pattern;
+        uint8_t data[SHIFTREG_BUFFER_SIZE];
+        data[U1] = (pattern & 0xFF0000) >> 16;
+        data[U2] = (pattern & 0x00FF00) >> 8;
+        data[U3] = pattern & 0x0000FF;
+
+        flag_set(FLAG_LAMP_TEST_ACTIVE);
+        lamp_test_start = HAL_GetTick();
+        shift_out(data);
+        lamps_reported = pattern & 0xFFFFFF;
+        telemetry_event(TELEMETRY_LAMPS, 1, lamps_reported);
+        return;
+    }
+
+    if (flag_get(FLAG_LAMP_TEST_ACTIVE) && (HAL_GetTick() - lamp_test_start) >= lamp_test_duration) {
+        flag_clear(FLAG_LAMP_TEST_ACTIVE);
+        buffer_to_SPI();
+    }
+}
+
+/**************************************************************************//**
+ * @brief   Checks whether a lamp test is showing.
+ * @version 1.1
+ * @param   None
+ * @return  boolean, true while the test pattern is shown.
+ *****************************************************************************/
+bool lamp_test_running(void) {
+    return flag_get(FLAG_LAMP_TEST_ACTIVE);
+}
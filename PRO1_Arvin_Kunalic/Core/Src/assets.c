@@ -0,0 +1,535 @@
+/**************************************************************************//**
+ * @file     assets.c
+ * @brief    Fonts and bitmaps of the OLED, generated from Assets/assets.txt.
+ *
+ * @details  Generated by Tools/font_convert.py, do not edit. Rerun the script
+ *           after changing an asset or the list.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "assets.h"
+
+/* Variables ----------------------------------------------------------------*/
+static const uint8_t font_large_data[] = {
+    /* ' ' */
+    0xAB, 0x00,
+    /* '!' */
+    0x84, 0x00, 0x81, 0xFF, 0x8A, 0x00, 0x81, 0x7F, 0x8A, 0x00, 0x81, 0x1C,
+    0x84, 0x00,
+    /* '"' */
+    0x81, 0x00, 0x81, 0x3F, 0x81, 0x00, 0x81, 0x3F, 0x9F, 0x00,
+    /* '#' */
+    0x81, 0xC0, 0x81, 0xFF, 0x81, 0xC0, 0x81, 0xFF, 0x81, 0xC0, 0x81, 0x71,
+    0x81, 0xFF, 0x81, 0x71, 0x81, 0xFF, 0x81, 0x71, 0x81, 0x00, 0x81, 0x1F,
+    0x81, 0x00, 0x81, 0x1F, 0x81, 0x00,
+    /* '$' */
+    0x81, 0xC0, 0x81, 0x38, 0x81, 0xFF, 0x84, 0x38, 0x81, 0x81, 0x81, 0x8E,
+    0x81, 0xFF, 0x81, 0x8E, 0x81, 0x70, 0x84, 0x03, 0x81, 0x1F, 0x81, 0x03,
+    0x81, 0x00,
+    /* '%' */
+    0x84, 0x3F, 0x81, 0x00, 0x81, 0xC0, 0x81, 0x38, 0x81, 0x80, 0x81, 0x70,
+    0x81, 0x0E, 0x81, 0x81, 0x81, 0x80, 0x81, 0x03, 0x84, 0x00, 0x84, 0x1F,
+    /* '&' */
+    0x81, 0xF8, 0x81, 0x07, 0x81, 0xC7, 0x81, 0x38, 0x81, 0x00, 0x81, 0xF1,
+    0x81, 0x0E, 0x81, 0x71, 0x81, 0x80, 0x81, 0x70, 0x81, 0x03, 0x84, 0x1C,
+    0x81, 0x03, 0x81, 0x1C,
+    /* '\'' */
+    0x81, 0x00, 0x81, 0xC7, 0x81, 0x3F, 0x87, 0x00, 0x81, 0x01, 0x96, 0x00,
+    /* '(' */
+    0x81, 0x00, 0x81, 0xC0, 0x81, 0x38, 0x81, 0x07, 0x84, 0x00, 0x81, 0x7F,
+    0x81, 0x80, 0x8A, 0x00, 0x81, 0x03, 0x81, 0x1C, 0x81, 0x00,
+    /* ')' */
+    0x81, 0x00, 0x81, 0x07, 0x81, 0x38, 0x81, 0xC0, 0x87, 0x00, 0x81, 0x80,
+    0x81, 0x7F, 0x84, 0x00, 0x81, 0x1C, 0x81, 0x03, 0x84, 0x00,
+    /* '*' */
+    0x81, 0xC0, 0x81, 0x00, 0x81, 0xF8, 0x81, 0x00, 0x81, 0xC0, 0x81, 0x71,
+    0x81, 0x0E, 0x81, 0xFF, 0x81, 0x0E, 0x81, 0x71, 0x84, 0x00, 0x81, 0x03,
+    0x84, 0x00,
+    /* '+' */
+    0x84, 0x00, 0x81, 0xF8, 0x84, 0x00, 0x84, 0x0E, 0x81, 0xFF, 0x84, 0x0E,
+    0x84, 0x00, 0x81, 0x03, 0x84, 0x00,
+    /* ',' */
+    0x90, 0x00, 0x81, 0x70, 0x81, 0xF0, 0x87, 0x00, 0x81, 0x1C, 0x81, 0x03,
+    0x84, 0x00,
+    /* '-' */
+    0x8D, 0x00, 0x8D, 0x0E, 0x8D, 0x00,
+    /* '.' */
+    0x90, 0x00, 0x84, 0x80, 0x87, 0x00, 0x84, 0x1F, 0x84, 0x00,
+    /* '/' */
+    0x87, 0x00, 0x81, 0xC0, 0x81, 0x38, 0x81, 0x80, 0x81, 0x70, 0x81, 0x0E,
+    0x81, 0x01, 0x81, 0x00, 0x81, 0x03, 0x8A, 0x00,
+    /* '0' */
+    0x81, 0xF8, 0x84, 0x07, 0x81, 0xC7, 0x81, 0xF8, 0x81, 0xFF, 0x81, 0x70,
+    0x81, 0x0E, 0x81, 0x01, 0x81, 0xFF, 0x81, 0x03, 0x87, 0x1C, 0x81, 0x03,
+    /* '1' */
+    0x81, 0x00, 0x81, 0x38, 0x81, 0xFF, 0x8A, 0x00, 0x81, 0xFF, 0x87, 0x00,
+    0x81, 0x1C, 0x81, 0x1F, 0x81, 0x1C, 0x81, 0x00,
+    /* '2' */
+    0x81, 0x38, 0x87, 0x07, 0x81, 0xF8, 0x81, 0x00, 0x81, 0x80, 0x81, 0x70,
+    0x81, 0x0E, 0x81, 0x01, 0x81, 0x1C, 0x81, 0x1F, 0x87, 0x1C,
+    /* '3' */
+    0x84, 0x07, 0x81, 0xC7, 0x81, 0x3F, 0x81, 0x07, 0x81, 0x80, 0x81, 0x00,
+    0x81, 0x01, 0x81, 0x0E, 0x81, 0xF0, 0x81, 0x03, 0x87, 0x1C, 0x81, 0x03,
+    /* '4' */
+    0x81, 0x00, 0x81, 0xC0, 0x81, 0x38, 0x81, 0xFF, 0x81, 0x00, 0x81, 0x7E,
+    0x81, 0x71, 0x81, 0x70, 0x81, 0xFF, 0x81, 0x70, 0x87, 0x00, 0x81, 0x1F,
+    0x81, 0x00,
+    /* '5' */
+    0x81, 0xFF, 0x87, 0xC7, 0x81, 0x07, 0x81, 0x81, 0x87, 0x01, 0x81, 0xFE,
+    0x81, 0x03, 0x87, 0x1C, 0x81, 0x03,
+    /* '6' */
+    0x81, 0xC0, 0x81, 0x38, 0x84, 0x07, 0x81, 0x00, 0x81, 0xFF, 0x87, 0x0E,
+    0x81, 0xF0, 0x81, 0x03, 0x87, 0x1C, 0x81, 0x03,
+    /* '7' */
+    0x87, 0x07, 0x81, 0xC7, 0x81, 0x3F, 0x81, 0x00, 0x81, 0xF0, 0x81, 0x0E,
+    0x81, 0x01, 0x84, 0x00, 0x81, 0x1F, 0x87, 0x00,
+    /* '8' */
+    0x81, 0xF8, 0x87, 0x07, 0x81, 0xF8, 0x81, 0xF1, 0x87, 0x0E, 0x81, 0xF1,
+    0x81, 0x03, 0x87, 0x1C, 0x81, 0x03,
+    /* '9' */
+    0x81, 0xF8, 0x87, 0x07, 0x81, 0xF8, 0x81, 0x01, 0x84, 0x0E, 0x81, 0x8E,
+    0x81, 0x7F, 0x81, 0x00, 0x84, 0x1C, 0x81, 0x03, 0x81, 0x00,
+    /* ':' */
+    0x81, 0x00, 0x84, 0xF8, 0x87, 0x00, 0x84, 0xF1, 0x87, 0x00, 0x84, 0x03,
+    0x84, 0x00,
+};
+
+static const glyph_t font_large_glyphs[] = {
+    {    0,  15}, // ' '
+    {    2,  15}, // '!'
+    {   16,  15}, // '"'
+    {   26,  15}, // '#'
+    {   56,  15}, // '$'
+    {   82,  15}, // '%'
+    {  106,  15}, // '&'
+    {  134,  15}, // '\''
+    {  146,  15}, // '('
+    {  168,  15}, // ')'
+    {  190,  15}, // '*'
+    {  216,  15}, // '+'
+    {  234,  15}, // ','
+    {  248,  15}, // '-'
+    {  254,  15}, // '.'
+    {  264,  15}, // '/'
+    {  284,  15}, // '0'
+    {  308,  15}, // '1'
+    {  328,  15}, // '2'
+    {  350,  15}, // '3'
+    {  374,  15}, // '4'
+    {  400,  15}, // '5'
+    {  418,  15}, // '6'
+    {  438,  15}, // '7'
+    {  458,  15}, // '8'
+    {  476,  15}, // '9'
+    {  498,  15}, // ':'
+};
+
+const font_t font_large = {
+    .data = font_large_data,
+    .glyphs = font_large_glyphs,
+    .first = 0x20,
+    .last = 0x3A,
+    .width = 15,
+    .height = 24,
+    .spacing = 3,
+    .encoding = GLYPH_RLE,
+};
+
+static const uint8_t font_small_data[] = {
+    /* ' ' */
+    0x00, 0x00, 0x00,
+    /* '!' */
+    0x5F,
+    /* '"' */
+    0x03, 0x00, 0x03,
+    /* '#' */
+    0x14, 0x7F, 0x14, 0x7F, 0x14,
+    /* '$' */
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,
+    /* '%' */
+    0x23, 0x13, 0x08, 0x64, 0x62,
+    /* '&' */
+    0x36, 0x49, 0x55, 0x22, 0x50,
+    /* '\'' */
+    0x05, 0x03,
+    /* '(' */
+    0x1C, 0x22, 0x41,
+    /* ')' */
+    0x41, 0x22, 0x1C,
+    /* '*' */
+    0x14, 0x08, 0x3E, 0x08, 0x14,
+    /* '+' */
+    0x08, 0x08, 0x3E, 0x08, 0x08,
+    /* ',' */
+    0x50, 0x30,
+    /* '-' */
+    0x08, 0x08, 0x08, 0x08, 0x08,
+    /* '.' */
+    0x60, 0x60,
+    /* '/' */
+    0x20, 0x10, 0x08, 0x04, 0x02,
+    /* '0' */
+    0x3E, 0x51, 0x49, 0x45, 0x3E,
+    /* '1' */
+    0x42, 0x7F, 0x40,
+    /* '2' */
+    0x42, 0x61, 0x51, 0x49, 0x46,
+    /* '3' */
+    0x21, 0x41, 0x45, 0x4B, 0x31,
+    /* '4' */
+    0x18, 0x14, 0x12, 0x7F, 0x10,
+    /* '5' */
+    0x27, 0x45, 0x45, 0x45, 0x39,
+    /* '6' */
+    0x3C, 0x4A, 0x49, 0x49, 0x30,
+    /* '7' */
+    0x01, 0x71, 0x09, 0x05, 0x03,
+    /* '8' */
+    0x36, 0x49, 0x49, 0x49, 0x36,
+    /* '9' */
+    0x06, 0x49, 0x49, 0x29, 0x1E,
+    /* ':' */
+    0x36, 0x36,
+    /* ';' */
+    0x56, 0x36,
+    /* '<' */
+    0x08, 0x14, 0x22, 0x41,
+    /* '=' */
+    0x14, 0x14, 0x14, 0x14, 0x14,
+    /* '>' */
+    0x41, 0x22, 0x14, 0x08,
+    /* '?' */
+    0x02, 0x01, 0x51, 0x09, 0x06,
+    /* '@' */
+    0x3E, 0x41, 0x5D, 0x59, 0x4E,
+    /* 'A' */
+    0x7E, 0x09, 0x09, 0x09, 0x7E,
+    /* 'B' */
+    0x7F, 0x49, 0x49, 0x49, 0x36,
+    /* 'C' */
+    0x3E, 0x41, 0x41, 0x41, 0x22,
+    /* 'D' */
+    0x7F, 0x41, 0x41, 0x22, 0x1C,
+    /* 'E' */
+    0x7F, 0x49, 0x49, 0x49, 0x41,
+    /* 'F' */
+    0x7F, 0x09, 0x09, 0x09, 0x01,
+    /* 'G' */
+    0x3E, 0x41, 0x49, 0x49, 0x7A,
+    /* 'H' */
+    0x7F, 0x08, 0x08, 0x08, 0x7F,
+    /* 'I' */
+    0x41, 0x7F, 0x41,
+    /* 'J' */
+    0x20, 0x40, 0x41, 0x3F, 0x01,
+    /* 'K' */
+    0x7F, 0x08, 0x14, 0x22, 0x41,
+    /* 'L' */
+    0x7F, 0x40, 0x40, 0x40, 0x40,
+    /* 'M' */
+    0x7F, 0x02, 0x04, 0x02, 0x7F,
+    /* 'N' */
+    0x7F, 0x04, 0x08, 0x10, 0x7F,
+    /* 'O' */
+    0x3E, 0x41, 0x41, 0x41, 0x3E,
+    /* 'P' */
+    0x7F, 0x09, 0x09, 0x09, 0x06,
+    /* 'Q' */
+    0x3E, 0x41, 0x51, 0x21, 0x5E,
+    /* 'R' */
+    0x7F, 0x09, 0x19, 0x29, 0x46,
+    /* 'S' */
+    0x46, 0x49, 0x49, 0x49, 0x31,
+    /* 'T' */
+    0x01, 0x01, 0x7F, 0x01, 0x01,
+    /* 'U' */
+    0x3F, 0x40, 0x40, 0x40, 0x3F,
+    /* 'V' */
+    0x1F, 0x20, 0x40, 0x20, 0x1F,
+    /* 'W' */
+    0x3F, 0x40, 0x38, 0x40, 0x3F,
+    /* 'X' */
+    0x63, 0x14, 0x08, 0x14, 0x63,
+    /* 'Y' */
+    0x07, 0x08, 0x70, 0x08, 0x07,
+    /* 'Z' */
+    0x61, 0x51, 0x49, 0x45, 0x43,
+    /* '[' */
+    0x7F, 0x41, 0x41,
+    /* '\' */
+    0x02, 0x04, 0x08, 0x10, 0x20,
+    /* ']' */
+    0x41, 0x41, 0x7F,
+    /* '^' */
+    0x04, 0x02, 0x01, 0x02, 0x04,
+    /* '_' */
+    0x80, 0x80, 0x80, 0x80, 0x80,
+    /* '`' */
+    0x03, 0x05,
+    /* 'a' */
+    0x20, 0x54, 0x54, 0x54, 0x78,
+    /* 'b' */
+    0x7F, 0x48, 0x44, 0x44, 0x38,
+    /* 'c' */
+    0x38, 0x44, 0x44, 0x44, 0x20,
+    /* 'd' */
+    0x38, 0x44, 0x44, 0x48, 0x7F,
+    /* 'e' */
+    0x38, 0x54, 0x54, 0x54, 0x18,
+    /* 'f' */
+    0x08, 0x7E, 0x09, 0x01, 0x02,
+    /* 'g' */
+    0x08, 0x14, 0x54, 0x54, 0x3C,
+    /* 'h' */
+    0x7F, 0x08, 0x04, 0x04, 0x78,
+    /* 'i' */
+    0x44, 0x7D, 0x40,
+    /* 'j' */
+    0x20, 0x40, 0x44, 0x3D,
+    /* 'k' */
+    0x7F, 0x10, 0x28, 0x44,
+    /* 'l' */
+    0x41, 0x7F, 0x40,
+    /* 'm' */
+    0x7C, 0x04, 0x18, 0x04, 0x78,
+    /* 'n' */
+    0x7C, 0x08, 0x04, 0x04, 0x78,
+    /* 'o' */
+    0x38, 0x44, 0x44, 0x44, 0x38,
+    /* 'p' */
+    0x7C, 0x14, 0x14, 0x14, 0x08,
+    /* 'q' */
+    0x08, 0x14, 0x14, 0x18, 0x7C,
+    /* 'r' */
+    0x7C, 0x08, 0x04, 0x04, 0x08,
+    /* 's' */
+    0x48, 0x54, 0x54, 0x54, 0x20,
+    /* 't' */
+    0x04, 0x3F, 0x44, 0x40, 0x20,
+    /* 'u' */
+    0x3C, 0x40, 0x40, 0x20, 0x7C,
+    /* 'v' */
+    0x1C, 0x20, 0x40, 0x20, 0x1C,
+    /* 'w' */
+    0x3C, 0x40, 0x30, 0x40, 0x3C,
+    /* 'x' */
+    0x44, 0x28, 0x10, 0x28, 0x44,
+    /* 'y' */
+    0x0C, 0x50, 0x50, 0x50, 0x3C,
+    /* 'z' */
+    0x44, 0x64, 0x54, 0x4C, 0x44,
+    /* '{' */
+    0x08, 0x36, 0x41,
+    /* '|' */
+    0x7F,
+    /* '}' */
+    0x41, 0x36, 0x08,
+    /* '~' */
+    0x10, 0x08, 0x08, 0x10, 0x08,
+};
+
+static const glyph_t font_small_glyphs[] = {
+    {    0,   3}, // ' '
+    {    3,   1}, // '!'
+    {    4,   3}, // '"'
+    {    7,   5}, // '#'
+    {   12,   5}, // '$'
+    {   17,   5}, // '%'
+    {   22,   5}, // '&'
+    {   27,   2}, // '\''
+    {   29,   3}, // '('
+    {   32,   3}, // ')'
+    {   35,   5}, // '*'
+    {   40,   5}, // '+'
+    {   45,   2}, // ','
+    {   47,   5}, // '-'
+    {   52,   2}, // '.'
+    {   54,   5}, // '/'
+    {   59,   5}, // '0'
+    {   64,   3}, // '1'
+    {   67,   5}, // '2'
+    {   72,   5}, // '3'
+    {   77,   5}, // '4'
+    {   82,   5}, // '5'
+    {   87,   5}, // '6'
+    {   92,   5}, // '7'
+    {   97,   5}, // '8'
+    {  102,   5}, // '9'
+    {  107,   2}, // ':'
+    {  109,   2}, // ';'
+    {  111,   4}, // '<'
+    {  115,   5}, // '='
+    {  120,   4}, // '>'
+    {  124,   5}, // '?'
+    {  129,   5}, // '@'
+    {  134,   5}, // 'A'
+    {  139,   5}, // 'B'
+    {  144,   5}, // 'C'
+    {  149,   5}, // 'D'
+    {  154,   5}, // 'E'
+    {  159,   5}, // 'F'
+    {  164,   5}, // 'G'
+    {  169,   5}, // 'H'
+    {  174,   3}, // 'I'
+    {  177,   5}, // 'J'
+    {  182,   5}, // 'K'
+    {  187,   5}, // 'L'
+    {  192,   5}, // 'M'
+    {  197,   5}, // 'N'
+    {  202,   5}, // 'O'
+    {  207,   5}, // 'P'
+    {  212,   5}, // 'Q'
+    {  217,   5}, // 'R'
+    {  222,   5}, // 'S'
+    {  227,   5}, // 'T'
+    {  232,   5}, // 'U'
+    {  237,   5}, // 'V'
+    {  242,   5}, // 'W'
+    {  247,   5}, // 'X'
+    {  252,   5}, // 'Y'
+    {  257,   5}, // 'Z'
+    {  262,   3}, // '['
+    {  265,   5}, // '\'
+    {  270,   3}, // ']'
+    {  273,   5}, // '^'
+    {  278,   5}, // '_'
+    {  283,   2}, // '`'
+    {  285,   5}, // 'a'
+    {  290,   5}, // 'b'
+    {  295,   5}, // 'c'
+    {  300,   5}, // 'd'
+    {  305,   5}, // 'e'
+    {  310,   5}, // 'f'
+    {  315,   5}, // 'g'
+    {  320,   5}, // 'h'
+    {  325,   3}, // 'i'
+    {  328,   4}, // 'j'
+    {  332,   4}, // 'k'
+    {  336,   3}, // 'l'
+    {  339,   5}, // 'm'
+    {  344,   5}, // 'n'
+    {  349,   5}, // 'o'
+    {  354,   5}, // 'p'
+    {  359,   5}, // 'q'
+    {  364,   5}, // 'r'
+    {  369,   5}, // 's'
+    {  374,   5}, // 't'
+    {  379,   5}, // 'u'
+    {  384,   5}, // 'v'
+    {  389,   5}, // 'w'
+    {  394,   5}, // 'x'
+    {  399,   5}, // 'y'
+    {  404,   5}, // 'z'
+    {  409,   3}, // '{'
+    {  412,   1}, // '|'
+    {  413,   3}, // '}'
+    {  416,   5}, // '~'
+};
+
+const font_t font_small = {
+    .data = font_small_data,
+    .glyphs = font_small_glyphs,
+    .first = 0x20,
+    .last = 0x7E,
+    .width = 5,
+    .height = 8,
+    .spacing = 1,
+    .encoding = GLYPH_RAW,
+};
+
+static const uint8_t icon_car_data[] = {
+    0x38, 0x38, 0xDC, 0xDA, 0x39, 0x39, 0x3F, 0x39, 0x39, 0x3F, 0x39, 0xDA,
+    0xDC, 0x38, 0x38, 0x30,
+};
+
+const bitmap_t icon_car = {
+    .data = icon_car_data,
+    .width = 16,
+    .height = 8,
+    .encoding = GLYPH_RAW,
+};
+
+static const uint8_t icon_pedestrian_data[] = {
+    0x60, 0x10, 0xF8, 0xFB, 0xFB, 0x10, 0x60, 0x00, 0x60, 0x3C, 0x07, 0x01,
+    0x07, 0x7C, 0x40, 0x00,
+};
+
+const bitmap_t icon_pedestrian = {
+    .data = icon_pedestrian_data,
+    .width = 8,
+    .height = 16,
+    .encoding = GLYPH_RAW,
+};
+
+static const uint8_t font_signal_data[] = {
+    /* '0' */
+    0x8E, 0xE3, 0xA2, 0x28, 0x46, 0x51, 0x8C, 0xA2, 0xE8, 0x38, 0x0E,
+    /* '1' */
+    0x8E, 0xE3, 0xBE, 0x28, 0x7E, 0x51, 0xFC, 0xA2, 0xE8, 0x38, 0x0E,
+    /* '2' */
+    0x8E, 0xE3, 0xA2, 0x2F, 0x46, 0x5F, 0x8C, 0xBE, 0xE8, 0x38, 0x0E,
+    /* '3' */
+    0x8E, 0xE3, 0xBE, 0x2F, 0x7E, 0x5F, 0xFC, 0xBE, 0xE8, 0x38, 0x0E,
+    /* '4' */
+    0x8E, 0xE3, 0xA2, 0xE8, 0x47, 0xD1, 0x8F, 0xA2, 0xEF, 0x38, 0x0E,
+    /* '5' */
+    0x8E, 0xE3, 0xBE, 0xE8, 0x7F, 0xD1, 0xFF, 0xA2, 0xEF, 0x38, 0x0E,
+    /* '6' */
+    0x8E, 0xE3, 0xA2, 0xEF, 0x47, 0xDF, 0x8F, 0xBE, 0xEF, 0x38, 0x0E,
+    /* '7' */
+    0x8E, 0xE3, 0xBE, 0xEF, 0x7F, 0xDF, 0xFF, 0xBE, 0xEF, 0x38, 0x0E,
+    /* '8' */
+    0x8E, 0x03, 0xA2, 0xE8, 0x44, 0x51, 0x89, 0xA2, 0xE3, 0x38, 0x00,
+    /* '9' */
+    0x8E, 0x03, 0xBE, 0xE8, 0x7C, 0x51, 0xF9, 0xA2, 0xE3, 0x38, 0x00,
+    /* ':' */
+    0x8E, 0x03, 0xA2, 0xEF, 0x44, 0x5F, 0x89, 0xBE, 0xE3, 0x38, 0x00,
+    /* ';' */
+    0x8E, 0x03, 0xBE, 0xEF, 0x7C, 0x5F, 0xF9, 0xBE, 0xE3, 0x38, 0x00,
+    /* '<' */
+    0x8E, 0x03, 0xA2, 0xE8, 0x44, 0xD1, 0x89, 0xA2, 0xE3, 0x38, 0x00,
+    /* '=' */
+    0x8E, 0x03, 0xBE, 0xE8, 0x7C, 0xD1, 0xF9, 0xA2, 0xE3, 0x38, 0x00,
+    /* '>' */
+    0x8E, 0x03, 0xA2, 0xEF, 0x44, 0xDF, 0x89, 0xBE, 0xE3, 0x38, 0x00,
+    /* '?' */
+    0x8E, 0x03, 0xBE, 0xEF, 0x7C, 0xDF, 0xF9, 0xBE, 0xE3, 0x38, 0x00,
+};
+
+const font_t font_signal = {
+    .data = font_signal_data,
+    .glyphs = NULL,
+    .first = 0x30,
+    .last = 0x3F,
+    .width = 5,
+    .height = 17,
+    .spacing = 0,
+    .encoding = GLYPH_PACKED,
+};
+
+static const uint8_t junction_data[] = {
+    0x95, 0x00, 0x00, 0xFF, 0x8E, 0x00, 0x00, 0xFF, 0x95, 0x00, 0x00, 0xFF,
+    0xD4, 0x00, 0x00, 0xFF, 0x8E, 0x00, 0x00, 0xFF, 0x95, 0x00, 0x00, 0xFF,
+    0xBD, 0x00, 0x95, 0x80, 0x01, 0xFF, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x80,
+    0x3E, 0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x80,
+    0x3E, 0x01, 0x00, 0xFF, 0x95, 0x80, 0x00, 0xFF, 0xCE, 0x00, 0x83, 0xB6,
+    0xA8, 0x00, 0x00, 0xFF, 0xCE, 0x00, 0x83, 0x6D, 0xA8, 0x00, 0x00, 0xFF,
+    0xBD, 0x00, 0x95, 0x01, 0x00, 0xFF, 0x8E, 0x00, 0x00, 0xFF, 0x95, 0x01,
+    0x00, 0xFF, 0xD4, 0x00, 0x00, 0xFF, 0x8E, 0x00, 0x00, 0xFF, 0x95, 0x00,
+    0x00, 0xFF, 0xD4, 0x00, 0x00, 0xFF, 0x8E, 0x00, 0x00, 0xFF, 0x95, 0x00,
+    0x00, 0xFF, 0xBD, 0x00,
+};
+
+const bitmap_t junction = {
+    .data = junction_data,
+    .width = 128,
+    .height = 64,
+    .encoding = GLYPH_RLE,
+};
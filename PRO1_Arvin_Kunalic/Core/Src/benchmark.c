@@ -0,0 +1,369 @@
+/**************************************************************************//**
+ * @file     benchmark.c
+ * @brief    On-board benchmarks of the interrupt latencies and output paths.
+ *
+ * @details  Every benchmark takes BENCH_ITERATIONS samples with the DWT cycle
+ *           counter and prints min, percentiles, max and mean as a JSON line:
+ *
+ *             {"bench":"exti_latency","unit":"cycles","core_hz":80000000,
+ *              "n":256,"min":..,"p50":..,"p90":..,"p99":..,"max":..,"mean":..}
+ *
+ *           - exti_latency:    software EXTI trigger (SWIER1) to the first
+ *                              line of HAL_GPIO_EXTI_Callback.
+ *           - timer_to_isr:    TIM3 update event to the first line of
+ *                              HAL_TIM_PeriodElapsedCallback.
+ *           - timer_to_latch:  TIM3 update event to the shift registers
+ *                              latched by the TIM3 branch (toggle_pedestrian).
+ *           - buffer_to_spi:   One buffer_to_SPI call.
+ *           - shiftreg_spi:    The three byte transfer and latch of
+ *                              buffer_to_SPI, without its delay.
+ *           - update_screen:   One full OLED frame.
+ *           - send_data_oled:  One send_data_OLED call (one byte).
+ *           - draw_char:       One draw_char call (glyph to framebuffer).
+ *           - draw_glyph:      One draw_glyph call of font_large (15x24,
+ *                              run-length coded) at a row across pages.
+ *           - boot_to_latch:   Reset vector to the safe lamp state latched,
+ *                              in microseconds, one sample (see boot.h).
+ *           - boot_to_frame:   Reset vector to the first OLED frame.
+ *
+ *           For the timer benchmarks TIM3 runs on the core clock (prescaler
+ *           0), so its update event happens a known number of cycles after
+ *           the counter was enabled. SysTick and the telemetry DMA keep
+ *           running, their interrupts show up in the upper percentiles.
+ *
+ *           The output transfers go through fast_io.h, the start line tells
+ *           if FAST_IO_ENABLED was set. A build with it set to 0 gives the
+ *           HAL numbers to compare with. Likewise RAMFUNC_ENABLED for the
+ *           functions run from SRAM2 (see ramfunc.h).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      benchmark.h, Tools/bench_report.py
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "tim.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+#include "595_shiftreg.h"
+#include "ssd1306_config.h"
+#include "fast_io.h"
+#include "gpio_pins.h"
+#include "ramfunc.h"
+#include "uart_stdio.h"
+#include "boot.h"
+#include "glyph.h"
+#include "assets.h"
+
+#if BENCHMARK_ENABLED
+
+/* Defines ------------------------------------------------------------------*/
+/* EXTI line triggered in software, its callback is swallowed by the hook */
+#define BENCH_EXTI_PIN      PL1_Switch_Pin
+
+/* TIM3 period while measuring, in core clock cycles (100us) */
+#define BENCH_TIMER_CYCLES  8000
+
+/* Longest wait for one interrupt before the sample is skipped */
+#define BENCH_TIMEOUT_MS    100
+
+/* Variables ----------------------------------------------------------------*/
+static uint32_t samples[BENCH_ITERATIONS];
+static uint32_t samples_latch[BENCH_ITERATIONS];
+
+static volatile bool running = 0;       // Hooks swallow every callback
+static volatile bool armed = 0;         // Next callback takes the stamps
+static volatile uint32_t stamp_entry;   // CYCCNT at the start of the callback
+static volatile uint32_t stamp_done;    // CYCCNT after the shift register latch
+
+/* Functions ----------------------------------------------------------------*/
+
+static int compare_samples(const void *a, const void *b) {
+  const uint32_t x = *(const uint32_t *)a;
+  const uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**************************************************************************//**
+ * @brief   Prints the statistics of a series of samples as a JSON line.
+ * @details The samples are sorted in place.
+ * @version 1.0
+ * @param   const char *name, Name of the benchmark.
+ * @param   uint32_t *data, The samples in cycles.
+ * @param   uint32_t n, Number of samples, 0 if every sample timed out.
+ * @return  None
+ *****************************************************************************/
+static void report(const char *name, uint32_t *data, uint32_t n) {
+  uint64_t total = 0;
+
+  if (n == 0) {
+    printf("{\"bench\":\"%s\",\"unit\":\"cycles\",\"n\":0,\"error\":\"timeout\"}\n", name);
+    return;
+  }
+
+  qsort(data, n, sizeof(data[0]), compare_samples);
+  for (uint32_t i = 0; i < n; i++) {
+    total += data[i];
+  }
+
+  printf("{\"bench\":\"%s\",\"unit\":\"cycles\",\"core_hz\":%lu,\"n\":%lu,"
+         "\"min\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu,\"mean\":%lu}\n",
+         name, (unsigned long)SystemCoreClock, (unsigned long)n,
+         (unsigned long)data[0], (unsigned long)data[(n - 1) * 50 / 100],
+         (unsigned long)data[(n - 1) * 90 / 100], (unsigned long)data[(n - 1) * 99 / 100],
+         (unsigned long)data[n - 1], (unsigned long)(total / n));
+}
+
+#if BOOT_TIMING_ENABLED
+/**************************************************************************//**
+ * @brief   Prints one boot time as a single sample result.
+ * @version 1.0
+ * @param   const char *name, The benchmark name.
+ * @param   boot_point_t point, The boot point.
+ * @return  None
+ *****************************************************************************/
+static void report_boot(const char *name, boot_point_t point) {
+  const unsigned long us = boot_time_us(point);
+
+  printf("{\"bench\":\"%s\",\"unit\":\"us\",\"core_hz\":%lu,\"n\":1,"
+         "\"min\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu,\"mean\":%lu}\n",
+         name, (unsigned long)SystemCoreClock, us, us, us, us, us, us);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief   Waits until a hook has taken its stamps.
+ * @version 1.0
+ * @param   None
+ * @return  boolean, false on a timeout.
+ *****************************************************************************/
+static bool wait_for_hook(void) {
+  const uint32_t start = HAL_GetTick();
+
+  while (armed) {
+    if (HAL_GetTick() - start > BENCH_TIMEOUT_MS) {
+      armed = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Measures the latency from an EXTI trigger to its callback.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void bench_exti_latency(void) {
+  uint32_t n = 0;
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    uint32_t start;
+
+    armed = 1;
+    start = DWT->CYCCNT;
+    EXTI->SWIER1 = BENCH_EXTI_PIN;
+    if (wait_for_hook()) {
+      samples[n++] = stamp_entry - start;
+    }
+  }
+  report("exti_latency", samples, n);
+}
+
+/**************************************************************************//**
+ * @brief   Measures the latency from a TIM3 update event to the callback
+ *          and to the shift register latch of the TIM3 branch.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void bench_timer_latency(void) {
+  uint32_t n = 0;
+
+  /* One-shot TIM3 on the core clock, the hook stops it again */
+  HAL_TIM_Base_Stop_IT(&htim3);
+  __HAL_TIM_SET_PRESCALER(&htim3, 0);
+  __HAL_TIM_SET_AUTORELOAD(&htim3, BENCH_TIMER_CYCLES - 1);
+  htim3.Instance->EGR = TIM_EGR_UG;
+  __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+  HAL_NVIC_ClearPendingIRQ(TIM3_IRQn);
+  __HAL_TIM_ENABLE_IT(&htim3, TIM_IT_UPDATE);
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    uint32_t expiry;
+
+    armed = 1;
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    expiry = DWT->CYCCNT + BENCH_TIMER_CYCLES;
+    __HAL_TIM_ENABLE(&htim3);
+    if (wait_for_hook()) {
+      samples[n] = stamp_entry - expiry;
+      samples_latch[n] = stamp_done - expiry;
+      n++;
+    }
+  }
+
+  /* Back to the configuration of tim.c */
+  HAL_TIM_Base_Stop_IT(&htim3);
+  __HAL_TIM_SET_PRESCALER(&htim3, htim3.Init.Prescaler);
+  __HAL_TIM_SET_AUTORELOAD(&htim3, htim3.Init.Period);
+  htim3.Instance->EGR = TIM_EGR_UG;
+  __HAL_TIM_SET_COUNTER(&htim3, 0);
+  __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+  clear_pin(PL1_Blue);
+  buffer_to_SPI();
+
+  report("timer_to_isr", samples, n);
+  report("timer_to_latch", samples_latch, n);
+}
+
+/**************************************************************************//**
+ * @brief   Measures buffer_to_SPI, the shift register transfer, update_screen,
+ *          send_data_OLED, draw_char and draw_glyph.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void bench_outputs(void) {
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    buffer_to_SPI();
+    samples[i] = DWT->CYCCNT - start;
+  }
+  report("buffer_to_spi", samples, BENCH_ITERATIONS);
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    PIN_RESET(_595_STCP);
+    fast_spi_send(&hspi3, shiftreg_buffer, SHIFTREG_BUFFER_SIZE);
+    PIN_SET(_595_STCP);
+    samples[i] = DWT->CYCCNT - start;
+  }
+  report("shiftreg_spi", samples, BENCH_ITERATIONS);
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    update_screen();
+    samples[i] = DWT->CYCCNT - start;
+  }
+  report("update_screen", samples, BENCH_ITERATIONS);
+
+  /* Rewrite the top page with its own contents, one byte at a time */
+  send_command_OLED(0xB0);
+  send_command_OLED(0x00);
+  send_command_OLED(0x10);
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    send_data_OLED(OLED_framebuffer[i % OLED_WIDTH]);
+    samples[i] = DWT->CYCCNT - start;
+  }
+  update_screen();
+  report("send_data_oled", samples, BENCH_ITERATIONS);
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    draw_char(0, 56, 'A' + i % 26);
+    samples[i] = DWT->CYCCNT - start;
+  }
+  report("draw_char", samples, BENCH_ITERATIONS);
+
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    draw_glyph(0, 36, &font_large, '0' + i % 10);
+    samples[i] = DWT->CYCCNT - start;
+  }
+  report("draw_glyph", samples, BENCH_ITERATIONS);
+}
+
+/**************************************************************************//**
+ * @brief   Runs the benchmark suite once, instead of the traffic light.
+ * @details Has to be called after the peripherals are initialized. The
+ *          output ends with a line holding "status":"done".
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void Benchmark(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  /* Results must not be dropped when the telemetry ring is full */
+  uart_stdio_set_overflow(UART_STDIO_BLOCK);
+
+  reset_595register();
+  init_OLED();
+  draw_string(0, 0, "Benchmark running..");
+  update_screen();
+  boot_stamp(BOOT_FRAME);
+
+  running = 1;
+  printf("{\"suite\":\"board\",\"status\":\"start\",\"iterations\":%u,\"fast_io\":%u,\"ramfunc\":%u,\"build\":\"%s %s\"}\n",
+         BENCH_ITERATIONS, FAST_IO_ENABLED, RAMFUNC_ENABLED, __DATE__, __TIME__);
+  bench_exti_latency();
+  bench_timer_latency();
+  bench_outputs();
+#if BOOT_TIMING_ENABLED
+  report_boot("boot_to_latch", BOOT_LATCH);
+  report_boot("boot_to_frame", BOOT_FRAME);
+#endif
+  running = 0;
+
+  printf("{\"suite\":\"board\",\"status\":\"done\"}\n");
+  uart_stdio_flush();
+  draw_string(0, 0, "Benchmark done     ");
+  update_screen();
+}
+
+/**************************************************************************//**
+ * @brief   Takes the stamp of the EXTI benchmark.
+ * @details Called first in HAL_GPIO_EXTI_Callback (BENCH_HOOK_EXTI).
+ * @version 1.0
+ * @param   uint16_t pin, The pin of the interrupt.
+ * @param   uint32_t now, CYCCNT at the start of the callback.
+ * @return  boolean, true if the callback has to return right away.
+ *****************************************************************************/
+bool bench_exti_hook(uint16_t pin, uint32_t now) {
+  if (!running) {
+    return false;
+  }
+  if (armed && pin == BENCH_EXTI_PIN) {
+    stamp_entry = now;
+    armed = 0;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Takes the stamps of the timer benchmarks.
+ * @details Called first in HAL_TIM_PeriodElapsedCallback (BENCH_HOOK_TIMER).
+ *          Runs the real TIM3 work (toggle_pedestrian) and stamps the end
+ *          of the shift register latch.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer of the interrupt.
+ * @param   uint32_t now, CYCCNT at the start of the callback.
+ * @return  boolean, true if the callback has to return right away.
+ *****************************************************************************/
+bool bench_timer_hook(TIM_HandleTypeDef *htim, uint32_t now) {
+  if (!running) {
+    return false;
+  }
+  if (armed && htim->Instance == TIM3) {
+    __HAL_TIM_DISABLE(htim);
+    stamp_entry = now;
+    toggle_pedestrian(1);
+    stamp_done = DWT->CYCCNT;
+    armed = 0;
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**************************************************************************//**
+ * @file     boot.c
+ * @brief    Safe lamp state right after reset and boot time measurement.
+ *
+ * @details  boot_latch runs before HAL_Init and SystemClock_Config, on the
+ *           4 MHz MSI clock. It only uses what works without the SysTick:
+ *           HAL_GPIO_Init, MX_SPI3_Init and the polled SPI of fast_io.h.
+ *           MX_GPIO_Init later sets the same pins to the same levels, so
+ *           the latched state is kept; it also enables the EXTI interrupts,
+ *           which is why it can't be called this early itself.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      boot.h, startup_stm32l476rgtx.s (starts the cycle counter)
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "spi.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "boot.h"
+#include "595_shiftreg.h"
+#include "ssd1306_config.h"
+#include "fast_io.h"
+#include "gpio_pins.h"
+
+/* Variables ----------------------------------------------------------------*/
+#if BOOT_TIMING_ENABLED
+static uint32_t stamp_cycles[BOOT_POINTS];  // DWT->CYCCNT since the reset vector
+static uint32_t stamp_hz[BOOT_POINTS];      // SystemCoreClock at the stamp
+static uint32_t stamped = 0;                // Bit per boot_point_t
+static bool reported = 0;
+#endif
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Latches the safe lamp state into the shift registers.
+ * @details Has to be the first call in main. The 595 outputs stay disabled
+ *          (OE high) until init_state is latched. MX_SPI3_Init is not called
+ *          again later.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void boot_latch(void) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  __HAL_RCC_GPIOC_CLK_ENABLE();
+
+  /* Levels before the pins become outputs */
+  PIN_SET(_595_Enable);     // Outputs off
+  PIN_SET(_595_Reset);      // Shift register not in reset
+  PIN_RESET(_595_STCP);
+
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  GPIO_InitStruct.Pin = _595_Reset_Pin;
+  HAL_GPIO_Init(_595_Reset_GPIO_Port, &GPIO_InitStruct);
+  GPIO_InitStruct.Pin = _595_STCP_Pin;
+  HAL_GPIO_Init(_595_STCP_GPIO_Port, &GPIO_InitStruct);
+  GPIO_InitStruct.Pin = _595_Enable_Pin;
+  HAL_GPIO_Init(_595_Enable_GPIO_Port, &GPIO_InitStruct);
+
+  MX_SPI3_Init();
+
+  update_shiftreg_buffer(init_state);
+  fast_spi_send(&hspi3, shiftreg_buffer, SHIFTREG_BUFFER_SIZE);
+  PIN_SET(_595_STCP);       // Latch
+  PIN_RESET(_595_STCP);
+  PIN_RESET(_595_Enable);   // Outputs on
+
+  boot_stamp(BOOT_LATCH);
+}
+
+#if BOOT_TIMING_ENABLED
+
+/**************************************************************************//**
+ * @brief   Records the cycle count of a boot point, only the first time.
+ * @version 1.0
+ * @param   boot_point_t point, The boot point.
+ * @return  None
+ *****************************************************************************/
+void boot_stamp(boot_point_t point) {
+  if (stamped & (1u << point)) {
+    return;
+  }
+  stamp_cycles[point] = DWT->CYCCNT;
+  stamp_hz[point] = SystemCoreClock;
+  stamped |= 1u << point;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the time from the reset vector to a boot point.
+ * @details Every interval is converted with the core clock at its start.
+ * @version 1.0
+ * @param   boot_point_t point, The boot point.
+ * @return  uint32_t, Microseconds, 0 if the point or one before it was not
+ *          stamped yet.
+ *****************************************************************************/
+uint32_t boot_time_us(boot_point_t point) {
+  uint64_t us = 0;
+  uint32_t previous = 0;
+  uint32_t hz = stamp_hz[BOOT_LATCH];
+
+  for (uint32_t p = 0; p <= point; p++) {
+    if (!(stamped & (1u << p)) || !hz) {
+      return 0;
+    }
+    us += (uint64_t)(stamp_cycles[p] - previous) * 1000000u / hz;
+    previous = stamp_cycles[p];
+    hz = stamp_hz[p];
+  }
+  return (uint32_t)us;
+}
+
+/**************************************************************************//**
+ * @brief   Stamps the first frame and prints the boot times once.
+ * @details Called from the main loop after display_service.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void boot_service(void) {
+  if (reported || display_frames() == 0) {
+    return;
+  }
+  boot_stamp(BOOT_FRAME);
+  printf("boot: latch %lu us, clock %lu us, first frame %lu us\n",
+         (unsigned long)boot_time_us(BOOT_LATCH),
+         (unsigned long)boot_time_us(BOOT_CLOCK),
+         (unsigned long)boot_time_us(BOOT_FRAME));
+  reported = 1;
+}
+
+#endif
@@ -38,6 +38,14 @@
 #include "fonts.h"
 #include <stm32l476xx.h>
 #include "clock.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "hil.h"
+#include "profile.h"
+#include "benchmark.h"
+#include "crash_dump.h"
+#include "ramfunc.h"
+#include "status_page.h"
 
 /**
   * @brief System Clock Configuration
@@ -92,138 +100,188 @@ void SystemClock_Config(void)
 /**************************************************************************//**
  * @brief    ISR for the switches and buttons of the traffic light shield
  * @details  Based off of: https://wiki.st.com/stm32mcu/wiki/Getting_started_with_EXTI
- * @version  1.0
+ *           In HIL mode the events are injected over USART2 and the car
+ *           sensor levels come from hil_read_pin (see hil.c).
+ *           Its execution time is profiled as PROFILE_EXTI. Runs from SRAM2
+ *           (RAMFUNC). The text messages are only drawn without the status
+ *           page (STATUS_TEXT), which shows the inputs itself.
+ * @version  1.3
  * @param    uint16_t GPIO_Pin, the GPIO pin that triggered the interrupt.
  * @return   None
  * @see      https://wiki.st.com/stm32mcu/wiki/Getting_started_with_EXTI
  *****************************************************************************/
-void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+RAMFUNC void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+  BENCH_HOOK_EXTI(GPIO_Pin);
+  PROFILE_BEGIN();
+
   switch (GPIO_Pin) {
     case PL1_Switch_Pin:
-      if (!PL1_SW_HIT && crosswalk1_red) {
-        PL1_SW_HIT = 1;
-        draw_string(0, 0, "Pedestrian1        ");
-        draw_string(0, 8, "   wants to cross..");
+      if (!flag_get(FLAG_PL1_SW_HIT) && flag_get(FLAG_CROSSWALK1_RED)) {
+        flag_set(FLAG_PL1_SW_HIT);
+        TRACE("PL1 request, intersection1 green = %u", flag_get(FLAG_INTERSECTION1_GREEN));
+        STATUS_TEXT(0, 0, "Pedestrian1        ");
+        STATUS_TEXT(0, 8, "   wants to cross..");
         HAL_TIM_Base_Start_IT(&htim3); // Start toggling blue lights
         HAL_TIM_Base_Start(&htim4); // Start 5s timer to transition lights
       }
     break;
 
     case PL2_Switch_Pin:
-      if (!PL2_SW_HIT && crosswalk2_red) {
-        PL2_SW_HIT = 1;
-        draw_string(0, 0, "Pedestrian2        ");
-        draw_string(0, 8, "   wants to cross..");
+      if (!flag_get(FLAG_PL2_SW_HIT) && flag_get(FLAG_CROSSWALK2_RED)) {
+        flag_set(FLAG_PL2_SW_HIT);
+        TRACE("PL2 request, intersection2 green = %u", flag_get(FLAG_INTERSECTION2_GREEN));
+        STATUS_TEXT(0, 0, "Pedestrian2        ");
+        STATUS_TEXT(0, 8, "   wants to cross..");
         HAL_TIM_Base_Start_IT(&htim3); // Start toggling blue lights
         HAL_TIM_Base_Start(&htim4); // Start 5s timer to transition lights
       }
     break;
 
     case TL1_Car_Pin:
-      if (HAL_GPIO_ReadPin(TL1_Car_GPIO_Port, TL1_Car_Pin) == 0) {
-        car1_active = 1;
-        draw_string(0, 31, "Car1 active  ");
+      if (hil_read_pin(TL1_Car_GPIO_Port, TL1_Car_Pin) == 0) {
+        flag_set(FLAG_CAR1_ACTIVE);
+        TRACE("Car%u active", 1);
+        STATUS_TEXT(0, 31, "Car1 active  ");
       } else {
-        car1_active = 0;
-        draw_string(0, 31, "Car1 inactive");
+        flag_clear(FLAG_CAR1_ACTIVE);
+        TRACE("Car%u inactive", 1);
+        STATUS_TEXT(0, 31, "Car1 inactive");
       }
     break;
 
     case TL2_Car_Pin:
-      if (HAL_GPIO_ReadPin(TL2_Car_GPIO_Port, TL2_Car_Pin) == 0) {
-        car2_active = 1;
-        draw_string(0, 39, "Car2 active  ");
+      if (hil_read_pin(TL2_Car_GPIO_Port, TL2_Car_Pin) == 0) {
+        flag_set(FLAG_CAR2_ACTIVE);
+        TRACE("Car%u active", 2);
+        STATUS_TEXT(0, 39, "Car2 active  ");
       } else {
-        car2_active = 0;
-        draw_string(0, 39, "Car2 inactive");
+        flag_clear(FLAG_CAR2_ACTIVE);
+        TRACE("Car%u inactive", 2);
+        STATUS_TEXT(0, 39, "Car2 inactive");
       }
     break;
 
     case TL3_Car_Pin:
-      if (HAL_GPIO_ReadPin(TL3_Car_GPIO_Port, TL3_Car_Pin) == 0) {
-        car3_active = 1;
-        draw_string(0, 47, "Car3 active  ");
+      if (hil_read_pin(TL3_Car_GPIO_Port, TL3_Car_Pin) == 0) {
+        flag_set(FLAG_CAR3_ACTIVE);
+        TRACE("Car%u active", 3);
+        STATUS_TEXT(0, 47, "Car3 active  ");
       } else {
-        car3_active = 0;
-        draw_string(0, 47, "Car3 inactive");
+        flag_clear(FLAG_CAR3_ACTIVE);
+        TRACE("Car%u inactive", 3);
+        STATUS_TEXT(0, 47, "Car3 inactive");
       }
     break;
 
     case TL4_Car_Pin:
-      if (HAL_GPIO_ReadPin(TL4_Car_GPIO_Port, TL4_Car_Pin) == 0) {
-        car4_active = 1;
-        draw_string(0, 55, "Car4 active  ");
+      if (hil_read_pin(TL4_Car_GPIO_Port, TL4_Car_Pin) == 0) {
+        flag_set(FLAG_CAR4_ACTIVE);
+        TRACE("Car%u active", 4);
+        STATUS_TEXT(0, 55, "Car4 active  ");
       } else {
-        car4_active = 0;
-        draw_string(0, 55, "Car4 inactive");
+        flag_clear(FLAG_CAR4_ACTIVE);
+        TRACE("Car%u inactive", 4);
+        STATUS_TEXT(0, 55, "Car4 inactive");
       }
     break;
   }
+
+  /* Log the pin and the resulting input state: bit 0-3 = car1-4, bit 4-5 = PL1/PL2 */
+  telemetry_event(TELEMETRY_INPUT, GPIO_Pin, ctrl_inputs());
+
+  PROFILE_END(PROFILE_EXTI);
+}
+
+/**************************************************************************//**
+ * @brief    Handles the 125ms period of TIM3.
+ * @details  Toggles the blue indicator of a waiting pedestrian, and turns
+ *           it off once the crosswalk is green. The requests of both
+ *           crosswalks are checked on every period: with both buttons
+ *           pressed, one is served while the other one still waits.
+ * @version  1.1
+ * @param    None
+ * @return   None
+ *****************************************************************************/
+static void pedestrian_blink_elapsed(void) {
+  /* Crosswalk is green, turn of blue indicator lights */
+  if (flag_get(FLAG_PL1_SW_HIT) && flag_get(FLAG_CROSSWALK1_GREEN)) {
+    clear_pin(PL1_Blue);
+    flag_clear(FLAG_PL1_SW_HIT);
+  }
+  if (flag_get(FLAG_PL2_SW_HIT) && flag_get(FLAG_CROSSWALK2_GREEN)) {
+    clear_pin(PL2_Blue);
+    flag_clear(FLAG_PL2_SW_HIT);
+  }
+
+  /* Toggle the blue LEDS every 125ms, with TIM3*/
+  if (flag_get(FLAG_PL1_SW_HIT) && flag_get(FLAG_CROSSWALK1_RED)) {
+    toggle_pedestrian(1);
+    return;
+  } else if (flag_get(FLAG_PL2_SW_HIT) && flag_get(FLAG_CROSSWALK2_RED)) {
+    toggle_pedestrian(2);
+    return;
+  }
+
+  /* No pedestrian waiting, stop and reset the 125ms timer (TIM3) */
+  if (!flag_get(FLAG_PL1_SW_HIT) && !flag_get(FLAG_PL2_SW_HIT)) {
+    __HAL_TIM_SetCounter(&htim3, 0);
+    __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+    HAL_TIM_Base_Stop_IT(&htim3);
+  }
+}
+
+/**************************************************************************//**
+ * @brief    Handles the end of the walk time (TIM5).
+ * @version  1.0
+ * @param    None
+ * @return   None
+ *****************************************************************************/
+static void walk_time_elapsed(void) {
+  if (flag_get(FLAG_CROSSWALK1_GREEN) && flag_get(FLAG_INTERSECTION1_GREEN)) {
+    TRACE("Walk time over, crosswalk %u", 1);
+    stop_pedestrian(1);
+
+    /* Clear 'walking_Delay' timer */
+    HAL_TIM_Base_Stop_IT(&htim5);
+    __HAL_TIM_SetCounter(&htim5, 0);
+    __HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_UPDATE);
+    return;
+  } else if (flag_get(FLAG_CROSSWALK2_GREEN) && flag_get(FLAG_INTERSECTION2_GREEN)) {
+    TRACE("Walk time over, crosswalk %u", 2);
+    stop_pedestrian(2);
+
+    /* Clear 'walking_Delay' timer */
+    HAL_TIM_Base_Stop_IT(&htim5);
+    __HAL_TIM_SetCounter(&htim5, 0);
+    __HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_UPDATE);
+    return;
+  }
 }
 
 /**************************************************************************//**
  * @brief    ISR for the timers on the STM32L476RG
  * @details  Based off of: 
  *           https://www.digikey.com/en/maker/projects/getting-started-with-stm32-timers-and-timer-interrupts/d08e6493cefa486fb1e79c43c0b08cc6
- * @version  1.0
+ *           The TIM3 and TIM5 branches are profiled as PROFILE_TIM3 and
+ *           PROFILE_TIM5. Runs from SRAM2 (RAMFUNC).
+ * @version  1.1
  * @param    TIM_HandleTypeDef *htim, the Timer that triggered the interrupt.
  * @return   None
  * @see      https://www.digikey.com/en/maker/projects/getting-started-with-stm32-timers-and-timer-interrupts/d08e6493cefa486fb1e79c43c0b08cc6
  *****************************************************************************/
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
-  if (htim->Instance == TIM3) {
-    /* Toggle the blue LEDS every 125ms, with TIM3*/
-    if (PL1_SW_HIT && crosswalk1_red) {
-      toggle_pedestrian(1);
-      return;
-    } else if (PL2_SW_HIT && crosswalk2_red) {
-      toggle_pedestrian(2);
-      return;
-    }
-
-    /* Crosswalk is green, turn of blue indicator lights */
-    if (PL1_SW_HIT && crosswalk1_green) {
-      clear_pin(PL1_Blue);
-      PL1_SW_HIT = 0;
-
-      /* Stop and reset the 125ms timer (TIM3) */
-      __HAL_TIM_SetCounter(&htim3, 0);
-      __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
-      HAL_TIM_Base_Stop_IT(&htim3);
-      return;
-    }
+RAMFUNC void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+  BENCH_HOOK_TIMER(htim);
+  PROFILE_BEGIN();
 
-    /* Crosswalk is green, turn of blue indicator lights */
-    if (PL2_SW_HIT && crosswalk2_green) {
-      clear_pin(PL2_Blue);
-      PL2_SW_HIT = 0;
-      
-      /* Stop and reset the 125ms timer (TIM3) */
-      __HAL_TIM_SetCounter(&htim3, 0);
-      __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
-      HAL_TIM_Base_Stop_IT(&htim3);
-    }
+  if (htim->Instance == TIM3) {
+    pedestrian_blink_elapsed();
+    PROFILE_END(PROFILE_TIM3);
   }
 
   /* Ensure the pedestrian lights stays green for 'walking_Delay' seconds*/
   if (htim->Instance == TIM5) {
-    if (crosswalk1_green && intersection1_green) {
-      stop_pedestrian(1);
-
-      /* Clear 'walking_Delay' timer */
-      HAL_TIM_Base_Stop_IT(&htim5);
-      __HAL_TIM_SetCounter(&htim5, 0);
-      __HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_UPDATE);
-      return;
-    } else if (crosswalk2_green && intersection2_green) {
-      stop_pedestrian(2);
-
-      /* Clear 'walking_Delay' timer */
-      HAL_TIM_Base_Stop_IT(&htim5);
-      __HAL_TIM_SetCounter(&htim5, 0);
-      __HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_UPDATE);
-      return;
-    }
+    walk_time_elapsed();
+    PROFILE_END(PROFILE_TIM5);
   }
 }
 
@@ -236,8 +294,11 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
 void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
-  /* User can add his own implementation to report the HAL error return state */
+  /* Save a crash dump and reset, see crash_dump.h */
   __disable_irq();
+#if CRASH_DUMP_ENABLED
+  crash_error((uint32_t)__builtin_return_address(0));
+#endif
   while (1)
   {
   }
@@ -0,0 +1,432 @@
+/**************************************************************************//**
+ * @file     cmd_protocol.c
+ * @brief    Binary command protocol on USART2.
+ *
+ * @details  USART2 receives into a circular DMA ring. The HAL reports new
+ *           data with HAL_UARTEx_RxEventCallback when the ring is half full,
+ *           full, or when the line goes idle after a burst, so every request
+ *           is handled right after its last byte arrived and nothing is ever
+ *           polled.
+ *
+ *           Bytes are collected until the 0x00 delimiter, the frame is COBS
+ *           decoded in place, its CRC checked and the command carried out
+ *           directly in the callback. None of the commands touch the state
+ *           of the traffic light state machine:
+ *           - Timing parameters are single 16-bit words that the state
+ *             machine reads on its next comparison (timer_config.c).
+ *           - A lamp test is shown by the main loop on top of the normal
+ *             lamp state (595_shiftreg.c).
+ *           - Injected inputs (HIL mode) take the same EXTI path as the
+ *             real buttons and sensors (hil.c).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @note     USART2 RX DMA (DMA1 Channel6, circular) has to be enabled, see
+ *           dma.c and usart.c.
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "usart.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cmd_protocol.h"
+#include "telemetry.h"
+#include "timer_config.h"
+#include "traffic_functions.h"
+#include "595_shiftreg.h"
+#include "uart_stdio.h"
+#include "hil.h"
+
+/* Defines ------------------------------------------------------------------*/
+/* seq, cmd, status before the data and the CRC after it */
+#define RESPONSE_OVERHEAD   5
+#define RESPONSE_DATA_MAX   (255 - RESPONSE_OVERHEAD)
+
+/* seq and cmd before the arguments and the CRC after them */
+#define REQUEST_OVERHEAD    4
+
+/* Variables ----------------------------------------------------------------*/
+static uint8_t rx_ring[CMD_RX_BUFFER_SIZE];
+static uint16_t rx_pos = 0;             // Next ring offset to be parsed
+
+static uint8_t frame[CMD_FRAME_MAX];
+static uint8_t frame_len = 0;
+static bool frame_overflow = 0;
+
+static cmd_counters_t counters;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Calculates a CRC-16/CCITT-FALSE checksum.
+ * @details Uses a 16 entry table, processing one nibble at a time.
+ * @version 1.0
+ * @param   const uint8_t *data, The bytes to check.
+ * @param   uint32_t len, Number of bytes.
+ * @return  uint16_t, The checksum.
+ *****************************************************************************/
+static uint16_t crc16(const uint8_t *data, uint32_t len) {
+  static const uint16_t table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  };
+  uint16_t crc = 0xFFFF;
+
+  while (len--) {
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (*data >> 4)];
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (*data & 0x0F)];
+    data++;
+  }
+  return crc;
+}
+
+/**************************************************************************//**
+ * @brief   Decodes a COBS frame in place.
+ * @version 1.0
+ * @param   uint8_t *buf, The encoded frame, without the 0x00 delimiter.
+ * @param   uint32_t len, Length of the encoded frame.
+ * @return  int32_t, Length of the decoded frame, -1 if the frame is invalid.
+ *****************************************************************************/
+static int32_t cobs_decode(uint8_t *buf, uint32_t len) {
+  uint32_t in = 0, out = 0;
+
+  while (in < len) {
+    uint8_t code = buf[in++];
+
+    if (code == 0 || in + code - 1 > len) {
+      return -1;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      buf[out++] = buf[in++];
+    }
+    if (code != 0xFF && in < len) {
+      buf[out++] = 0;
+    }
+  }
+  return out;
+}
+
+/**************************************************************************//**
+ * @brief   Sends a response as a TELEMETRY_RESPONSE record.
+ * @version 1.0
+ * @param   uint8_t seq, Sequence number of the request.
+ * @param   uint8_t cmd, The command.
+ * @param   uint8_t status, CMD_OK or an error code.
+ * @param   const void *data, Response data, may be NULL if len is 0.
+ * @param   uint8_t len, Length of the response data.
+ * @return  None
+ *****************************************************************************/
+static void respond(uint8_t seq, uint8_t cmd, uint8_t status, const void *data, uint8_t len) {
+  uint8_t buf[RESPONSE_OVERHEAD + RESPONSE_DATA_MAX];
+  uint16_t crc;
+
+  buf[0] = seq;
+  buf[1] = cmd;
+  buf[2] = status;
+  if (len > 0) {
+    memcpy(&buf[3], data, len);
+  }
+
+  crc = crc16(buf, 3 + len);
+  buf[3 + len] = crc & 0xFF;
+  buf[4 + len] = crc >> 8;
+
+  telemetry_write(TELEMETRY_RESPONSE, buf, RESPONSE_OVERHEAD + len);
+}
+
+/**************************************************************************//**
+ * @brief   Carries out one request.
+ * @version 1.0
+ * @param   uint8_t seq, Sequence number of the request.
+ * @param   uint8_t cmd, The command.
+ * @param   const uint8_t *args, The command arguments.
+ * @param   uint32_t len, Length of the arguments.
+ * @return  None
+ *****************************************************************************/
+static void dispatch(uint8_t seq, uint8_t cmd, const uint8_t *args, uint32_t len) {
+  switch (cmd) {
+    case CMD_PING: {
+      cmd_ping_t ping = {
+        .version = CMD_PROTOCOL_VERSION,
+        .tick = HAL_GetTick(),
+      };
+      respond(seq, cmd, CMD_OK, &ping, sizeof(ping));
+      break;
+    }
+
+    case CMD_STATUS: {
+      cmd_status_t status = {
+        .state = traffic_state(),
+        .inputs = ctrl_inputs(),
+        .flags = ctrl_greens()
+               | (lamp_test_running() << 4) | (hil_enabled() << 5),
+        .lamps = (shiftreg_buffer[U1] << 16) | (shiftreg_buffer[U2] << 8) | shiftreg_buffer[U3],
+        .tick = HAL_GetTick(),
+      };
+      respond(seq, cmd, CMD_OK, &status, sizeof(status));
+      break;
+    }
+
+    case CMD_COUNTERS: {
+      cmd_counters_t snapshot = counters;
+      snapshot.telemetry_dropped = telemetry_dropped();
+      snapshot.stdio_dropped = uart_stdio_dropped();
+      snapshot.phase_changes = traffic_phase_changes();
+      respond(seq, cmd, CMD_OK, &snapshot, sizeof(snapshot));
+      break;
+    }
+
+    case CMD_GET_PARAM:
+    case CMD_SET_PARAM: {
+      cmd_param_t param;
+      uint16_t min, max;
+
+      if (len != ((cmd == CMD_GET_PARAM) ? 1 : 3)) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      param.id = args[0];
+      if (!timer_param_limits(param.id, &min, &max)) {
+        respond(seq, cmd, CMD_ERR_PARAM, NULL, 0);
+        break;
+      }
+      param.min = min;
+      param.max = max;
+      if (cmd == CMD_SET_PARAM && !timer_param_set(param.id, args[1] | (args[2] << 8))) {
+        param.value = timer_params[param.id];
+        respond(seq, cmd, CMD_ERR_RANGE, &param, sizeof(param));
+        break;
+      }
+      param.value = timer_params[param.id];
+      respond(seq, cmd, CMD_OK, &param, sizeof(param));
+      break;
+    }
+
+    case CMD_RESET_PARAMS:
+      if (len != 0) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      timer_params_reset();
+      respond(seq, cmd, CMD_OK, NULL, 0);
+      break;
+
+    case CMD_LAMP_TEST:
+      if (len != 6) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      lamp_test(args[0] | (args[1] << 8) | (args[2] << 16) | ((uint32_t)args[3] << 24),
+                args[4] | (args[5] << 8));
+      respond(seq, cmd, CMD_OK, NULL, 0);
+      break;
+
+    case CMD_HIL_MODE: {
+      cmd_hil_t hil;
+
+      if (len != 2) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      if (!timer_set_speedup(args[1])) {
+        hil.enabled = hil_enabled();
+        hil.speedup = timer_speedup();
+        respond(seq, cmd, CMD_ERR_RANGE, &hil, sizeof(hil));
+        break;
+      }
+      hil_set_mode(args[0] != 0);
+      hil.enabled = hil_enabled();
+      hil.speedup = timer_speedup();
+      respond(seq, cmd, CMD_OK, &hil, sizeof(hil));
+      break;
+    }
+
+    case CMD_INJECT:
+      if (len != 3) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      if (!hil_enabled()) {
+        respond(seq, cmd, CMD_ERR_STATE, NULL, 0);
+        break;
+      }
+      if (!hil_inject(args[0] | (args[1] << 8), args[2] ? GPIO_PIN_SET : GPIO_PIN_RESET)) {
+        respond(seq, cmd, CMD_ERR_PARAM, NULL, 0);
+        break;
+      }
+      respond(seq, cmd, CMD_OK, NULL, 0);
+      break;
+
+#if PROFILE_ENABLED
+    case CMD_PROFILE: {
+      cmd_profile_t profile;
+      profile_stats_t stats;
+
+      if (len != 2) {
+        respond(seq, cmd, CMD_ERR_LENGTH, NULL, 0);
+        break;
+      }
+      if (args[0] >= PROFILE_COUNT || args[1] > CMD_PROFILE_SHOW) {
+        respond(seq, cmd, CMD_ERR_PARAM, NULL, 0);
+        break;
+      }
+      profile_snapshot(args[0], &stats);
+      if (args[1] == CMD_PROFILE_RESET) {
+        profile_reset(args[0]);
+      } else if (args[1] == CMD_PROFILE_SHOW) {
+        profile_request_show();
+      }
+
+      profile.probe = args[0];
+      profile.core_hz = SystemCoreClock;
+      profile.count = stats.count;
+      profile.min = stats.min;
+      profile.max = stats.max;
+      profile.total = stats.total;
+      memcpy(profile.histogram, stats.histogram, sizeof(profile.histogram));
+      respond(seq, cmd, CMD_OK, &profile, sizeof(profile));
+      break;
+    }
+#endif
+
+#if MEM_MONITOR_ENABLED
+    case CMD_MEMORY: {
+      mem_usage_t usage;
+
+      mem_monitor_usage(&usage);
+      respond(seq, cmd, CMD_OK, &usage, sizeof(usage));
+      break;
+    }
+#endif
+
+    default:
+      respond(seq, cmd, CMD_ERR_UNKNOWN, NULL, 0);
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Decodes and checks a complete frame, then carries it out.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void frame_done(void) {
+  int32_t len = cobs_decode(frame, frame_len);
+  uint16_t crc;
+
+  if (len < REQUEST_OVERHEAD) {
+    counters.frame_errors++;
+    return;
+  }
+
+  crc = frame[len - 2] | (frame[len - 1] << 8);
+  if (crc16(frame, len - 2) != crc) {
+    counters.crc_errors++;
+    return;
+  }
+
+  counters.frames++;
+  dispatch(frame[0], frame[1], &frame[2], len - REQUEST_OVERHEAD);
+}
+
+/**************************************************************************//**
+ * @brief   Feeds received bytes to the frame collector.
+ * @version 1.0
+ * @param   const uint8_t *data, The received bytes.
+ * @param   uint32_t len, Number of bytes.
+ * @return  None
+ *****************************************************************************/
+static void parse(const uint8_t *data, uint32_t len) {
+  while (len--) {
+    uint8_t byte = *data++;
+
+    if (byte == 0x00) {
+      if (frame_overflow) {
+        counters.frame_errors++;
+      } else if (frame_len > 0) {
+        frame_done();
+      }
+      frame_len = 0;
+      frame_overflow = 0;
+    } else if (frame_len < CMD_FRAME_MAX) {
+      frame[frame_len++] = byte;
+    } else {
+      frame_overflow = 1;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Starts (or restarts) the USART2 DMA reception.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void start_reception(void) {
+  rx_pos = 0;
+  frame_len = 0;
+  frame_overflow = 0;
+  HAL_UARTEx_ReceiveToIdle_DMA(&huart2, rx_ring, CMD_RX_BUFFER_SIZE);
+}
+
+/**************************************************************************//**
+ * @brief   Starts listening for requests on USART2.
+ * @details Has to be called after MX_USART2_UART_Init and telemetry_init.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void cmd_protocol_init(void) {
+  memset(&counters, 0, sizeof(counters));
+  start_reception();
+}
+
+/**************************************************************************//**
+ * @brief   Handles a USART2 receive error.
+ * @details Called from HAL_UART_ErrorCallback. An overrun makes the HAL
+ *          abort the reception, it is started again with an empty frame.
+ * @version 1.0
+ * @param   UART_HandleTypeDef *huart, The UART that reported the error.
+ * @return  None
+ *****************************************************************************/
+void cmd_protocol_rx_error(UART_HandleTypeDef *huart) {
+  if (huart->Instance != USART2 || huart->ErrorCode == HAL_UART_ERROR_NONE) {
+    return;
+  }
+
+  counters.uart_errors++;
+  if (huart->RxState == HAL_UART_STATE_READY) {
+    start_reception();
+  }
+}
+
+/**************************************************************************//**
+ * @brief   USART2 receive event callback (half full, full or idle line).
+ * @details 'Size' is the ring offset the DMA has written up to, everything
+ *          from the last offset up to it is new.
+ * @version 1.0
+ * @param   UART_HandleTypeDef *huart, The UART that triggered the callback.
+ * @param   uint16_t Size, Current write offset of the DMA in the ring.
+ * @return  None
+ *****************************************************************************/
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+  if (huart->Instance != USART2 || Size == rx_pos) {
+    return;
+  }
+
+  if (Size > rx_pos) {
+    parse(&rx_ring[rx_pos], Size - rx_pos);
+  } else {
+    parse(&rx_ring[rx_pos], CMD_RX_BUFFER_SIZE - rx_pos);
+    parse(rx_ring, Size);
+  }
+
+  rx_pos = (Size == CMD_RX_BUFFER_SIZE) ? 0 : Size;
+}
@@ -0,0 +1,318 @@
+/**************************************************************************//**
+ * @file     crash_dump.c
+ * @brief    Fault handlers, crash dump in .noinit RAM and its report.
+ *
+ * @details  A fault handler first switches to a stack of its own, the fault
+ *           may have been a stack overflow, then fills in 'dump' and resets
+ *           the MCU. The reset happens within microseconds of the fault, the
+ *           board is back after the normal start-up.
+ *
+ *           The backtrace is a scan of the faulting stack for words that are
+ *           return addresses: odd (Thumb) addresses in .text right after a BL
+ *           or BLX instruction. Without frame pointers this is a heuristic,
+ *           stale return addresses of returned calls can show up as well.
+ *
+ *           With a debugger attached the handlers stop at a breakpoint
+ *           before the reset.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      crash_dump.h, Tools/crash_decode.py
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "crash_dump.h"
+#include "telemetry.h"
+
+#if CRASH_DUMP_ENABLED
+
+/* Defines ------------------------------------------------------------------*/
+#define RAM_START           0x20000000u
+#define FLASH_START         0x08000000u
+
+/* Stack of the fault handlers, in bytes */
+#define CRASH_STACK_SIZE    256
+#define STRINGIFY(x)        #x
+#define TO_STRING(x)        STRINGIFY(x)
+
+/* Variables ----------------------------------------------------------------*/
+extern uint8_t _estack;             /* Symbols defined in the linker script */
+extern uint8_t _etext;
+extern uint8_t _sramfunc;
+extern uint8_t _eramfunc;
+
+/* Kept over the reset, checked with 'magic' and 'check' */
+static crash_dump_t dump __attribute__((section(".noinit")));
+
+/* Used by the fault handler entry (assembly) */
+uint32_t crash_stack[CRASH_STACK_SIZE / 4] __attribute__((used));
+
+static crash_event_t history[CRASH_EVENTS];
+static uint32_t history_count = 0;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   32-bit FNV-1a hash, the checksum of a dump.
+ * @version 1.0
+ * @param   const void *data, The bytes.
+ * @param   uint32_t len, Number of bytes.
+ * @return  uint32_t, The hash.
+ *****************************************************************************/
+static uint32_t checksum(const void *data, uint32_t len) {
+  const uint8_t *bytes = data;
+  uint32_t hash = 2166136261u;
+
+  for (uint32_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/**************************************************************************//**
+ * @brief   Checks if a word is a return address.
+ * @details True for a Thumb address in .text or .ramfunc (SRAM2) that
+ *          follows a BL (32-bit) or BLX register (16-bit) instruction.
+ * @version 1.0
+ * @param   uint32_t value, The word.
+ * @return  boolean, true if it looks like a return address.
+ *****************************************************************************/
+static bool is_return_address(uint32_t value) {
+  const uint32_t addr = value & ~1u;
+  const uint16_t *code = (const uint16_t *)addr;
+  const bool in_text = addr >= FLASH_START + 4 && addr <= (uint32_t)&_etext;
+  const bool in_ramfunc = addr >= (uint32_t)&_sramfunc + 4 && addr <= (uint32_t)&_eramfunc;
+
+  if (!(value & 1) || !(in_text || in_ramfunc)) {
+    return false;
+  }
+  if ((code[-2] & 0xF800) == 0xF000 && (code[-1] & 0xD000) == 0xD000) {
+    return true;    // BL
+  }
+  return (code[-1] & 0xFF87) == 0x4780;   // BLX Rm
+}
+
+/**************************************************************************//**
+ * @brief   Checks if a range of words lies in the main RAM.
+ * @version 1.0
+ * @param   const uint32_t *start, First word.
+ * @param   uint32_t words, Number of words.
+ * @return  boolean, true if every word can be read.
+ *****************************************************************************/
+static bool in_ram(const uint32_t *start, uint32_t words) {
+  const uint32_t addr = (uint32_t)start;
+
+  return !(addr & 3) && addr >= RAM_START && addr + words * 4 <= (uint32_t)&_estack;
+}
+
+/**************************************************************************//**
+ * @brief   Adds an address to the backtrace, unless it repeats the last one.
+ * @version 1.0
+ * @param   uint32_t *depth, Used entries, advanced.
+ * @param   uint32_t addr, The address.
+ * @return  None
+ *****************************************************************************/
+static void backtrace_add(uint32_t *depth, uint32_t addr) {
+  if (*depth < CRASH_BACKTRACE_DEPTH && (*depth == 0 || dump.backtrace[*depth - 1] != addr)) {
+    dump.backtrace[(*depth)++] = addr;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Completes the dump and resets the MCU.
+ * @details Scans the stack from 'sp' for the backtrace and copies the event
+ *          history, oldest first.
+ * @version 1.0
+ * @param   uint32_t depth, Backtrace entries already filled in.
+ * @return  None
+ *****************************************************************************/
+static void __attribute__((noreturn)) finish(uint32_t depth) {
+  const uint32_t *word = (const uint32_t *)dump.sp;
+  const uint32_t count = history_count;
+  const uint32_t events = (count < CRASH_EVENTS) ? count : CRASH_EVENTS;
+
+  while (in_ram(word, 1) && depth < CRASH_BACKTRACE_DEPTH) {
+    if (is_return_address(*word)) {
+      backtrace_add(&depth, *word);
+    }
+    word++;
+  }
+
+  for (uint32_t i = 0; i < events; i++) {
+    dump.event[i] = history[(count - events + i) % CRASH_EVENTS];
+  }
+  dump.events = events;
+
+  dump.magic = CRASH_MAGIC;
+  dump.size = sizeof(dump);
+  dump.check = checksum(&dump, offsetof(crash_dump_t, check));
+
+  if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) {
+    __BKPT(0);
+  }
+  NVIC_SystemReset();
+}
+
+/**************************************************************************//**
+ * @brief   Saves the state of a fault, then resets.
+ * @details Called by the fault handler entry, on crash_stack.
+ * @version 1.0
+ * @param   const uint32_t *frame, Exception stack frame (MSP or PSP).
+ * @param   uint32_t exc_return, EXC_RETURN value of the handler.
+ * @return  None
+ *****************************************************************************/
+void __attribute__((used, noreturn)) crash_fault(const uint32_t *frame, uint32_t exc_return) {
+  uint32_t depth = 0;
+
+  __disable_irq();
+  memset(&dump, 0, sizeof(dump));
+  dump.reason = __get_IPSR() & 0xFF;
+  dump.tick = HAL_GetTick();
+  dump.exc_return = exc_return;
+  dump.cfsr = SCB->CFSR;
+  dump.hfsr = SCB->HFSR;
+  dump.mmfar = SCB->MMFAR;
+  dump.bfar = SCB->BFAR;
+
+  /* A frame outside the RAM (stack overflow) leaves the registers 0 */
+  if (in_ram(frame, 8)) {
+    dump.r0 = frame[0];
+    dump.r1 = frame[1];
+    dump.r2 = frame[2];
+    dump.r3 = frame[3];
+    dump.r12 = frame[4];
+    dump.lr = frame[5];
+    dump.pc = frame[6];
+    dump.xpsr = frame[7];
+
+    /* Basic frame 8 words, with FPU state 26, plus 1 if it was aligned */
+    dump.sp = (uint32_t)frame + ((exc_return & 0x10) ? 32 : 104) + ((dump.xpsr & 0x200) ? 4 : 0);
+    backtrace_add(&depth, dump.pc);
+    if (is_return_address(dump.lr)) {
+      backtrace_add(&depth, dump.lr);
+    }
+  }
+  finish(depth);
+}
+
+/**************************************************************************//**
+ * @brief   Entry of the fault handlers.
+ * @details Hands the exception frame and EXC_RETURN to crash_fault, on a
+ *          stack of its own. MemManage, BusFault and UsageFault are aliases.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void __attribute__((naked)) HardFault_Handler(void) {
+  __asm volatile(
+    "  tst   lr, #4                 \n"
+    "  ite   eq                     \n"
+    "  mrseq r0, msp                \n"
+    "  mrsne r0, psp                \n"
+    "  mov   r1, lr                 \n"
+    "  ldr   r2, =crash_stack + " TO_STRING(CRASH_STACK_SIZE) "\n"
+    "  mov   sp, r2                 \n"
+    "  b     crash_fault            \n");
+}
+
+void MemManage_Handler(void) __attribute__((alias("HardFault_Handler")));
+void BusFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+
+/**************************************************************************//**
+ * @brief   Saves the state of an Error_Handler call, then resets.
+ * @version 1.0
+ * @param   uint32_t caller, Return address of the Error_Handler call.
+ * @return  None
+ *****************************************************************************/
+void crash_error(uint32_t caller) {
+  __disable_irq();
+  memset(&dump, 0, sizeof(dump));
+  dump.reason = CRASH_ERROR_HANDLER;
+  dump.tick = HAL_GetTick();
+  dump.pc = caller;
+  dump.sp = __get_MSP();
+  dump.cfsr = SCB->CFSR;
+  dump.hfsr = SCB->HFSR;
+  finish(0);
+}
+
+/**************************************************************************//**
+ * @brief   Enables the MemManage, BusFault and UsageFault exceptions.
+ * @details Without this every fault escalates to HardFault, the CFSR tells
+ *          the cause either way.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void crash_dump_init(void) {
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+}
+
+/**************************************************************************//**
+ * @brief   Sends the dump of the last crash, if there is one.
+ * @details Has to be called after telemetry_init. The dump is sent in
+ *          TELEMETRY_CRASH records of up to CRASH_CHUNK_SIZE bytes and then
+ *          deleted. After a power-on the RAM holds no valid dump.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void crash_dump_report(void) {
+  uint8_t record[2 + CRASH_CHUNK_SIZE];
+
+  if (dump.magic != CRASH_MAGIC || dump.size != sizeof(dump)
+      || dump.check != checksum(&dump, offsetof(crash_dump_t, check))) {
+    dump.magic = 0;
+    return;
+  }
+
+  for (uint16_t offset = 0; offset < sizeof(dump); offset += CRASH_CHUNK_SIZE) {
+    const uint16_t len = (sizeof(dump) - offset < CRASH_CHUNK_SIZE) ? sizeof(dump) - offset : CRASH_CHUNK_SIZE;
+
+    record[0] = offset & 0xFF;
+    record[1] = offset >> 8;
+    memcpy(&record[2], (const uint8_t *)&dump + offset, len);
+    telemetry_write(TELEMETRY_CRASH, record, 2 + len);
+  }
+  dump.magic = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Keeps a telemetry record in the event history of the dump.
+ * @details Called by telemetry_write for every record, only PHASE, INPUT,
+ *          LAMPS and TRACE records are kept. Safe to call from any context.
+ * @version 1.0
+ * @param   uint8_t type, The record type.
+ * @param   const void *payload, The record payload.
+ * @param   uint8_t len, Payload length in bytes.
+ * @return  None
+ *****************************************************************************/
+void crash_dump_event(uint8_t type, const void *payload, uint8_t len) {
+  crash_event_t *entry;
+  uint32_t slot;
+
+  if (type < TELEMETRY_PHASE || type > TELEMETRY_TRACE) {
+    return;
+  }
+
+  do {
+    slot = __LDREXW(&history_count);
+  } while (__STREXW(slot + 1, &history_count));
+
+  entry = &history[slot % CRASH_EVENTS];
+  entry->type = type;
+  entry->len = (len < CRASH_EVENT_SIZE) ? len : CRASH_EVENT_SIZE;
+  memcpy(entry->payload, payload, entry->len);
+}
+
+#endif
@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ * @file     ctrl_state.c
+ * @brief    The shared controller state.
+ *
+ * @details  One 8-byte block in SRAM1, its flag word first so the linker
+ *           script can place the bit-band alias ctrl_state_bb on it. The
+ *           start-up state has intersection 2 and crosswalk 1 green, per
+ *           requirements R1.1 and R2.8, like init_state of the shift
+ *           registers.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      ctrl_state.h, STM32L476RGTX_FLASH.ld
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "ctrl_state.h"
+
+/* Variables ----------------------------------------------------------------*/
+ctrl_state_t ctrl_state __attribute__((aligned(8))) = {
+  .flags = (1u << FLAG_INTERSECTION2_GREEN)
+         | (1u << FLAG_CROSSWALK1_GREEN)
+         | (1u << FLAG_INTERSECTION1_RED)
+         | (1u << FLAG_CROSSWALK2_RED),
+};
@@ -0,0 +1,214 @@
+/**************************************************************************//**
+ * @file     fmt.c
+ * @brief    Number formatting without snprintf.
+ *
+ * @details  Decimal digits are produced two at a time, from the back: the
+ *           quotient by 100 is a multiply-high with the reciprocal (one
+ *           UMULL, no UDIV) and the remainder indexes a table of the 100
+ *           digit pairs. A 32-bit number takes at most five rounds.
+ *           Hexadecimal digits are shifts and a table lookup.
+ *
+ *           The digits are built in a small local buffer and then copied
+ *           behind the padding and the sign, so the caller's buffer is
+ *           written once, front to back.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      fmt.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fmt.h"
+
+/* Defines ------------------------------------------------------------------*/
+/* ceil(2^37 / 100), exact quotient for every 32-bit value */
+#define RECIPROCAL_100  0x51EB851Fu
+#define SHIFT_100       37
+
+/* Variables ----------------------------------------------------------------*/
+static const char digit_pairs[200] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Writes the decimal digits of a value, backwards from 'end'.
+ * @version 1.0
+ * @param   char *end, The character after the last digit.
+ * @param   uint32_t value, The value.
+ * @return  char *, The first digit.
+ *****************************************************************************/
+static char *put_digits(char *end, uint32_t value) {
+  while (value >= 100) {
+    const uint32_t quotient = (uint32_t)(((uint64_t)value * RECIPROCAL_100) >> SHIFT_100);
+    const uint32_t pair = value - quotient * 100;
+
+    end -= 2;
+    end[0] = digit_pairs[pair * 2];
+    end[1] = digit_pairs[pair * 2 + 1];
+    value = quotient;
+  }
+
+  if (value >= 10) {
+    end -= 2;
+    end[0] = digit_pairs[value * 2];
+    end[1] = digit_pairs[value * 2 + 1];
+  } else {
+    *--end = (char)('0' + value);
+  }
+  return end;
+}
+
+/**************************************************************************//**
+ * @brief   Writes the padding, the sign and the digits into the buffer.
+ * @details A '0' pad goes between the sign and the digits, any other pad in
+ *          front of the sign.
+ * @version 1.0
+ * @param   char *buf, The buffer of the caller.
+ * @param   bool negative, Write a '-' first.
+ * @param   const char *digits, The digits.
+ * @param   uint8_t count, Number of digits.
+ * @param   uint8_t width, Minimum length.
+ * @param   char pad, Fills up to the width.
+ * @return  uint8_t, Characters written, without the null.
+ *****************************************************************************/
+static uint8_t finish(char *buf, bool negative, const char *digits,
+                      uint8_t count, uint8_t width, char pad) {
+  const uint8_t length = count + (negative ? 1 : 0);
+  const uint8_t padding = (width > length) ? width - length : 0;
+  char *out = buf;
+
+  if (pad != '0') {
+    memset(out, pad, padding);
+    out += padding;
+  }
+  if (negative) {
+    *out++ = '-';
+  }
+  if (pad == '0') {
+    memset(out, '0', padding);
+    out += padding;
+  }
+  memcpy(out, digits, count);
+  out[count] = '\0';
+
+  return length + padding;
+}
+
+/**************************************************************************//**
+ * @brief   Formats an unsigned decimal number.
+ * @version 1.0
+ * @param   char *buf, Room for FMT_U32_SIZE or width + 1 characters.
+ * @param   uint32_t value, The number.
+ * @param   uint8_t width, Minimum length, 0 for none.
+ * @param   char pad, ' ' or '0', fills up to the width.
+ * @return  uint8_t, Characters written, without the null.
+ *****************************************************************************/
+uint8_t fmt_u32(char *buf, uint32_t value, uint8_t width, char pad) {
+  char digits[FMT_U32_SIZE];
+  char *const end = &digits[sizeof(digits)];
+  const char *first = put_digits(end, value);
+
+  return finish(buf, false, first, end - first, width, pad);
+}
+
+/**************************************************************************//**
+ * @brief   Formats a signed decimal number.
+ * @version 1.0
+ * @param   char *buf, Room for FMT_I32_SIZE or width + 1 characters.
+ * @param   int32_t value, The number.
+ * @param   uint8_t width, Minimum length with the sign, 0 for none.
+ * @param   char pad, ' ' or '0', fills up to the width.
+ * @return  uint8_t, Characters written, without the null.
+ *****************************************************************************/
+uint8_t fmt_i32(char *buf, int32_t value, uint8_t width, char pad) {
+  char digits[FMT_U32_SIZE];
+  char *const end = &digits[sizeof(digits)];
+  const uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+  const char *first = put_digits(end, magnitude);
+
+  return finish(buf, value < 0, first, end - first, width, pad);
+}
+
+/**************************************************************************//**
+ * @brief   Formats a hexadecimal number, upper case, without a prefix.
+ * @version 1.0
+ * @param   char *buf, Room for digits + 1, or FMT_HEX_SIZE characters.
+ * @param   uint32_t value, The number.
+ * @param   uint8_t digits, Number of digits (the low ones), 1 to 8; 0 for
+ *          as many as needed.
+ * @return  uint8_t, Characters written, without the null.
+ *****************************************************************************/
+uint8_t fmt_hex(char *buf, uint32_t value, uint8_t digits) {
+  if (digits == 0) {
+    digits = 1;
+    while (digits < 8 && (value >> (digits * 4))) {
+      digits++;
+    }
+  } else if (digits > 8) {
+    digits = 8;
+  }
+
+  for (uint8_t i = 0; i < digits; i++) {
+    buf[i] = hex_digits[(value >> ((digits - 1 - i) * 4)) & 0xF];
+  }
+  buf[digits] = '\0';
+
+  return digits;
+}
+
+/**************************************************************************//**
+ * @brief   Formats a decimal fixed-point number.
+ * @details The value is in units of 10^-decimals: 1234 with 2 decimals is
+ *          "12.34", 5 with 2 decimals "0.05". There is always a digit in
+ *          front of the point.
+ * @version 1.0
+ * @param   char *buf, Room for FMT_FIXED_SIZE or width + 1 characters.
+ * @param   int32_t value, The number, scaled.
+ * @param   uint8_t decimals, Digits after the point, up to
+ *          FMT_MAX_DECIMALS; 0 for an integer.
+ * @param   uint8_t width, Minimum length with the sign, 0 for none.
+ * @param   char pad, ' ' or '0', fills up to the width.
+ * @return  uint8_t, Characters written, without the null.
+ *****************************************************************************/
+uint8_t fmt_fixed(char *buf, int32_t value, uint8_t decimals, uint8_t width, char pad) {
+  char digits[FMT_FIXED_SIZE];
+  char *const end = &digits[sizeof(digits)];
+  const uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+
+  if (decimals > FMT_MAX_DECIMALS) {
+    decimals = FMT_MAX_DECIMALS;
+  }
+
+  /* Digits after the point, then the integer part one to the left of them */
+  char *first = put_digits(end, magnitude);
+  while (end - first < decimals + 1) {
+    *--first = '0';
+  }
+  if (decimals > 0) {
+    char *const point = end - decimals - 1;
+
+    memmove(first - 1, first, point + 1 - first);
+    *point = '.';
+    first--;
+  }
+
+  return finish(buf, value < 0, first, end - first, width, pad);
+}
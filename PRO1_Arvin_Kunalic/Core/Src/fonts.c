@@ -14,7 +14,7 @@
  * 
  ******************************************************************************
  * @author   Arvin Kunalic
- * @version  1.0
+ * @version  1.1
  * @date     01-December-2024
  * @note     Confirm proper alignment and indexing when using the font array 
  *           to prevent accessing invalid memory regions.
@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "fonts.h"
+
 /* Variables ----------------------------------------------------------------*/
 const uint8_t Font5x7[][5] = {
     {0x00, 0x00, 0x00, 0x00, 0x00}, // ' ' (Space)
@@ -124,3 +126,14 @@ const uint8_t Font5x7[][5] = {
     {0x10, 0x08, 0x08, 0x10, 0x08}, // '~'
 };
 
+/* Font5x7 for draw_text, row 7 is only used by '_' */
+const font_t font_5x7 = {
+    .data = &Font5x7[0][0],
+    .glyphs = NULL,
+    .first = ' ',
+    .last = '~',
+    .width = 5,
+    .height = 8,
+    .spacing = 1,
+    .encoding = GLYPH_RAW,
+};
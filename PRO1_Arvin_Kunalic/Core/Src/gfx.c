@@ -0,0 +1,362 @@
+/**************************************************************************//**
+ * @file     gfx.c
+ * @brief    Drawing primitives for the OLED framebuffer.
+ *
+ * @details  All rectangles, lines along an axis included, go through
+ *           fill_rect: clip, then one row mask per page applied to a run of
+ *           bytes by span. span writes the bytes up to a word boundary one
+ *           by one and the rest a 32-bit word at a time, with a separate
+ *           loop per color so the inner loop is a load, one operation and
+ *           a store. draw_line follows Bresenham's algorithm but hands
+ *           every run of pixels in one row (or column, for steep lines) to
+ *           fill_rect at once.
+ *
+ *           The framebuffer is accessed through fb_word_t, a uint32_t that
+ *           may alias the bytes, and is word-aligned (ssd1306_config.c).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      gfx.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "gfx.h"
+#include "ssd1306_config.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define OLED_PAGES      (OLED_HEIGHT / 8)
+
+_Static_assert(OLED_WIDTH % 4 == 0, "every page has to start on a word");
+
+/* Types --------------------------------------------------------------------*/
+typedef uint32_t __attribute__((may_alias)) fb_word_t;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Applies a row mask to one framebuffer byte.
+ * @version 1.0
+ * @param   uint8_t *byte, The byte.
+ * @param   uint8_t mask, The rows to change.
+ * @param   gfx_color_t color, Set, clear or invert them.
+ * @return  None
+ *****************************************************************************/
+static inline void apply(uint8_t *byte, uint8_t mask, gfx_color_t color) {
+  if (color == GFX_SET) {
+    *byte |= mask;
+  } else if (color == GFX_CLEAR) {
+    *byte &= ~mask;
+  } else {
+    *byte ^= mask;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Applies a row mask to the columns x to end - 1 of one page.
+ * @version 1.0
+ * @param   uint8_t *page, First byte of the page.
+ * @param   int16_t x, First column, on the screen.
+ * @param   int16_t end, Column after the last one, on the screen.
+ * @param   uint8_t mask, The rows to change.
+ * @param   gfx_color_t color, Set, clear or invert them.
+ * @return  None
+ *****************************************************************************/
+static void span(uint8_t *page, int16_t x, int16_t end, uint8_t mask,
+                 gfx_color_t color) {
+  /* Up to a word boundary */
+  for (; x < end && (x & 3); x++) {
+    apply(&page[x], mask, color);
+  }
+
+  const uint32_t mask32 = mask * 0x01010101u;
+  fb_word_t *word = (fb_word_t *)&page[x];
+  const int16_t words = (end - x) / 4;
+
+  if (color == GFX_SET) {
+    for (int16_t i = 0; i < words; i++) {
+      word[i] |= mask32;
+    }
+  } else if (color == GFX_CLEAR) {
+    for (int16_t i = 0; i < words; i++) {
+      word[i] &= ~mask32;
+    }
+  } else {
+    for (int16_t i = 0; i < words; i++) {
+      word[i] ^= mask32;
+    }
+  }
+
+  /* The rest */
+  for (x += words * 4; x < end; x++) {
+    apply(&page[x], mask, color);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Fills a rectangle.
+ * @version 1.0
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   int16_t width, Columns, nothing if 0 or less.
+ * @param   int16_t height, Rows, nothing if 0 or less.
+ * @param   gfx_color_t color, Set, clear or invert the pixels.
+ * @return  None
+ *****************************************************************************/
+void fill_rect(int16_t x, int16_t y, int16_t width, int16_t height,
+               gfx_color_t color) {
+  int16_t right = x + width;
+  int16_t bottom = y + height;
+
+  if (x < 0) {
+    x = 0;
+  }
+  if (y < 0) {
+    y = 0;
+  }
+  if (right > OLED_WIDTH) {
+    right = OLED_WIDTH;
+  }
+  if (bottom > OLED_HEIGHT) {
+    bottom = OLED_HEIGHT;
+  }
+  if (x >= right || y >= bottom) {
+    return;
+  }
+
+  const uint8_t first = y / 8;
+  const uint8_t last = (bottom - 1) / 8;
+
+  for (uint8_t page = first; page <= last; page++) {
+    uint8_t mask = 0xFF;
+
+    if (page == first) {
+      mask &= 0xFF << (y % 8);
+    }
+    if (page == last) {
+      mask &= 0xFF >> (7 - (bottom - 1) % 8);
+    }
+    span(&OLED_framebuffer[page * OLED_WIDTH], x, right, mask, color);
+  }
+  display_mark_rows(y, bottom - y);
+}
+
+/**************************************************************************//**
+ * @brief   Draws one pixel.
+ * @version 1.0
+ * @param   int16_t x, Column, nothing if off-screen.
+ * @param   int16_t y, Row, nothing if off-screen.
+ * @param   gfx_color_t color, Set, clear or invert it.
+ * @return  None
+ *****************************************************************************/
+void draw_pixel(int16_t x, int16_t y, gfx_color_t color) {
+  if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_HEIGHT) {
+    return;
+  }
+  apply(&OLED_framebuffer[(y / 8) * OLED_WIDTH + x], 1u << (y % 8), color);
+  display_mark_rows(y, 1);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a horizontal line, from x to the right.
+ * @version 1.0
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Row.
+ * @param   int16_t width, Length in pixels.
+ * @param   gfx_color_t color, Set, clear or invert the pixels.
+ * @return  None
+ *****************************************************************************/
+void draw_hline(int16_t x, int16_t y, int16_t width, gfx_color_t color) {
+  fill_rect(x, y, width, 1, color);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a vertical line, from y down. One byte per page.
+ * @version 1.0
+ * @param   int16_t x, Column.
+ * @param   int16_t y, Top row.
+ * @param   int16_t height, Length in pixels.
+ * @param   gfx_color_t color, Set, clear or invert the pixels.
+ * @return  None
+ *****************************************************************************/
+void draw_vline(int16_t x, int16_t y, int16_t height, gfx_color_t color) {
+  fill_rect(x, y, 1, height, color);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a line between two points, both included.
+ * @details Bresenham's algorithm, integer only. Consecutive pixels in one
+ *          row (one column for a steep line) are drawn as one line, a line
+ *          along an axis is a single fill_rect. The pixels are the same in
+ *          both directions.
+ * @version 1.0
+ * @param   int16_t x0, Column of the first point.
+ * @param   int16_t y0, Row of the first point.
+ * @param   int16_t x1, Column of the second point.
+ * @param   int16_t y1, Row of the second point.
+ * @param   gfx_color_t color, Set, clear or invert the pixels.
+ * @return  None
+ *****************************************************************************/
+void draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+               gfx_color_t color) {
+  const bool steep = abs(y1 - y0) > abs(x1 - x0);
+
+  /* Walk along the long axis, in increasing order */
+  if (steep ? (y0 > y1) : (x0 > x1)) {
+    int16_t t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  if (!steep) {
+    const int16_t dx = x1 - x0;
+    const int16_t dy = abs(y1 - y0);
+    const int16_t step = (y1 > y0) ? 1 : -1;
+    int16_t error = dx / 2;
+    int16_t start = x0;
+
+    for (int16_t x = x0; x <= x1; x++) {
+      error -= dy;
+      if (error < 0 || x == x1) {
+        draw_hline(start, y0, x - start + 1, color);
+        start = x + 1;
+        y0 += step;
+        error += dx;
+      }
+    }
+  } else {
+    const int16_t dy = y1 - y0;
+    const int16_t dx = abs(x1 - x0);
+    const int16_t step = (x1 > x0) ? 1 : -1;
+    int16_t error = dy / 2;
+    int16_t start = y0;
+
+    for (int16_t y = y0; y <= y1; y++) {
+      error -= dx;
+      if (error < 0 || y == y1) {
+        draw_vline(x0, start, y - start + 1, color);
+        start = y + 1;
+        x0 += step;
+        error += dy;
+      }
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Draws the outline of a rectangle.
+ * @details Every pixel is drawn once, also with GFX_INVERT.
+ * @version 1.0
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   int16_t width, Columns, including the outline.
+ * @param   int16_t height, Rows, including the outline.
+ * @param   gfx_color_t color, Set, clear or invert the pixels.
+ * @return  None
+ *****************************************************************************/
+void draw_rect(int16_t x, int16_t y, int16_t width, int16_t height,
+               gfx_color_t color) {
+  if (width <= 2 || height <= 2) {
+    fill_rect(x, y, width, height, color);
+    return;
+  }
+  draw_hline(x, y, width, color);
+  draw_hline(x, y + height - 1, width, color);
+  draw_vline(x, y + 1, height - 2, color);
+  draw_vline(x + width - 1, y + 1, height - 2, color);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a progress bar: an outline, filled from the left.
+ * @details The fill is 2 pixels inside the outline, the space between is
+ *          cleared. With max equal to width - 4 every step of value is one
+ *          column.
+ * @version 1.0
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   int16_t width, Columns, at least 5.
+ * @param   int16_t height, Rows, at least 5.
+ * @param   uint32_t value, Progress, up to max.
+ * @param   uint32_t max, Value of a full bar, empty if 0.
+ * @return  None
+ *****************************************************************************/
+void draw_progress(int16_t x, int16_t y, int16_t width, int16_t height,
+                   uint32_t value, uint32_t max) {
+  const int16_t inner = width - 4;
+  int16_t filled = 0;
+
+  if (inner <= 0 || height < 5) {
+    return;
+  }
+  if (max > 0) {
+    filled = (value >= max) ? inner : (int16_t)(((uint64_t)inner * value) / max);
+  }
+
+  draw_rect(x, y, width, height, GFX_SET);
+  fill_rect(x + 1, y + 1, width - 2, height - 2, GFX_CLEAR);
+  fill_rect(x + 2, y + 2, filled, height - 4, GFX_SET);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a sprite over the framebuffer.
+ * @details Only the lit pixels of the sprite are drawn: GFX_SET lights
+ *          them, GFX_CLEAR erases them and GFX_INVERT flips them, the rest
+ *          of the box is left as it is. The columns and pages off the
+ *          screen are skipped before the loop. The sprite has to be
+ *          GLYPH_RAW; other encodings are drawn with draw_bitmap, which
+ *          overwrites the whole box. The columns are indexed from the
+ *          start of the page, so a sprite partly left of the screen never
+ *          forms a pointer before the framebuffer.
+ * @version 1.1
+ * @param   int16_t x, Left column, may be partly off-screen.
+ * @param   int16_t y, Top row, any row, may be partly off-screen.
+ * @param   const bitmap_t *sprite, The sprite.
+ * @param   gfx_color_t color, What to do with its lit pixels.
+ * @return  None
+ *****************************************************************************/
+void blit_sprite(int16_t x, int16_t y, const bitmap_t *sprite,
+                 gfx_color_t color) {
+  if (sprite->encoding != GLYPH_RAW) {
+    draw_bitmap(x, y, sprite);
+    return;
+  }
+
+  const int16_t first = (x < 0) ? -x : 0;
+  const int16_t end = (x + sprite->width > OLED_WIDTH) ? OLED_WIDTH - x : sprite->width;
+  if (first >= end || y >= OLED_HEIGHT || y + sprite->height <= 0) {
+    return;
+  }
+
+  /* Page of the top row and the shift within it, rounded down */
+  const int16_t top = (y >= 0) ? y / 8 : -((7 - y) / 8);
+  const uint8_t shift = y - top * 8;
+  const uint8_t pages = (sprite->height + 7) / 8;
+
+  for (uint8_t p = 0; p < pages; p++) {
+    const uint8_t *src = &sprite->data[p * sprite->width];
+    const int16_t upper = top + p;
+    const int16_t lower = upper + 1;
+    uint8_t rows = 0xFF;
+
+    if (p == pages - 1 && (sprite->height % 8)) {
+      rows = 0xFF >> (8 - sprite->height % 8);
+    }
+    if (upper >= 0 && upper < OLED_PAGES) {
+      uint8_t *dst = &OLED_framebuffer[upper * OLED_WIDTH];
+      for (int16_t c = first; c < end; c++) {
+        apply(&dst[x + c], (uint8_t)((src[c] & rows) << shift), color);
+      }
+    }
+    if (shift && lower >= 0 && lower < OLED_PAGES) {
+      uint8_t *dst = &OLED_framebuffer[lower * OLED_WIDTH];
+      for (int16_t c = first; c < end; c++) {
+        apply(&dst[x + c], (uint8_t)((src[c] & rows) >> (8 - shift)), color);
+      }
+    }
+  }
+  display_mark_rows(y, sprite->height);
+}
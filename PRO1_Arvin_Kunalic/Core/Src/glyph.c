@@ -0,0 +1,368 @@
+/**************************************************************************//**
+ * @file     glyph.c
+ * @brief    Draws flash-resident fonts and bitmaps into the OLED framebuffer.
+ *
+ * @details  All three encodings of glyph.h are decoded in one pass over the
+ *           data, strip by strip (8 rows of one column) into the
+ *           framebuffer. A strip at a row that is not a multiple of 8 is
+ *           split over two pages. The pixels of the glyph box are
+ *           overwritten, set and cleared, like draw_char does.
+ *
+ *           Like the other drawing functions these only change the
+ *           framebuffer and mark the pages, display_service sends them.
+ *           Glyphs wholly off-screen are skipped without decoding, so the
+ *           cost follows the pixels drawn, not the length of the text.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      glyph.h, Tools/font_convert.py
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "glyph.h"
+#include "gfx.h"
+#include "ssd1306_config.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define OLED_PAGES      (OLED_HEIGHT / 8)
+
+/* Types --------------------------------------------------------------------*/
+typedef struct {
+  const uint8_t *data;
+  uint32_t bits;                // Read ahead, next bit in bit 0
+  uint8_t count;                // Bits in 'bits'
+} bit_reader_t;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Overwrites up to 8 rows of one framebuffer column.
+ * @version 1.0
+ * @param   int16_t x, Column, may be off-screen.
+ * @param   int16_t y, Row of bit 0, may be off-screen.
+ * @param   uint8_t bits, The pixels, bit 0 at row y.
+ * @param   uint8_t rows, How many of the bits to write (1-8).
+ * @return  None
+ *****************************************************************************/
+static void put_strip(int16_t x, int16_t y, uint8_t bits, uint8_t rows) {
+  uint16_t mask = (1u << rows) - 1u;
+  uint16_t value = bits & mask;
+
+  if (x < 0 || x >= OLED_WIDTH || y >= OLED_HEIGHT || y <= -8) {
+    return;
+  }
+  if (y < 0) {
+    mask >>= -y;
+    value >>= -y;
+    y = 0;
+  }
+
+  const uint8_t page = y / 8;
+  mask <<= y % 8;
+  value <<= y % 8;
+
+  uint8_t *column = &OLED_framebuffer[page * OLED_WIDTH + x];
+  column[0] = (column[0] & ~mask) | value;
+  if ((mask >> 8) && page + 1 < OLED_PAGES) {
+    column[OLED_WIDTH] = (column[OLED_WIDTH] & ~(mask >> 8)) | (value >> 8);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Reads the next bits of a GLYPH_PACKED stream, LSB first.
+ * @version 1.0
+ * @param   bit_reader_t *reader, The stream.
+ * @param   uint8_t count, Number of bits (1-8).
+ * @return  uint8_t, The bits.
+ *****************************************************************************/
+static uint8_t read_bits(bit_reader_t *reader, uint8_t count) {
+  if (reader->count < count) {
+    reader->bits |= (uint32_t)*reader->data++ << reader->count;
+    reader->count += 8;
+  }
+  const uint8_t bits = reader->bits & ((1u << count) - 1u);
+  reader->bits >>= count;
+  reader->count -= count;
+  return bits;
+}
+
+/**************************************************************************//**
+ * @brief   Decodes a block of columns into the framebuffer.
+ * @details GLYPH_RAW and GLYPH_RLE come page by page, GLYPH_PACKED column
+ *          by column; either way every byte or bit field is read once.
+ * @version 1.0
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   uint8_t width, Columns.
+ * @param   uint8_t height, Rows.
+ * @param   uint8_t encoding, glyph_encoding_t of the data.
+ * @param   const uint8_t *data, The encoded columns.
+ * @return  None
+ *****************************************************************************/
+static void draw_block(int16_t x, int16_t y, uint8_t width, uint8_t height,
+                       uint8_t encoding, const uint8_t *data) {
+  const uint8_t pages = (height + 7) / 8;
+
+  if (width == 0 || height == 0 || x >= OLED_WIDTH || x + width <= 0
+      || y >= OLED_HEIGHT || y + height <= 0) {
+    return;
+  }
+
+  if (encoding == GLYPH_PACKED) {
+    bit_reader_t reader = {.data = data, .bits = 0, .count = 0};
+
+    for (uint8_t col = 0; col < width; col++) {
+      for (uint8_t row = 0; row < height; row += 8) {
+        const uint8_t rows = (height - row < 8) ? height - row : 8;
+        put_strip(x + col, y + row, read_bits(&reader, rows), rows);
+      }
+    }
+  } else {
+    /* Page-major bytes, as they are or run-length coded */
+    uint8_t col = 0, page = 0;
+    uint8_t run = 0;            // Bytes left in the current run
+    bool repeat = false;
+    uint8_t value = 0;
+
+    while (page < pages) {
+      if (encoding == GLYPH_RLE) {
+        if (run == 0) {
+          const uint8_t control = *data++;
+          repeat = control & 0x80;
+          run = repeat ? control - 0x7E : control + 1;
+          if (repeat) {
+            value = *data++;
+          }
+        }
+        if (!repeat) {
+          value = *data++;
+        }
+        run--;
+      } else {
+        value = *data++;
+      }
+
+      const uint8_t rows = (height - page * 8 < 8) ? height - page * 8 : 8;
+      put_strip(x + col, y + page * 8, value, rows);
+      if (++col == width) {
+        col = 0;
+        page++;
+      }
+    }
+  }
+
+  display_mark_rows(y, height);
+}
+
+/**************************************************************************//**
+ * @brief   Clears a block of columns, clipped to the screen.
+ * @details Erases an icon or a text box drawn earlier, see fill_rect.
+ * @version 1.1
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row, any row.
+ * @param   int16_t width, Columns, nothing if 0 or less.
+ * @param   uint8_t height, Rows.
+ * @return  None
+ *****************************************************************************/
+void clear_area(int16_t x, int16_t y, int16_t width, uint8_t height) {
+  fill_rect(x, y, width, height, GFX_CLEAR);
+}
+
+/**************************************************************************//**
+ * @brief   Looks up the data and width of a character.
+ * @version 1.0
+ * @param   const font_t *font, The font.
+ * @param   char c, The character.
+ * @param   uint8_t *width, Set to the glyph width.
+ * @return  const uint8_t *, The glyph data, NULL if not in the font.
+ *****************************************************************************/
+static const uint8_t *find_glyph(const font_t *font, char c, uint8_t *width) {
+  const uint8_t code = (uint8_t)c;
+
+  if (code < font->first || code > font->last) {
+    return NULL;
+  }
+
+  const uint8_t index = code - font->first;
+  if (font->glyphs) {
+    *width = font->glyphs[index].width;
+    return &font->data[font->glyphs[index].offset];
+  }
+
+  uint16_t size;
+  if (font->encoding == GLYPH_PACKED) {
+    size = (font->width * font->height + 7) / 8;
+  } else {
+    size = font->width * ((font->height + 7) / 8);
+  }
+  *width = font->width;
+  return &font->data[index * size];
+}
+
+/**************************************************************************//**
+ * @brief   Draws a string on one line, up to a right edge.
+ * @details The spacing after each glyph is cleared, but not beyond 'right'.
+ *          Stops at the first glyph that does not end before 'right' or the
+ *          edge of the screen, so nothing is drawn past them.
+ * @version 1.1
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   const font_t *font, The font.
+ * @param   const char *str, Null-terminated string.
+ * @param   int16_t right, The column after the last one to draw.
+ * @return  int16_t, The column after the text.
+ *****************************************************************************/
+static int16_t draw_run(int16_t x, int16_t y, const font_t *font,
+                        const char *str, int16_t right) {
+  if (right > OLED_WIDTH) {
+    right = OLED_WIDTH;
+  }
+
+  while (*str && x < right) {
+    uint8_t width;
+    const uint8_t *data = find_glyph(font, *str++, &width);
+
+    if (!data) {
+      continue;
+    }
+    if (x + width > right) {
+      break;
+    }
+    draw_block(x, y, width, font->height, font->encoding, data);
+    x += width;
+
+    /* The spacing is cleared too, a shorter text overwrites a longer one */
+    if (x < right) {
+      const int16_t spacing = (right - x < font->spacing) ? right - x : font->spacing;
+      clear_area(x, y, spacing, font->height);
+    }
+    x += font->spacing;
+  }
+  return x;
+}
+
+/**************************************************************************//**
+ * @brief   Draws one character.
+ * @details Characters outside the font are skipped, 0 columns.
+ * @version 1.1
+ * @param   int16_t x, Left column, may be partly off-screen.
+ * @param   int16_t y, Top row, any row, may be partly off-screen.
+ * @param   const font_t *font, The font.
+ * @param   char c, The character.
+ * @return  uint8_t, The advance: glyph width plus the font spacing.
+ *****************************************************************************/
+uint8_t draw_glyph(int16_t x, int16_t y, const font_t *font, char c) {
+  uint8_t width;
+  const uint8_t *data = find_glyph(font, c, &width);
+
+  if (!data) {
+    return 0;
+  }
+  draw_block(x, y, width, font->height, font->encoding, data);
+
+  /* The spacing is cleared too, a shorter text overwrites a longer one */
+  clear_area(x + width, y, font->spacing, font->height);
+  return width + font->spacing;
+}
+
+/**************************************************************************//**
+ * @brief   Draws a string on one line, without wrapping.
+ * @details Stops at the first glyph that does not fit on the screen.
+ * @version 1.2
+ * @param   int16_t x, Left column.
+ * @param   int16_t y, Top row.
+ * @param   const font_t *font, The font.
+ * @param   const char *str, Null-terminated string.
+ * @return  int16_t, The column after the text, or after the last glyph
+ *          that fit on the screen.
+ *****************************************************************************/
+int16_t draw_text(int16_t x, int16_t y, const font_t *font, const char *str) {
+  return draw_run(x, y, font, str, OLED_WIDTH);
+}
+
+/**************************************************************************//**
+ * @brief   Draws a string aligned in a box and clears the rest of the box.
+ * @details The box is 'width' columns from x and font->height rows from y.
+ *          Without the spacing after the last glyph the text is put at the
+ *          left, in the middle or at the right of the box, and the columns
+ *          around it are cleared, so a shorter text replaces a longer one
+ *          (a countdown going from 10 to 9). A text wider than the box
+ *          starts at its left edge, glyphs that do not end inside the box are
+ *          left out.
+ * @version 1.1
+ * @param   int16_t x, Left column of the box.
+ * @param   int16_t y, Top row of the box.
+ * @param   uint8_t width, Columns of the box.
+ * @param   const font_t *font, The font.
+ * @param   const char *str, Null-terminated string.
+ * @param   text_align_t align, TEXT_LEFT, TEXT_CENTER or TEXT_RIGHT.
+ * @return  None
+ *****************************************************************************/
+void draw_text_aligned(int16_t x, int16_t y, uint8_t width,
+                       const font_t *font, const char *str,
+                       text_align_t align) {
+  int16_t ink = text_width(font, str);
+  int16_t left = 0;
+
+  if (ink > 0) {
+    ink -= font->spacing;
+  }
+  if (ink < width) {
+    if (align == TEXT_RIGHT) {
+      left = width - ink;
+    } else if (align == TEXT_CENTER) {
+      left = (width - ink) / 2;
+    }
+  }
+
+  clear_area(x, y, left, font->height);
+  const int16_t end = draw_run(x + left, y, font, str, x + width);
+  clear_area(end, y, x + width - end, font->height);
+}
+
+/**************************************************************************//**
+ * @brief   Returns the width draw_text would use for a string.
+ * @details Only the glyph widths are read, no glyph data: a multiply for a
+ *          fixed-width font, one table entry per character otherwise.
+ * @version 1.1
+ * @param   const font_t *font, The font.
+ * @param   const char *str, Null-terminated string.
+ * @return  uint16_t, Columns, including the spacing after the last glyph.
+ *****************************************************************************/
+uint16_t text_width(const font_t *font, const char *str) {
+  uint16_t width = 0;
+  uint16_t count = 0;
+
+  for (; *str; str++) {
+    const uint8_t code = (uint8_t)*str;
+
+    if (code < font->first || code > font->last) {
+      continue;
+    }
+    if (font->glyphs) {
+      width += font->glyphs[code - font->first].width;
+    }
+    count++;
+  }
+  if (!font->glyphs) {
+    width = count * font->width;
+  }
+  return width + count * font->spacing;
+}
+
+/**************************************************************************//**
+ * @brief   Draws a bitmap.
+ * @version 1.0
+ * @param   int16_t x, Left column, may be partly off-screen.
+ * @param   int16_t y, Top row, any row, may be partly off-screen.
+ * @param   const bitmap_t *bitmap, The bitmap.
+ * @return  None
+ *****************************************************************************/
+void draw_bitmap(int16_t x, int16_t y, const bitmap_t *bitmap) {
+  draw_block(x, y, bitmap->width, bitmap->height, bitmap->encoding, bitmap->data);
+}
@@ -0,0 +1,124 @@
+/**************************************************************************//**
+ * @file     hil.c
+ * @brief    Hardware-in-the-loop input injection.
+ *
+ * @details  Entering HIL mode clears the rising and falling edge triggers of
+ *           the input EXTI lines, so the physical buttons and sensors no
+ *           longer raise interrupts. The interrupt mask is left alone, which
+ *           keeps the lines usable by the software interrupt register:
+ *           hil_inject stores the injected pin level and, when the change
+ *           is an edge the line was configured for, sets the line in EXTI
+ *           SWIER1. The EXTI interrupt then runs as if the pin had changed,
+ *           and the car sensor branches of HAL_GPIO_EXTI_Callback read the
+ *           injected level through hil_read_pin. The pedestrian switches
+ *           only trigger on the rising edge, so an injected press is only
+ *           seen once it is released, as on the board.
+ *
+ *           Leaving HIL mode restores the edge triggers and raises the car
+ *           sensor lines once more, so the car flags follow the real
+ *           sensors again.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hil.h"
+
+/* Variables ----------------------------------------------------------------*/
+static volatile bool enabled = 0;
+static volatile uint16_t levels = HIL_INPUT_PINS;  // All inputs are active low
+static uint32_t saved_rtsr, saved_ftsr;  // Edge triggers of each input line
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Enters or leaves HIL mode.
+ * @details The car lines are triggered on both changes, so the state machine
+ *          starts from released inputs in HIL mode and picks the real sensor
+ *          levels up again when leaving it.
+ * @version 1.0
+ * @param   bool enable, true to ignore the physical inputs.
+ * @return  None
+ *****************************************************************************/
+void hil_set_mode(bool enable) {
+  if (enable == enabled) {
+    return;
+  }
+
+  if (enable) {
+    levels = HIL_INPUT_PINS;
+    saved_rtsr = EXTI->RTSR1 & HIL_INPUT_PINS;
+    saved_ftsr = EXTI->FTSR1 & HIL_INPUT_PINS;
+    EXTI->RTSR1 &= ~HIL_INPUT_PINS;
+    EXTI->FTSR1 &= ~HIL_INPUT_PINS;
+    enabled = 1;
+    __HAL_GPIO_EXTI_GENERATE_SWIT(HIL_CAR_PINS);
+  } else {
+    enabled = 0;
+    EXTI->RTSR1 |= saved_rtsr;
+    EXTI->FTSR1 |= saved_ftsr;
+    __HAL_GPIO_EXTI_GENERATE_SWIT(HIL_CAR_PINS);  // Re-read the real sensors
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Checks whether HIL mode is active.
+ * @version 1.0
+ * @param   None
+ * @return  boolean, true in HIL mode.
+ *****************************************************************************/
+bool hil_enabled(void) {
+  return enabled;
+}
+
+/**************************************************************************//**
+ * @brief   Injects an input event.
+ * @details Raises the EXTI interrupt of the pin if the level change is an
+ *          edge its line triggers on outside HIL mode, the event is handled
+ *          once this function has returned and the EXTI priority allows it.
+ * @version 1.0
+ * @param   uint16_t pin, One of HIL_INPUT_PINS.
+ * @param   GPIO_PinState level, The new pin level (the inputs are active
+ *          low, GPIO_PIN_RESET means pressed / car present).
+ * @return  boolean, false if HIL mode is off or the pin is not an input.
+ *****************************************************************************/
+bool hil_inject(uint16_t pin, GPIO_PinState level) {
+  if (!enabled || (pin & HIL_INPUT_PINS) != pin || (pin & (pin - 1)) != 0 || pin == 0) {
+    return false;
+  }
+
+  uint16_t old = levels;
+  if (level == GPIO_PIN_RESET) {
+    levels &= ~pin;
+  } else {
+    levels |= pin;
+  }
+
+  uint16_t rising = levels & ~old, falling = old & ~levels;
+  if ((rising & saved_rtsr) || (falling & saved_ftsr)) {
+    __HAL_GPIO_EXTI_GENERATE_SWIT(pin);
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Reads an input pin, or its injected level in HIL mode.
+ * @version 1.0
+ * @param   GPIO_TypeDef *port, The GPIO port of the pin.
+ * @param   uint16_t pin, The pin.
+ * @return  GPIO_PinState, The pin level.
+ *****************************************************************************/
+GPIO_PinState hil_read_pin(GPIO_TypeDef *port, uint16_t pin) {
+  if (enabled && (pin & HIL_INPUT_PINS)) {
+    return (levels & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+  }
+  return HAL_GPIO_ReadPin(port, pin);
+}
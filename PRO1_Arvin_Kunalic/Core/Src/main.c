@@ -18,6 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "spi.h"
 #include "tim.h"
 #include "usart.h"
@@ -35,6 +36,14 @@
 #include "fonts.h"
 #include <stm32l476xx.h>
 #include "clock.h"
+#include "telemetry.h"
+#include "uart_stdio.h"
+#include "cmd_protocol.h"
+#include "profile.h"
+#include "benchmark.h"
+#include "mem_monitor.h"
+#include "crash_dump.h"
+#include "boot.h"
 
 #define RUN_TEST_PROGRAM
 #undef RUN_TEST_PROGRAM
@@ -42,22 +51,33 @@
 
 int main(void)
 {
+  boot_latch();
+  mem_monitor_init();
+  crash_dump_init();
 
   HAL_Init();
   SystemClock_Config();
+  boot_stamp(BOOT_CLOCK);
+  profile_init();
 
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
+  telemetry_init();
+  uart_stdio_init();
+  crash_dump_report();
  
-  MX_SPI3_Init();
   MX_SPI2_Init();
   MX_TIM3_Init();
   MX_TIM4_Init();
   MX_TIM5_Init();
   MX_TIM15_Init();
+  cmd_protocol_init();
 
 #ifdef RUN_TEST_PROGRAM
   Test_Program();
+#elif BENCHMARK_ENABLED
+  Benchmark();
 #else
   Traffic();
 #endif
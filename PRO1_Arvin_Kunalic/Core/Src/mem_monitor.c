@@ -0,0 +1,202 @@
+/**************************************************************************//**
+ * @file     mem_monitor.c
+ * @brief    Stack painting and stack/heap high-water marks.
+ *
+ * @details  The RAM layout of the linker script (STM32L476RGTX_FLASH.ld):
+ *
+ *             SRAM1: .data | .bss | .noinit | heap -> ... <- MSP stack
+ *                    ^ 0x20000000          ^ _end              ^ _estack
+ *             SRAM2: .ramfunc | .ram2_bss (OLED_framebuffer, ...)
+ *                    ^ 0x10000000
+ *
+ *           A stack that outgrows the free space runs into the heap, then
+ *           into the crash dump in .noinit and into .bss with the
+ *           controller state. The framebuffer and the RAM functions are in
+ *           SRAM2, out of its reach. The monitor reports how close the
+ *           stack came, so the reserves can be sized from measurements and
+ *           an overflow is seen (MEM_FLAG_GUARD) before .bss is overwritten.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      mem_monitor.h, sysmem.c
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mem_monitor.h"
+#include "telemetry.h"
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Fills a stack area with MEM_PAINT_PATTERN.
+ * @details Must not be used on the running stack, the painted area would
+ *          include the frame of this function.
+ * @version 1.0
+ * @param   uint32_t *start, Lowest word of the stack area.
+ * @param   uint32_t *end, One past the highest word.
+ * @return  None
+ *****************************************************************************/
+void mem_paint(uint32_t *start, uint32_t *end) {
+  while (start < end) {
+    *start++ = MEM_PAINT_PATTERN;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the never used part of a painted, downward growing stack.
+ * @version 1.0
+ * @param   const uint32_t *start, Lowest word of the stack area.
+ * @param   const uint32_t *end, One past the highest word.
+ * @return  size_t, Bytes from 'start' up to the first overwritten word.
+ *****************************************************************************/
+size_t mem_unused(const uint32_t *start, const uint32_t *end) {
+  const uint32_t *word = start;
+
+  while (word < end && *word == MEM_PAINT_PATTERN) {
+    word++;
+  }
+  return (size_t)(word - start) * sizeof(uint32_t);
+}
+
+#if MEM_MONITOR_ENABLED
+
+/* Defines ------------------------------------------------------------------*/
+/* Bytes below the stack pointer of mem_monitor_init left unpainted */
+#define PAINT_MARGIN        32
+
+/* Variables ----------------------------------------------------------------*/
+extern uint8_t _end;                /* Symbols defined in the linker script */
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+extern uint32_t _Min_Heap_Size;
+
+static uint32_t *painted_end;       // One past the highest painted word
+static mem_usage_t usage;           // Result of the last scan
+static bool scanned = 0;
+static bool pending = 0;            // Change not sent yet (ring was full)
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Returns the first word above the heap.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t *, Word aligned heap end.
+ *****************************************************************************/
+static uint32_t *heap_end(void) {
+  const uintptr_t end = (uintptr_t)&_end + sysmem_heap_used();
+
+  return (uint32_t *)((end + 3) & ~(uintptr_t)3);
+}
+
+/**************************************************************************//**
+ * @brief   Paints the free RAM between the heap and the main stack.
+ * @details Has to be the first call in main after boot_latch, the stack
+ *          used before it (the start-up code and main itself) is above the
+ *          painted area and counted as used. The few words boot_latch used
+ *          below it are painted over. The loop is written out here, a call
+ *          to mem_paint would paint over its own stack frame.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void mem_monitor_init(void) {
+  uint32_t *word = heap_end();
+
+  painted_end = (uint32_t *)((__get_MSP() - PAINT_MARGIN) & ~(uint32_t)3);
+  while (word < painted_end) {
+    *word++ = MEM_PAINT_PATTERN;
+  }
+
+  memset(&usage, 0, sizeof(usage));
+  scanned = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Measures the stack and heap use.
+ * @details Reads every free word once, about 1ms for the whole free RAM.
+ * @version 1.0
+ * @param   mem_usage_t *result, Receives the result.
+ * @return  None
+ *****************************************************************************/
+static void scan(mem_usage_t *result) {
+  const uint32_t *low = heap_end();
+  const uint32_t unused = (low < painted_end) ? mem_unused(low, painted_end) : 0;
+
+  result->tick = HAL_GetTick();
+  result->stack_reserve = (uint32_t)(uintptr_t)&_Min_Stack_Size;
+  result->heap_reserve = (uint32_t)(uintptr_t)&_Min_Heap_Size;
+  result->heap_used = sysmem_heap_used();
+  result->free = unused;
+  result->stack_peak = (uint32_t)((uintptr_t)&_estack - (uintptr_t)low) - unused;
+  result->sbrk_failures = sysmem_sbrk_failures();
+
+  result->flags = 0;
+  if (result->stack_peak > result->stack_reserve) {
+    result->flags |= MEM_FLAG_STACK_RESERVE;
+  }
+  if (result->heap_used > result->heap_reserve) {
+    result->flags |= MEM_FLAG_HEAP_RESERVE;
+  }
+  if (unused < MEM_GUARD_SIZE) {
+    result->flags |= MEM_FLAG_GUARD;
+  }
+  if (result->sbrk_failures) {
+    result->flags |= MEM_FLAG_SBRK_FAILED;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Rescans the memory use and reports changes.
+ * @details Called from the main loop. A TELEMETRY_MEMORY record is sent
+ *          after the first scan and whenever a high-water mark grew or the
+ *          flags changed.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void mem_monitor_service(void) {
+  mem_usage_t now;
+
+  if (scanned && HAL_GetTick() - usage.tick < MEM_MONITOR_PERIOD_MS) {
+    return;
+  }
+
+  scan(&now);
+  if (!scanned
+      || now.stack_peak != usage.stack_peak
+      || now.heap_used != usage.heap_used
+      || now.flags != usage.flags) {
+    pending = 1;
+  }
+  scanned = 1;
+
+  /* CMD_MEMORY copies 'usage' in the USART2 interrupt */
+  __disable_irq();
+  usage = now;
+  __enable_irq();
+
+  if (pending) {
+    pending = !telemetry_write(TELEMETRY_MEMORY, &now, sizeof(now));
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the result of the last scan.
+ * @version 1.0
+ * @param   mem_usage_t *result, Receives the memory use.
+ * @return  None
+ *****************************************************************************/
+void mem_monitor_usage(mem_usage_t *result) {
+  *result = usage;
+}
+
+#endif
@@ -0,0 +1,195 @@
+/**************************************************************************//**
+ * @file     profile.c
+ * @brief    DWT cycle counter profiling.
+ *
+ * @details  Enables the DWT cycle counter and keeps the statistics of the
+ *           probes placed with PROFILE_BEGIN/PROFILE_END. The cycle counter
+ *           runs at the core clock (80MHz, 12.5ns per cycle) and wraps
+ *           after about 53s, which is far longer than any measured section.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      profile.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "profile.h"
+#include "fmt.h"
+#include "ssd1306_config.h"
+#include "status_page.h"
+
+#if PROFILE_ENABLED
+
+/* Defines ------------------------------------------------------------------*/
+/* Characters per OLED text line (6 pixels each) */
+#define OLED_COLUMNS        21
+#define NAME_COLUMNS        4
+#define MEAN_COLUMNS        7
+#define MAX_COLUMNS         8
+
+/* Variables ----------------------------------------------------------------*/
+profile_stats_t profile_stats[PROFILE_COUNT];
+uint32_t profile_overhead = 0;
+
+/* Set by profile_request_show, the table is drawn by profile_service */
+static volatile bool show_requested;
+
+static const char *const probe_names[PROFILE_COUNT] = {
+  [PROFILE_EXTI]         = "EXTI",
+  [PROFILE_TIM3]         = "TIM3",
+  [PROFILE_TIM5]         = "TIM5",
+  [PROFILE_TRAFFIC_STEP] = "STEP",
+  [PROFILE_STATUS_PAGE]  = "PAGE",
+};
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Clears the statistics of a probe.
+ * @details Has to be called with interrupts disabled, or before the probe
+ *          is in use.
+ * @version 1.0
+ * @param   profile_stats_t *stats, The statistics to clear.
+ * @return  None
+ *****************************************************************************/
+static void clear_stats(profile_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->min = UINT32_MAX;
+}
+
+/**************************************************************************//**
+ * @brief   Starts the DWT cycle counter and measures the probe overhead.
+ * @details The overhead is the smallest count of an empty section, it is
+ *          subtracted from every measurement. The counter is not cleared,
+ *          it runs since the reset vector for the boot times (boot.h).
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void profile_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  profile_overhead = UINT32_MAX;
+  for (uint8_t i = 0; i < 8; i++) {
+    const uint32_t start = DWT->CYCCNT;
+    const uint32_t cycles = DWT->CYCCNT - start;
+    if (cycles < profile_overhead) {
+      profile_overhead = cycles;
+    }
+  }
+
+  for (uint8_t probe = 0; probe < PROFILE_COUNT; probe++) {
+    clear_stats(&profile_stats[probe]);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Copies the statistics of a probe.
+ * @details Interrupts are disabled while copying, so the copy is consistent
+ *          even if the probe is recorded by an ISR.
+ * @version 1.0
+ * @param   profile_probe_t probe, The probe.
+ * @param   profile_stats_t *stats, Receives the statistics.
+ * @return  None
+ *****************************************************************************/
+void profile_snapshot(profile_probe_t probe, profile_stats_t *stats) {
+  const uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  *stats = profile_stats[probe];
+  __set_PRIMASK(primask);
+}
+
+/**************************************************************************//**
+ * @brief   Starts the statistics of a probe over.
+ * @version 1.0
+ * @param   profile_probe_t probe, The probe.
+ * @return  None
+ *****************************************************************************/
+void profile_reset(profile_probe_t probe) {
+  const uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  clear_stats(&profile_stats[probe]);
+  __set_PRIMASK(primask);
+}
+
+/**************************************************************************//**
+ * @brief   Shows the mean and maximum cycles of every probe on the OLED.
+ * @details Replaces the whole screen. The status page comes back after
+ *          STATUS_PAGE_HOLD_MS; without it the state machine draws its
+ *          messages over the table again as they change. The numbers are
+ *          written with fmt_u32 and capped to their columns, so every line
+ *          is exactly OLED_COLUMNS characters.
+ * @version 1.2
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void profile_show(void) {
+  static const char header[OLED_COLUMNS + 1] = "CYCLES  mean      max";
+  char text[(PROFILE_COUNT + 1) * OLED_COLUMNS + 1];
+  char *pos = text;
+
+  /* Full lines, draw_string wraps after OLED_COLUMNS characters */
+  memcpy(pos, header, OLED_COLUMNS);
+  pos += OLED_COLUMNS;
+  for (uint8_t probe = 0; probe < PROFILE_COUNT; probe++) {
+    const uint32_t name = strlen(probe_names[probe]);
+    profile_stats_t stats;
+    uint32_t mean;
+
+    profile_snapshot(probe, &stats);
+    mean = stats.count ? (uint32_t)(stats.total / stats.count) : 0;
+
+    memcpy(pos, probe_names[probe], name);
+    memset(pos + name, ' ', NAME_COLUMNS + 1 - name);
+    pos += NAME_COLUMNS + 1;
+    pos += fmt_u32(pos, (mean > 9999999u) ? 9999999u : mean, MEAN_COLUMNS, ' ');
+    *pos++ = ' ';
+    pos += fmt_u32(pos, (stats.max > 99999999u) ? 99999999u : stats.max, MAX_COLUMNS, ' ');
+  }
+
+  clear_screen();
+  draw_string(0, 0, text);
+  status_page_hold();
+}
+
+/**************************************************************************//**
+ * @brief   Requests the table of profile_show.
+ * @details Safe to call from an ISR (CMD_PROFILE), the table is drawn by
+ *          profile_service in the main loop. Drawing it in the ISR would
+ *          race with a refresh of the status page.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ * @see     profile_service
+ *****************************************************************************/
+void profile_request_show(void) {
+  show_requested = true;
+}
+
+/**************************************************************************//**
+ * @brief   Draws a requested table.
+ * @details Called from the main loop, by status_page_service.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ * @see     profile_request_show
+ *****************************************************************************/
+void profile_service(void) {
+  if (show_requested) {
+    show_requested = false;
+    profile_show();
+  }
+}
+
+#endif
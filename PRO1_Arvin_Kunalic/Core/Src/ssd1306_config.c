@@ -14,6 +14,12 @@
  *           - Screen clearing and scrolling utilities.
  *           - Hardware reset handling.
  *
+ *           The drawing functions only change the framebuffer and mark the
+ *           pages they touched. display_service, called from the main loop,
+ *           brings the display up after display_start and sends the marked
+ *           pages, one per call. Nothing here waits with HAL_Delay, so the
+ *           display neither holds up the start nor an interrupt that draws.
+ *
  ******************************************************************************
  * @author   Arvin Kunalic
  * @version  1.0
@@ -34,26 +40,75 @@
 #include "gpio.h"
 #include "ssd1306_config.h"
 #include "fonts.h"
+#include "fast_io.h"
+#include "gpio_pins.h"
+#include "ramfunc.h"
 #include <string.h>
 
+/* Defines ------------------------------------------------------------------*/
+/* Reset pulse in ticks, at least 1ms (the SSD1306 needs 3us) */
+#define OLED_RESET_MS   2
+
+#define OLED_PAGES      (OLED_HEIGHT / 8)
+#define ALL_PAGES       ((1u << OLED_PAGES) - 1)
+
 /* Variables ----------------------------------------------------------------*/
-uint8_t OLED_framebuffer[OLED_BUFFER_SIZE] = {0};
+/* In SRAM2, cleared by the start-up code (see ramfunc.h). Word-aligned for
+ * the 32-bit spans of gfx.c */
+RAM2_BSS __attribute__((aligned(4))) uint8_t OLED_framebuffer[OLED_BUFFER_SIZE];
+
+typedef enum {
+    DISPLAY_OFF,
+    DISPLAY_RESET,  // Reset pin low since 'reset_start'
+    DISPLAY_READY,
+} display_state_t;
+
+/* Display state, one block */
+static struct {
+    uint32_t reset_start;
+    uint32_t frames;        // Times all marked pages were sent
+    uint8_t dirty_pages;    // Bit per page changed since it was last sent
+    uint8_t state;          // display_state_t
+} display = {
+    .state = DISPLAY_OFF,
+};
+
+/* Information provided by the datasheet */
+static const uint8_t init_sequence[] = {
+    0xAE,       // Display off
+    0xD5, 0x80, // Set clock divide ratio and oscillator frequency
+    0xA8, 0x3F, // Set multiplex ratio (1/64)
+    0xD3, 0x00, // Set display offset
+    0x40,       // Set start line address
+    0x8D, 0x14, // Enable charge pump
+    0x20, 0x00, // Set memory addressing mode (horizontal)
+    0xA1,       // Set segment re-map (A1 for horizontal flip)
+    0xC8,       // Set COM output scan direction (C0: Normal C8: for vertical flip)
+    0xDA, 0x12, // Set COM pins hardware configuration
+    0x81, 0x7F, // Set contrast control
+    0xD9, 0xF1, // Set pre-charge period
+    0xDB, 0x40, // Set VCOMH deselect level
+    0xA4,       // Entire display ON (resume to RAM content)
+    0xA6,       // Normal display mode (A7 for inverse)
+    0xAF        // Display ON
+};
 
 /**************************************************************************//**
- * @brief   Resets the SSD1306 OLED display.
- *
- * @details This function resets the SSD1306 by pulling the RESET pin low for
- *          20ms, veriying the display is in a known state before configuration.
- *          Resetting the display clears any previous settings or RAM contents.
- *
+ * @brief   Sends bytes to the display in one chip select cycle.
+ * @details The D/C pin selects the command or the data register, the SSD1306
+ *          takes any number of bytes while CS is low. Both pins are on port
+ *          C and change in one BSRR store, SPI2 is driven through fast_io.h.
+ *          Runs from SRAM2 (RAMFUNC), the byte loop is inlined.
  * @version 1.0
- * @param   None
+ * @param   const uint8_t *bytes, The bytes to send.
+ * @param   uint16_t len, Number of bytes.
+ * @param   bool data, true for display data, false for commands.
  * @return  None
  *****************************************************************************/
-void reset_OLED(void) {
-    HAL_GPIO_WritePin(Disp_Reset_GPIO_Port, Disp_Reset_Pin, GPIO_PIN_RESET); // Reset OLED
-    HAL_Delay(20);
-    HAL_GPIO_WritePin(Disp_Reset_GPIO_Port, Disp_Reset_Pin, GPIO_PIN_SET); // Release reset
+static RAMFUNC void write_OLED(const uint8_t *bytes, uint16_t len, bool data) {
+    PIN_WRITE2(Disp_CS, 0, Disp_Data_Instr, data); // Select OLED, data or command mode
+    fast_spi_send(&hspi2, bytes, len);
+    PIN_SET(Disp_CS);                              // Deselect OLED
 }
 
 /**************************************************************************//**
@@ -70,10 +125,7 @@ void reset_OLED(void) {
  * @see     send_data_OLED
  *****************************************************************************/
 void send_command_OLED(uint8_t command) {
-    HAL_GPIO_WritePin(Disp_CS_GPIO_Port, Disp_CS_Pin, GPIO_PIN_RESET);                 // Select OLED
-    HAL_GPIO_WritePin(Disp_Data_Instr_GPIO_Port, Disp_Data_Instr_Pin, GPIO_PIN_RESET); // Command mode
-    HAL_SPI_Transmit(&hspi2, &command, 1, HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(Disp_CS_GPIO_Port, Disp_CS_Pin, GPIO_PIN_SET); // Deselect OLED
+    write_OLED(&command, 1, false);
 }
 
 /**************************************************************************//**
@@ -85,49 +137,141 @@ void send_command_OLED(uint8_t command) {
  * @return  Return type, description of what the function returns default None
  *****************************************************************************/
 void send_data_OLED(uint8_t data) {
-    HAL_GPIO_WritePin(Disp_CS_GPIO_Port, Disp_CS_Pin, GPIO_PIN_RESET);               // Select OLED
-    HAL_GPIO_WritePin(Disp_Data_Instr_GPIO_Port, Disp_Data_Instr_Pin, GPIO_PIN_SET); // Data mode
-    HAL_SPI_Transmit(&hspi2, &data, 1, HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(Disp_CS_GPIO_Port, Disp_CS_Pin, GPIO_PIN_SET); // Deselect OLED
+    write_OLED(&data, 1, true);
 }
 
 /**************************************************************************//**
- * @brief   Initializes the SSD1306 OLED display.
+ * @brief   Initializes the SSD1306 OLED display and waits until it is ready.
  *
- * @details This function configures the SSD1306 display by sending a sequence
- *          of initialization commands. The initialization sequence is based on
- *          the SSD1306 datasheet and sets the display properties.
+ * @details Blocking version of display_start and display_service, for
+ *          programs without a main loop of their own (benchmark suite).
+ *          Needs the SysTick.
  *
- * @version 1.0
+ * @version 1.1
  * @param   None
  * @return  None
  *****************************************************************************/
 void init_OLED(void) {
-    reset_OLED();
-
-    /* Information provided by the datasheet */
-    uint8_t init_sequence[] = {
-        0xAE,       // Display off
-        0xD5, 0x80, // Set clock divide ratio and oscillator frequency
-        0xA8, 0x3F, // Set multiplex ratio (1/64)
-        0xD3, 0x00, // Set display offset
-        0x40,       // Set start line address
-        0x8D, 0x14, // Enable charge pump
-        0x20, 0x00, // Set memory addressing mode (horizontal)
-        0xA1,       // Set segment re-map (A1 for horizontal flip)
-        0xC8,       // Set COM output scan direction (C0: Normal C8: for vertical flip)
-        0xDA, 0x12, // Set COM pins hardware configuration
-        0x81, 0x7F, // Set contrast control
-        0xD9, 0xF1, // Set pre-charge period
-        0xDB, 0x40, // Set VCOMH deselect level
-        0xA4,       // Entire display ON (resume to RAM content)
-        0xA6,       // Normal display mode (A7 for inverse)
-        0xAF        // Display ON
+    display_start();
+    while (!display_ready()) {
+        display_service();
+    }
+}
+
+/**************************************************************************//**
+ * @brief   Starts bringing up the display, without waiting.
+ * @details Pulls the reset pin low and marks every page, display_service
+ *          does the rest. Drawing can start right away.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void display_start(void) {
+    PIN_RESET(Disp_Reset);
+    display.reset_start = HAL_GetTick();
+    display.state = DISPLAY_RESET;
+    __atomic_fetch_or(&display.dirty_pages, ALL_PAGES, __ATOMIC_RELAXED);
+}
+
+/**************************************************************************//**
+ * @brief   Sends one page of the framebuffer.
+ * @version 1.0
+ * @param   uint8_t page, The page (0-7), 8 rows of pixels.
+ * @return  None
+ *****************************************************************************/
+static void send_page(uint8_t page) {
+    const uint8_t address[] = {
+        0xB0 + page, // Set page start adress
+        0x00,        // Set lower column start adress
+        0x10,        // Set higher column start adress
     };
+    write_OLED(address, sizeof(address), false);
+
+    /* Write 128 bytes from current page in one transfer */
+    write_OLED(&OLED_framebuffer[page * OLED_WIDTH], OLED_WIDTH, true);
+}
 
-    for (uint8_t i = 0; i < sizeof(init_sequence); i++) {
-        send_command_OLED(init_sequence[i]);
+/**************************************************************************//**
+ * @brief   Marks the pages of a range of rows, for display_service.
+ * @details For drawing functions outside this file (glyph.c).
+ * @version 1.0
+ * @param   int16_t y, First row, may be off-screen.
+ * @param   int16_t height, Number of rows.
+ * @return  None
+ *****************************************************************************/
+void display_mark_rows(int16_t y, int16_t height) {
+    const int16_t first = (y < 0) ? 0 : y;
+    const int16_t last = (y + height > OLED_HEIGHT) ? OLED_HEIGHT - 1 : y + height - 1;
+
+    if (height <= 0 || first > last) {
+        return;
     }
+    const uint8_t pages = ((1u << (last / 8 + 1)) - 1) & ~((1u << (first / 8)) - 1);
+    __atomic_fetch_or(&display.dirty_pages, pages, __ATOMIC_RELAXED);
+}
+
+/**************************************************************************//**
+ * @brief   Brings up the display and sends the changed pages.
+ * @details Called from the main loop, never waits. After display_start the
+ *          reset pin is released once OLED_RESET_MS passed and the init
+ *          sequence is sent in one transfer. From then on each call sends
+ *          the lowest marked page. The mark is taken before the page is
+ *          sent, a page drawn again meanwhile (e.g. by an interrupt) is
+ *          sent once more.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void display_service(void) {
+    switch (display.state) {
+        case DISPLAY_RESET:
+            if (HAL_GetTick() - display.reset_start < OLED_RESET_MS) {
+                break;
+            }
+            PIN_SET(Disp_Reset); // Release reset
+            write_OLED(init_sequence, sizeof(init_sequence), false);
+            display.state = DISPLAY_READY;
+            break;
+
+        case DISPLAY_READY: {
+            const uint8_t dirty = __atomic_load_n(&display.dirty_pages, __ATOMIC_RELAXED);
+            if (!dirty) {
+                break;
+            }
+            const uint8_t page = __builtin_ctz(dirty);
+            __atomic_fetch_and(&display.dirty_pages, ~(1u << page), __ATOMIC_RELAXED);
+            send_page(page);
+            if (!__atomic_load_n(&display.dirty_pages, __ATOMIC_RELAXED)) {
+                display.frames++;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/**************************************************************************//**
+ * @brief   Checks if the display was brought up.
+ * @version 1.0
+ * @param   None
+ * @return  boolean, true once the init sequence was sent.
+ *****************************************************************************/
+bool display_ready(void) {
+    return display.state == DISPLAY_READY;
+}
+
+/**************************************************************************//**
+ * @brief   Returns how often the display caught up with the framebuffer.
+ * @details Counts the display_service calls that sent the last marked page,
+ *          and the update_screen calls. The first one completes the boot.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, Number of complete frames.
+ *****************************************************************************/
+uint32_t display_frames(void) {
+    return display.frames;
 }
 
 /**************************************************************************//**
@@ -144,39 +288,34 @@ void init_OLED(void) {
  *             3. 128 bytes of pixel data are written from the frambuffer to the OLED
  *
  *           Each byte in the framebuffer represents 8 vertical pixels in a column.
+ *           Sends every page right away and clears the page marks, the
+ *           display has to be ready.
  *
- * @version  1.0
+ * @version  1.1
  * @param    None
  * @return   None
  * @see      send_command_OLED, send_data_OLED
  *****************************************************************************/
 void update_screen(void) {
-    for (uint8_t page = 0; page < 8; page++) {
-        /* Set page start adress */
-        send_command_OLED(0xB0 + page);
-        /* Set column adresses, start at column 0 */
-        send_command_OLED(0x00); // Set lower column start adress
-        send_command_OLED(0x10); // Set higher column start adress
-
-        /* Write 128 bytes from current page*/
-        for (uint8_t col = 0; col < 128; col++) {
-            send_data_OLED(OLED_framebuffer[page * OLED_WIDTH + col]);
-        }
+    __atomic_fetch_and(&display.dirty_pages, ~ALL_PAGES, __ATOMIC_RELAXED);
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        send_page(page);
     }
+    display.frames++;
 }
 
 /**************************************************************************//**
  * @brief    Clears the display.
  * @details  This function sets all pixels of the OLED framebuffer to 0
- *           and sends that to the display, turning off every pixel.
- * @version  1.0
+ *           and marks every page, display_service turns off every pixel.
+ * @version  1.1
  * @param    None
  * @return   None
  *****************************************************************************/
 void clear_screen(void) {
     /* Set all bytes in the framebuffer to 0*/
     memset(OLED_framebuffer, 0x00, sizeof(OLED_framebuffer));
-    update_screen(); // Send to display
+    __atomic_fetch_or(&display.dirty_pages, ALL_PAGES, __ATOMIC_RELAXED);
 }
 
 /**************************************************************************//**
@@ -186,19 +325,20 @@ void clear_screen(void) {
  *          at the specified (x, y) position. The character is represented
  *          using a 5x7 font bitmap 'Font5x7'. Each column of the character is
  *          written into the corresponding position in the framebuffer.
+ *          Runs from SRAM2 (RAMFUNC).
  *
- * @version 1.0
+ * @version 1.1
  * @param   uint8_t x, The horizontal starting position (0-127).
  * @param   uint8_t y, The vertical starting position (0-63).
  * @param   char c,    The character to render.
  * @return  None
  *
- * @note    The function only updates the framebuffer and not the display.
- *          To show the changes onscreen, call 'update_screen' after this function.
+ * @note    The function only updates the framebuffer and marks the page,
+ *          display_service sends it.
  *
  * @see     draw_string
  *****************************************************************************/
-void draw_char(uint8_t x, uint8_t y, char c) {
+RAMFUNC void draw_char(uint8_t x, uint8_t y, char c) {
     /* Is the character a valid ASCII character? */
     if (c < 32 || c > 126)
         return;
@@ -208,6 +348,7 @@ void draw_char(uint8_t x, uint8_t y, char c) {
     for (uint8_t i = 0; i < 5; i++) {  // Each column of the character
         OLED_framebuffer[x + (y / 8) * 128 + i] = char_bitmap[i]; // Calculate framebuffer index
     }
+    __atomic_fetch_or(&display.dirty_pages, 1u << (y / 8), __ATOMIC_RELAXED);
 }
 
 /**************************************************************************//**
@@ -216,9 +357,10 @@ void draw_char(uint8_t x, uint8_t y, char c) {
   * @details This function writes a string to the OLED framebuffer at the
   *          specified (x, y) coordinates. Each character is rendered using
   *          a 5x7 font stored in the `Font5x7` array. Characters are
-  *          spaced by 1 pixel horizontally.
+  *          spaced by 1 pixel horizontally. Like draw_char it only changes
+  *          the framebuffer, display_service sends it.
 
-  * @version 1.0
+  * @version 1.1
   * @param   uint8_t x, The horizontal starting position (0-127).
   * @param   uint8_t y, The vertical starting position (0-63).
   * @param   char *str, Pointer to the null-terminated string to render.
@@ -235,5 +377,4 @@ void draw_string(uint8_t x, uint8_t y, const char *str) {
         }
         str++;
     }
-    update_screen();
 }
\ No newline at end of file
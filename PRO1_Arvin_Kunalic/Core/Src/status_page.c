@@ -0,0 +1,388 @@
+/**************************************************************************//**
+ * @file     status_page.c
+ * @brief    Graphical status page of the OLED.
+ *
+ * @details  The page is a static background (the junction bitmap) and a
+ *           fixed set of elements on it: six signal heads, four car icons,
+ *           two pedestrian icons, the state name, the countdown, its
+ *           label and a bar with the part of the phase that has passed.
+ *           For every element the value it was last drawn with is kept in
+ *           'page'; a refresh redraws an element only when its value
+ *           changed, and only its own box. After another screen
+ *           (status_page_hold) the whole page is drawn again.
+ *
+ *           The countdown is the part of the current phase that is timed,
+ *           read from the timer the state machine compares against:
+ *           TIM5 while pedestrians walk, TIM15 in Wait20s/Wait30s and TIM4
+ *           while an intersection changes. A green intersection waiting
+ *           for cars or buttons has no time limit and shows "--".
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      status_page.h, Assets/assets.txt (junction, font_signal)
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "tim.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "status_page.h"
+#include "ssd1306_config.h"
+#include "glyph.h"
+#include "gfx.h"
+#include "fmt.h"
+#include "assets.h"
+#include "595_shiftreg.h"
+#include "ctrl_state.h"
+#include "timer_config.h"
+#include "profile.h"
+
+#if STATUS_PAGE_ENABLED
+
+/* Defines ------------------------------------------------------------------*/
+#define PANEL_X         66                          // Right of the divider
+#define PANEL_WIDTH     (OLED_WIDTH - PANEL_X)
+#define NAME_Y          0
+#define COUNTDOWN_Y     14
+#define LABEL_Y         42
+#define BAR_X           (PANEL_X + 4)
+#define BAR_Y           54
+#define BAR_WIDTH       (PANEL_WIDTH - 8)
+#define BAR_HEIGHT      8
+#define BAR_STEPS       (BAR_WIDTH - 4)             // One per column of the fill
+
+#define TIMER_HZ        (80000000 / TIMER_PRESCALER) // Ticks per second at 80 MHz, speed-up 1
+#define NOT_DRAWN       0xFF
+#define SECONDS_NOT_DRAWN INT8_MIN
+#define NO_COUNTDOWN    -1
+
+#define HEADS           6
+#define CARS            4
+#define WALKERS         2
+
+/* Types --------------------------------------------------------------------*/
+typedef struct {
+  uint8_t x;
+  uint8_t y;
+  uint8_t shift;                // Of its three lamps in the lamp word
+  char base;                    // font_signal: '0' car head, '8' pedestrian
+} head_t;
+
+typedef struct {
+  uint8_t x;
+  uint8_t y;
+  ctrl_flag_t flag;
+} icon_t;
+
+/* The states of traffic.c, in its order */
+enum {
+  STATE_INTERSECTION1,
+  STATE_INTERSECTION2,
+  STATE_WAIT20S,
+  STATE_WAIT30S,
+};
+
+/* Variables ----------------------------------------------------------------*/
+
+/* Signal heads: TL1-TL4, then PL1 and PL2 */
+static const head_t heads[HEADS] = {
+  {17,  2, 16, '0'},
+  {17, 44,  8, '0'},
+  {44, 44,  0, '0'},
+  {59,  2,  3, '0'},
+  {43,  2, 19, '8'},
+  { 2,  2, 11, '8'},
+};
+
+/* A car on each approach, in its lane */
+static const icon_t cars[CARS] = {
+  {24,  4, FLAG_CAR1_ACTIVE},
+  { 0, 28, FLAG_CAR2_ACTIVE},
+  {24, 52, FLAG_CAR3_ACTIVE},
+  {46, 28, FLAG_CAR4_ACTIVE},
+};
+
+/* A pedestrian next to each pedestrian head */
+static const icon_t walkers[WALKERS] = {
+  {50,  2, FLAG_PL1_SW_HIT},
+  { 8,  2, FLAG_PL2_SW_HIT},
+};
+
+static const char *const state_names[] = {
+  [STATE_INTERSECTION1] = "Road 1",
+  [STATE_INTERSECTION2] = "Road 2",
+  [STATE_WAIT20S]       = "Wait 20s",
+  [STATE_WAIT30S]       = "Wait 30s",
+};
+
+/* What was drawn last, NOT_DRAWN forces the element to be drawn */
+static struct {
+  uint32_t last_refresh;
+  uint32_t hold_start;
+  bool holding;
+  bool drawn;                   // Background
+  char heads[HEADS];
+  uint8_t cars;
+  uint8_t walkers;
+  uint8_t state;
+  int8_t seconds;
+  const char *label;
+  uint8_t bar;                  // Filled columns
+} page = {.drawn = false};
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Tells if a timer is counting.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer.
+ * @return  boolean, true if it is enabled.
+ *****************************************************************************/
+static bool timer_running(TIM_HandleTypeDef *htim) {
+  return (htim->Instance->CR1 & TIM_CR1_CEN) != 0u;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the ticks left until a timer reaches a limit.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer.
+ * @param   uint32_t limit, The count the state machine waits for.
+ * @return  int32_t, Ticks left, 0 if already reached.
+ *****************************************************************************/
+static int32_t ticks_left(TIM_HandleTypeDef *htim, uint32_t limit) {
+  const uint32_t count = __HAL_TIM_GetCounter(htim);
+
+  return (count < limit) ? (int32_t)(limit - count) : 0;
+}
+
+/**************************************************************************//**
+ * @brief   Finds the timed part of the current phase.
+ * @details Mirrors the comparisons of Traffic_step, go_intersection,
+ *          stop_intersection and the TIM5 interrupt.
+ * @version 1.1
+ * @param   const char **label, Set to what happens when the time is up.
+ * @param   uint32_t *limit, Set to the ticks of the whole timed part.
+ * @return  int32_t, Timer ticks left, NO_COUNTDOWN if nothing is timed.
+ *****************************************************************************/
+static int32_t phase_ticks(const char **label, uint32_t *limit) {
+  const uint8_t state = ctrl_state.state;
+
+  if (timer_running(&htim5)) {
+    *label = "walk ends";
+    *limit = walk_Time;
+    return ticks_left(&htim5, *limit);
+  }
+
+  if (state == STATE_WAIT20S || state == STATE_WAIT30S) {
+    *label = "to switch";
+    *limit = (state == STATE_WAIT20S) ? red_delay_Max : green_Delay;
+    return ticks_left(&htim15, *limit);
+  }
+
+  if (state <= STATE_INTERSECTION2 && ctrl_state.stage[state] < 2 && timer_running(&htim4)) {
+    const ctrl_flag_t other_red = (state == STATE_INTERSECTION1)
+                                  ? FLAG_INTERSECTION2_RED : FLAG_INTERSECTION1_RED;
+
+    if (flag_get(FLAG_GO_YELLOW)) {
+      *label = "to green";
+      *limit = orange_Delay;
+    } else if (flag_get(FLAG_STOP_YELLOW)) {
+      *label = "to red";
+      *limit = orange_Delay;
+    } else if (ctrl_state.stage[state] == 0 && flag_get(other_red)) {
+      *label = "crosswalks";
+      *limit = pedestrian_Delay;
+    } else {
+      *label = "to yellow";
+      *limit = TIMER_2s;
+    }
+    return ticks_left(&htim4, *limit);
+  }
+
+  *label = "";
+  *limit = 0;
+  return NO_COUNTDOWN;
+}
+
+/**************************************************************************//**
+ * @brief   Redraws the signal heads whose lamps changed.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void refresh_heads(void) {
+  const uint32_t lamps = (shiftreg_buffer[U1] << 16)
+                       | (shiftreg_buffer[U2] << 8)
+                       | shiftreg_buffer[U3];
+
+  for (uint8_t i = 0; i < HEADS; i++) {
+    const char glyph = heads[i].base + ((lamps >> heads[i].shift) & 0x07u);
+
+    if (glyph != page.heads[i]) {
+      draw_glyph(heads[i].x, heads[i].y, &font_signal, glyph);
+      page.heads[i] = glyph;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Draws or clears the icons whose flag changed.
+ * @version 1.0
+ * @param   const icon_t *icons, The icons.
+ * @param   uint8_t count, Number of icons.
+ * @param   const bitmap_t *bitmap, Their bitmap.
+ * @param   uint8_t *drawn, Bit per icon, shown last time; updated.
+ * @return  None
+ *****************************************************************************/
+static void refresh_icons(const icon_t *icons, uint8_t count,
+                          const bitmap_t *bitmap, uint8_t *drawn) {
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t bit = 1u << i;
+    const uint8_t shown = flag_get(icons[i].flag) ? bit : 0u;
+
+    if ((*drawn & bit) == shown) {
+      continue;
+    }
+    if (shown) {
+      draw_bitmap(icons[i].x, icons[i].y, bitmap);
+    } else {
+      clear_area(icons[i].x, icons[i].y, bitmap->width, bitmap->height);
+    }
+    *drawn = (*drawn & ~bit) | shown;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Redraws the state name, the countdown, its label and the
+ *          progress bar if changed.
+ * @details The bar is redrawn only when a column more is filled, about
+ *          50 times per phase.
+ * @version 1.2
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void refresh_panel(void) {
+  const uint8_t state = ctrl_state.state;
+  const char *label;
+  uint32_t limit;
+  const int32_t ticks = phase_ticks(&label, &limit);
+  int8_t seconds = NO_COUNTDOWN;
+  uint8_t bar = 0;
+
+  if (ticks != NO_COUNTDOWN) {
+    /* Rounded up, the timers run faster during hardware-in-the-loop runs */
+    const uint32_t hz = TIMER_HZ * timer_speedup();
+    const uint32_t left = (ticks + hz - 1) / hz;
+    seconds = (left > 99) ? 99 : (int8_t)left;
+    if (limit > 0) {
+      bar = (uint8_t)(((uint64_t)(limit - ticks) * BAR_STEPS) / limit);
+    }
+  }
+
+  if (state != page.state && state < sizeof(state_names) / sizeof(state_names[0])) {
+    draw_text_aligned(PANEL_X, NAME_Y, PANEL_WIDTH, &font_small, state_names[state], TEXT_CENTER);
+    page.state = state;
+  }
+
+  if (seconds != page.seconds) {
+    char digits[4] = "--";
+
+    if (seconds != NO_COUNTDOWN) {
+      fmt_u32(digits, seconds, 0, ' ');
+    }
+    draw_text_aligned(PANEL_X, COUNTDOWN_Y, PANEL_WIDTH, &font_large, digits, TEXT_CENTER);
+    page.seconds = seconds;
+  }
+
+  if (label != page.label) {
+    draw_text_aligned(PANEL_X, LABEL_Y, PANEL_WIDTH, &font_small, label, TEXT_CENTER);
+    page.label = label;
+  }
+
+  if (bar != page.bar) {
+    draw_progress(BAR_X, BAR_Y, BAR_WIDTH, BAR_HEIGHT, bar, BAR_STEPS);
+    page.bar = bar;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Refreshes the page once: redraws the elements that changed.
+ * @details Draws the background and every element first if the page was
+ *          not on the screen. Profiled as PROFILE_STATUS_PAGE.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void status_page_refresh(void) {
+  PROFILE_BEGIN();
+
+  if (!page.drawn) {
+    clear_screen();
+    draw_bitmap(0, 0, &junction);
+    for (uint8_t i = 0; i < HEADS; i++) {
+      page.heads[i] = NOT_DRAWN;
+    }
+    page.cars = 0;
+    page.walkers = 0;
+    page.state = NOT_DRAWN;
+    page.seconds = SECONDS_NOT_DRAWN;
+    page.label = NULL;
+    page.bar = NOT_DRAWN;
+    page.drawn = true;
+  }
+
+  refresh_heads();
+  refresh_icons(cars, CARS, &icon_car, &page.cars);
+  refresh_icons(walkers, WALKERS, &icon_pedestrian, &page.walkers);
+  refresh_panel();
+
+  PROFILE_END(PROFILE_STATUS_PAGE);
+}
+
+/**************************************************************************//**
+ * @brief   Refreshes the page every STATUS_PAGE_PERIOD_MS.
+ * @details Called from the main loop, before display_service sends the
+ *          pages. Draws a requested profile table first (profile_service),
+ *          which holds the screen. Does nothing while another screen is
+ *          held.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void status_page_service(void) {
+  profile_service();
+
+  const uint32_t now = HAL_GetTick();
+  if (page.holding) {
+    if (now - page.hold_start < STATUS_PAGE_HOLD_MS) {
+      return;
+    }
+    page.holding = false;
+  }
+  if (page.drawn && now - page.last_refresh < STATUS_PAGE_PERIOD_MS) {
+    return;
+  }
+  page.last_refresh = now;
+  status_page_refresh();
+}
+
+/**************************************************************************//**
+ * @brief   Leaves the screen to another view for STATUS_PAGE_HOLD_MS.
+ * @details Called from the main loop after drawing another screen
+ *          (profile_show). The page is drawn again in full afterwards.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void status_page_hold(void) {
+  page.hold_start = HAL_GetTick();
+  page.holding = true;
+  page.drawn = false;
+}
+
+#endif
@@ -24,11 +24,18 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include "mem_monitor.h"
+
 /**
  * Pointer to the current high watermark of the heap usage
  */
 static uint8_t *__sbrk_heap_end = NULL;
 
+/**
+ * Number of allocations refused to protect the MSP stack
+ */
+static uint32_t __sbrk_failures = 0;
+
 /**
  * @brief _sbrk() allocates memory to the newlib heap and is used by malloc
  *        and others from the C library
@@ -68,6 +75,7 @@ void *_sbrk(ptrdiff_t incr)
   /* Protect heap from growing into the reserved MSP stack */
   if (__sbrk_heap_end + incr > max_heap)
   {
+    __sbrk_failures++;
     errno = ENOMEM;
     return (void *)-1;
   }
@@ -77,3 +85,32 @@ void *_sbrk(ptrdiff_t incr)
 
   return (void *)prev_heap_end;
 }
+
+/**
+ * @brief Returns the heap size handed out by _sbrk, see mem_monitor.h
+ *
+ * newlib never gives memory back to _sbrk, so this is the heap
+ * high-water mark as well.
+ *
+ * @return Bytes between '_end' and the heap end
+ */
+uint32_t sysmem_heap_used(void)
+{
+  extern uint8_t _end; /* Symbol defined in the linker script */
+
+  if (NULL == __sbrk_heap_end)
+  {
+    return 0;
+  }
+  return (uint32_t)(__sbrk_heap_end - &_end);
+}
+
+/**
+ * @brief Returns the number of refused _sbrk calls
+ *
+ * @return Failure count since start-up
+ */
+uint32_t sysmem_sbrk_failures(void)
+{
+  return __sbrk_failures;
+}
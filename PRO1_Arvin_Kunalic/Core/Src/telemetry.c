@@ -0,0 +1,303 @@
+/**************************************************************************//**
+ * @file     telemetry.c
+ * @brief    Non-blocking telemetry stream over USART2.
+ *
+ * @details  Producers (ISRs and the main loop) append records to a byte ring
+ *           buffer without ever disabling interrupts or waiting:
+ *           - Space is claimed by moving 'head' with LDREX/STREX.
+ *           - The record is copied into the claimed space.
+ *           - When the outermost producer finishes, every claimed byte has
+ *             been written (ISRs nest LIFO on a single core), so 'commit'
+ *             is moved up to 'head'.
+ *
+ *           The consumer side runs from the SysTick and the USART2 DMA
+ *           interrupts. It hands the committed bytes to DMA1 Channel7 in
+ *           bursts of up to TELEMETRY_MAX_BURST bytes, straight out of the
+ *           ring. The half-complete interrupt releases the first half of a
+ *           burst back to the producers, the complete interrupt releases the
+ *           rest and starts the next burst.
+ *
+ *           If the ring is full the record is dropped and counted, the
+ *           producer is never blocked.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @note     USART2 TX DMA (DMA1 Channel7) and the USART2 interrupt have to be
+ *           enabled, see dma.c and usart.c.
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "usart.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "cmd_protocol.h"
+#include "crash_dump.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define TELEMETRY_MASK  (TELEMETRY_BUFFER_SIZE - 1)
+
+/* Variables ----------------------------------------------------------------*/
+
+/*
+ * All indexes are free running byte counters, only the ring offset is masked.
+ * tail <= sent <= commit <= head always holds (modulo 2^32).
+ */
+static struct {
+  uint8_t buffer[TELEMETRY_BUFFER_SIZE];
+  volatile uint32_t head;       // Next byte to be claimed by a producer
+  volatile uint32_t commit;     // Bytes completely written by producers
+  volatile uint32_t sent;       // Bytes completely transmitted by DMA
+  volatile uint32_t tail;       // Bytes released back to the producers
+  volatile uint32_t writers;    // Producers currently inside telemetry_write
+  volatile uint32_t dma_busy;   // 1 while a burst is in flight
+  volatile uint32_t dma_len;    // Length of the burst in flight
+  volatile uint32_t dropped;    // Records lost because the ring was full
+} tx;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Atomically adds a value to a counter.
+ * @version 1.0
+ * @param   volatile uint32_t *counter, The counter to modify.
+ * @param   int32_t delta, The value to add.
+ * @return  uint32_t, The new value of the counter.
+ *****************************************************************************/
+static inline uint32_t atomic_add(volatile uint32_t *counter, int32_t delta) {
+  uint32_t value;
+  do {
+    value = __LDREXW(counter) + delta;
+  } while (__STREXW(value, counter));
+  return value;
+}
+
+/**************************************************************************//**
+ * @brief   Copies bytes into the ring, wrapping at the end of the buffer.
+ * @version 1.0
+ * @param   uint32_t pos, Free running position of the first byte.
+ * @param   const uint8_t *src, The bytes to copy.
+ * @param   uint32_t len, Number of bytes to copy.
+ * @return  None
+ *****************************************************************************/
+static inline void ring_copy(uint32_t pos, const uint8_t *src, uint32_t len) {
+  uint32_t offset = pos & TELEMETRY_MASK;
+  uint32_t first = TELEMETRY_BUFFER_SIZE - offset;
+
+  if (first > len) {
+    first = len;
+  }
+  memcpy(&tx.buffer[offset], src, first);
+  memcpy(tx.buffer, src + first, len - first);
+}
+
+/**************************************************************************//**
+ * @brief   Leaves the producer section and publishes finished records.
+ * @details Only the outermost producer publishes. 'commit' is only ever moved
+ *          forward, in case a nested producer already published further.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static inline void writer_leave(void) {
+  uint32_t head, old;
+
+  __DMB(); // Record bytes must be visible before they are committed
+
+  if (atomic_add(&tx.writers, -1) != 0) {
+    return;
+  }
+
+  head = tx.head;
+  do {
+    old = __LDREXW(&tx.commit);
+    if ((int32_t)(head - old) <= 0) {
+      __CLREX();
+      return;
+    }
+  } while (__STREXW(head, &tx.commit));
+}
+
+/**************************************************************************//**
+ * @brief   Resets the telemetry ring buffer.
+ * @details Has to be called once, after MX_USART2_UART_Init, before any
+ *          producer is enabled.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void telemetry_init(void) {
+  memset(&tx, 0, sizeof(tx));
+}
+
+/**************************************************************************//**
+ * @brief   Appends a record to the telemetry stream.
+ * @details Safe to call from any interrupt priority and from the main loop.
+ *          The function never blocks, if the ring is full the record is
+ *          dropped. Event and trace records are also kept for a crash
+ *          dump (crash_dump_event).
+ * @version 1.1
+ * @param   uint8_t type, The record type (TELEMETRY_xxx).
+ * @param   const void *payload, The record payload.
+ * @param   uint8_t len, Payload length in bytes.
+ * @return  boolean, true if the record was queued, false if it was dropped.
+ * @see     telemetry_event
+ *****************************************************************************/
+bool telemetry_write(uint8_t type, const void *payload, uint8_t len) {
+  const uint8_t header[TELEMETRY_HEADER_SIZE] = {TELEMETRY_SYNC, type, len};
+  uint32_t size = TELEMETRY_HEADER_SIZE + len;
+  uint32_t head;
+
+  crash_dump_event(type, payload, len);
+  atomic_add(&tx.writers, 1);
+
+  /* Claim 'size' bytes, unless that would overwrite unreleased data */
+  do {
+    head = __LDREXW(&tx.head);
+    if ((head + size) - tx.tail > TELEMETRY_BUFFER_SIZE) {
+      __CLREX();
+      atomic_add(&tx.dropped, 1);
+      writer_leave();
+      return false;
+    }
+  } while (__STREXW(head + size, &tx.head));
+
+  ring_copy(head, header, TELEMETRY_HEADER_SIZE);
+  ring_copy(head + TELEMETRY_HEADER_SIZE, payload, len);
+
+  writer_leave();
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Appends a time stamped event record to the telemetry stream.
+ * @version 1.0
+ * @param   uint8_t type, The record type (TELEMETRY_PHASE, _INPUT, _LAMPS).
+ * @param   uint16_t id, Event identifier, meaning depends on the type.
+ * @param   uint32_t value, Event value, meaning depends on the type.
+ * @return  boolean, true if the record was queued, false if it was dropped.
+ * @see     telemetry_write
+ *****************************************************************************/
+bool telemetry_event(uint8_t type, uint16_t id, uint32_t value) {
+  telemetry_event_t event = {
+    .tick = HAL_GetTick(),
+    .value = value,
+    .id = id,
+  };
+
+  return telemetry_write(type, &event, sizeof(event));
+}
+
+/**************************************************************************//**
+ * @brief   Starts a DMA burst if committed data is waiting.
+ * @details Called from the SysTick interrupt and from the DMA complete
+ *          callback. A burst never wraps around the end of the ring, the
+ *          remainder is sent by the next burst.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void telemetry_kick(void) {
+  uint32_t start, pending, offset, chunk;
+
+  /* Take the DMA, unless a burst is already in flight */
+  if (__LDREXW(&tx.dma_busy)) {
+    __CLREX();
+    return;
+  }
+  if (__STREXW(1, &tx.dma_busy)) {
+    return;
+  }
+
+  start = tx.sent;
+  pending = tx.commit - start;
+  if (pending == 0) {
+    tx.dma_busy = 0;
+    return;
+  }
+
+  offset = start & TELEMETRY_MASK;
+  chunk = TELEMETRY_BUFFER_SIZE - offset;
+  if (chunk > pending) {
+    chunk = pending;
+  }
+  if (chunk > TELEMETRY_MAX_BURST) {
+    chunk = TELEMETRY_MAX_BURST;
+  }
+
+  tx.dma_len = chunk;
+  if (HAL_UART_Transmit_DMA(&huart2, &tx.buffer[offset], chunk) != HAL_OK) {
+    tx.dma_busy = 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the number of records dropped since telemetry_init.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, Dropped record count.
+ *****************************************************************************/
+uint32_t telemetry_dropped(void) {
+  return tx.dropped;
+}
+
+/**************************************************************************//**
+ * @brief   Releases a burst back to the producers and starts the next one.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void burst_done(void) {
+  tx.sent += tx.dma_len;
+  tx.tail = tx.sent;
+  tx.dma_busy = 0;
+  telemetry_kick();
+}
+
+/**************************************************************************//**
+ * @brief   USART2 TX DMA half-complete callback.
+ * @details The first half of the burst is on the wire, hand it back to the
+ *          producers early.
+ * @version 1.0
+ * @param   UART_HandleTypeDef *huart, The UART that triggered the callback.
+ * @return  None
+ *****************************************************************************/
+void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart) {
+  if (huart->Instance == USART2) {
+    tx.tail = tx.sent + tx.dma_len / 2;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   USART2 TX complete callback.
+ * @version 1.0
+ * @param   UART_HandleTypeDef *huart, The UART that triggered the callback.
+ * @return  None
+ *****************************************************************************/
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+  if (huart->Instance == USART2) {
+    burst_done();
+  }
+}
+
+/**************************************************************************//**
+ * @brief   USART2 error callback.
+ * @details A failed burst is skipped rather than retried, so a line error
+ *          can never stall the stream. Receive errors are handed to the
+ *          command protocol.
+ * @version 1.1
+ * @param   UART_HandleTypeDef *huart, The UART that triggered the callback.
+ * @return  None
+ *****************************************************************************/
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+  if (huart->Instance == USART2 && tx.dma_busy && huart->gState == HAL_UART_STATE_READY) {
+    burst_done();
+  }
+  cmd_protocol_rx_error(huart);
+}
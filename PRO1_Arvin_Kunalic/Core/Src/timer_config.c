@@ -0,0 +1,229 @@
+/**************************************************************************//**
+ * @file     timer_config.c
+ * @brief    Runtime timing parameters of the Traffic Light Project.
+ *
+ * @details  Holds the delays the state machine compares its timers against
+ *           and validates changes made at runtime (see cmd_protocol.c).
+ *
+ *           A parameter is a single 16-bit word, so the state machine always
+ *           reads either the old or the new value. The periods of TIM3 and
+ *           TIM5 are Auto-Reload values, they are written to the timer
+ *           directly.
+ *
+ *           For hardware-in-the-loop runs the timers can also be sped up as
+ *           a whole (timer_set_speedup).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      timer_config.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "tim.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "timer_config.h"
+
+/* Types --------------------------------------------------------------------*/
+typedef struct {
+  uint16_t initial;
+  uint16_t min;
+  uint16_t max;
+} timer_param_info_t;
+
+/* Variables ----------------------------------------------------------------*/
+
+/* Limits are in timer ticks (0.5ms), see timer_config.h */
+static const timer_param_info_t param_info[TIMER_PARAM_COUNT] = {
+  [PARAM_STEP_DELAY]    = {TIMER_2s_DEFAULT,      200,  TIM4_PERIOD},
+  [PARAM_ORANGE_DELAY]  = {orange_Delay_DEFAULT,  200,  TIM4_PERIOD},
+  [PARAM_RED_DELAY_MAX] = {red_delay_Max_DEFAULT, 0,    TIM15_PERIOD - TIM15_MARGIN},
+  [PARAM_GREEN_DELAY]   = {green_Delay_DEFAULT,   0,    TIM15_PERIOD - TIM15_MARGIN},
+  [PARAM_TOGGLE_FREQ]   = {toggle_Freq_DEFAULT,   TIM3_PERIOD_MIN - 1, 3999},
+  [PARAM_WALK_TIME]     = {walk_Time_DEFAULT,     1999, TIM5_PERIOD_MAX},
+};
+
+static uint8_t speedup = 1;
+
+volatile uint16_t timer_params[TIMER_PARAM_COUNT] = {
+  [PARAM_STEP_DELAY]    = TIMER_2s_DEFAULT,
+  [PARAM_ORANGE_DELAY]  = orange_Delay_DEFAULT,
+  [PARAM_RED_DELAY_MAX] = red_delay_Max_DEFAULT,
+  [PARAM_GREEN_DELAY]   = green_Delay_DEFAULT,
+  [PARAM_TOGGLE_FREQ]   = toggle_Freq_DEFAULT,
+  [PARAM_WALK_TIME]     = walk_Time_DEFAULT,
+};
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Writes a new Auto-Reload value to a running timer.
+ * @details If the counter is already past the new value it is restarted,
+ *          otherwise it would count all the way to the end of its range.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer to modify.
+ * @param   uint32_t period, The new Auto-Reload value.
+ * @return  None
+ *****************************************************************************/
+static void set_period(TIM_HandleTypeDef *htim, uint32_t period) {
+  __HAL_TIM_SET_AUTORELOAD(htim, period);
+  if (__HAL_TIM_GET_COUNTER(htim) > period) {
+    __HAL_TIM_SET_COUNTER(htim, 0);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Checks a TIM3 period against TIM3_PERIOD_MIN at a speed-up.
+ * @version 1.0
+ * @param   uint32_t period, The Auto-Reload value of TIM3.
+ * @param   uint8_t factor, The speed-up the timers run at.
+ * @return  boolean, true if the real period is long enough.
+ *****************************************************************************/
+static bool toggle_period_valid(uint32_t period, uint8_t factor) {
+  return period + 1 >= (uint32_t)TIM3_PERIOD_MIN * factor;
+}
+
+/**************************************************************************//**
+ * @brief   Restores the default value of every timing parameter.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void timer_params_reset(void) {
+  for (uint8_t id = 0; id < TIMER_PARAM_COUNT; id++) {
+    timer_params[id] = param_info[id].initial;
+  }
+  set_period(&htim3, toggle_Freq);
+  set_period(&htim5, walk_Time);
+}
+
+/**************************************************************************//**
+ * @brief   Changes a timing parameter.
+ * @details The value has to be inside the limits of the parameter, and the
+ *          two TIM4 delays of a transition together have to fit in one TIM4
+ *          period with TIM4_MARGIN to spare, otherwise the pedestrian delay
+ *          could be passed between two passes of the main loop. The TIM3
+ *          period has to stay above TIM3_PERIOD_MIN at the current
+ *          speed-up.
+ * @version 1.2
+ * @param   uint8_t id, The parameter (timer_param_t).
+ * @param   uint16_t value, The new value in timer ticks.
+ * @return  boolean, true if the value was accepted.
+ *****************************************************************************/
+bool timer_param_set(uint8_t id, uint16_t value) {
+  if (id >= TIMER_PARAM_COUNT || value < param_info[id].min || value > param_info[id].max) {
+    return false;
+  }
+
+  switch (id) {
+    case PARAM_STEP_DELAY:
+      if ((uint32_t)value + orange_Delay > TIM4_PERIOD - TIM4_MARGIN) {
+        return false;
+      }
+      break;
+
+    case PARAM_ORANGE_DELAY:
+      if ((uint32_t)value + TIMER_2s > TIM4_PERIOD - TIM4_MARGIN) {
+        return false;
+      }
+      break;
+
+    case PARAM_TOGGLE_FREQ:
+      if (!toggle_period_valid(value, speedup)) {
+        return false;
+      }
+      set_period(&htim3, value);
+      break;
+
+    case PARAM_WALK_TIME:
+      set_period(&htim5, value);
+      break;
+
+    default:
+      break;
+  }
+
+  timer_params[id] = value;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the valid range of a timing parameter.
+ * @version 1.0
+ * @param   uint8_t id, The parameter (timer_param_t).
+ * @param   uint16_t *min, Receives the lowest valid value.
+ * @param   uint16_t *max, Receives the highest valid value.
+ * @return  boolean, false if the parameter does not exist.
+ *****************************************************************************/
+bool timer_param_limits(uint8_t id, uint16_t *min, uint16_t *max) {
+  if (id >= TIMER_PARAM_COUNT) {
+    return false;
+  }
+  *min = param_info[id].min;
+  *max = param_info[id].max;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Changes the prescaler of a running timer right away.
+ * @details The new prescaler is loaded with an update event. The update
+ *          request source is limited to overflows while doing so, so no
+ *          interrupt is raised, and the counter value is kept.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer to modify.
+ * @param   uint32_t prescaler, The new prescaler value.
+ * @return  None
+ *****************************************************************************/
+static void set_prescaler(TIM_HandleTypeDef *htim, uint32_t prescaler) {
+  uint32_t counter = __HAL_TIM_GET_COUNTER(htim);
+
+  __HAL_TIM_SET_PRESCALER(htim, prescaler);
+  htim->Instance->CR1 |= TIM_CR1_URS;
+  htim->Instance->EGR = TIM_EGR_UG;
+  htim->Instance->CR1 &= ~TIM_CR1_URS;
+  __HAL_TIM_SET_COUNTER(htim, counter);
+}
+
+/**************************************************************************//**
+ * @brief   Makes the traffic light timers run faster than real time.
+ * @details Used by hardware-in-the-loop runs to play scenarios quickly. All
+ *          delays of the state machine are measured with TIM3, TIM4, TIM5
+ *          and TIM15, dividing their prescaler speeds the whole cycle up.
+ *          The HAL tick (time stamps, HAL_Delay) keeps running in real time.
+ * @version 1.1
+ * @param   uint8_t factor, 1 for real time, up to TIMER_SPEEDUP_MAX. Has to
+ *          divide TIMER_PRESCALER and keep the current TIM3 period above
+ *          TIM3_PERIOD_MIN.
+ * @return  boolean, true if the factor was accepted.
+ * @note    Every shift register update still takes 10ms (buffer_to_SPI),
+ *          which limits the factor (TIMER_SPEEDUP_MAX).
+ *****************************************************************************/
+bool timer_set_speedup(uint8_t factor) {
+  if (factor == 0 || factor > TIMER_SPEEDUP_MAX || (TIMER_PRESCALER % factor) != 0
+      || !toggle_period_valid(toggle_Freq, factor)) {
+    return false;
+  }
+
+  uint32_t prescaler = TIMER_PRESCALER / factor - 1;
+  set_prescaler(&htim3, prescaler);
+  set_prescaler(&htim4, prescaler);
+  set_prescaler(&htim5, prescaler);
+  set_prescaler(&htim15, prescaler);
+  speedup = factor;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the current time speed-up.
+ * @version 1.0
+ * @param   None
+ * @return  uint8_t, The speed-up factor, 1 for real time.
+ *****************************************************************************/
+uint8_t timer_speedup(void) {
+  return speedup;
+}
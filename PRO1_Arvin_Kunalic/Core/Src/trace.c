@@ -0,0 +1,56 @@
+/**************************************************************************//**
+ * @file     trace.c
+ * @brief    Tokenized logging on top of the telemetry stream.
+ *
+ * @details  Packs a TRACE call (message ID, time stamp and raw arguments)
+ *           into a TELEMETRY_TRACE record. The cost is a handful of stores
+ *           and one telemetry_write, which makes it safe to use inside ISRs
+ *           such as HAL_GPIO_EXTI_Callback.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      trace.h, telemetry.c and Tools/trace_decode.py
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "trace.h"
+
+/* Types --------------------------------------------------------------------*/
+typedef struct __attribute__((packed)) {
+  uint32_t tick;
+  uint16_t id;
+  uint32_t args[TRACE_MAX_ARGS];
+} trace_record_t;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Emits one tokenized log message.
+ * @details Should not be called directly, use the TRACE macro.
+ * @version 1.0
+ * @param   uint16_t id, Offset of the format string in '.trace_fmt'.
+ * @param   uint8_t argc, Number of arguments.
+ * @param   const uint32_t *argv, The arguments.
+ * @return  None
+ * @see     TRACE
+ *****************************************************************************/
+void trace_emit(uint16_t id, uint8_t argc, const uint32_t *argv) {
+  trace_record_t record;
+
+  record.tick = HAL_GetTick();
+  record.id = id;
+  memcpy(record.args, argv, argc * sizeof(uint32_t));
+
+  telemetry_write(TELEMETRY_TRACE, &record,
+                  offsetof(trace_record_t, args) + argc * sizeof(uint32_t));
+}
@@ -46,6 +46,12 @@
 #include "fonts.h"
 #include <stm32l476xx.h>
 #include "clock.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "mem_monitor.h"
+#include "boot.h"
+#include "ctrl_state.h"
+#include "status_page.h"
 
 /* States */
 typedef enum {
@@ -54,275 +60,339 @@ typedef enum {
   Wait20s,
   Wait30s,
 } states;
-static states State, NextState;
 
-void Traffic(void) {
-    init_program();
-    State = Intersection2;
-    NextState = Intersection2;
+/* The state, next state and the stages of Intersection1/2 live in ctrl_state */
+static volatile uint32_t phase_changes = 0;
 
-    while (1) {
-        State = NextState;
+/**************************************************************************//**
+ * @brief   Returns the current state of the state machine.
+ * @version 1.0
+ * @param   None
+ * @return  uint8_t, The state (Intersection1, Intersection2, Wait20s, Wait30s).
+ *****************************************************************************/
+uint8_t traffic_state(void) {
+    return ctrl_state.state;
+}
 
-        switch (State) {
-            case Intersection1: {
-                static uint8_t stage = 0;
+/**************************************************************************//**
+ * @brief   Returns the number of state changes since start-up.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, State change count.
+ *****************************************************************************/
+uint32_t traffic_phase_changes(void) {
+    return phase_changes;
+}
 
-                /* Stage 0: If switching from an active intersection to an inactive */
-                if (stage == 0) {
-                    /* If Intersection1 already is green, skip this stage */
-                    if (intersection1_green) {
-                        stage = 1;
-                        break;
-                    }
+/**************************************************************************//**
+ * @brief   Initializes the outputs and the state machine.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void Traffic_init(void) {
+    init_program();
+    ctrl_state.state = Intersection2;
+    ctrl_state.next_state = Intersection2;
+}
 
-                    /* Stop active Intersection2 */
-                    if (!intersection2_red) {
-                        stop_intersection(2);
-                    }
+/**************************************************************************//**
+ * @brief   Runs one pass of the traffic light state machine.
+ * @details Never blocks waiting for a timer, it has to be called again and
+ *          again (see Traffic). Running the state machine pass by pass lets
+ *          the host build drive it from simulated time. Each pass also
+ *          refreshes the status page when it is due (status_page_service)
+ *          and sends at most one changed display page (display_service).
+ * @version 1.3
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void Traffic_step(void) {
+    if (ctrl_state.next_state != ctrl_state.state) {
+        telemetry_event(TELEMETRY_PHASE, ctrl_state.next_state, ctrl_state.state);
+        phase_changes++;
+    }
+    ctrl_state.state = ctrl_state.next_state;
+
+    lamp_test_service();
+    mem_monitor_service();
+    status_page_service();
+    display_service();
+    boot_service();
+
+    switch (ctrl_state.state) {
+        case Intersection1: {
+            /* Stage 0: If switching from an active intersection to an inactive */
+            if (ctrl_state.stage[0] == 0) {
+                /* If Intersection1 already is green, skip this stage */
+                if (flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    ctrl_state.stage[0] = 1;
+                    break;
+                }
 
-                    /* 5s after cars are stopped, allow pedestrians to walk across inactive lane */
-                    if (intersection2_red && __HAL_TIM_GetCounter(&htim4) >= pedestrian_Delay) {  
-                        stop_and_resetTimer(&htim4);
-                        stop_pedestrian(1);
-                        go_pedestrian(2);
-                        HAL_TIM_Base_Start(&htim4);
-                        stage = 1;
-                    }  else {
-                        break;
-                    }
+                /* Stop active Intersection2 */
+                if (!flag_get(FLAG_INTERSECTION2_RED)) {
+                    stop_intersection(2);
                 }
 
-                /* Stage 1: If not already, turn on Intersection1 */
-                if (stage == 1 && crosswalk1_red) {
-                    if (!intersection1_green) {
-                        go_intersection(1);
-                    } else if (intersection1_green) {
-                        stop_and_resetTimer(&htim4);
-                        stage = 2;
-                    }
+                /* 5s after cars are stopped, allow pedestrians to walk across inactive lane */
+                if (flag_get(FLAG_INTERSECTION2_RED) && __HAL_TIM_GetCounter(&htim4) >= pedestrian_Delay) {  
+                    stop_and_resetTimer(&htim4);
+                    stop_pedestrian(1);
+                    go_pedestrian(2);
+                    HAL_TIM_Base_Start(&htim4);
+                    ctrl_state.stage[0] = 1;
+                }  else {
                     break;
-                } 
+                }
+            }
 
-                /* Stage 2: If/when Intersection1 is green, check the following */
-                if (stage == 2) {
-                
-                    /* Pedestrain waiting? */
-                    if (PL1_SW_HIT) {
-                        NextState = Intersection2;
-                        stage = 0;
-                        break;
-                    }
+            /* Stage 1: If not already, turn on Intersection1 */
+            if (ctrl_state.stage[0] == 1 && flag_get(FLAG_CROSSWALK1_RED)) {
+                if (!flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    go_intersection(1);
+                } else if (flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    stop_and_resetTimer(&htim4);
+                    ctrl_state.stage[0] = 2;
+                }
+                break;
+            } 
+
+            /* Stage 2: If/when Intersection1 is green, check the following */
+            if (ctrl_state.stage[0] == 2) {
+            
+                /* Pedestrain waiting? */
+                if (flag_get(FLAG_PL1_SW_HIT)) {
+                    ctrl_state.next_state = Intersection2;
+                    ctrl_state.stage[0] = 0;
+                    HAL_TIM_Base_Start(&htim4); // Stopped in stage 1 if pressed while turning green
+                    break;
+                }
 
-                    /* Any active cars at all? */
-                    if (no_active_cars()) {
-                        NextState = Wait30s;
-                        stage = 0;
-                        HAL_TIM_Base_Start(&htim15);
-                        break;
-                    }
+                /* Any active cars at all? */
+                if (no_active_cars()) {
+                    ctrl_state.next_state = Wait30s;
+                    ctrl_state.stage[0] = 0;
+                    HAL_TIM_Base_Start(&htim15);
+                    break;
+                }
 
-                    /* If there are active cars at the active Intersection */
-                    if (active_cars_at(1)) {
-                        /* If cars are also waiting at red light */
-                        if (active_cars_at(2)) {
-                        NextState = Wait20s;
-                        stage = 0;
-                        HAL_TIM_Base_Start(&htim15);
+                /* If there are active cars at the active Intersection */
+                if (active_cars_at(1)) {
+                    /* If cars are also waiting at red light */
+                    if (active_cars_at(2)) {
+                    ctrl_state.next_state = Wait20s;
+                    ctrl_state.stage[0] = 0;
+                    HAL_TIM_Base_Start(&htim15);
+                    break;
+                    } else { // No cars are waiting at a red light
+                        ctrl_state.stage[0] = 2;
                         break;
-                        } else { // No cars are waiting at a red light
-                            stage = 2;
-                            break;
-                        }
                     }
+                }
 
-                    /* No active cars at the active Intersection, but cars waiting at inactive Intersection */
-                    if (!(active_cars_at(1)) && (active_cars_at(2))) {
-                        NextState = Intersection2;
-                        stage = 0;
-                        HAL_TIM_Base_Start(&htim4);
-                        break;
-                    } else {
-                        NextState = Intersection1;
-                        stage = 2;
-                    }
+                /* No active cars at the active Intersection, but cars waiting at inactive Intersection */
+                if (!(active_cars_at(1)) && (active_cars_at(2))) {
+                    ctrl_state.next_state = Intersection2;
+                    ctrl_state.stage[0] = 0;
+                    HAL_TIM_Base_Start(&htim4);
                     break;
+                } else {
+                    ctrl_state.next_state = Intersection1;
+                    ctrl_state.stage[0] = 2;
                 }
+                break;
             }
+        }
 
-            case Intersection2: {
-                static uint8_t stage = 0;
-                
-                /* Stage 0: If switching from an active intersection to an inactive */
-                if (stage == 0) {
-                    /* If Intersection2 already is green, skip this stage */
-                    if (intersection2_green) {
-                        stage = 1;
-                        break;
-                    }
-
-                    /* Stop active Intersection1 */
-                    if (!intersection1_red) {
-                        stop_intersection(1);
-                    } 
-
-                    /* 5s after cars are stopped, allow pedestrians to walk across inactive lane  */
-                    if (intersection1_red && __HAL_TIM_GetCounter(&htim4) >= pedestrian_Delay) {            
-                        stop_and_resetTimer(&htim4);
-                        stop_pedestrian(2);
-                        go_pedestrian(1);
-                        HAL_TIM_Base_Start(&htim4);
-                        stage = 1;
-                    } else {
-                        break;
-                    }
+        case Intersection2: {
+            /* Stage 0: If switching from an active intersection to an inactive */
+            if (ctrl_state.stage[1] == 0) {
+                /* If Intersection2 already is green, skip this stage */
+                if (flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    ctrl_state.stage[1] = 1;
+                    break;
                 }
 
-                /* Stage 1: If not already, turn on Intersection2 */
-                if (stage == 1 && crosswalk2_red) {
-                    if (!intersection2_green) {
-                        go_intersection(2);
-                    } else if (intersection2_green) {
-                        stop_and_resetTimer(&htim4);
-                        stage = 2;
-                    }
-                    break;
+                /* Stop active Intersection1 */
+                if (!flag_get(FLAG_INTERSECTION1_RED)) {
+                    stop_intersection(1);
                 } 
 
-                /* Stage 2: If/when Intersection2 is green, check the following */
-                if (stage == 2) {
-                    
-                    /* Pedestrain waiting? */
-                    if (PL2_SW_HIT) {
-                        NextState = Intersection1;
-                        stage = 0;
-                        break;
-                    }
-
-                    /* Any active cars at all? */
-                    if (no_active_cars()) {
-                        NextState = Wait30s;
-                        stage = 0;
-                        HAL_TIM_Base_Start(&htim15);
-                        break;
-                    }
-
-                    /* If there are active cars at the active Intersection*/
-                    if (active_cars_at(2)) {
-                        /* If cars are also waiting at red light */
-                        if (active_cars_at(1)) {
-                        NextState = Wait20s;
-                        stage = 0,
-                        HAL_TIM_Base_Start(&htim15);
-                        break;
-                        } else { // No cars are waiting at a red light
-                            stage = 2;
-                            break;
-                        }
-                    }
-
-                    /* No active cars at the active Intersection, but cars waiting at inactive Intersection */
-                    if (!(active_cars_at(2)) && (active_cars_at(1))) {
-                        NextState =Intersection1;
-                        stage = 0;
-                        HAL_TIM_Base_Start(&htim4);
-                        break;
-                    } else {
-                        NextState = Intersection2;
-                        stage = 2;
-                    }
+                /* 5s after cars are stopped, allow pedestrians to walk across inactive lane  */
+                if (flag_get(FLAG_INTERSECTION1_RED) && __HAL_TIM_GetCounter(&htim4) >= pedestrian_Delay) {            
+                    stop_and_resetTimer(&htim4);
+                    stop_pedestrian(2);
+                    go_pedestrian(1);
+                    HAL_TIM_Base_Start(&htim4);
+                    ctrl_state.stage[1] = 1;
+                } else {
                     break;
                 }
             }
 
-            /* You'll only end up here if there are active cars at the intersection and at the inactive Intersection */
-            case Wait20s:
-                /* If PL1_SW is pressed while wating interesction1 is active, transition immideately */
-                if (PL1_SW_HIT && intersection1_green) {
-                    stop_and_resetTimer(&htim15);
-                    NextState = Intersection2;
-                    break; /* If PL1_SW is pressed while intersection2 is active, turn on crosswalk1 after 5s */
-                } 
+            /* Stage 1: If not already, turn on Intersection2 */
+            if (ctrl_state.stage[1] == 1 && flag_get(FLAG_CROSSWALK2_RED)) {
+                if (!flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    go_intersection(2);
+                } else if (flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    stop_and_resetTimer(&htim4);
+                    ctrl_state.stage[1] = 2;
+                }
+                break;
+            } 
 
-                /* If PL2_SW is pressed while waiting interesction2 is active, transition immideately */
-                if (PL2_SW_HIT && intersection2_green) {
-                    stop_and_resetTimer(&htim15);
-                    NextState = Intersection1;
-                    break; /* If PL2_SW is pressed while intersection1 is active, turn on crosswalk2 after 5s */
-                } 
+            /* Stage 2: If/when Intersection2 is green, check the following */
+            if (ctrl_state.stage[1] == 2) {
+                
+                /* Pedestrain waiting? */
+                if (flag_get(FLAG_PL2_SW_HIT)) {
+                    ctrl_state.next_state = Intersection1;
+                    ctrl_state.stage[1] = 0;
+                    HAL_TIM_Base_Start(&htim4); // Stopped in stage 1 if pressed while turning green
+                    break;
+                }
 
-                /* Waits ~ 5s (transition_time = 15s => total time = 20s) */
-                if (__HAL_TIM_GetCounter(&htim15) >= red_delay_Max) {
-                    stop_and_resetTimer(&htim15);
+                /* Any active cars at all? */
+                if (no_active_cars()) {
+                    ctrl_state.next_state = Wait30s;
+                    ctrl_state.stage[1] = 0;
+                    HAL_TIM_Base_Start(&htim15);
+                    break;
+                }
 
-                    /* If the Intersection before, entering wait was 1, It's the 2:nd Intersections turn */
-                    if (intersection1_green) {
-                        NextState = Intersection2;
-                        HAL_TIM_Base_Start(&htim4);
+                /* If there are active cars at the active Intersection*/
+                if (active_cars_at(2)) {
+                    /* If cars are also waiting at red light */
+                    if (active_cars_at(1)) {
+                    ctrl_state.next_state = Wait20s;
+                    ctrl_state.stage[1] = 0,
+                    HAL_TIM_Base_Start(&htim15);
+                    break;
+                    } else { // No cars are waiting at a red light
+                        ctrl_state.stage[1] = 2;
                         break;
                     }
+                }
 
-                    /* Vice versa ^^ */
-                    if (intersection2_green) {
-                        NextState = Intersection1;
-                        HAL_TIM_Base_Start(&htim4);
-                        break;
-                    }
+                /* No active cars at the active Intersection, but cars waiting at inactive Intersection */
+                if (!(active_cars_at(2)) && (active_cars_at(1))) {
+                    ctrl_state.next_state =Intersection1;
+                    ctrl_state.stage[1] = 0;
+                    HAL_TIM_Base_Start(&htim4);
+                    break;
                 } else {
-                    NextState = Wait20s;
+                    ctrl_state.next_state = Intersection2;
+                    ctrl_state.stage[1] = 2;
                 }
-            break;
-
-            /* You'll only end up here if there are no active cars at a green intersection */
-            case Wait30s:
-                /* A car is active, go back and check what should be done */
-                if (!no_active_cars()) {
-                    stop_and_resetTimer(&htim15);
-                    if (intersection1_green) {
-                        NextState = Intersection1;
-                        break;
-                    } else if (intersection2_green) {
-                        NextState = Intersection2;
-                        break;
-                    }
+                break;
+            }
+        }
+
+        /* You'll only end up here if there are active cars at the intersection and at the inactive Intersection */
+        case Wait20s:
+            /* If PL1_SW is pressed while wating interesction1 is active, transition immideately */
+            if (flag_get(FLAG_PL1_SW_HIT) && flag_get(FLAG_INTERSECTION1_GREEN)) {
+                stop_and_resetTimer(&htim15);
+                ctrl_state.next_state = Intersection2;
+                break; /* If PL1_SW is pressed while intersection2 is active, turn on crosswalk1 after 5s */
+            } 
+
+            /* If PL2_SW is pressed while waiting interesction2 is active, transition immideately */
+            if (flag_get(FLAG_PL2_SW_HIT) && flag_get(FLAG_INTERSECTION2_GREEN)) {
+                stop_and_resetTimer(&htim15);
+                ctrl_state.next_state = Intersection1;
+                break; /* If PL2_SW is pressed while intersection1 is active, turn on crosswalk2 after 5s */
+            } 
+
+            /* Waits ~ 5s (transition_time = 15s => total time = 20s) */
+            if (__HAL_TIM_GetCounter(&htim15) >= red_delay_Max) {
+                stop_and_resetTimer(&htim15);
+
+                /* If the Intersection before, entering wait was 1, It's the 2:nd Intersections turn */
+                if (flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    ctrl_state.next_state = Intersection2;
+                    HAL_TIM_Base_Start(&htim4);
+                    break;
                 }
 
-                /* If PL1_SW is pressed while wating interesction1 is active, transition immideately */
-                if (PL1_SW_HIT && intersection1_green) {
-                    stop_and_resetTimer(&htim15);
-                    NextState = Intersection2;
-                    break; /* If PL1_SW is pressed while intersection2 is active, turn on crosswalk1 after 5s */
-                } 
+                /* Vice versa ^^ */
+                if (flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    ctrl_state.next_state = Intersection1;
+                    HAL_TIM_Base_Start(&htim4);
+                    break;
+                }
+            } else {
+                ctrl_state.next_state = Wait20s;
+            }
+        break;
+
+        /* You'll only end up here if there are no active cars at a green intersection */
+        case Wait30s:
+            /* A car is active, go back and check what should be done */
+            if (!no_active_cars()) {
+                stop_and_resetTimer(&htim15);
+                if (flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    ctrl_state.next_state = Intersection1;
+                    break;
+                } else if (flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    ctrl_state.next_state = Intersection2;
+                    break;
+                }
+            }
 
-                /* If PL2_SW is pressed while waiting interesction2 is active, transition immideately */
-                if (PL2_SW_HIT && intersection2_green) {
-                    stop_and_resetTimer(&htim15);
-                    NextState = Intersection1;
-                    break; /* If PL2_SW is pressed while intersection1 is active, turn on crosswalk2 after 5s */
-                } 
+            /* If PL1_SW is pressed while wating interesction1 is active, transition immideately */
+            if (flag_get(FLAG_PL1_SW_HIT) && flag_get(FLAG_INTERSECTION1_GREEN)) {
+                stop_and_resetTimer(&htim15);
+                ctrl_state.next_state = Intersection2;
+                break; /* If PL1_SW is pressed while intersection2 is active, turn on crosswalk1 after 5s */
+            } 
+
+            /* If PL2_SW is pressed while waiting interesction2 is active, transition immideately */
+            if (flag_get(FLAG_PL2_SW_HIT) && flag_get(FLAG_INTERSECTION2_GREEN)) {
+                stop_and_resetTimer(&htim15);
+                ctrl_state.next_state = Intersection1;
+                break; /* If PL2_SW is pressed while intersection1 is active, turn on crosswalk2 after 5s */
+            } 
+
+            /* Waits ~15s (transition_time = 15s => total time = 30s) */
+            if (__HAL_TIM_GetCounter(&htim15) >= green_Delay) {
+                stop_and_resetTimer(&htim15);
+                
+                /* Intersection1 was active before the wait, now switch intersection */
+                if (flag_get(FLAG_INTERSECTION1_GREEN)) {
+                    ctrl_state.next_state = Intersection2;
+                    HAL_TIM_Base_Start(&htim4);
+                    break;
+                }
 
-                /* Waits ~15s (transition_time = 15s => total time = 30s) */
-                if (__HAL_TIM_GetCounter(&htim15) >= green_Delay) {
-                    stop_and_resetTimer(&htim15);
-                    
-                    /* Intersection1 was active before the wait, now switch intersection */
-                    if (intersection1_green) {
-                        NextState = Intersection2;
-                        HAL_TIM_Base_Start(&htim4);
-                        break;
-                    }
+                /* Intersection2 was active before the wait, now switch intersection */
+                if (flag_get(FLAG_INTERSECTION2_GREEN)) {
+                    ctrl_state.next_state = Intersection1;
+                    HAL_TIM_Base_Start(&htim4);
+                    break;
+                }
 
-                    /* Intersection2 was active before the wait, now switch intersection */
-                    if (intersection2_green) {
-                        NextState = Intersection1;
-                        HAL_TIM_Base_Start(&htim4);
-                        break;
-                    }
+            } else {
+                ctrl_state.next_state = Wait30s;
+            }
+        break;
+    }
+}
 
-                } else {
-                    NextState = Wait30s;
-                }
-            break;
-        }
+/**************************************************************************//**
+ * @brief   The main program, runs the state machine forever.
+ * @details Every pass is profiled as PROFILE_TRAFFIC_STEP.
+ * @version 1.2
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void Traffic(void) {
+    Traffic_init();
+
+    while (1) {
+        PROFILE_BEGIN();
+        Traffic_step();
+        PROFILE_END(PROFILE_TRAFFIC_STEP);
     }
 }
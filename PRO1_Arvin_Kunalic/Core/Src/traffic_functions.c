@@ -33,28 +33,25 @@
 #include "fonts.h"
 #include <stm32l476xx.h>
 #include "clock.h"
-
-/* Variables ----------------------------------------------------------------*/
-volatile bool car1_active = 0;
-volatile bool car2_active = 0;
-volatile bool car3_active = 0;
-volatile bool car4_active = 0;
+#include "status_page.h"
 
 /**************************************************************************//**
  * @brief    Initializes the entire traffic light program
  * @details  The function initializes the OLED screen, shift registers start-state,
  *           timers, and displays the cars and pedestrian states.
- * @version  1.0
+ *           boot_latch already latched the start-state and the display is
+ *           only started here, display_service in the main loop brings it up
+ *           and shows the status page (or the text drawn below without it).
+ * @version  1.2
  * @param    None
  * @return   None
- * @see      595_shiftreg.c/.h, ssd1306_config.c/.h and stm32l4xx_it.c
+ * @see      595_shiftreg.c/.h, ssd1306_config.c/.h, boot.c and stm32l4xx_it.c
  *****************************************************************************/
 void init_program(void) {
-  /* init screen */
-  init_OLED();
+  /* init screen, without waiting for it */
+  display_start();
   clear_screen();
-  /* init shift registers and it's start-state */
-  reset_595register();
+  /* shift registers start-state, latched by boot_latch already */
   update_shiftreg_buffer(init_state);
   buffer_to_SPI();
 
@@ -63,12 +60,12 @@ void init_program(void) {
   __HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_UPDATE); // Clear interrupt flag
 
   /* Display at start */
-  draw_string(0, 0, "No pedestrian");
-  draw_string(0, 8, "       is waiting..");
-  draw_string(0, 31, "Car1 inactive");
-  draw_string(0, 39, "Car2 inactive");
-  draw_string(0, 47, "Car3 inactive");
-  draw_string(0, 55, "Car4 inactive");
+  STATUS_TEXT(0, 0, "No pedestrian");
+  STATUS_TEXT(0, 8, "       is waiting..");
+  STATUS_TEXT(0, 31, "Car1 inactive");
+  STATUS_TEXT(0, 39, "Car2 inactive");
+  STATUS_TEXT(0, 47, "Car3 inactive");
+  STATUS_TEXT(0, 55, "Car4 inactive");
 }
 
 /**************************************************************************//**
@@ -95,7 +92,7 @@ void stop_and_resetTimer(TIM_HandleTypeDef *htim_x) {
  * @return   boolean 
  *****************************************************************************/
 bool no_active_cars(void) {
-  if (!car1_active && !car2_active && !car3_active && !car4_active) {
+  if (!flag_get(FLAG_CAR1_ACTIVE) && !flag_get(FLAG_CAR2_ACTIVE) && !flag_get(FLAG_CAR3_ACTIVE) && !flag_get(FLAG_CAR4_ACTIVE)) {
     return 1;
   } else {
     return 0;
@@ -115,10 +112,10 @@ bool no_active_cars(void) {
 bool active_cars_at(uint8_t intersection) {
   bool status = 0;
   if (intersection == 1) {
-    (car1_active || car3_active) ? (status = 1) : (status = 0);
+    (flag_get(FLAG_CAR1_ACTIVE) || flag_get(FLAG_CAR3_ACTIVE)) ? (status = 1) : (status = 0);
     return status;
   } else if (intersection == 2) {
-    (car2_active || car4_active) ? (status = 1) : (status = 0);
+    (flag_get(FLAG_CAR2_ACTIVE) || flag_get(FLAG_CAR4_ACTIVE)) ? (status = 1) : (status = 0);
     return status;
   } 
   return -1;
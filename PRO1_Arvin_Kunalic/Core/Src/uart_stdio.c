@@ -0,0 +1,172 @@
+/**************************************************************************//**
+ * @file     uart_stdio.c
+ * @brief    Buffered, DMA-backed stdout/stderr on USART2.
+ *
+ * @details  Provides the '_write' system call used by newlib, overriding the
+ *           weak stub in syscalls.c. Instead of a blocking HAL_UART_Transmit
+ *           per character, the text is handed to the telemetry ring, which
+ *           is drained by DMA:
+ *           - Thread mode: characters are collected in a line buffer and
+ *             sent as one TELEMETRY_TEXT record per line (or per
+ *             UART_STDIO_LINE_SIZE characters).
+ *           - Handler mode: the line buffer belongs to the main loop, so
+ *             each write is sent as its own record right away.
+ *
+ *           stdout is switched to unbuffered mode, newlib then formats each
+ *           printf into a temporary buffer on the caller's stack and calls
+ *           '_write' once. That buffer is BUFSIZ (1024) bytes, the whole
+ *           _Min_Stack_Size reserve, and printf shares the _impure_ptr
+ *           state with the main loop, so printf is not safe in ISRs: use
+ *           TRACE or telemetry_write there. Only a direct '_write' call is
+ *           safe in handler mode.
+ *
+ *           When the ring is full the text is either dropped (default) or,
+ *           with UART_STDIO_BLOCK and only in thread mode with interrupts
+ *           enabled, the caller waits for the DMA to free space.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @note     Keep UART_STDIO_DROP in production builds, printing must never
+ *           change the timing of the traffic light state machine.
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "telemetry.h"
+#include "uart_stdio.h"
+
+/* Defines ------------------------------------------------------------------*/
+/* Largest payload of a single telemetry record */
+#define TEXT_RECORD_MAX 255
+
+/* Variables ----------------------------------------------------------------*/
+static char line[UART_STDIO_LINE_SIZE];
+static uint32_t line_len = 0;
+
+static volatile uint8_t overflow_policy = UART_STDIO_OVERFLOW;
+static volatile uint32_t dropped = 0;
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Checks whether the caller may wait for the ring to drain.
+ * @version 1.0
+ * @param   None
+ * @return  boolean, true in thread mode with interrupts enabled.
+ *****************************************************************************/
+static inline bool can_block(void) {
+  return (__get_IPSR() == 0) && (__get_PRIMASK() == 0);
+}
+
+/**************************************************************************//**
+ * @brief   Sends text as one or more TELEMETRY_TEXT records.
+ * @details Applies the overflow policy if the telemetry ring is full.
+ * @version 1.0
+ * @param   const char *text, The text to send.
+ * @param   uint32_t len, Number of characters.
+ * @return  None
+ *****************************************************************************/
+static void emit(const char *text, uint32_t len) {
+  while (len > 0) {
+    uint32_t chunk = (len > TEXT_RECORD_MAX) ? TEXT_RECORD_MAX : len;
+
+    while (!telemetry_write(TELEMETRY_TEXT, text, chunk)) {
+      if (overflow_policy == UART_STDIO_DROP || !can_block()) {
+        uint32_t count;
+        do {
+          count = __LDREXW(&dropped) + chunk;
+        } while (__STREXW(count, &dropped));
+        break;
+      }
+      telemetry_kick(); // UART_STDIO_BLOCK: wait for the DMA to release space
+    }
+
+    text += chunk;
+    len -= chunk;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Prepares stdout for the telemetry stream.
+ * @details Has to be called after telemetry_init and before the first printf.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void uart_stdio_init(void) {
+  line_len = 0;
+  setvbuf(stdout, NULL, _IONBF, 0);
+}
+
+/**************************************************************************//**
+ * @brief   Selects what happens when the telemetry ring is full.
+ * @version 1.0
+ * @param   uint8_t policy, UART_STDIO_DROP or UART_STDIO_BLOCK.
+ * @return  None
+ *****************************************************************************/
+void uart_stdio_set_overflow(uint8_t policy) {
+  overflow_policy = policy;
+}
+
+/**************************************************************************//**
+ * @brief   Sends the partially collected line.
+ * @details Only has an effect in thread mode, ISRs never own the line buffer.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void uart_stdio_flush(void) {
+  if (__get_IPSR() != 0 || line_len == 0) {
+    return;
+  }
+  emit(line, line_len);
+  line_len = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the number of characters dropped since start-up.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, Dropped character count.
+ *****************************************************************************/
+uint32_t uart_stdio_dropped(void) {
+  return dropped;
+}
+
+/**************************************************************************//**
+ * @brief   newlib write system call for stdout and stderr.
+ * @version 1.0
+ * @param   int file, The file descriptor.
+ * @param   char *ptr, The characters to write.
+ * @param   int len, Number of characters.
+ * @return  int, Number of characters accepted, -1 for other descriptors.
+ * @see     syscalls.c
+ *****************************************************************************/
+int _write(int file, char *ptr, int len) {
+  if (file != STDOUT_FILENO && file != STDERR_FILENO) {
+    errno = EBADF;
+    return -1;
+  }
+
+  if (__get_IPSR() != 0) {
+    emit(ptr, len);
+    return len;
+  }
+
+  for (int i = 0; i < len; i++) {
+    line[line_len++] = ptr[i];
+    if (ptr[i] == '\n' || line_len == UART_STDIO_LINE_SIZE) {
+      uart_stdio_flush();
+    }
+  }
+  return len;
+}
@@ -61,6 +61,18 @@ defined in linker script */
 Reset_Handler:
   ldr   sp, =_estack    /* Set stack pointer */
 
+/* Start the DWT cycle counter from zero, for the boot times (see boot.h) */
+  ldr r0, =0xE000EDFC   /* CoreDebug->DEMCR */
+  ldr r1, [r0]
+  orr r1, r1, #0x01000000 /* TRCENA */
+  str r1, [r0]
+  ldr r0, =0xE0001000   /* DWT->CTRL */
+  movs r1, #0
+  str r1, [r0, #4]      /* DWT->CYCCNT */
+  ldr r1, [r0]
+  orr r1, r1, #1        /* CYCCNTENA */
+  str r1, [r0]
+
 /* Call the clock system initialization function.*/
     bl  SystemInit
 
@@ -80,6 +92,23 @@ LoopCopyDataInit:
   adds r4, r0, r3
   cmp r4, r1
   bcc CopyDataInit
+
+/* Copy the RAM functions from flash to SRAM2 (see ramfunc.h) */
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  movs r3, #0
+  b LoopCopyRamfuncInit
+
+CopyRamfuncInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamfuncInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamfuncInit
   
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
@@ -95,6 +124,19 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Zero fill the SRAM2 data (see ramfunc.h), r3 is still 0 */
+  ldr r2, =_sram2bss
+  ldr r4, =_eram2bss
+  b LoopFillZeroRam2bss
+
+FillZeroRam2bss:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopFillZeroRam2bss:
+  cmp r2, r4
+  bcc FillZeroRam2bss
+
 /* Call static constructors */
     bl __libc_init_array
 /* Call the application's entry point.*/
@@ -0,0 +1,100 @@
+/**************************************************************************//**
+ * @file     batch.h
+ * @brief    Header for batch.c file
+ *
+ * @details  Batched controllers: the state machine of traffic.c, with the
+ *           interrupts of clock.c and the light sequences of 595_shiftreg.c,
+ *           for many junctions at once. Every field of the controller state
+ *           is an array with one entry per junction (structure of arrays),
+ *           and one call advances all junctions by one tick: the timers
+ *           count, the inputs and the timer interrupts are handled and the
+ *           state machine makes one pass, as on the board.
+ *
+ *           The tick is a whole number of timer counts (0.5 ms) and at most
+ *           one period of the blue light (TIM3). The state machine only
+ *           looks at the timers once per tick, so with a tick of 10 ms a
+ *           delay may end up to 10 ms later than on the board.
+ *
+ *           The firmware per junction (grid.c) is the reference:
+ *           build/traffic_batch steps both with the same inputs and compares
+ *           them after every tick (batch_main.c).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef BATCH_H
+#define BATCH_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Junctions per kernel iteration, one 256-bit vector of 32-bit lanes */
+#define BATCH_LANES         8
+
+/* Timers of the controller, bits of 'running' */
+#define BATCH_TIM3          0x01    // Blue light period, interrupt
+#define BATCH_TIM4          0x02    // Light sequences, polled
+#define BATCH_TIM5          0x04    // Walk time, interrupt
+#define BATCH_TIM15         0x08    // Wait20s/Wait30s, polled
+
+/* Inputs: car sensors 1-4 (level, bit 0-3) and buttons PL1/PL2 (pressed
+ * during the last tick, bit 0-1) */
+#define BATCH_CARS          0x0F
+#define BATCH_BUTTONS       0x03
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  BATCH_KERNEL_BASELINE,        // Baseline instruction set (SSE2, 128-bit)
+  BATCH_KERNEL_AVX2,            // 256-bit, see batch_kernel_supported
+} batch_kernel_t;
+
+/* The state of one junction */
+typedef struct {
+  uint8_t state;                // traffic.c states
+  uint8_t next_state;
+  uint8_t stage;                // Stage of the active intersection
+  uint8_t running;              // BATCH_TIMx
+  uint32_t flags;               // ctrl_flag_t bits
+  uint32_t lamps;               // Shift register word (595_shiftreg.h)
+  uint16_t count[4];            // TIM3, TIM4, TIM5, TIM15 counters
+  uint32_t phase_changes;
+} batch_junction_t;
+
+/* All junctions, one array per field, padded to whole vectors */
+typedef struct {
+  uint32_t count;               // Junctions
+  uint32_t padded;              // ... rounded up to BATCH_LANES
+  uint32_t tick_counts;         // Timer counts per tick
+
+  uint32_t *state;
+  uint32_t *next_state;
+  uint32_t *stage;
+  uint32_t *running;
+  uint32_t *flags;
+  uint32_t *lamps;
+  uint32_t *tim3;
+  uint32_t *tim4;
+  uint32_t *tim5;
+  uint32_t *tim15;
+  uint32_t *phase_changes;
+
+  uint32_t *cars;               // Inputs, set before each step
+  uint32_t *buttons;            // ... cleared by the step
+} batch_t;
+
+/* Exported functions -------------------------------------------------------*/
+bool batch_init(batch_t *batch, uint32_t count, uint32_t tick_us);
+void batch_free(batch_t *batch);
+void batch_set(batch_t *batch, uint32_t index, const batch_junction_t *junction);
+void batch_get(const batch_t *batch, uint32_t index, batch_junction_t *junction);
+void batch_step(batch_t *batch, batch_kernel_t kernel);
+bool batch_kernel_supported(batch_kernel_t kernel);
+
+#endif
@@ -0,0 +1,62 @@
+/**************************************************************************//**
+ * @file     calendar.h
+ * @brief    Header for calendar.c file
+ *
+ * @details  Calendar queue (R. Brown, 1988): a priority queue of timed
+ *           events for the event-driven simulation. The time axis is cut
+ *           into buckets of equal width that wrap around like the days of
+ *           a year, every bucket holds its events sorted. The width follows
+ *           the spacing of the events and the number of buckets follows
+ *           their number, so a bucket holds about one event and push and
+ *           pop take constant time on average.
+ *
+ *           Events of the same time are popped in the order they were
+ *           pushed, a push passes the others of its time: with many events
+ *           per unit of time the times should be finer. An event may not be
+ *           earlier than the last one popped.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported types -----------------------------------------------------------*/
+typedef struct {
+  uint64_t time;
+  uint32_t id;                  // What the event is for, the caller's
+  uint32_t next;                // Next event in the bucket
+} calendar_event_t;
+
+typedef struct {
+  calendar_event_t *events;     // Pool, the unused ones in a free list
+  uint32_t capacity;
+  uint32_t free;
+  uint32_t *buckets;            // First event of every bucket
+  uint32_t bucket_count;        // Power of 2
+  uint64_t width;               // Time per bucket
+  uint32_t size;                // Events queued
+  uint32_t current;             // Bucket of the last event popped
+  uint64_t current_end;         // ... and the end of its time slot
+  uint64_t last;                // Time of the last event popped
+  uint32_t ops;                 // Pushes and pops since the last check
+  uint64_t steps;               // ... and their work
+  uint64_t resizes;
+} calendar_t;
+
+/* Exported functions -------------------------------------------------------*/
+bool calendar_init(calendar_t *cal, uint32_t capacity);
+void calendar_free(calendar_t *cal);
+bool calendar_push(calendar_t *cal, uint64_t time, uint32_t id);
+bool calendar_pop(calendar_t *cal, uint64_t *time, uint32_t *id);
+uint32_t calendar_size(const calendar_t *cal);
+
+#endif
@@ -0,0 +1,95 @@
+/**************************************************************************//**
+ * @file     grid.h
+ * @brief    Header for grid.c file
+ *
+ * @details  City-grid simulation: one instance of the traffic light firmware
+ *           per junction of a rows x cols grid, connected by links with a
+ *           travel time.
+ *
+ *           Every junction has the four approaches of the board (car sensor
+ *           1-4 = from the north, west, south and east) and its two
+ *           crosswalks. Vehicles enter at the edge of the grid, queue at the
+ *           stop line (the car sensor is active while the queue is not
+ *           empty), leave one per headway while their signal is green and
+ *           drive straight on to the next junction, where they arrive one
+ *           travel time later. Pedestrians press the crosswalk buttons at
+ *           random.
+ *
+ *           The firmware runs unmodified in HIL mode (hil.h), inputs are
+ *           injected like the HIL stand-in does. Its writable data is
+ *           swapped per junction, see grid.c.
+ *
+ *           grid_tick and grid_controller run the junctions' firmware tick
+ *           by tick with given inputs instead, as the reference for the
+ *           batched controllers (batch.h). grid_step runs a single junction
+ *           the same way, but only in the ticks it can act in, for the
+ *           event-driven driver (des_main.c).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef GRID_H
+#define GRID_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "batch.h"
+
+/* Exported constants -------------------------------------------------------*/
+#define GRID_APPROACHES     4
+#define GRID_CROSSWALKS     2
+
+/* Worker processes at most */
+#define GRID_MAX_JOBS       64
+
+/* Vehicles on a link and in its queue, a full link blocks the departures
+ * into it (about 400m of road) */
+#define GRID_LANE_CAPACITY  64
+
+/* Exported types -----------------------------------------------------------*/
+typedef struct {
+  uint16_t rows;
+  uint16_t cols;
+  uint32_t travel_ms;           // Link travel time, at least 1s
+  uint32_t headway_ms;          // Between two departures on green
+  double rate;                  // Vehicles per hour per edge approach
+  double ped_rate;              // Button presses per hour per crosswalk
+  uint64_t seed;
+  uint16_t jobs;                // Worker processes, 0 or 1 runs in the caller
+} grid_config_t;
+
+typedef struct {
+  uint64_t entered;             // Vehicles that entered at the edge
+  uint64_t exited;              // Vehicles that left at the edge
+  uint64_t dropped;             // Not entered, the edge lane was full
+  uint64_t departures;          // Vehicles through a stop line
+  uint64_t blocked;             // Departures held back by a full link
+  uint64_t delay_us;            // Total time waiting at stop lines
+  uint64_t max_delay_us;
+  uint64_t presses;
+  uint64_t phase_changes;
+  uint64_t activations;         // Firmware runs (events handled)
+} grid_stats_t;
+
+/* Exported functions -------------------------------------------------------*/
+bool grid_init(const grid_config_t *config);
+void grid_run(uint64_t until_us);
+uint64_t grid_time_us(void);
+void grid_stats(grid_stats_t *stats);
+void grid_write_csv(FILE *out);
+void grid_tick(uint32_t first, uint32_t count, uint32_t tick_us,
+               const uint32_t *cars, const uint32_t *buttons);
+bool grid_step(uint32_t index, uint64_t idle_us, uint32_t tick_us, uint32_t cars,
+               uint32_t buttons, uint64_t *wake_ticks);
+void grid_controller(uint32_t index, batch_junction_t *junction);
+uint32_t grid_context_size(void);
+void grid_free(void);
+
+#endif
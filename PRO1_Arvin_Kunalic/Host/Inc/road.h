@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     road.h
+ * @brief    Header for road.c file
+ *
+ * @details  Vehicles on the approaches of junctions: a Nagel-Schreckenberg
+ *           cellular automaton per lane. A lane is a row of cells of 7.5 m
+ *           ending at the stop line, a cell is empty or holds one vehicle
+ *           and its speed in cells per step (a step is one second). Every
+ *           step, all vehicles at once:
+ *           - speed up by 1, up to the top speed,
+ *           - slow down to the free cells ahead, the stop line counts as a
+ *             vehicle while the lane's signal is not green,
+ *           - slow down by 1 at random (the slowdown chance),
+ *           - move; past the stop line they leave the lane.
+ *           Then a vehicle may enter at the first cell (the inflow chance).
+ *           The car sensor of the lane is active while a vehicle is on one
+ *           of the detector cells in front of the stop line.
+ *
+ *           The cells of ROAD_VECTOR lanes are interleaved, one byte per
+ *           lane and cell, so one vector holds the same cell of all of
+ *           them and the kernels update ROAD_VECTOR lanes per instruction.
+ *           The random numbers are drawn per cell for all lanes, so every
+ *           kernel gives the same result; the scalar one, vehicle by
+ *           vehicle, is the reference.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef ROAD_H
+#define ROAD_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Lanes per kernel iteration, one 256-bit vector of bytes */
+#define ROAD_VECTOR         32
+
+/* Top speed at most, cells per step (5 = 135 km/h) */
+#define ROAD_MAX_SPEED      5
+
+/* Exported types -----------------------------------------------------------*/
+typedef enum {
+  ROAD_KERNEL_SCALAR,           // Vehicle by vehicle, the reference
+  ROAD_KERNEL_BASELINE,         // Baseline instruction set (SSE2, 128-bit)
+  ROAD_KERNEL_AVX2,             // 256-bit, see road_kernel_supported
+} road_kernel_t;
+
+typedef struct {
+  uint16_t cells;               // Before the stop line, 7.5 m each
+  uint8_t speed;                // Top speed, 1 to ROAD_MAX_SPEED
+  uint8_t slowdown;             // Chance of the random slowdown, in 1/256
+  uint8_t inflow;               // Chance of a vehicle entering, in 1/256
+  uint8_t detector;             // Cells in front of the stop line sensed
+  uint64_t seed;
+} road_config_t;
+
+/* All lanes, in groups of ROAD_VECTOR */
+typedef struct {
+  road_config_t config;
+  uint32_t count;               // Lanes
+  uint32_t groups;
+  uint32_t rows;                // Cells per lane and the ones past the line
+
+  uint8_t *cells;               // [group][row][lane], 0 empty, else speed + 1
+  uint8_t *next;                // ... the step being computed
+  uint8_t *stop;                // [lane] 0xFF while not green, set per step
+  uint8_t *present;             // [lane] 0xFF while the car sensor is active
+  uint32_t *entered;            // [lane] vehicles in
+  uint32_t *departed;           // [lane] vehicles out over the stop line
+  uint64_t *random;             // [group][4] xorshift64 per 8 lanes
+  uint64_t updates;             // Vehicles moved, counted by the scalar kernel
+} road_t;
+
+/* Exported functions -------------------------------------------------------*/
+bool road_init(road_t *road, uint32_t count, const road_config_t *config);
+void road_free(road_t *road);
+void road_set_green(road_t *road, uint32_t lane, bool green);
+void road_step(road_t *road, road_kernel_t kernel);
+bool road_present(const road_t *road, uint32_t lane);
+uint32_t road_vehicles(const road_t *road, uint32_t lane);
+bool road_equal(const road_t *a, const road_t *b);
+bool road_kernel_supported(road_kernel_t kernel);
+
+#endif
@@ -0,0 +1,42 @@
+/**************************************************************************//**
+ * @file     sim.h
+ * @brief    Header for sim_hal.c file
+ *
+ * @details  Simulated time and peripherals of the host build. The firmware
+ *           runs on a single thread, "interrupts" are delivered by
+ *           sim_advance between two passes of the state machine (and during
+ *           HAL_Delay), in the order of their NVIC priorities.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef SIM_H
+#define SIM_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Exported constants -------------------------------------------------------*/
+
+/* Simulated time of one pass of the main loop */
+#define SIM_STEP_US         100
+
+/* Timer input clock (APB1/APB2 at 80MHz) */
+#define SIM_TIMER_CLOCK_MHZ 80
+
+/* Exported functions -------------------------------------------------------*/
+void sim_advance(uint32_t us);
+uint64_t sim_time_us(void);
+void sim_pace(void);
+
+int sim_uart_open(const char *link);
+void sim_uart_close(void);
+
+uint32_t sim_lamps(void);
+
+#endif
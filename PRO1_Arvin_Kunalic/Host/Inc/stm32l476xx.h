@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ * @file     stm32l476xx.h
+ * @brief    Host replacement, everything is declared in stm32l4xx_hal.h.
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef SIM_STM32L476XX_H
+#define SIM_STM32L476XX_H
+
+#include "stm32l4xx_hal.h"
+
+#endif
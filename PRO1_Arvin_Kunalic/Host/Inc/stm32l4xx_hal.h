@@ -0,0 +1,273 @@
+/**************************************************************************//**
+ * @file     stm32l4xx_hal.h
+ * @brief    Host replacement of the STM32L4 HAL.
+ *
+ * @details  Shadows the real HAL header in the host build, so the firmware
+ *           sources in Core/Src compile unchanged on Linux. Only the parts of
+ *           the HAL and CMSIS used by the firmware are provided:
+ *           - GPIO, EXTI and TIM are small register structs that the
+ *             simulator (sim_hal.c) reads and updates.
+ *           - SPI transfers are recorded, UART traffic goes to a pty.
+ *           - The Cortex-M intrinsics are plain loads and stores, the
+ *             simulator runs every "interrupt" on the same thread.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      sim.h
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef STM32L4xx_HAL_H
+#define STM32L4xx_HAL_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Common -------------------------------------------------------------------*/
+#define __IO                volatile
+
+typedef enum {
+  HAL_OK = 0x00,
+  HAL_ERROR = 0x01,
+  HAL_BUSY = 0x02,
+  HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY       0xFFFFFFFFU
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* Cortex-M intrinsics ------------------------------------------------------*/
+extern volatile uint32_t sim_ipsr;
+
+static inline uint32_t __LDREXW(volatile uint32_t *addr) { return *addr; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { *addr = value; return 0; }
+static inline void __CLREX(void) { }
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __ISB(void) { }
+static inline void __NOP(void) { }
+static inline uint32_t __get_IPSR(void) { return sim_ipsr; }
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void) { }
+
+/* GPIO ---------------------------------------------------------------------*/
+typedef struct {
+  __IO uint32_t IDR;
+  __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef enum {
+  GPIO_PIN_RESET = 0U,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0          ((uint16_t)0x0001)
+#define GPIO_PIN_1          ((uint16_t)0x0002)
+#define GPIO_PIN_2          ((uint16_t)0x0004)
+#define GPIO_PIN_3          ((uint16_t)0x0008)
+#define GPIO_PIN_4          ((uint16_t)0x0010)
+#define GPIO_PIN_5          ((uint16_t)0x0020)
+#define GPIO_PIN_6          ((uint16_t)0x0040)
+#define GPIO_PIN_7          ((uint16_t)0x0080)
+#define GPIO_PIN_8          ((uint16_t)0x0100)
+#define GPIO_PIN_9          ((uint16_t)0x0200)
+#define GPIO_PIN_10         ((uint16_t)0x0400)
+#define GPIO_PIN_11         ((uint16_t)0x0800)
+#define GPIO_PIN_12         ((uint16_t)0x1000)
+#define GPIO_PIN_13         ((uint16_t)0x2000)
+#define GPIO_PIN_14         ((uint16_t)0x4000)
+#define GPIO_PIN_15         ((uint16_t)0x8000)
+
+extern GPIO_TypeDef sim_gpio[3];
+#define GPIOA               (&sim_gpio[0])
+#define GPIOB               (&sim_gpio[1])
+#define GPIOC               (&sim_gpio[2])
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* EXTI ---------------------------------------------------------------------*/
+typedef struct {
+  __IO uint32_t IMR1;
+  __IO uint32_t EMR1;
+  __IO uint32_t RTSR1;
+  __IO uint32_t FTSR1;
+  __IO uint32_t SWIER1;
+  __IO uint32_t PR1;
+} EXTI_TypeDef;
+
+extern EXTI_TypeDef sim_exti;
+#define EXTI                (&sim_exti)
+
+#define __HAL_GPIO_EXTI_GENERATE_SWIT(__EXTI_LINE__)  (EXTI->SWIER1 |= (__EXTI_LINE__))
+
+/* TIM ----------------------------------------------------------------------*/
+typedef struct {
+  __IO uint32_t CR1;
+  __IO uint32_t DIER;
+  __IO uint32_t SR;
+  __IO uint32_t EGR;
+  __IO uint32_t CNT;
+  __IO uint32_t PSC;
+  __IO uint32_t ARR;
+} TIM_TypeDef;
+
+#define TIM_CR1_CEN         0x0001U
+#define TIM_CR1_URS         0x0004U
+#define TIM_DIER_UIE        0x0001U
+#define TIM_SR_UIF          0x0001U
+#define TIM_EGR_UG          0x0001U
+#define TIM_FLAG_UPDATE     TIM_SR_UIF
+#define TIM_IT_UPDATE       TIM_DIER_UIE
+
+typedef struct {
+  uint32_t Prescaler;
+  uint32_t CounterMode;
+  uint32_t Period;
+  uint32_t ClockDivision;
+  uint32_t RepetitionCounter;
+  uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+  TIM_TypeDef *Instance;
+  TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+extern TIM_TypeDef sim_tim[5];
+#define TIM3                (&sim_tim[0])
+#define TIM4                (&sim_tim[1])
+#define TIM5                (&sim_tim[2])
+#define TIM7                (&sim_tim[3])
+#define TIM15               (&sim_tim[4])
+
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)             ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) ((__HANDLE__)->Instance->CNT = (__COUNTER__))
+#define __HAL_TIM_GetCounter                          __HAL_TIM_GET_COUNTER
+#define __HAL_TIM_SetCounter                          __HAL_TIM_SET_COUNTER
+#define __HAL_TIM_SET_PRESCALER(__HANDLE__, __PRESC__) ((__HANDLE__)->Instance->PSC = (__PRESC__))
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+  do {                                                       \
+    (__HANDLE__)->Instance->ARR = (__AUTORELOAD__);          \
+    (__HANDLE__)->Init.Period = (__AUTORELOAD__);            \
+  } while (0)
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__)    ((__HANDLE__)->Instance->SR = ~(__FLAG__))
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/* SPI ----------------------------------------------------------------------*/
+typedef struct {
+  uint32_t id;
+} SPI_TypeDef;
+
+typedef struct {
+  SPI_TypeDef *Instance;
+} SPI_HandleTypeDef;
+
+extern SPI_TypeDef sim_spi[2];
+#define SPI2                (&sim_spi[0])
+#define SPI3                (&sim_spi[1])
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+/* DMA and UART -------------------------------------------------------------*/
+typedef struct {
+  void *Instance;
+} DMA_HandleTypeDef;
+
+typedef struct {
+  uint32_t id;
+} USART_TypeDef;
+
+typedef enum {
+  HAL_UART_STATE_RESET = 0x00U,
+  HAL_UART_STATE_READY = 0x20U,
+  HAL_UART_STATE_BUSY_TX = 0x21U,
+  HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_ORE  0x00000008U
+
+typedef struct {
+  USART_TypeDef *Instance;
+  DMA_HandleTypeDef *hdmatx;
+  DMA_HandleTypeDef *hdmarx;
+  __IO HAL_UART_StateTypeDef gState;
+  __IO HAL_UART_StateTypeDef RxState;
+  __IO uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+extern USART_TypeDef sim_usart2;
+#define USART2              (&sim_usart2)
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+/* RCC, PWR and FLASH (SystemClock_Config) ----------------------------------*/
+typedef struct {
+  uint32_t PLLState;
+  uint32_t PLLSource;
+  uint32_t PLLM;
+  uint32_t PLLN;
+  uint32_t PLLP;
+  uint32_t PLLQ;
+  uint32_t PLLR;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+  uint32_t OscillatorType;
+  uint32_t HSIState;
+  uint32_t HSICalibrationValue;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+  uint32_t ClockType;
+  uint32_t SYSCLKSource;
+  uint32_t AHBCLKDivider;
+  uint32_t APB1CLKDivider;
+  uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define PWR_REGULATOR_VOLTAGE_SCALE1    1U
+#define RCC_OSCILLATORTYPE_HSI          0x02U
+#define RCC_HSI_ON                      1U
+#define RCC_HSICALIBRATION_DEFAULT      16U
+#define RCC_PLL_ON                      2U
+#define RCC_PLLSOURCE_HSI               2U
+#define RCC_PLLP_DIV7                   7U
+#define RCC_PLLQ_DIV2                   2U
+#define RCC_PLLR_DIV2                   2U
+#define RCC_CLOCKTYPE_SYSCLK            0x01U
+#define RCC_CLOCKTYPE_HCLK              0x02U
+#define RCC_CLOCKTYPE_PCLK1             0x04U
+#define RCC_CLOCKTYPE_PCLK2             0x08U
+#define RCC_SYSCLKSOURCE_PLLCLK         3U
+#define RCC_SYSCLK_DIV1                 0U
+#define RCC_HCLK_DIV1                   0U
+#define FLASH_LATENCY_4                 4U
+
+HAL_StatusTypeDef HAL_PWREx_ControlVoltageScaling(uint32_t VoltageScaling);
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+
+#endif
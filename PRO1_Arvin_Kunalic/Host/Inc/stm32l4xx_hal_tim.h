@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ * @file     stm32l4xx_hal_tim.h
+ * @brief    Host replacement, everything is declared in stm32l4xx_hal.h.
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef SIM_STM32L4XX_HAL_TIM_H
+#define SIM_STM32L4XX_HAL_TIM_H
+
+#include "stm32l4xx_hal.h"
+
+#endif
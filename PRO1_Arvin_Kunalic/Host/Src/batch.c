@@ -0,0 +1,686 @@
+/**************************************************************************//**
+ * @file     batch.c
+ * @brief    Batched controllers, one kernel for all junctions.
+ *
+ * @details  The kernel works on BATCH_LANES junctions at a time, one 32-bit
+ *           lane each, with the vector types of GCC. It has no branches on
+ *           the state: every 'if' of the firmware becomes a lane mask, both
+ *           sides are computed and the mask selects (SEL). A lane takes
+ *           exactly the path the firmware would, the others are masked off.
+ *           The two intersections are symmetric, so the flags of the active
+ *           side are found by shifting with the side (the flag pairs of
+ *           ctrl_state.h are adjacent bits) instead of branching on it.
+ *
+ *           The kernel is compiled twice: for the baseline instruction set
+ *           (SSE2 on x86-64, every vector op is two 128-bit ops) and for
+ *           AVX2 (target attribute, chosen at run time).
+ *
+ *           One tick, in the order of the simulated HAL (sim_hal.c):
+ *           - the running timers count, TIM3 and TIM5 may overflow,
+ *           - the EXTI interrupts: car sensor levels and button presses,
+ *           - the timer interrupts: TIM3 (blue light) and TIM5 (walk time),
+ *           - one pass of the state machine (Traffic_step).
+ *
+ *           Every lamp write takes the 10 ms latch delay of shift_out
+ *           (HAL_Delay), on the board as in the simulation: the timers go on
+ *           counting, and during a write of the state machine the timer
+ *           interrupts run. The kernel follows that write by write, the
+ *           only loop on data is the one over pending interrupts (deliver).
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      batch.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "595_shiftreg.h"
+#include "ctrl_state.h"
+#include "timer_config.h"
+#include "sim.h"
+#include "batch.h"
+
+/* Defines ------------------------------------------------------------------*/
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86           1
+#else
+#define BATCH_X86           0
+#endif
+
+#define US_PER_COUNT        (TIMER_PRESCALER / SIM_TIMER_CLOCK_MHZ)
+
+#define INLINE              static inline __attribute__((always_inline))
+
+/* Lane operations: every lane set to a value, lane-wise select (all ones in
+ * the mask takes 'a'), all ones in the non-zero lanes, no lane set */
+#define SPLAT(value)        ((vec_t){0} + (uint32_t)(value))
+#define SEL(mask, a, b)     (((a) & (mask)) | ((b) & ~(mask)))
+#define ANY(value)          ((vec_t)((value) != 0))
+#define NONE(value)         ({ const vec_t v_ = (value); uint32_t r_ = 0;           \
+                               for (int i_ = 0; i_ < BATCH_LANES; i_++) r_ |= v_[i_]; \
+                               r_ == 0; })
+
+/* The latch delay of shift_out (595_shiftreg.c) */
+#define LATCH_US            10000
+
+/* States of traffic.c */
+#define INTERSECTION1       0
+#define INTERSECTION2       1
+#define WAIT20S             2
+#define WAIT30S             3
+
+/* Flags, the Intersection1/crosswalk 1 bit of each pair: the bit of side s
+ * (0 = Intersection1, 1 = Intersection2) is the bit shifted by s */
+#define F(flag)             (1u << (flag))
+#define CARS_1              (F(FLAG_CAR1_ACTIVE) | F(FLAG_CAR3_ACTIVE))
+#define HIT_1               F(FLAG_PL1_SW_HIT)
+#define GREEN_1             F(FLAG_INTERSECTION1_GREEN)
+#define RED_1               F(FLAG_INTERSECTION1_RED)
+#define WALK_1              F(FLAG_CROSSWALK1_GREEN)
+#define STOP_1              F(FLAG_CROSSWALK1_RED)
+#define HITS                (F(FLAG_PL1_SW_HIT) | F(FLAG_PL2_SW_HIT))
+
+/* Lamps of the intersections; the pedestrian lamps of crosswalk 2 are the
+ * ones of crosswalk 1 shifted down by 8 */
+#define GREENS_1            (TL1_Green | TL3_Green)
+#define YELLOWS_1           (TL1_Yellow | TL3_Yellow)
+#define REDS_1              (TL1_Red | TL3_Red)
+#define GREENS_2            (TL2_Green | TL4_Green)
+#define YELLOWS_2           (TL2_Yellow | TL4_Yellow)
+#define REDS_2              (TL2_Red | TL4_Red)
+
+/* Types --------------------------------------------------------------------*/
+typedef uint32_t vec_t __attribute__((vector_size(BATCH_LANES * 4), may_alias));
+
+/* BATCH_LANES junctions in registers; masks are all ones or zero per lane */
+typedef struct {
+  vec_t state;
+  vec_t next;
+  vec_t stage;
+  vec_t running;
+  vec_t flags;
+  vec_t lamps;
+  vec_t count3;
+  vec_t count4;
+  vec_t count5;
+  vec_t count15;
+  vec_t phase_changes;
+  vec_t update3;                // Pending interrupts (UIF)
+  vec_t update5;
+} lanes_t;
+
+/* Variables ----------------------------------------------------------------*/
+
+/* Delays and timer periods of timer_config.h, in counts */
+static struct {
+  uint32_t step;
+  uint32_t orange;
+  uint32_t pedestrian;
+  uint32_t red_max;
+  uint32_t green;
+  uint32_t period3;
+  uint32_t period4;
+  uint32_t period5;
+  uint32_t period15;
+  uint32_t latch;
+} timing;
+
+/* Functions: kernel --------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Counts one timer, with the wrap-around at its period.
+ * @version 1.0
+ * @param   vec_t *counter, The counters.
+ * @param   vec_t on, Lanes where the timer runs.
+ * @param   vec_t counts, Counts to add.
+ * @param   uint32_t period, The auto-reload value.
+ * @return  vec_t, Lanes where it overflowed.
+ *****************************************************************************/
+INLINE vec_t count_timer(vec_t *counter, vec_t on, vec_t counts, uint32_t period) {
+  *counter += counts & on;
+  const vec_t over = on & (vec_t)(*counter > period);
+  *counter -= over & (period + 1);
+  return over;
+}
+
+/**************************************************************************//**
+ * @brief   Lets time pass: the running timers count (count_timers).
+ * @details Overflows of TIM3 and TIM5 make their interrupt pending.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, Lanes where the time passes.
+ * @param   vec_t counts, Timer counts.
+ * @return  None
+ *****************************************************************************/
+INLINE void pass_time(lanes_t *l, vec_t mask, vec_t counts) {
+  l->update3 |= count_timer(&l->count3, mask & ANY(l->running & BATCH_TIM3), counts, timing.period3);
+  count_timer(&l->count4, mask & ANY(l->running & BATCH_TIM4), counts, timing.period4);
+  l->update5 |= count_timer(&l->count5, mask & ANY(l->running & BATCH_TIM5), counts, timing.period5);
+  count_timer(&l->count15, mask & ANY(l->running & BATCH_TIM15), counts, timing.period15);
+}
+
+/**************************************************************************//**
+ * @brief   Stops a timer and sets its counter to 0 (stop_and_resetTimer).
+ * @version 1.0
+ * @param   vec_t *counter, The counters.
+ * @param   vec_t *running, The running timers.
+ * @param   vec_t mask, The lanes.
+ * @param   uint32_t timer, BATCH_TIMx.
+ * @return  None
+ *****************************************************************************/
+INLINE void stop_and_reset(vec_t *counter, vec_t *running, vec_t mask, uint32_t timer) {
+  *counter &= ~mask;
+  *running &= ~(mask & timer);
+}
+
+/**************************************************************************//**
+ * @brief   Writes the lamps from an interrupt (buffer_to_SPI).
+ * @details The latch delay passes, the interrupts it makes pending wait.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, The lanes.
+ * @param   vec_t lamps, The new lamps.
+ * @return  None
+ *****************************************************************************/
+INLINE void isr_write(lanes_t *l, vec_t mask, vec_t lamps) {
+  l->lamps = SEL(mask, lamps, l->lamps);
+  pass_time(l, mask, SPLAT(timing.latch));
+}
+
+/**************************************************************************//**
+ * @brief   pedestrian_blink_elapsed, the TIM3 interrupt.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, Lanes where it runs.
+ * @return  None
+ *****************************************************************************/
+INLINE void blink_isr(lanes_t *l, vec_t mask) {
+  /* Served requests, crosswalk 1 then 2 */
+  vec_t served = mask & ANY(l->flags & HIT_1) & ANY(l->flags & WALK_1);
+  isr_write(l, served, l->lamps & ~PL1_Blue);
+  l->flags &= ~(served & HIT_1);
+  served = mask & ANY(l->flags & (HIT_1 << 1)) & ANY(l->flags & (WALK_1 << 1));
+  isr_write(l, served, l->lamps & ~PL2_Blue);
+  l->flags &= ~(served & (HIT_1 << 1));
+
+  /* toggle_pedestrian of the first waiting one */
+  const vec_t wait1 = mask & ANY(l->flags & HIT_1) & ANY(l->flags & STOP_1);
+  const vec_t wait2 = mask & ~wait1 & ANY(l->flags & (HIT_1 << 1)) & ANY(l->flags & (STOP_1 << 1));
+  const vec_t toggle = wait1 | wait2;
+  const vec_t blue = SEL(wait1, SPLAT(PL1_Blue), SPLAT(PL2_Blue));
+  const vec_t lit = ANY(l->flags & F(FLAG_BLUE_ON));
+  isr_write(l, toggle, SEL(lit, l->lamps & ~blue, l->lamps | blue));
+  l->flags ^= toggle & F(FLAG_BLUE_ON);
+
+  /* None left, the timer stops */
+  const vec_t idle = mask & ~toggle & (vec_t)((l->flags & HITS) == 0);
+  stop_and_reset(&l->count3, &l->running, idle, BATCH_TIM3);
+  l->update3 &= ~idle;
+}
+
+/**************************************************************************//**
+ * @brief   walk_time_elapsed, the TIM5 interrupt.
+ * @details stop_pedestrian on the green side, then the timer stops.
+ *          Without one the timer keeps running.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, Lanes where it runs.
+ * @return  None
+ *****************************************************************************/
+INLINE void walk_isr(lanes_t *l, vec_t mask) {
+  for (uint32_t crosswalk = 0; crosswalk < 2; crosswalk++) {
+    const vec_t over = mask & ANY(l->flags & (WALK_1 << crosswalk))
+                       & ANY(l->flags & (GREEN_1 << crosswalk));
+
+    l->flags = SEL(over, (l->flags & ~(WALK_1 << crosswalk)) | (STOP_1 << crosswalk), l->flags);
+    isr_write(l, over, l->lamps & ~(PL1_Green >> (crosswalk * 8)));
+    isr_write(l, over, l->lamps | (PL1_Red >> (crosswalk * 8)));
+    stop_and_reset(&l->count5, &l->running, over, BATCH_TIM5);
+    l->update5 &= ~over;
+    mask &= ~over;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs the pending timer interrupts (deliver_interrupts).
+ * @details TIM3 before TIM5, until none is pending: the latch delay in an
+ *          interrupt can make the other one pending.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, The lanes.
+ * @return  None
+ *****************************************************************************/
+INLINE void deliver(lanes_t *l, vec_t mask) {
+  for (;;) {
+    const vec_t run3 = mask & l->update3;
+    const vec_t run5 = mask & ~run3 & l->update5;
+
+    if (NONE(run3 | run5)) {
+      return;
+    }
+    l->update3 &= ~run3;
+    blink_isr(l, run3);
+    l->update5 &= ~run5;
+    walk_isr(l, run5);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Writes the lamps from the state machine (set_pin, clear_pin).
+ * @details The interrupts that become pending in the latch delay run
+ *          before it returns, as HAL_Delay in the main loop lets them.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, The lanes.
+ * @param   vec_t lamps, The new lamps.
+ * @return  None
+ *****************************************************************************/
+INLINE void write(lanes_t *l, vec_t mask, vec_t lamps) {
+  isr_write(l, mask, lamps);
+  deliver(l, mask);
+}
+
+/**************************************************************************//**
+ * @brief   stop_pedestrian and go_pedestrian of 595_shiftreg.c.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, The lanes.
+ * @param   vec_t stop, Crosswalk that turns red, 0 or 1.
+ * @param   vec_t go, Crosswalk that turns green.
+ * @return  None
+ *****************************************************************************/
+INLINE void swap_pedestrians(lanes_t *l, vec_t mask, vec_t stop, vec_t go) {
+  if (NONE(mask)) {
+    return;
+  }
+
+  const vec_t shift_stop = stop << 3;
+  const vec_t shift_go = go << 3;
+
+  l->flags = SEL(mask, (l->flags & ~(WALK_1 << stop)) | (STOP_1 << stop), l->flags);
+  write(l, mask, l->lamps & ~(SPLAT(PL1_Green) >> shift_stop));
+  write(l, mask, l->lamps | (SPLAT(PL1_Red) >> shift_stop));
+
+  l->flags = SEL(mask, (l->flags | (WALK_1 << go)) & ~(STOP_1 << go), l->flags);
+  write(l, mask, l->lamps & ~(SPLAT(PL1_Red) >> shift_go));
+  write(l, mask, l->lamps | (SPLAT(PL1_Green) >> shift_go));
+  l->running |= (mask & ANY(l->flags & HITS)) & BATCH_TIM5;
+}
+
+/**************************************************************************//**
+ * @brief   One step of stop_intersection or go_intersection.
+ * @details TIM4 is stopped and reset, one colour is cleared and the next
+ *          one set.
+ * @version 1.0
+ * @param   lanes_t *l, The junctions.
+ * @param   vec_t mask, The lanes.
+ * @param   vec_t from, Lamps to clear.
+ * @param   vec_t to, Lamps to set.
+ * @return  None
+ *****************************************************************************/
+INLINE void change_lights(lanes_t *l, vec_t mask, vec_t from, vec_t to) {
+  if (NONE(mask)) {
+    return;
+  }
+  stop_and_reset(&l->count4, &l->running, mask, BATCH_TIM4);
+  write(l, mask, l->lamps & ~from);
+  write(l, mask, l->lamps | to);
+}
+
+/**************************************************************************//**
+ * @brief   Advances BATCH_LANES junctions by one tick.
+ * @details Follows traffic.c, clock.c and 595_shiftreg.c statement by
+ *          statement; the comments name the firmware function. Within a
+ *          case of the state machine the masked updates run in the order
+ *          of the firmware, as later conditions read what earlier ones
+ *          (and the interrupts during the latch delays) changed.
+ * @version 1.0
+ * @param   batch_t *batch, The junctions.
+ * @param   uint32_t i, The first lane, a multiple of BATCH_LANES.
+ * @return  None
+ *****************************************************************************/
+INLINE void step_lanes(batch_t *batch, uint32_t i) {
+  lanes_t lanes = {
+    .state = *(vec_t *)&batch->state[i],
+    .next = *(vec_t *)&batch->next_state[i],
+    .stage = *(vec_t *)&batch->stage[i],
+    .running = *(vec_t *)&batch->running[i],
+    .flags = *(vec_t *)&batch->flags[i],
+    .lamps = *(vec_t *)&batch->lamps[i],
+    .count3 = *(vec_t *)&batch->tim3[i],
+    .count4 = *(vec_t *)&batch->tim4[i],
+    .count5 = *(vec_t *)&batch->tim5[i],
+    .count15 = *(vec_t *)&batch->tim15[i],
+    .phase_changes = *(vec_t *)&batch->phase_changes[i],
+  };
+  lanes_t *const l = &lanes;
+  const vec_t all = ~(vec_t){0};
+  const vec_t cars = *(vec_t *)&batch->cars[i];
+  const vec_t buttons = *(vec_t *)&batch->buttons[i];
+
+  /* sim_advance: the timers count, then the interrupts run */
+  pass_time(l, all, SPLAT(batch->tick_counts));
+
+  /* HAL_GPIO_EXTI_Callback: car sensors follow the level, a button counts
+   * while its crosswalk is red and it has not been pressed yet */
+  l->flags = (l->flags & ~BATCH_CARS) | (cars & BATCH_CARS);
+  const vec_t request = (buttons << 4) & ~l->flags & (l->flags >> 8) & HITS;
+  l->flags |= request;
+  l->running |= ANY(request) & (BATCH_TIM3 | BATCH_TIM4);
+
+  deliver(l, all);
+
+  /* Traffic_step */
+  l->phase_changes -= (vec_t)(l->next != l->state);
+  l->state = l->next;
+
+  const vec_t intersection = (vec_t)(l->state <= INTERSECTION2);
+  const vec_t side = l->state & 1;              // Active side a
+  const vec_t other = side ^ 1;                 // Inactive side b
+  const vec_t on2 = ANY(side);
+  const vec_t greens_a = SEL(on2, SPLAT(GREENS_2), SPLAT(GREENS_1));
+  const vec_t yellows_a = SEL(on2, SPLAT(YELLOWS_2), SPLAT(YELLOWS_1));
+  const vec_t reds_a = SEL(on2, SPLAT(REDS_2), SPLAT(REDS_1));
+  const vec_t greens_b = SEL(on2, SPLAT(GREENS_1), SPLAT(GREENS_2));
+  const vec_t yellows_b = SEL(on2, SPLAT(YELLOWS_1), SPLAT(YELLOWS_2));
+  const vec_t reds_b = SEL(on2, SPLAT(REDS_1), SPLAT(REDS_2));
+
+  const vec_t stage0 = intersection & (vec_t)(l->stage == 0);
+  const vec_t stage1 = intersection & (vec_t)(l->stage == 1);
+  const vec_t stage2 = intersection & (vec_t)(l->stage == 2);
+
+  /* Stage 0: skipped if side a is green already */
+  vec_t green_a = ANY(l->flags & (GREEN_1 << side));
+  l->stage = SEL(stage0 & green_a, SPLAT(1), l->stage);
+  const vec_t switching = stage0 & ~green_a;
+
+  /* stop_intersection(b) while it is not red */
+  const vec_t stopping = switching & ~ANY(l->flags & (RED_1 << other));
+  const vec_t stop_yellow = ANY(l->flags & F(FLAG_STOP_YELLOW));
+  const vec_t to_yellow = stopping & ~stop_yellow & (vec_t)(l->count4 >= timing.step);
+  const vec_t to_red = stopping & stop_yellow & (vec_t)(l->count4 >= timing.orange);
+  change_lights(l, to_yellow | to_red, SEL(to_yellow, greens_b, yellows_b),
+                SEL(to_yellow, yellows_b, reds_b));
+  l->running |= (to_yellow | to_red) & BATCH_TIM4;
+  l->flags = SEL(to_yellow, (l->flags & ~(GREEN_1 << other)) | F(FLAG_STOP_YELLOW), l->flags);
+  l->flags = SEL(to_red, (l->flags | (RED_1 << other)) & ~F(FLAG_STOP_YELLOW), l->flags);
+
+  /* Once b is red for pedestrian_Delay: stop_pedestrian(a), go_pedestrian(b) */
+  const vec_t crossing = switching & ANY(l->flags & (RED_1 << other))
+                         & (vec_t)(l->count4 >= timing.pedestrian);
+  stop_and_reset(&l->count4, &l->running, crossing, BATCH_TIM4);
+  swap_pedestrians(l, crossing, side, other);
+  l->running |= crossing & BATCH_TIM4;
+  l->stage = SEL(crossing, SPLAT(1), l->stage);
+
+  /* Stage 1: go_intersection(a), then stage 2 once it is green */
+  const vec_t starting = (stage1 | crossing) & ANY(l->flags & (STOP_1 << side));
+  green_a = ANY(l->flags & (GREEN_1 << side));
+  const vec_t going = starting & ~green_a;
+  const vec_t go_yellow = ANY(l->flags & F(FLAG_GO_YELLOW));
+  const vec_t from_red = going & ~go_yellow & (vec_t)(l->count4 >= timing.step);
+  const vec_t to_green = going & go_yellow & (vec_t)(l->count4 >= timing.orange);
+  change_lights(l, from_red | to_green, SEL(from_red, reds_a, yellows_a),
+                SEL(from_red, yellows_a, greens_a));
+  l->running |= from_red & BATCH_TIM4;
+  l->flags = SEL(from_red, (l->flags & ~(RED_1 << side)) | F(FLAG_GO_YELLOW), l->flags);
+  l->flags = SEL(to_green, (l->flags | (GREEN_1 << side)) & ~F(FLAG_GO_YELLOW), l->flags);
+
+  const vec_t green = starting & green_a;
+  stop_and_reset(&l->count4, &l->running, green, BATCH_TIM4);
+  l->stage = SEL(green, SPLAT(2), l->stage);
+
+  /* Stage 2: a pedestrian, no cars, cars on both sides or only on b */
+  const vec_t pedestrian = stage2 & ANY(l->flags & (HIT_1 << side));
+  vec_t rest = stage2 & ~pedestrian;
+  const vec_t no_cars = rest & (vec_t)((l->flags & BATCH_CARS) == 0);
+  rest &= ~no_cars;
+  const vec_t cars_a = ANY(l->flags & (CARS_1 << side));
+  const vec_t cars_b = ANY(l->flags & (CARS_1 << other));
+  const vec_t both = rest & cars_a & cars_b;
+  const vec_t only_b = rest & ~cars_a & cars_b;
+
+  l->next = SEL(pedestrian | only_b, other, l->next);
+  l->next = SEL(no_cars, SPLAT(WAIT30S), l->next);
+  l->next = SEL(both, SPLAT(WAIT20S), l->next);
+  l->stage = SEL(pedestrian | no_cars | both | only_b, SPLAT(0), l->stage);
+  l->running |= (pedestrian | only_b) & BATCH_TIM4;
+  l->running |= (no_cars | both) & BATCH_TIM15;
+
+  /* Wait20s and Wait30s */
+  const vec_t wait20 = (vec_t)(l->state == WAIT20S);
+  const vec_t wait30 = (vec_t)(l->state == WAIT30S);
+  const vec_t green1 = ANY(l->flags & GREEN_1);
+  const vec_t green2 = ANY(l->flags & (GREEN_1 << 1));
+
+  /* Wait30s: a car is back, stay on the green side */
+  const vec_t car = wait30 & ANY(l->flags & BATCH_CARS);
+  stop_and_reset(&l->count15, &l->running, car, BATCH_TIM15);
+  l->next = SEL(car & green1, SPLAT(INTERSECTION1), l->next);
+  l->next = SEL(car & ~green1 & green2, SPLAT(INTERSECTION2), l->next);
+  const vec_t waiting = wait20 | (wait30 & ~(car & (green1 | green2)));
+
+  /* A pedestrian on the green side switches right away */
+  const vec_t press1 = waiting & ANY(l->flags & HIT_1) & green1;
+  const vec_t press2 = waiting & ~press1 & ANY(l->flags & (HIT_1 << 1)) & green2;
+  stop_and_reset(&l->count15, &l->running, press1 | press2, BATCH_TIM15);
+  l->next = SEL(press1, SPLAT(INTERSECTION2), l->next);
+  l->next = SEL(press2, SPLAT(INTERSECTION1), l->next);
+
+  /* red_delay_Max or green_Delay over: the other side's turn */
+  rest = waiting & ~press1 & ~press2;
+  const vec_t limit = SEL(wait20, SPLAT(timing.red_max), SPLAT(timing.green));
+  const vec_t due = rest & (vec_t)(l->count15 >= limit);
+  const vec_t due1 = due & green1;
+  const vec_t due2 = due & ~green1 & green2;
+  stop_and_reset(&l->count15, &l->running, due, BATCH_TIM15);
+  l->running |= (due1 | due2) & BATCH_TIM4;
+  l->next = SEL(due1, SPLAT(INTERSECTION2), l->next);
+  l->next = SEL(due2, SPLAT(INTERSECTION1), l->next);
+  l->next = SEL(rest & ~due, l->state, l->next);
+
+  *(vec_t *)&batch->state[i] = l->state;
+  *(vec_t *)&batch->next_state[i] = l->next;
+  *(vec_t *)&batch->stage[i] = l->stage;
+  *(vec_t *)&batch->running[i] = l->running;
+  *(vec_t *)&batch->flags[i] = l->flags;
+  *(vec_t *)&batch->lamps[i] = l->lamps;
+  *(vec_t *)&batch->tim3[i] = l->count3;
+  *(vec_t *)&batch->tim4[i] = l->count4;
+  *(vec_t *)&batch->tim5[i] = l->count5;
+  *(vec_t *)&batch->tim15[i] = l->count15;
+  *(vec_t *)&batch->phase_changes[i] = l->phase_changes;
+  *(vec_t *)&batch->buttons[i] = (vec_t){0};
+}
+
+/**************************************************************************//**
+ * @brief   Advances all junctions by one tick, baseline instruction set.
+ * @version 1.0
+ * @param   batch_t *batch, The junctions.
+ * @return  None
+ *****************************************************************************/
+static void step_baseline(batch_t *batch) {
+  for (uint32_t i = 0; i < batch->padded; i += BATCH_LANES) {
+    step_lanes(batch, i);
+  }
+}
+
+#if BATCH_X86
+/**************************************************************************//**
+ * @brief   Advances all junctions by one tick with AVX2.
+ * @version 1.0
+ * @param   batch_t *batch, The junctions.
+ * @return  None
+ *****************************************************************************/
+__attribute__((target("avx2")))
+static void step_avx2(batch_t *batch) {
+  for (uint32_t i = 0; i < batch->padded; i += BATCH_LANES) {
+    step_lanes(batch, i);
+  }
+}
+#endif
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Allocates the junctions, in the state after Traffic_init.
+ * @details Takes the delays from timer_config.h as they are set now, for
+ *          every batch.
+ * @version 1.0
+ * @param   batch_t *batch, The batch.
+ * @param   uint32_t count, Number of junctions.
+ * @param   uint32_t tick_us, Simulated time per step, a multiple of the
+ *          timer count (500 us) up to the blue light period.
+ * @return  boolean, false for an unusable tick or out of memory.
+ *****************************************************************************/
+bool batch_init(batch_t *batch, uint32_t count, uint32_t tick_us) {
+  uint32_t **const fields[] = {
+    &batch->state, &batch->next_state, &batch->stage, &batch->running,
+    &batch->flags, &batch->lamps, &batch->tim3, &batch->tim4, &batch->tim5,
+    &batch->tim15, &batch->phase_changes, &batch->cars, &batch->buttons,
+  };
+
+  memset(batch, 0, sizeof(*batch));
+  timing.step = TIMER_2s;
+  timing.orange = orange_Delay;
+  timing.pedestrian = pedestrian_Delay;
+  timing.red_max = red_delay_Max;
+  timing.green = green_Delay;
+  timing.period3 = toggle_Freq;
+  timing.period4 = TIM4_PERIOD;
+  timing.period5 = walk_Time;
+  timing.period15 = TIM15_PERIOD;
+  timing.latch = LATCH_US / US_PER_COUNT;
+
+  if (count == 0 || tick_us == 0 || tick_us % US_PER_COUNT != 0
+      || tick_us / US_PER_COUNT > timing.period3 + 1) {
+    return false;
+  }
+  batch->count = count;
+  batch->padded = (count + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+  batch->tick_counts = tick_us / US_PER_COUNT;
+
+  for (uint32_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+    *fields[f] = aligned_alloc(sizeof(vec_t), batch->padded * sizeof(uint32_t));
+    if (*fields[f] == NULL) {
+      batch_free(batch);
+      return false;
+    }
+    memset(*fields[f], 0, batch->padded * sizeof(uint32_t));
+  }
+
+  const batch_junction_t start = {
+    .state = INTERSECTION2,
+    .next_state = INTERSECTION2,
+    .flags = GREEN_1 << 1 | WALK_1 | RED_1 | STOP_1 << 1,
+    .lamps = init_state,
+  };
+  for (uint32_t i = 0; i < batch->padded; i++) {
+    batch_set(batch, i, &start);
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Frees the junctions.
+ * @version 1.0
+ * @param   batch_t *batch, The batch.
+ * @return  None
+ *****************************************************************************/
+void batch_free(batch_t *batch) {
+  uint32_t *const fields[] = {
+    batch->state, batch->next_state, batch->stage, batch->running,
+    batch->flags, batch->lamps, batch->tim3, batch->tim4, batch->tim5,
+    batch->tim15, batch->phase_changes, batch->cars, batch->buttons,
+  };
+
+  for (uint32_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+    free(fields[f]);
+  }
+  memset(batch, 0, sizeof(*batch));
+}
+
+/**************************************************************************//**
+ * @brief   Sets the state of one junction.
+ * @version 1.0
+ * @param   batch_t *batch, The batch.
+ * @param   uint32_t index, The junction.
+ * @param   const batch_junction_t *junction, The state.
+ * @return  None
+ *****************************************************************************/
+void batch_set(batch_t *batch, uint32_t index, const batch_junction_t *junction) {
+  batch->state[index] = junction->state;
+  batch->next_state[index] = junction->next_state;
+  batch->stage[index] = junction->stage;
+  batch->running[index] = junction->running;
+  batch->flags[index] = junction->flags;
+  batch->lamps[index] = junction->lamps;
+  batch->tim3[index] = junction->count[0];
+  batch->tim4[index] = junction->count[1];
+  batch->tim5[index] = junction->count[2];
+  batch->tim15[index] = junction->count[3];
+  batch->phase_changes[index] = junction->phase_changes;
+}
+
+/**************************************************************************//**
+ * @brief   Reads the state of one junction.
+ * @version 1.0
+ * @param   const batch_t *batch, The batch.
+ * @param   uint32_t index, The junction.
+ * @param   batch_junction_t *junction, The state.
+ * @return  None
+ *****************************************************************************/
+void batch_get(const batch_t *batch, uint32_t index, batch_junction_t *junction) {
+  junction->state = batch->state[index];
+  junction->next_state = batch->next_state[index];
+  junction->stage = batch->stage[index];
+  junction->running = batch->running[index];
+  junction->flags = batch->flags[index];
+  junction->lamps = batch->lamps[index];
+  junction->count[0] = batch->tim3[index];
+  junction->count[1] = batch->tim4[index];
+  junction->count[2] = batch->tim5[index];
+  junction->count[3] = batch->tim15[index];
+  junction->phase_changes = batch->phase_changes[index];
+}
+
+/**************************************************************************//**
+ * @brief   Checks whether the CPU can run a kernel.
+ * @version 1.0
+ * @param   batch_kernel_t kernel, The kernel.
+ * @return  boolean, true if it can.
+ *****************************************************************************/
+bool batch_kernel_supported(batch_kernel_t kernel) {
+  if (kernel == BATCH_KERNEL_AVX2) {
+#if BATCH_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Advances all junctions by one tick.
+ * @details Set the inputs (cars, buttons) first, the buttons are cleared.
+ * @version 1.0
+ * @param   batch_t *batch, The junctions.
+ * @param   batch_kernel_t kernel, The kernel, see batch_kernel_supported.
+ * @return  None
+ *****************************************************************************/
+void batch_step(batch_t *batch, batch_kernel_t kernel) {
+#if BATCH_X86
+  if (kernel == BATCH_KERNEL_AVX2) {
+    step_avx2(batch);
+    return;
+  }
+#endif
+  step_baseline(batch);
+}
@@ -0,0 +1,244 @@
+/**************************************************************************//**
+ * @file     batch_main.c
+ * @brief    Main program of the batched controllers check and benchmark.
+ *
+ * @details  Steps a grid of junctions with random inputs twice, with the
+ *           firmware per junction (grid_tick) and with the batch kernels
+ *           (batch_step), and compares every junction after every tick.
+ *           Then each of them is timed alone on the same inputs and the
+ *           junction-ticks per second are printed:
+ *
+ *             build/traffic_batch [--rows N] [--cols N] [--ticks N]
+ *                                 [--tick MS] [--seed N] [--no-check]
+ *
+ *           The inputs are car sensors that change every 20s and presses
+ *           every 5 minutes per crosswalk, on average. Only the stepping is
+ *           timed, not the inputs.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "grid.h"
+#include "batch.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define CAR_CHANGE_MS       20000
+#define PRESS_MS            300000
+
+/* Variables ----------------------------------------------------------------*/
+static const char *const kernel_names[] = {"baseline", "avx2"};
+
+/* Functions ----------------------------------------------------------------*/
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--rows N] [--cols N] [--ticks N] [--tick MS] [--seed N]\n"
+                  "       [--no-check]\n", name);
+  exit(2);
+}
+
+static double wall_seconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/* Toggles car sensors and presses buttons, the chances per tick are in 2^-32 */
+static void make_inputs(uint64_t *random, batch_t *batch, uint32_t car_chance,
+                        uint32_t press_chance) {
+  for (uint32_t i = 0; i < batch->count; i++) {
+    for (uint8_t a = 0; a < 4; a++) {
+      if ((uint32_t)next_random(random) < car_chance) {
+        batch->cars[i] ^= 1u << a;
+      }
+    }
+    batch->buttons[i] = 0;
+    for (uint8_t c = 0; c < 2; c++) {
+      if ((uint32_t)next_random(random) < press_chance) {
+        batch->buttons[i] |= 1u << c;
+      }
+    }
+  }
+}
+
+static void copy_inputs(batch_t *to, const batch_t *from) {
+  memcpy(to->cars, from->cars, from->count * sizeof(uint32_t));
+  memcpy(to->buttons, from->buttons, from->count * sizeof(uint32_t));
+}
+
+static void load_from_grid(batch_t *batch) {
+  for (uint32_t i = 0; i < batch->count; i++) {
+    batch_junction_t junction;
+
+    grid_controller(i, &junction);
+    batch_set(batch, i, &junction);
+    batch->cars[i] = junction.flags & BATCH_CARS;
+    batch->buttons[i] = 0;
+  }
+}
+
+static bool same(const batch_junction_t *a, const batch_junction_t *b) {
+  return a->state == b->state && a->next_state == b->next_state
+         && a->stage == b->stage && a->running == b->running
+         && a->flags == b->flags && a->lamps == b->lamps
+         && memcmp(a->count, b->count, sizeof(a->count)) == 0
+         && a->phase_changes == b->phase_changes;
+}
+
+static void print_junction(const char *name, const batch_junction_t *j) {
+  fprintf(stderr, "  %-9s state %u->%u stage %u running %X flags %05lX lamps %06lX"
+                  " counts %u %u %u %u phases %lu\n",
+          name, j->state, j->next_state, j->stage, j->running,
+          (unsigned long)j->flags, (unsigned long)j->lamps, j->count[0],
+          j->count[1], j->count[2], j->count[3], (unsigned long)j->phase_changes);
+}
+
+int main(int argc, char **argv) {
+  grid_config_t config = {
+    .rows = 32,
+    .cols = 32,
+    .travel_ms = 30000,
+    .headway_ms = 2000,
+    .seed = 1,
+  };
+  uint32_t ticks = 30000;
+  uint32_t tick_ms = 10;
+  bool check = true;
+
+  for (int i = 1; i < argc; i++) {
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (strcmp(argv[i], "--no-check") == 0) {
+      check = false;
+      continue;
+    } else if (value == NULL) {
+      usage(argv[0]);
+    } else if (strcmp(argv[i], "--rows") == 0) {
+      config.rows = atoi(value);
+    } else if (strcmp(argv[i], "--cols") == 0) {
+      config.cols = atoi(value);
+    } else if (strcmp(argv[i], "--ticks") == 0) {
+      ticks = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--tick") == 0) {
+      tick_ms = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      config.seed = strtoull(value, NULL, 0);
+    } else {
+      usage(argv[0]);
+    }
+    i++;
+  }
+
+  const uint32_t count = (uint32_t)config.rows * config.cols;
+  const uint32_t tick_us = tick_ms * 1000;
+  const uint32_t car_chance = (uint32_t)(4294967296.0 * tick_ms / CAR_CHANGE_MS);
+  const uint32_t press_chance = (uint32_t)(4294967296.0 * tick_ms / PRESS_MS);
+  batch_t batches[2];
+  batch_t *const reference = &batches[BATCH_KERNEL_BASELINE];
+  const int kernels = batch_kernel_supported(BATCH_KERNEL_AVX2) ? 2 : 1;
+
+  if (!grid_init(&config)) {
+    fprintf(stderr, "batch: empty grid or out of memory\n");
+    return 1;
+  }
+  for (int k = 0; k < kernels; k++) {
+    if (!batch_init(&batches[k], count, tick_us)) {
+      fprintf(stderr, "batch: the tick has to be 1 to 125 ms\n");
+      return 1;
+    }
+  }
+  printf("%u junctions, %u ticks of %u ms, kernels: %s%s\n", count, ticks, tick_ms,
+         kernel_names[0], (kernels > 1) ? ", avx2" : "");
+
+  /* Lockstep: the firmware and the kernels from the same state, compared */
+  if (check) {
+    uint64_t random = config.seed * 0x9E3779B97F4A7C15ull | 1;
+
+    for (int k = 0; k < kernels; k++) {
+      load_from_grid(&batches[k]);
+    }
+    for (uint32_t t = 0; t < ticks; t++) {
+      make_inputs(&random, reference, car_chance, press_chance);
+      for (int k = 1; k < kernels; k++) {
+        copy_inputs(&batches[k], reference);
+      }
+      grid_tick(0, count, tick_us, reference->cars, reference->buttons);
+      for (int k = 0; k < kernels; k++) {
+        batch_step(&batches[k], (batch_kernel_t)k);
+      }
+
+      for (uint32_t i = 0; i < count; i++) {
+        batch_junction_t firmware;
+
+        grid_controller(i, &firmware);
+        for (int k = 0; k < kernels; k++) {
+          batch_junction_t batched;
+
+          batch_get(&batches[k], i, &batched);
+          if (!same(&firmware, &batched)) {
+            fprintf(stderr, "batch: junction %u differs after tick %u\n", i, t + 1);
+            print_junction("firmware", &firmware);
+            print_junction(kernel_names[k], &batched);
+            return 1;
+          }
+        }
+      }
+    }
+    printf("check: %llu junction-ticks identical\n", (unsigned long long)count * ticks);
+  }
+
+  /* Timing: each on its own, from the same state with the same inputs.
+   * The kernels first, the firmware is left where it is until its run */
+  double seconds[3] = {0};
+  for (int k = 0; k < kernels; k++) {
+    load_from_grid(&batches[k]);
+  }
+  for (int run = kernels; run >= 0; run--) {
+    batch_t *const batch = &batches[(run > 0) ? run - 1 : 0];
+    uint64_t random = (config.seed + 1) * 0x9E3779B97F4A7C15ull | 1;
+
+    if (run == 0) {
+      load_from_grid(batch);    // Only for the inputs
+    }
+    for (uint32_t t = 0; t < ticks; t++) {
+      make_inputs(&random, batch, car_chance, press_chance);
+
+      const double start = wall_seconds();
+      if (run == 0) {
+        grid_tick(0, count, tick_us, batch->cars, batch->buttons);
+      } else {
+        batch_step(batch, (batch_kernel_t)(run - 1));
+      }
+      seconds[run] += wall_seconds() - start;
+    }
+  }
+
+  const double junction_ticks = (double)count * ticks;
+  printf("%-9s %10.1f M junction-ticks/s\n", "firmware", junction_ticks / seconds[0] / 1e6);
+  for (int k = 0; k < kernels; k++) {
+    printf("%-9s %10.1f M junction-ticks/s  %6.1fx\n", kernel_names[k],
+           junction_ticks / seconds[k + 1] / 1e6, seconds[0] / seconds[k + 1]);
+  }
+
+  for (int k = 0; k < kernels; k++) {
+    batch_free(&batches[k]);
+  }
+  grid_free();
+  return 0;
+}
@@ -0,0 +1,359 @@
+/**************************************************************************//**
+ * @file     bench_main.c
+ * @brief    Host micro-benchmarks of the framebuffer and output kernels.
+ *
+ * @details  Times the pure computation of the firmware on the PC, with the
+ *           peripherals stubbed by the simulated HAL (sim_hal.c), so a change
+ *           to one of the kernels can be evaluated without flashing:
+ *
+ *           - draw_char:              One character into the framebuffer.
+ *           - draw_string:            A 19 character line into the
+ *                                     framebuffer, display_service sends it.
+ *           - draw_text_large:        A clock time in font_large (15x24,
+ *                                     run-length coded) at a row across
+ *                                     pages.
+ *           - draw_text_aligned:      A status line in font_small
+ *                                     (proportional), centered in the
+ *                                     screen width.
+ *           - fill_rect:              The whole screen inverted, 32-bit
+ *                                     spans.
+ *           - draw_line:              A line at a different angle every
+ *                                     call, corner to edge.
+ *           - blit_sprite:            icon_car over the framebuffer at a
+ *                                     row across pages.
+ *           - fmt_u32, snprintf_u32:  A counter right-aligned in 8
+ *                                     columns, with fmt.h and with the C
+ *                                     library for comparison.
+ *           - status_page_refresh:    One refresh of the status page with
+ *                                     one car icon changed.
+ *           - update_screen:          One frame to the (stubbed) SPI2.
+ *           - update_shiftreg_buffer: Packing of a 24-bit lamp word.
+ *           - set_pin, clear_pin:     Read-modify-write of the lamp word and
+ *                                     buffer_to_SPI (stubbed SPI3, simulated
+ *                                     HAL_Delay).
+ *           - traffic_step:           One pass of the sim main loop, an idle
+ *                                     Traffic_step (at most one display
+ *                                     page) and SIM_STEP_US of simulated
+ *                                     time.
+ *
+ *           Every benchmark is warmed up first, then the number of calls per
+ *           sample is doubled until a sample takes BENCH_SAMPLE_NS, so the
+ *           clock overhead is negligible. The result is the time per call in
+ *           nanoseconds, written in the result format of Tools/bench_report.py:
+ *
+ *             build/traffic_bench [-o FILE] [-n SAMPLES] [BENCH...]
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "dma.h"
+#include "spi.h"
+#include "tim.h"
+#include "usart.h"
+#include "gpio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "traffic_functions.h"
+#include "595_shiftreg.h"
+#include "ssd1306_config.h"
+#include "glyph.h"
+#include "gfx.h"
+#include "fmt.h"
+#include "assets.h"
+#include "status_page.h"
+#include "ctrl_state.h"
+#include "clock.h"
+#include "telemetry.h"
+#include "uart_stdio.h"
+#include "cmd_protocol.h"
+#include "sim.h"
+
+/* Defines ------------------------------------------------------------------*/
+/* Default number of samples per benchmark */
+#define BENCH_SAMPLES       200
+
+/* Wall time every benchmark runs before it is measured */
+#define BENCH_WARMUP_NS     20000000LL
+
+/* Shortest sample, the batch size grows until it is reached */
+#define BENCH_SAMPLE_NS     50000LL
+
+/* Types --------------------------------------------------------------------*/
+typedef struct {
+  const char *name;
+  void (*op)(uint32_t i);
+} bench_t;
+
+/* Variables ----------------------------------------------------------------*/
+static const char line[] = "Pedestrians can    ";
+
+/* Keeps the results of pure kernels from being optimized away */
+static volatile char bench_sink;
+
+/* Functions: kernels -------------------------------------------------------*/
+
+static void op_draw_char(uint32_t i) {
+  /* Walks over every text cell and printable character */
+  draw_char((i % 21) * 6, ((i / 21) % 8) * 8, 32 + i % 95);
+}
+
+static void op_draw_string(uint32_t i) {
+  draw_string(0, (i % 8) * 8, line);
+}
+
+static void op_draw_text_large(uint32_t i) {
+  draw_text(4 + i % 8, 20 + i % 8, &font_large, "12:34");
+}
+
+static void op_draw_text_aligned(uint32_t i) {
+  draw_text_aligned(0, (i % 8) * 8, OLED_WIDTH, &font_small,
+                    (i & 1) ? "Car1 active" : "Car1 inactive", TEXT_CENTER);
+}
+
+static void op_fill_rect(uint32_t i) {
+  (void)i;
+  fill_rect(0, 0, OLED_WIDTH, OLED_HEIGHT, GFX_INVERT);
+}
+
+static void op_draw_line(uint32_t i) {
+  const int16_t edge = i % (OLED_WIDTH + OLED_HEIGHT);
+
+  if (edge < OLED_WIDTH) {
+    draw_line(0, 0, edge, OLED_HEIGHT - 1, GFX_INVERT);
+  } else {
+    draw_line(0, 0, OLED_WIDTH - 1, edge - OLED_WIDTH, GFX_INVERT);
+  }
+}
+
+static void op_blit_sprite(uint32_t i) {
+  blit_sprite((i * 7) % (OLED_WIDTH - 16), 3 + i % 8, &icon_car, GFX_INVERT);
+}
+
+static void op_fmt_u32(uint32_t i) {
+  char text[FMT_U32_SIZE];
+
+  fmt_u32(text, i * 2654435761u >> (i % 32), 8, ' ');
+  bench_sink = text[7];
+}
+
+static void op_snprintf_u32(uint32_t i) {
+  char text[FMT_U32_SIZE];
+
+  snprintf(text, sizeof(text), "%8lu", (unsigned long)(i * 2654435761u >> (i % 32)));
+  bench_sink = text[7];
+}
+
+static void op_status_page_refresh(uint32_t i) {
+  flag_write(FLAG_CAR1_ACTIVE, i & 1);
+  status_page_refresh();
+}
+
+static void op_update_screen(uint32_t i) {
+  (void)i;
+  update_screen();
+}
+
+static void op_update_shiftreg_buffer(uint32_t i) {
+  update_shiftreg_buffer(i * 0x9E3779u & 0xFFFFFF);
+}
+
+static void op_set_pin(uint32_t i) {
+  /* Every pin once, then all of them are set and the word stays the same */
+  set_pin(1u << (i % 24));
+  if (i % 24 == 23) {
+    update_shiftreg_buffer(0);
+  }
+}
+
+static void op_clear_pin(uint32_t i) {
+  clear_pin(1u << (i % 24));
+  if (i % 24 == 23) {
+    update_shiftreg_buffer(0xFFFFFF);
+  }
+}
+
+static void op_traffic_step(uint32_t i) {
+  (void)i;
+  Traffic_step();
+  sim_advance(SIM_STEP_US);
+}
+
+static const bench_t benches[] = {
+  {"draw_char",              op_draw_char},
+  {"draw_string",            op_draw_string},
+  {"draw_text_large",        op_draw_text_large},
+  {"draw_text_aligned",      op_draw_text_aligned},
+  {"fill_rect",              op_fill_rect},
+  {"draw_line",              op_draw_line},
+  {"blit_sprite",            op_blit_sprite},
+  {"fmt_u32",                op_fmt_u32},
+  {"snprintf_u32",           op_snprintf_u32},
+  {"status_page_refresh",    op_status_page_refresh},
+  {"update_screen",          op_update_screen},
+  {"update_shiftreg_buffer", op_update_shiftreg_buffer},
+  {"set_pin",                op_set_pin},
+  {"clear_pin",              op_clear_pin},
+  {"traffic_step",           op_traffic_step},
+};
+
+/* Functions: harness -------------------------------------------------------*/
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_samples(const void *a, const void *b) {
+  const double x = *(const double *)a;
+  const double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/**************************************************************************//**
+ * @brief   Times a batch of calls.
+ * @version 1.0
+ * @param   const bench_t *bench, The benchmark.
+ * @param   uint32_t *i, Running call index, advanced by the batch size.
+ * @param   uint32_t batch, Number of calls.
+ * @return  int64_t, Elapsed wall time in nanoseconds.
+ *****************************************************************************/
+static int64_t run_batch(const bench_t *bench, uint32_t *i, uint32_t batch) {
+  const int64_t start = now_ns();
+
+  for (uint32_t n = 0; n < batch; n++) {
+    bench->op((*i)++);
+  }
+  return now_ns() - start;
+}
+
+/**************************************************************************//**
+ * @brief   Runs one benchmark and writes its result object.
+ * @version 1.0
+ * @param   const bench_t *bench, The benchmark.
+ * @param   uint32_t samples, Number of samples.
+ * @param   FILE *out, Receives the JSON object.
+ * @return  None
+ *****************************************************************************/
+static void run_bench(const bench_t *bench, uint32_t samples, FILE *out) {
+  double *data = malloc(samples * sizeof(double));
+  double total = 0;
+  uint32_t i = 0;
+  uint32_t batch = 1;
+  int64_t start;
+
+  if (data == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  start = now_ns();
+  while (now_ns() - start < BENCH_WARMUP_NS) {
+    run_batch(bench, &i, 64);
+  }
+  while (batch < (1u << 24) && run_batch(bench, &i, batch) < BENCH_SAMPLE_NS) {
+    batch *= 2;
+  }
+
+  for (uint32_t s = 0; s < samples; s++) {
+    data[s] = (double)run_batch(bench, &i, batch) / batch;
+    total += data[s];
+  }
+  qsort(data, samples, sizeof(data[0]), compare_samples);
+
+  fprintf(out, "{\"bench\": \"%s\", \"unit\": \"ns\", \"n\": %u, \"batch\": %u, "
+          "\"min\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f, \"mean\": %.2f}",
+          bench->name, samples, batch,
+          data[0], data[(samples - 1) * 50 / 100], data[(samples - 1) * 90 / 100],
+          data[(samples - 1) * 99 / 100], data[samples - 1], total / samples);
+  fprintf(stderr, "%-24s p50 %10.2f ns\n", bench->name, data[(samples - 1) * 50 / 100]);
+  free(data);
+}
+
+static bool selected(const char *name, int argc, char **argv, int first) {
+  if (first >= argc) {
+    return true;
+  }
+  for (int a = first; a < argc; a++) {
+    if (strcmp(argv[a], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-o FILE] [-n SAMPLES] [BENCH...]\n", name);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  FILE *out = stdout;
+  uint32_t samples = BENCH_SAMPLES;
+  const char *sep = "";
+  int first = 1;
+
+  while (first < argc && argv[first][0] == '-') {
+    if (strcmp(argv[first], "-o") == 0 && first + 1 < argc) {
+      out = fopen(argv[first + 1], "w");
+      if (out == NULL) {
+        perror(argv[first + 1]);
+        return 1;
+      }
+    } else if (strcmp(argv[first], "-n") == 0 && first + 1 < argc) {
+      samples = strtoul(argv[first + 1], NULL, 0);
+      if (samples == 0) {
+        usage(argv[0]);
+      }
+    } else {
+      usage(argv[0]);
+    }
+    first += 2;
+  }
+
+  /* Start-up as in main.c, USART2 stays unconnected */
+  SystemClock_Config();
+
+  MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_USART2_UART_Init();
+  telemetry_init();
+  uart_stdio_init();
+
+  MX_SPI3_Init();
+  MX_SPI2_Init();
+  MX_TIM3_Init();
+  MX_TIM4_Init();
+  MX_TIM5_Init();
+  MX_TIM15_Init();
+  cmd_protocol_init();
+
+  Traffic_init();
+
+  fprintf(out, "{\"suite\": \"host\", \"samples\": %u, \"build\": \"%s %s\", \"compiler\": \"%s\",\n"
+          " \"results\": [", samples, __DATE__, __TIME__, __VERSION__);
+  for (uint32_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+    if (!selected(benches[b].name, argc, argv, first)) {
+      continue;
+    }
+    fprintf(out, "%s\n  ", sep);
+    run_bench(&benches[b], samples, out);
+    sep = ",";
+  }
+  fprintf(out, "\n]}\n");
+
+  if (out != stdout) {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,348 @@
+/**************************************************************************//**
+ * @file     calendar.c
+ * @brief    Calendar queue of timed events.
+ *
+ * @details  The events live in one pool and are linked by index, so growing
+ *           the pool moves no links. A pop looks at the bucket of the last
+ *           event popped: if its first event falls into the current slot of
+ *           that bucket it is the earliest of all, otherwise the next bucket
+ *           and slot are tried. After a whole year of empty slots (the
+ *           events are far apart) the earliest first event of all buckets
+ *           is taken directly.
+ *
+ *           When the number of events passes twice the number of buckets,
+ *           or falls below half of it, the buckets are doubled or halved
+ *           and the events are sorted into them again. The new width is
+ *           three times the mean spacing of the next few events, leaving
+ *           out the gaps much larger than the mean (Brown's estimate).
+ *
+ *           The spacing can also change while the number of events stays
+ *           the same, a simulation that starts with its events spread out
+ *           settles into a different pattern. So the work of the pushes and
+ *           pops (events passed in a bucket, empty slots skipped) is
+ *           counted as well, and if it averages more than MAX_STEPS per
+ *           operation the events are sorted again with a new width. That
+ *           is checked once per bucket_count operations at most, which
+ *           keeps the sorting constant per operation, on average.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      calendar.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdlib.h>
+
+#include "calendar.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define NONE                UINT32_MAX
+#define MIN_BUCKETS         2
+
+/* Events the bucket width is estimated from */
+#define SAMPLE              25
+
+/* Work per push or pop above which the width is estimated again */
+#define MAX_STEPS           4
+#define MIN_OPS             64
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Returns the bucket of a time.
+ * @version 1.0
+ * @param   const calendar_t *cal, The queue.
+ * @param   uint64_t time, The time.
+ * @return  uint32_t, The bucket.
+ *****************************************************************************/
+static inline uint32_t bucket_of(const calendar_t *cal, uint64_t time) {
+  return (uint32_t)(time / cal->width) & (cal->bucket_count - 1);
+}
+
+/**************************************************************************//**
+ * @brief   Links an event into its bucket, in time order.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @param   uint32_t event, The event.
+ * @param   bool before_equal, Goes before the events of the same time
+ *          instead of after them.
+ * @return  None
+ *****************************************************************************/
+static void insert(calendar_t *cal, uint32_t event, bool before_equal) {
+  const uint64_t time = cal->events[event].time;
+  uint32_t *link = &cal->buckets[bucket_of(cal, time)];
+
+  while (*link != NONE
+         && (cal->events[*link].time < time
+             || (!before_equal && cal->events[*link].time == time))) {
+    link = &cal->events[*link].next;
+    cal->steps++;
+  }
+  cal->events[event].next = *link;
+  *link = event;
+}
+
+/**************************************************************************//**
+ * @brief   Unlinks the earliest event.
+ * @details The queue may not be empty. The event stays allocated.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @return  uint32_t, The event.
+ *****************************************************************************/
+static uint32_t take_first(calendar_t *cal) {
+  const uint32_t mask = cal->bucket_count - 1;
+
+  for (uint32_t n = 0; n < cal->bucket_count; n++) {
+    const uint32_t first = cal->buckets[cal->current];
+
+    if (first != NONE && cal->events[first].time < cal->current_end) {
+      cal->buckets[cal->current] = cal->events[first].next;
+      cal->last = cal->events[first].time;
+      return first;
+    }
+    cal->current = (cal->current + 1) & mask;
+    cal->current_end += cal->width;
+    cal->steps++;
+  }
+
+  /* A year without an event, to the earliest one directly */
+  uint32_t earliest = NONE;
+  for (uint32_t b = 0; b < cal->bucket_count; b++) {
+    const uint32_t first = cal->buckets[b];
+
+    if (first != NONE
+        && (earliest == NONE || cal->events[first].time < cal->events[earliest].time)) {
+      earliest = first;
+    }
+  }
+  const uint64_t time = cal->events[earliest].time;
+  cal->current = bucket_of(cal, time);
+  cal->current_end = (time / cal->width + 1) * cal->width;
+  cal->buckets[cal->current] = cal->events[earliest].next;
+  cal->last = time;
+  return earliest;
+}
+
+/**************************************************************************//**
+ * @brief   Estimates the bucket width from the next events.
+ * @details They are taken out and put back in their order.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @return  uint64_t, The width, the current one with too few events.
+ *****************************************************************************/
+static uint64_t sample_width(calendar_t *cal) {
+  const uint32_t n = (cal->size < SAMPLE) ? cal->size : SAMPLE;
+  const uint32_t current = cal->current;
+  const uint64_t current_end = cal->current_end;
+  const uint64_t last = cal->last;
+  uint32_t taken[SAMPLE];
+
+  if (n < 2) {
+    return cal->width;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    taken[i] = take_first(cal);
+  }
+  for (uint32_t i = n; i-- > 0;) {
+    insert(cal, taken[i], true);
+  }
+  cal->current = current;
+  cal->current_end = current_end;
+  cal->last = last;
+
+  const uint64_t mean = (cal->events[taken[n - 1]].time - cal->events[taken[0]].time) / (n - 1);
+  uint64_t sum = 0;
+  uint32_t gaps = 0;
+  for (uint32_t i = 1; i < n; i++) {
+    const uint64_t gap = cal->events[taken[i]].time - cal->events[taken[i - 1]].time;
+
+    if (gap <= 2 * mean) {
+      sum += gap;
+      gaps++;
+    }
+  }
+  return 3 * sum / gaps + 1;    // 1 if they are at the same times
+}
+
+/**************************************************************************//**
+ * @brief   Sorts the events into a new number of buckets.
+ * @details Keeps the old buckets if out of memory, which is only slower.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @param   uint32_t count, Buckets, a power of 2.
+ * @return  None
+ *****************************************************************************/
+static void resize(calendar_t *cal, uint32_t count) {
+  const uint64_t width = sample_width(cal);
+  uint32_t *old = cal->buckets;
+  const uint32_t old_count = cal->bucket_count;
+
+  if (count == old_count && width == cal->width) {
+    return;     // Crowded at the same times, sorting again would not help
+  }
+  cal->buckets = malloc(count * sizeof(uint32_t));
+  if (!cal->buckets) {
+    cal->buckets = old;
+    return;
+  }
+  for (uint32_t b = 0; b < count; b++) {
+    cal->buckets[b] = NONE;
+  }
+  cal->bucket_count = count;
+  cal->width = width;
+
+  /* In list order, so equal times keep theirs */
+  for (uint32_t b = 0; b < old_count; b++) {
+    uint32_t event = old[b];
+
+    while (event != NONE) {
+      const uint32_t next = cal->events[event].next;
+
+      insert(cal, event, false);
+      event = next;
+    }
+  }
+  free(old);
+
+  cal->current = bucket_of(cal, cal->last);
+  cal->current_end = (cal->last / width + 1) * width;
+  cal->resizes++;
+}
+
+/**************************************************************************//**
+ * @brief   Counts an operation and resizes the queue if needed.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @return  None
+ *****************************************************************************/
+static void account(calendar_t *cal) {
+  if (cal->size > 2 * cal->bucket_count) {
+    resize(cal, cal->bucket_count * 2);
+  } else if (cal->size < cal->bucket_count / 2 && cal->bucket_count > MIN_BUCKETS) {
+    resize(cal, cal->bucket_count / 2);
+  } else if (++cal->ops < cal->bucket_count || cal->ops < MIN_OPS) {
+    return;
+  } else if (cal->steps > MAX_STEPS * cal->ops) {
+    resize(cal, cal->bucket_count);
+  }
+  cal->ops = 0;
+  cal->steps = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Creates an empty queue.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @param   uint32_t capacity, Events expected at once, the pool grows.
+ * @return  boolean, false if out of memory.
+ *****************************************************************************/
+bool calendar_init(calendar_t *cal, uint32_t capacity) {
+  *cal = (calendar_t){
+    .capacity = (capacity > 0) ? capacity : 1,
+    .free = 0,
+    .bucket_count = MIN_BUCKETS,
+    .width = 1,
+    .current_end = 1,
+  };
+
+  cal->events = malloc(cal->capacity * sizeof(calendar_event_t));
+  cal->buckets = malloc(MIN_BUCKETS * sizeof(uint32_t));
+  if (!cal->events || !cal->buckets) {
+    calendar_free(cal);
+    return false;
+  }
+  for (uint32_t e = 0; e < cal->capacity; e++) {
+    cal->events[e].next = (e + 1 < cal->capacity) ? e + 1 : NONE;
+  }
+  for (uint32_t b = 0; b < MIN_BUCKETS; b++) {
+    cal->buckets[b] = NONE;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Frees a queue.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @return  None
+ *****************************************************************************/
+void calendar_free(calendar_t *cal) {
+  free(cal->events);
+  free(cal->buckets);
+  cal->events = NULL;
+  cal->buckets = NULL;
+  cal->size = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Adds an event.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @param   uint64_t time, When, not before the last event popped.
+ * @param   uint32_t id, What for.
+ * @return  boolean, false if the time has passed or out of memory.
+ *****************************************************************************/
+bool calendar_push(calendar_t *cal, uint64_t time, uint32_t id) {
+  if (time < cal->last) {
+    return false;
+  }
+
+  if (cal->free == NONE) {
+    const uint32_t capacity = cal->capacity * 2;
+    calendar_event_t *events = realloc(cal->events, capacity * sizeof(calendar_event_t));
+
+    if (!events) {
+      return false;
+    }
+    for (uint32_t e = cal->capacity; e < capacity; e++) {
+      events[e].next = (e + 1 < capacity) ? e + 1 : NONE;
+    }
+    cal->events = events;
+    cal->free = cal->capacity;
+    cal->capacity = capacity;
+  }
+
+  const uint32_t event = cal->free;
+  cal->free = cal->events[event].next;
+  cal->events[event].time = time;
+  cal->events[event].id = id;
+  insert(cal, event, false);
+  cal->size++;
+  account(cal);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Takes the earliest event out.
+ * @version 1.0
+ * @param   calendar_t *cal, The queue.
+ * @param   uint64_t *time, Its time.
+ * @param   uint32_t *id, Its id.
+ * @return  boolean, false if the queue is empty.
+ *****************************************************************************/
+bool calendar_pop(calendar_t *cal, uint64_t *time, uint32_t *id) {
+  if (cal->size == 0) {
+    return false;
+  }
+
+  const uint32_t event = take_first(cal);
+  *time = cal->events[event].time;
+  *id = cal->events[event].id;
+  cal->events[event].next = cal->free;
+  cal->free = event;
+  cal->size--;
+  account(cal);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the number of events queued.
+ * @version 1.0
+ * @param   const calendar_t *cal, The queue.
+ * @return  uint32_t, The events.
+ *****************************************************************************/
+uint32_t calendar_size(const calendar_t *cal) {
+  return cal->size;
+}
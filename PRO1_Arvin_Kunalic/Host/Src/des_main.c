@@ -0,0 +1,283 @@
+/**************************************************************************//**
+ * @file     des_main.c
+ * @brief    Main program of the event-driven controllers and their benchmark.
+ *
+ * @details  Runs the firmware of many junctions with random detector inputs
+ *           in two ways and times both:
+ *
+ *             fixed tick    every junction runs every tick (grid_tick)
+ *             event driven  a junction runs only in the ticks an event is
+ *                           for: one of its timers reaches a delay or
+ *                           overflows, or one of its inputs changes
+ *
+ *           Every junction has one event in a calendar queue (calendar.h),
+ *           the earlier of its next timer event and its next input. When it
+ *           is popped the junction runs that tick (grid_step), and the next
+ *           ones as long as they change the controller, then its next event
+ *           is pushed. The junctions of the two runs are separate copies
+ *           with the same inputs, so afterwards both have to be in the same
+ *           state, the counters of their timers included:
+ *
+ *             build/traffic_des [--junctions N] [--minutes N] [--tick MS]
+ *                               [--cars S] [--press S] [--seed N]
+ *
+ *           The inputs are a car sensor changing every 20s per approach and
+ *           a press every 5 minutes per crosswalk, on average.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "grid.h"
+#include "calendar.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define NEVER               UINT64_MAX
+
+/* Types --------------------------------------------------------------------*/
+
+/* Random inputs of one junction, the same sequence for both runs */
+typedef struct {
+  uint64_t random;
+  uint64_t next;                // Tick of the next input
+  uint32_t cars;
+} source_t;
+
+/* Variables ----------------------------------------------------------------*/
+static double car_rate;         // Changes per tick and approach
+static double press_rate;       // Presses per tick and crosswalk
+
+/* Functions ----------------------------------------------------------------*/
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--junctions N] [--minutes N] [--tick MS] [--cars S]\n"
+                  "       [--press S] [--seed N]\n", name);
+  exit(2);
+}
+
+static double wall_seconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1Dull;
+}
+
+static double uniform(uint64_t *state) {
+  return (next_random(state) >> 11) * 0x1p-53;
+}
+
+/* The inputs of all approaches and crosswalks are one Poisson process */
+static void source_next(source_t *source, uint64_t tick) {
+  const double rate = 4 * car_rate + 2 * press_rate;
+
+  source->next = tick + 1 + (uint64_t)(-log1p(-uniform(&source->random)) / rate);
+}
+
+static void source_init(source_t *source, uint64_t seed, uint32_t index) {
+  source->random = (seed + index + 1) * 0x9E3779B97F4A7C15ull | 1;
+  source->cars = 0;
+  source_next(source, 0);
+}
+
+/* The input of a tick, if it has one: a car sensor toggles or a press */
+static uint32_t source_take(source_t *source, uint64_t tick) {
+  if (source->next != tick) {
+    return 0;
+  }
+
+  const double which = uniform(&source->random) * (4 * car_rate + 2 * press_rate);
+  uint32_t buttons = 0;
+  if (which < 4 * car_rate) {
+    source->cars ^= 1u << (uint32_t)(which / car_rate);
+  } else {
+    buttons = 1u << ((which - 4 * car_rate < press_rate) ? 0 : 1);
+  }
+  source_next(source, tick);
+  return buttons;
+}
+
+static bool same(const batch_junction_t *a, const batch_junction_t *b) {
+  return a->state == b->state && a->next_state == b->next_state
+         && a->stage == b->stage && a->running == b->running
+         && a->flags == b->flags && a->lamps == b->lamps
+         && memcmp(a->count, b->count, sizeof(a->count)) == 0
+         && a->phase_changes == b->phase_changes;
+}
+
+static void print_junction(const char *name, const batch_junction_t *j) {
+  fprintf(stderr, "  %-6s state %u->%u stage %u running %X flags %05lX lamps %06lX"
+                  " counts %u %u %u %u phases %lu\n",
+          name, j->state, j->next_state, j->stage, j->running,
+          (unsigned long)j->flags, (unsigned long)j->lamps, j->count[0],
+          j->count[1], j->count[2], j->count[3], (unsigned long)j->phase_changes);
+}
+
+int main(int argc, char **argv) {
+  grid_config_t config = {
+    .rows = 2,
+    .cols = 100,
+    .travel_ms = 30000,
+    .headway_ms = 2000,
+    .seed = 1,
+  };
+  uint32_t minutes = 10;
+  uint32_t tick_ms = 1;
+  double car_s = 20;
+  double press_s = 300;
+
+  for (int i = 1; i < argc; i++) {
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (value == NULL) {
+      usage(argv[0]);
+    } else if (strcmp(argv[i], "--junctions") == 0) {
+      config.cols = atoi(value);
+    } else if (strcmp(argv[i], "--minutes") == 0) {
+      minutes = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--tick") == 0) {
+      tick_ms = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--cars") == 0) {
+      car_s = atof(value);
+    } else if (strcmp(argv[i], "--press") == 0) {
+      press_s = atof(value);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      config.seed = strtoull(value, NULL, 0);
+    } else {
+      usage(argv[0]);
+    }
+    i++;
+  }
+  if (tick_ms == 0 || car_s <= 0 || press_s <= 0) {
+    usage(argv[0]);
+  }
+
+  /* Row 0 runs with the fixed tick, row 1 event driven */
+  const uint32_t count = config.cols;
+  const uint32_t tick_us = tick_ms * 1000;
+  const uint64_t ticks = (uint64_t)minutes * 60000 / tick_ms;
+  source_t *sources = malloc(count * sizeof(source_t));
+  uint32_t *cars = calloc(count, sizeof(uint32_t));
+  uint32_t *buttons = calloc(count, sizeof(uint32_t));
+  uint64_t *last = calloc(count, sizeof(uint64_t));
+  calendar_t calendar;
+
+  car_rate = tick_ms / (car_s * 1000);
+  press_rate = tick_ms / (press_s * 1000);
+  if (!sources || !cars || !buttons || !last || !calendar_init(&calendar, count)
+      || !grid_init(&config)) {
+    fprintf(stderr, "des: no junctions or out of memory\n");
+    return 1;
+  }
+  printf("%u junctions, %u minutes of %u ms ticks, a car sensor change every %.0fs\n"
+         "per approach and a press every %.0fs per crosswalk\n",
+         count, minutes, tick_ms, car_s, press_s);
+
+  /* Fixed tick */
+  double start = wall_seconds();
+  for (uint32_t i = 0; i < count; i++) {
+    source_init(&sources[i], config.seed, i);
+  }
+  for (uint64_t t = 1; t <= ticks; t++) {
+    for (uint32_t i = 0; i < count; i++) {
+      buttons[i] = source_take(&sources[i], t);
+      cars[i] = sources[i].cars;
+    }
+    grid_tick(0, count, tick_us, cars, buttons);
+  }
+  const double fixed_seconds = wall_seconds() - start;
+
+  /* Event driven, every junction starts with a tick to find its timers */
+  uint64_t events = 0;
+  uint64_t passes = 0;
+
+  start = wall_seconds();
+  for (uint32_t i = 0; i < count; i++) {
+    source_init(&sources[i], config.seed, i);
+    calendar_push(&calendar, 1, i);
+  }
+  uint64_t t;
+  uint32_t i;
+  while (calendar_pop(&calendar, &t, &i) && t <= ticks) {
+    source_t *source = &sources[i];
+    uint64_t idle = t - last[i] - 1;
+    uint64_t wake;
+
+    events++;
+    for (;;) {
+      const uint32_t pressed = source_take(source, t);
+
+      passes++;
+      last[i] = t;
+      if (!grid_step(count + i, idle * tick_us, tick_us, source->cars, pressed, &wake)
+          || t == ticks) {
+        break;
+      }
+      idle = 0;
+      t++;
+    }
+
+    uint64_t next = (wake == NEVER) ? NEVER : last[i] + wake;
+    if (source->next < next) {
+      next = source->next;
+    }
+    if (next <= ticks) {
+      calendar_push(&calendar, next, i);
+    }
+  }
+  /* The time since the last event of every junction */
+  for (i = 0; i < count; i++) {
+    uint64_t wake;
+
+    if (last[i] < ticks) {
+      grid_step(count + i, (ticks - last[i] - 1) * tick_us, tick_us, sources[i].cars, 0, &wake);
+    }
+  }
+  const double event_seconds = wall_seconds() - start;
+
+  for (i = 0; i < count; i++) {
+    batch_junction_t fixed, driven;
+
+    grid_controller(i, &fixed);
+    grid_controller(count + i, &driven);
+    if (!same(&fixed, &driven)) {
+      fprintf(stderr, "des: junction %u differs\n", i);
+      print_junction("fixed", &fixed);
+      print_junction("events", &driven);
+      return 1;
+    }
+  }
+
+  const double junction_ticks = (double)count * ticks;
+  printf("check: %u junctions identical after %llu ticks\n", count, (unsigned long long)ticks);
+  printf("fixed tick    %9.3f s  %12.0f firmware passes\n", fixed_seconds, junction_ticks);
+  printf("event driven  %9.3f s  %12llu firmware passes  %6.1fx\n", event_seconds,
+         (unsigned long long)passes, fixed_seconds / event_seconds);
+  printf("%llu events, %.2f per junction and second, %.1f passes per event,"
+         " %llu queue resizes\n",
+         (unsigned long long)events, events / (count * minutes * 60.0),
+         (double)passes / events, (unsigned long long)calendar.resizes);
+
+  calendar_free(&calendar);
+  grid_free();
+  free(sources);
+  free(cars);
+  free(buttons);
+  free(last);
+  return 0;
+}
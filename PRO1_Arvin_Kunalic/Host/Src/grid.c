@@ -0,0 +1,982 @@
+/**************************************************************************//**
+ * @file     grid.c
+ * @brief    City-grid simulation engine.
+ *
+ * @details  One copy of the firmware is linked, but every junction has its
+ *           own. The firmware objects of the grid build (Makefile, GRID_SRC
+ *           and sim_hal.c) have their .data and .bss renamed to grid_data
+ *           and grid_bss, so the linker puts every writable variable of the
+ *           firmware and of its simulated peripherals into two ranges
+ *           (__start_grid_data ... __stop_grid_bss). That is the whole
+ *           state of one controller, under a kilobyte: context_load copies
+ *           a junction's context in, the firmware runs, context_save copies
+ *           it back out. Pointers into the state stay valid, it is always at
+ *           the same address.
+ *
+ *           Time advances in windows of one link travel time. A vehicle
+ *           leaving a junction in a window arrives at the next one in a
+ *           later window, so within a window every junction depends only on
+ *           itself and is run through the whole window at once: one context
+ *           swap per junction and window. The space left on a link is taken
+ *           from the start of the window, so the result does not depend on
+ *           the order the junctions are run in.
+ *
+ *           Within a window a junction is event driven. Its events are
+ *           vehicles reaching the stop line, departures on green, vehicles
+ *           entering at the edge, button presses and the timers of the
+ *           firmware: the state machine only acts when a running timer
+ *           crosses one of the delays of timer_config.h or overflows, so
+ *           the next such moment is computed from the timer registers
+ *           (next_timer_event) and nothing runs in between. After each
+ *           event the state machine is stepped until it is stable (settle).
+ *
+ *           The windows are what lets the grid run in parallel: the travel
+ *           time is the lookahead between neighbours, and the junctions of
+ *           a window can run in any order and at the same time. The grid is
+ *           cut into tiles of TILE x TILE junctions, each worker starts
+ *           with an equal run of tiles and, once it is through, takes the
+ *           tiles the others have not started yet (work stealing), so busy
+ *           and quiet parts of the city even out. A barrier ends every
+ *           window. The firmware state is one per process, so the workers
+ *           are processes (fork) sharing the junctions, the contexts and
+ *           the queues; the result does not depend on their number.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      grid.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "dma.h"
+#include "spi.h"
+#include "tim.h"
+#include "gpio.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include "traffic_functions.h"
+#include "595_shiftreg.h"
+#include "clock.h"
+#include "ctrl_state.h"
+#include "timer_config.h"
+#include "hil.h"
+#include "sim.h"
+#include "grid.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define NEVER               UINT64_MAX
+#define US_PER_HOUR         3600e6
+
+/* Passes of the state machine after an event before it is taken as stuck */
+#define SETTLE_STEPS        32
+
+/* Junctions per side of a tile, the unit of work of the workers */
+#define TILE                4
+
+/* Types --------------------------------------------------------------------*/
+typedef struct {
+  uint64_t time[GRID_LANE_CAPACITY];    // Arrival at the stop line
+  uint32_t sent;                        // Vehicles put on the link
+  uint32_t arrived;                     // ... that reached the stop line
+  uint32_t taken;                       // ... that left it
+  uint32_t taken_before;                // 'taken' at the start of the window
+  uint64_t departure;                   // Next departure, NEVER if none
+} lane_t;
+
+typedef struct {
+  lane_t lanes[GRID_APPROACHES];
+  uint64_t source[GRID_APPROACHES];     // Next vehicle entering, NEVER inside the grid
+  uint64_t press[GRID_CROSSWALKS];      // Next button press
+  uint64_t wake;                        // Next timer event of the firmware
+  uint32_t lamps;
+  uint64_t random;
+  /* Statistics */
+  uint64_t departures;
+  uint64_t delay_us;
+  uint64_t max_delay_us;
+  uint32_t max_queue;
+  uint32_t presses;
+} junction_t;
+
+/* What a pass of the state machine can change, no padding */
+typedef struct {
+  uint32_t flags;
+  uint32_t lamps;
+  uint32_t running;                     // CEN and UIE of each timer
+  uint8_t state;
+  uint8_t next_state;
+  uint8_t stage[2];
+} snapshot_t;
+
+/* The tiles a worker starts with, the others steal from the same counter */
+typedef struct {
+  uint32_t next;
+  uint32_t end;
+} __attribute__((aligned(64))) queue_t;
+
+/* Shared by the workers */
+typedef struct {
+  pthread_barrier_t start;              // A window begins, or quit
+  pthread_barrier_t done;               // ... and is finished
+  uint64_t end;                         // Window end, firmware time
+  bool quit;
+  queue_t queues[GRID_MAX_JOBS];
+  grid_stats_t totals[GRID_MAX_JOBS];   // Per worker, summed by grid_stats
+} pool_t;
+
+typedef enum {
+  EVENT_WAKE,
+  EVENT_ARRIVAL,
+  EVENT_DEPARTURE,
+  EVENT_SOURCE,
+  EVENT_PRESS,
+} event_t;
+
+/* Variables ----------------------------------------------------------------*/
+
+/* Writable data of the firmware objects, see the Makefile */
+extern uint8_t __start_grid_data[], __stop_grid_data[];
+extern uint8_t __start_grid_bss[], __stop_grid_bss[];
+
+static const uint16_t car_pins[GRID_APPROACHES] = {
+  TL1_Car_Pin, TL2_Car_Pin, TL3_Car_Pin, TL4_Car_Pin,
+};
+static const uint32_t green_lamps[GRID_APPROACHES] = {
+  TL1_Green, TL2_Green, TL3_Green, TL4_Green,
+};
+static const uint16_t button_pins[GRID_CROSSWALKS] = {
+  PL1_Switch_Pin, PL2_Switch_Pin,
+};
+
+static TIM_HandleTypeDef *const timers[] = {&htim3, &htim4, &htim5, &htim15};
+
+static grid_config_t config;
+static junction_t *junctions;
+static uint8_t *contexts;
+static uint32_t junction_count;
+static uint32_t data_size;
+static uint32_t context_size;
+static uint64_t start_us;               // Firmware time of the grid start
+static uint64_t now_us;                 // Start of the next window
+static pool_t *pool;
+static grid_stats_t *totals;            // This worker's
+static pid_t workers[GRID_MAX_JOBS];
+static uint32_t jobs;
+static uint32_t tile_cols;
+static uint32_t tile_count;
+
+/* Functions: context -------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Makes a junction's firmware the one that runs.
+ * @version 1.0
+ * @param   uint32_t index, The junction.
+ * @return  None
+ *****************************************************************************/
+static void context_load(uint32_t index) {
+  const uint8_t *context = &contexts[(size_t)index * context_size];
+
+  memcpy(__start_grid_data, context, data_size);
+  memcpy(__start_grid_bss, context + data_size, context_size - data_size);
+}
+
+/**************************************************************************//**
+ * @brief   Stores the running firmware as a junction's.
+ * @version 1.0
+ * @param   uint32_t index, The junction.
+ * @return  None
+ *****************************************************************************/
+static void context_save(uint32_t index) {
+  uint8_t *context = &contexts[(size_t)index * context_size];
+
+  memcpy(context, __start_grid_data, data_size);
+  memcpy(context + data_size, __start_grid_bss, context_size - data_size);
+}
+
+/* Functions: firmware ------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Takes what a pass of the state machine can change.
+ * @version 1.0
+ * @param   snapshot_t *snap, Filled in.
+ * @return  None
+ *****************************************************************************/
+static void snapshot(snapshot_t *snap) {
+  snap->flags = ctrl_state.flags;
+  snap->lamps = sim_lamps();
+  snap->running = 0;
+  for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+    snap->running = (snap->running << 2)
+                    | ((timers[i]->Instance->CR1 & TIM_CR1_CEN) ? 1u : 0u)
+                    | ((timers[i]->Instance->DIER & TIM_DIER_UIE) ? 2u : 0u);
+  }
+  snap->state = ctrl_state.state;
+  snap->next_state = ctrl_state.next_state;
+  snap->stage[0] = ctrl_state.stage[0];
+  snap->stage[1] = ctrl_state.stage[1];
+}
+
+/**************************************************************************//**
+ * @brief   Runs the pending interrupts and the state machine until a pass
+ *          changes nothing.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void settle(void) {
+  sim_advance(0);
+
+  for (uint8_t i = 0; i < SETTLE_STEPS; i++) {
+    snapshot_t before, after;
+
+    snapshot(&before);
+    Traffic_step();
+    sim_advance(SIM_STEP_US);
+    snapshot(&after);
+    if (memcmp(&before, &after, sizeof(before)) == 0) {
+      break;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Finds the next moment the firmware can act without an input.
+ * @details The first time a running timer reaches one of the delays the
+ *          state machine compares the counters against, or overflows
+ *          (TIM3 and TIM5 interrupts, wrap-around).
+ * @version 1.0
+ * @param   None
+ * @return  uint64_t, Firmware time in microseconds, NEVER if no timer runs.
+ *****************************************************************************/
+static uint64_t next_timer_event(void) {
+  const uint32_t delays[] = {
+    TIMER_2s, orange_Delay, pedestrian_Delay, red_delay_Max, green_Delay,
+  };
+  uint64_t wake = NEVER;
+
+  for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+    const TIM_TypeDef *tim = timers[i]->Instance;
+
+    if (!(tim->CR1 & TIM_CR1_CEN)) {
+      continue;
+    }
+
+    uint32_t target = tim->ARR + 1;
+    for (uint32_t d = 0; d < sizeof(delays) / sizeof(delays[0]); d++) {
+      if (delays[d] > tim->CNT && delays[d] < target) {
+        target = delays[d];
+      }
+    }
+
+    const uint64_t us = ((uint64_t)(target - tim->CNT) * (tim->PSC + 1)
+                         + SIM_TIMER_CLOCK_MHZ - 1) / SIM_TIMER_CLOCK_MHZ;
+    if (sim_time_us() + us < wake) {
+      wake = sim_time_us() + us;
+    }
+  }
+  return wake;
+}
+
+/* Functions: traffic -------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Returns the next pseudo-random number of a junction (xorshift64*).
+ * @version 1.0
+ * @param   uint64_t *state, The generator state, not 0.
+ * @return  uint64_t, The number.
+ *****************************************************************************/
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/**************************************************************************//**
+ * @brief   Draws the next event of a Poisson process.
+ * @version 1.0
+ * @param   uint64_t *state, The generator state.
+ * @param   uint64_t time, The last event.
+ * @param   double per_hour, Events per hour, none if 0.
+ * @return  uint64_t, Time of the next event, NEVER if per_hour is 0.
+ *****************************************************************************/
+static uint64_t poisson_next(uint64_t *state, uint64_t time, double per_hour) {
+  if (per_hour <= 0) {
+    return NEVER;
+  }
+  const double uniform = (next_random(state) >> 11) * 0x1p-53;
+  return time + (uint64_t)(-log1p(-uniform) * US_PER_HOUR / per_hour) + 1;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the lane a vehicle drives into after a junction.
+ * @details Straight on: from the north (approach 0) to the north approach
+ *          of the junction below, and so on.
+ * @version 1.0
+ * @param   uint32_t index, The junction.
+ * @param   uint8_t approach, The approach the vehicle came from.
+ * @return  lane_t *, The lane, NULL if the vehicle leaves the grid.
+ *****************************************************************************/
+static lane_t *downstream(uint32_t index, uint8_t approach) {
+  const uint32_t row = index / config.cols;
+  const uint32_t col = index % config.cols;
+
+  switch (approach) {
+    case 0:
+      return (row + 1 < config.rows) ? &junctions[index + config.cols].lanes[0] : NULL;
+    case 1:
+      return (col + 1 < config.cols) ? &junctions[index + 1].lanes[1] : NULL;
+    case 2:
+      return (row > 0) ? &junctions[index - config.cols].lanes[2] : NULL;
+    default:
+      return (col > 0) ? &junctions[index - 1].lanes[3] : NULL;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Sets the car sensor of an approach.
+ * @version 1.0
+ * @param   uint8_t approach, The approach.
+ * @param   bool present, A car is waiting at the stop line.
+ * @return  None
+ *****************************************************************************/
+static void set_detector(uint8_t approach, bool present) {
+  hil_inject(car_pins[approach], present ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+/**************************************************************************//**
+ * @brief   Reads the outputs of the firmware after it has run.
+ * @details Starts the departures of the approaches that turned green with
+ *          vehicles waiting, stops them on the others, and finds the next
+ *          timer event.
+ * @version 1.0
+ * @param   junction_t *junction, The junction.
+ * @return  None
+ *****************************************************************************/
+static void observe(junction_t *junction) {
+  junction->lamps = sim_lamps();
+  junction->wake = next_timer_event();
+
+  for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+    lane_t *lane = &junction->lanes[a];
+
+    if (!(junction->lamps & green_lamps[a])) {
+      lane->departure = NEVER;
+    } else if (lane->departure == NEVER && lane->arrived != lane->taken) {
+      lane->departure = sim_time_us() + (uint64_t)config.headway_ms * 1000;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Lets the first vehicle of a lane through the junction.
+ * @version 1.1
+ * @param   uint32_t index, The junction.
+ * @param   uint8_t approach, The approach.
+ * @param   uint64_t time, Now.
+ * @return  None
+ *****************************************************************************/
+static void depart(uint32_t index, uint8_t approach, uint64_t time) {
+  junction_t *junction = &junctions[index];
+  lane_t *lane = &junction->lanes[approach];
+  lane_t *next = downstream(index, approach);
+  const uint64_t headway = (uint64_t)config.headway_ms * 1000;
+
+  /* The space the next link had when the window started */
+  if (next && next->sent - next->taken_before >= GRID_LANE_CAPACITY) {
+    totals->blocked++;
+    lane->departure = time + headway;
+    return;
+  }
+
+  const uint64_t delay = time - lane->time[lane->taken % GRID_LANE_CAPACITY];
+  lane->taken++;
+  junction->departures++;
+  junction->delay_us += delay;
+  if (delay > junction->max_delay_us) {
+    junction->max_delay_us = delay;
+  }
+
+  if (next) {
+    /* Read by the junction of the next link, which may run at the same time */
+    next->time[next->sent % GRID_LANE_CAPACITY] = time + (uint64_t)config.travel_ms * 1000;
+    __atomic_store_n(&next->sent, next->sent + 1, __ATOMIC_RELEASE);
+  } else {
+    totals->exited++;
+  }
+
+  if (lane->arrived == lane->taken) {
+    lane->departure = NEVER;
+    set_detector(approach, false);
+  } else {
+    lane->departure = time + headway;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs a junction through the events before a time.
+ * @details Its context has to be loaded.
+ * @version 1.1
+ * @param   uint32_t index, The junction.
+ * @param   uint64_t end, End of the window, firmware time.
+ * @return  None
+ *****************************************************************************/
+static void junction_advance(uint32_t index, uint64_t end) {
+  junction_t *junction = &junctions[index];
+
+  for (;;) {
+    uint64_t time = junction->wake;
+    event_t event = EVENT_WAKE;
+    uint8_t which = 0;
+
+    for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+      const lane_t *lane = &junction->lanes[a];
+
+      if (lane->arrived != __atomic_load_n(&lane->sent, __ATOMIC_ACQUIRE) && lane->time[lane->arrived % GRID_LANE_CAPACITY] < time) {
+        time = lane->time[lane->arrived % GRID_LANE_CAPACITY];
+        event = EVENT_ARRIVAL;
+        which = a;
+      }
+      if (lane->departure < time) {
+        time = lane->departure;
+        event = EVENT_DEPARTURE;
+        which = a;
+      }
+      if (junction->source[a] < time) {
+        time = junction->source[a];
+        event = EVENT_SOURCE;
+        which = a;
+      }
+    }
+    for (uint8_t c = 0; c < GRID_CROSSWALKS; c++) {
+      if (junction->press[c] < time) {
+        time = junction->press[c];
+        event = EVENT_PRESS;
+        which = c;
+      }
+    }
+    if (time >= end) {
+      return;
+    }
+
+    /* The firmware may be ahead, busy in a HAL_Delay */
+    if (sim_time_us() < time) {
+      sim_advance(time - sim_time_us());
+    }
+
+    lane_t *lane = &junction->lanes[which];
+    switch (event) {
+      case EVENT_WAKE:
+        break;
+
+      case EVENT_SOURCE:
+        junction->source[which] = poisson_next(&junction->random, time, config.rate);
+        if (lane->sent - lane->taken >= GRID_LANE_CAPACITY) {
+          totals->dropped++;
+          continue;
+        }
+        totals->entered++;
+        lane->time[lane->sent % GRID_LANE_CAPACITY] = time;
+        lane->sent++;
+        /* Reaches the stop line right away */
+        /* fall through */
+
+      case EVENT_ARRIVAL: {
+        const uint32_t queue = ++lane->arrived - lane->taken;
+        if (queue > junction->max_queue) {
+          junction->max_queue = queue;
+        }
+        if (queue > 1) {
+          continue;     // The sensor is already active
+        }
+        set_detector(which, true);
+        break;
+      }
+
+      case EVENT_DEPARTURE:
+        depart(index, which, time);
+        break;
+
+      case EVENT_PRESS:
+        junction->press[which] = poisson_next(&junction->random, time, config.ped_rate);
+        junction->presses++;
+        hil_inject(button_pins[which], GPIO_PIN_RESET);
+        hil_inject(button_pins[which], GPIO_PIN_SET);
+        break;
+    }
+
+    totals->activations++;
+    settle();
+    observe(junction);
+  }
+}
+
+/* Functions: workers -------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Allocates memory the workers share.
+ * @version 1.0
+ * @param   size_t size, Bytes, zeroed.
+ * @return  void *, The memory, NULL if out of memory.
+ *****************************************************************************/
+static void *shared_alloc(size_t size) {
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+  return (memory == MAP_FAILED) ? NULL : memory;
+}
+
+/**************************************************************************//**
+ * @brief   Runs the junctions of a tile through the window.
+ * @version 1.0
+ * @param   uint32_t tile, The tile, row by row.
+ * @return  None
+ *****************************************************************************/
+static void run_tile(uint32_t tile) {
+  const uint32_t row = tile / tile_cols * TILE;
+  const uint32_t col = tile % tile_cols * TILE;
+
+  for (uint32_t r = row; r < row + TILE && r < config.rows; r++) {
+    for (uint32_t c = col; c < col + TILE && c < config.cols; c++) {
+      const uint32_t index = r * config.cols + c;
+
+      context_load(index);
+      junction_advance(index, pool->end);
+      context_save(index);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs tiles until none is left: its own first, then the others'.
+ * @version 1.0
+ * @param   uint32_t worker, The worker.
+ * @return  None
+ *****************************************************************************/
+static void work(uint32_t worker) {
+  for (uint32_t k = 0; k < jobs; k++) {
+    queue_t *queue = &pool->queues[(worker + k) % jobs];
+
+    for (;;) {
+      const uint32_t tile = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+
+      if (tile >= queue->end) {
+        break;
+      }
+      run_tile(tile);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   The main loop of a worker process, one window per turn.
+ * @version 1.0
+ * @param   uint32_t worker, The worker, 1 or more.
+ * @return  None
+ *****************************************************************************/
+static void worker_main(uint32_t worker) {
+#ifdef __linux__
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+  totals = &pool->totals[worker];
+
+  for (;;) {
+    pthread_barrier_wait(&pool->start);
+    if (pool->quit) {
+      _exit(0);
+    }
+    work(worker);
+    pthread_barrier_wait(&pool->done);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Starts the worker processes, the caller is worker 0.
+ * @version 1.0
+ * @param   None
+ * @return  boolean, false if they could not be started.
+ *****************************************************************************/
+static bool start_workers(void) {
+  pthread_barrierattr_t attr;
+
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_barrier_init(&pool->start, &attr, jobs);
+  pthread_barrier_init(&pool->done, &attr, jobs);
+  pthread_barrierattr_destroy(&attr);
+
+  for (uint32_t w = 1; w < jobs; w++) {
+    workers[w] = fork();
+    if (workers[w] < 0) {
+      /* The ones running wait at the barrier for all, stop them */
+      for (uint32_t v = 1; v < w; v++) {
+        kill(workers[v], SIGKILL);
+        waitpid(workers[v], NULL, 0);
+      }
+      jobs = 1;
+      return false;
+    }
+    if (workers[w] == 0) {
+      worker_main(w);
+    }
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Runs all junctions through one window, on all workers.
+ * @version 1.0
+ * @param   uint64_t end, End of the window, firmware time.
+ * @return  None
+ *****************************************************************************/
+static void run_window(uint64_t end) {
+  pool->end = end;
+  for (uint32_t w = 0; w < jobs; w++) {
+    pool->queues[w].next = (uint64_t)tile_count * w / jobs;
+    pool->queues[w].end = (uint64_t)tile_count * (w + 1) / jobs;
+  }
+
+  if (jobs > 1) {
+    pthread_barrier_wait(&pool->start);
+    work(0);
+    pthread_barrier_wait(&pool->done);
+  } else {
+    work(0);
+  }
+}
+
+/* Functions: grid ----------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Boots the firmware and gives every junction a copy of it.
+ * @details All controllers start in the same state, the random inputs set
+ *          them apart within the first cycles. The worker processes are
+ *          started last, with everything set up.
+ * @version 1.1
+ * @param   const grid_config_t *cfg, The grid.
+ * @return  boolean, false if the grid is empty, out of memory or the
+ *          workers could not be started.
+ *****************************************************************************/
+bool grid_init(const grid_config_t *cfg) {
+  config = *cfg;
+  junction_count = (uint32_t)config.rows * config.cols;
+  data_size = __stop_grid_data - __start_grid_data;
+  context_size = data_size + (__stop_grid_bss - __start_grid_bss);
+  jobs = (config.jobs == 0) ? 1 : config.jobs;
+  tile_cols = (config.cols + TILE - 1) / TILE;
+  tile_count = tile_cols * ((config.rows + TILE - 1) / TILE);
+
+  if (junction_count == 0 || config.travel_ms < 1000 || jobs > GRID_MAX_JOBS) {
+    return false;
+  }
+  junctions = shared_alloc(junction_count * sizeof(junction_t));
+  contexts = shared_alloc((size_t)junction_count * context_size);
+  pool = shared_alloc(sizeof(pool_t));
+  if (!junctions || !contexts || !pool) {
+    grid_free();
+    return false;
+  }
+  totals = &pool->totals[0];
+
+  /* Start-up of main.c, inputs from the grid */
+  SystemClock_Config();
+  MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_SPI3_Init();
+  MX_SPI2_Init();
+  MX_TIM3_Init();
+  MX_TIM4_Init();
+  MX_TIM5_Init();
+  MX_TIM15_Init();
+  Traffic_init();
+  hil_set_mode(true);
+  settle();
+
+  start_us = sim_time_us();
+  now_us = start_us;
+
+  for (uint32_t i = 0; i < junction_count; i++) {
+    junction_t *junction = &junctions[i];
+    const uint32_t row = i / config.cols;
+    const uint32_t col = i % config.cols;
+    const bool edge[GRID_APPROACHES] = {
+      row == 0, col == 0, row == config.rows - 1u, col == config.cols - 1u,
+    };
+
+    context_save(i);
+    junction->random = (config.seed + i + 1) * 0x9E3779B97F4A7C15ull | 1;
+    for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+      junction->lanes[a].departure = NEVER;
+      junction->source[a] = edge[a] ? poisson_next(&junction->random, start_us, config.rate) : NEVER;
+    }
+    for (uint8_t c = 0; c < GRID_CROSSWALKS; c++) {
+      junction->press[c] = poisson_next(&junction->random, start_us, config.ped_rate);
+    }
+    observe(junction);
+  }
+
+  if (jobs > 1 && !start_workers()) {
+    grid_free();
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Runs the grid, window by window.
+ * @version 1.1
+ * @param   uint64_t until_us, Time since the start to run to.
+ * @return  None
+ *****************************************************************************/
+void grid_run(uint64_t until_us) {
+  const uint64_t window = (uint64_t)config.travel_ms * 1000;
+  const uint64_t until = start_us + until_us;
+
+  while (now_us < until) {
+    const uint64_t end = (now_us + window < until) ? now_us + window : until;
+
+    run_window(end);
+    for (uint32_t i = 0; i < junction_count; i++) {
+      for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+        junctions[i].lanes[a].taken_before = junctions[i].lanes[a].taken;
+      }
+    }
+    now_us = end;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the simulated time.
+ * @version 1.0
+ * @param   None
+ * @return  uint64_t, Microseconds since the start.
+ *****************************************************************************/
+uint64_t grid_time_us(void) {
+  return now_us - start_us;
+}
+
+/**************************************************************************//**
+ * @brief   Sums the statistics of every junction.
+ * @version 1.1
+ * @param   grid_stats_t *stats, The result.
+ * @return  None
+ *****************************************************************************/
+void grid_stats(grid_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (uint32_t w = 0; w < jobs; w++) {
+    const grid_stats_t *worker = &pool->totals[w];
+
+    stats->entered += worker->entered;
+    stats->exited += worker->exited;
+    stats->dropped += worker->dropped;
+    stats->blocked += worker->blocked;
+    stats->activations += worker->activations;
+  }
+
+  for (uint32_t i = 0; i < junction_count; i++) {
+    const junction_t *junction = &junctions[i];
+
+    context_load(i);
+    stats->phase_changes += traffic_phase_changes();
+    stats->departures += junction->departures;
+    stats->delay_us += junction->delay_us;
+    stats->presses += junction->presses;
+    if (junction->max_delay_us > stats->max_delay_us) {
+      stats->max_delay_us = junction->max_delay_us;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Writes one line per junction, comma separated.
+ * @version 1.0
+ * @param   FILE *out, The file.
+ * @return  None
+ *****************************************************************************/
+void grid_write_csv(FILE *out) {
+  fprintf(out, "row,col,departures,mean_delay_s,max_delay_s,max_queue,presses,phase_changes\n");
+  for (uint32_t i = 0; i < junction_count; i++) {
+    const junction_t *junction = &junctions[i];
+    const double mean = junction->departures
+                        ? junction->delay_us / 1e6 / junction->departures : 0;
+
+    context_load(i);
+    fprintf(out, "%lu,%lu,%llu,%.2f,%.2f,%lu,%lu,%lu\n",
+            (unsigned long)(i / config.cols), (unsigned long)(i % config.cols),
+            (unsigned long long)junction->departures, mean,
+            junction->max_delay_us / 1e6, (unsigned long)junction->max_queue,
+            (unsigned long)junction->presses, (unsigned long)traffic_phase_changes());
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Injects the inputs of a tick into the running firmware.
+ * @details The car sensors that changed and the presses.
+ * @version 1.0
+ * @param   uint32_t cars, Car sensors (BATCH_CARS).
+ * @param   uint32_t buttons, Presses (BATCH_BUTTONS).
+ * @return  None
+ *****************************************************************************/
+static void inject(uint32_t cars, uint32_t buttons) {
+  const uint32_t changed = (ctrl_inputs() ^ cars) & BATCH_CARS;
+
+  for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+    if (changed & (1u << a)) {
+      set_detector(a, cars & (1u << a));
+    }
+  }
+  for (uint8_t c = 0; c < GRID_CROSSWALKS; c++) {
+    if (buttons & (1u << c)) {
+      hil_inject(button_pins[c], GPIO_PIN_RESET);
+      hil_inject(button_pins[c], GPIO_PIN_SET);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs a range of junctions' firmware for one tick.
+ * @details Instead of grid_run, with the inputs of the caller and no
+ *          traffic: the changed car sensors and the presses are injected,
+ *          the time advances by the tick (interrupts included) and the state
+ *          machine makes one pass, the order of batch_step.
+ * @version 1.1
+ * @param   uint32_t first, The first junction.
+ * @param   uint32_t count, Junctions.
+ * @param   uint32_t tick_us, Simulated time of the tick.
+ * @param   const uint32_t *cars, Car sensors per junction (BATCH_CARS),
+ *          from the first.
+ * @param   const uint32_t *buttons, Presses per junction (BATCH_BUTTONS).
+ * @return  None
+ *****************************************************************************/
+void grid_tick(uint32_t first, uint32_t count, uint32_t tick_us,
+               const uint32_t *cars, const uint32_t *buttons) {
+  for (uint32_t i = 0; i < count; i++) {
+    context_load(first + i);
+    inject(cars[i], buttons[i]);
+    sim_advance(tick_us);
+    Traffic_step();
+    context_save(first + i);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs one junction's firmware for one tick, after idle ticks.
+ * @details The tick of grid_tick, for the event-driven driver
+ *          (des_main.c): the time first advances by the ticks in which
+ *          nothing happened, without the passes of the state machine,
+ *          which would not have changed anything. Then the tick runs and
+ *          the next tick the firmware can act in on its own is found from
+ *          its timers.
+ * @version 1.0
+ * @param   uint32_t index, The junction.
+ * @param   uint64_t idle_us, Simulated time of the idle ticks.
+ * @param   uint32_t tick_us, Simulated time of the tick.
+ * @param   uint32_t cars, Car sensors (BATCH_CARS).
+ * @param   uint32_t buttons, Presses (BATCH_BUTTONS).
+ * @param   uint64_t *wake_ticks, Ticks from this one to the next timer
+ *          event, UINT64_MAX if no timer runs.
+ * @return  boolean, true if the tick changed the controller, then the next
+ *          tick has to run as well.
+ *****************************************************************************/
+bool grid_step(uint32_t index, uint64_t idle_us, uint32_t tick_us, uint32_t cars,
+               uint32_t buttons, uint64_t *wake_ticks) {
+  snapshot_t before, after;
+
+  context_load(index);
+  if (idle_us > 0) {
+    sim_advance(idle_us);
+  }
+  snapshot(&before);
+  inject(cars, buttons);
+  sim_advance(tick_us);
+  Traffic_step();
+  snapshot(&after);
+
+  const uint64_t wake = next_timer_event();
+  *wake_ticks = (wake == NEVER) ? NEVER : (wake - sim_time_us() + tick_us - 1) / tick_us;
+  context_save(index);
+  return memcmp(&before, &after, sizeof(before)) != 0;
+}
+
+/**************************************************************************//**
+ * @brief   Reads the controller state of a junction's firmware.
+ * @details Only the stage of the active intersection is kept, the other one
+ *          is 0.
+ * @version 1.0
+ * @param   uint32_t index, The junction.
+ * @param   batch_junction_t *junction, The state, as batch_get has it.
+ * @return  None
+ *****************************************************************************/
+void grid_controller(uint32_t index, batch_junction_t *junction) {
+  const uint8_t bits[] = {BATCH_TIM3, BATCH_TIM4, BATCH_TIM5, BATCH_TIM15};
+
+  context_load(index);
+  junction->state = ctrl_state.state;
+  junction->next_state = ctrl_state.next_state;
+  junction->stage = ctrl_state.stage[0] + ctrl_state.stage[1];
+  junction->running = 0;
+  for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+    if (timers[i]->Instance->CR1 & TIM_CR1_CEN) {
+      junction->running |= bits[i];
+    }
+    junction->count[i] = timers[i]->Instance->CNT;
+  }
+  junction->flags = ctrl_state.flags;
+  junction->lamps = sim_lamps();
+  junction->phase_changes = traffic_phase_changes();
+}
+
+/**************************************************************************//**
+ * @brief   Returns the bytes of firmware state per junction.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, The size of one context.
+ *****************************************************************************/
+uint32_t grid_context_size(void) {
+  return context_size;
+}
+
+/**************************************************************************//**
+ * @brief   Stops the workers and frees the grid.
+ * @version 1.1
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void grid_free(void) {
+  if (pool && jobs > 1 && workers[1] > 0) {
+    pool->quit = true;
+    pthread_barrier_wait(&pool->start);
+    for (uint32_t w = 1; w < jobs; w++) {
+      waitpid(workers[w], NULL, 0);
+      workers[w] = 0;
+    }
+    pthread_barrier_destroy(&pool->start);
+    pthread_barrier_destroy(&pool->done);
+  }
+
+  if (junctions) {
+    munmap(junctions, junction_count * sizeof(junction_t));
+  }
+  if (contexts) {
+    munmap(contexts, (size_t)junction_count * context_size);
+  }
+  if (pool) {
+    munmap(pool, sizeof(pool_t));
+  }
+  junctions = NULL;
+  contexts = NULL;
+  pool = NULL;
+  junction_count = 0;
+}
@@ -0,0 +1,148 @@
+/**************************************************************************//**
+ * @file     grid_main.c
+ * @brief    Main program of the city-grid simulation.
+ *
+ * @details  Runs a grid of junctions, each with its own copy of the traffic
+ *           light firmware (see grid.c), as fast as possible and prints the
+ *           totals; --csv writes the statistics of every junction:
+ *
+ *             build/traffic_grid [--rows N] [--cols N] [--hours H]
+ *                                [--travel S] [--headway S] [--rate VEH/H]
+ *                                [--ped PRESSES/H] [--seed N] [--csv FILE]
+ *                                [--jobs N]
+ *
+ *           The progress is printed to stderr every simulated hour. The
+ *           junctions are run by one worker per CPU unless --jobs says
+ *           otherwise, the results are the same for any number.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "grid.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define US_PER_HOUR     3600000000ull
+
+/* Functions ----------------------------------------------------------------*/
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--rows N] [--cols N] [--hours H] [--travel S] [--headway S]\n"
+                  "       [--rate VEH/H] [--ped PRESSES/H] [--seed N] [--csv FILE] [--jobs N]\n",
+          name);
+  exit(2);
+}
+
+static double wall_seconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  grid_config_t config = {
+    .rows = 10,
+    .cols = 10,
+    .travel_ms = 30000,
+    .headway_ms = 2000,
+    .rate = 120,
+    .ped_rate = 10,
+    .seed = 1,
+    .jobs = (cpus < 1) ? 1 : (cpus > GRID_MAX_JOBS) ? GRID_MAX_JOBS : cpus,
+  };
+  double hours = 1;
+  const char *csv = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (value == NULL) {
+      usage(argv[0]);
+    } else if (strcmp(argv[i], "--rows") == 0) {
+      config.rows = atoi(value);
+    } else if (strcmp(argv[i], "--cols") == 0) {
+      config.cols = atoi(value);
+    } else if (strcmp(argv[i], "--hours") == 0) {
+      hours = atof(value);
+    } else if (strcmp(argv[i], "--travel") == 0) {
+      config.travel_ms = (uint32_t)(atof(value) * 1000);
+    } else if (strcmp(argv[i], "--headway") == 0) {
+      config.headway_ms = (uint32_t)(atof(value) * 1000);
+    } else if (strcmp(argv[i], "--rate") == 0) {
+      config.rate = atof(value);
+    } else if (strcmp(argv[i], "--ped") == 0) {
+      config.ped_rate = atof(value);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      config.seed = strtoull(value, NULL, 0);
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = value;
+    } else if (strcmp(argv[i], "--jobs") == 0) {
+      config.jobs = atoi(value);
+    } else {
+      usage(argv[0]);
+    }
+    i++;
+  }
+
+  if (!grid_init(&config)) {
+    fprintf(stderr, "grid: empty grid, travel time under 1s, more than %u jobs or out of memory\n",
+            GRID_MAX_JOBS);
+    return 1;
+  }
+
+  const uint64_t end = (uint64_t)(hours * US_PER_HOUR);
+  const double start = wall_seconds();
+
+  while (grid_time_us() < end) {
+    const uint64_t next = grid_time_us() + US_PER_HOUR;
+
+    grid_run(next < end ? next : end);
+    fprintf(stderr, "%6.2f h  %8.1f s\n", grid_time_us() / (double)US_PER_HOUR,
+            wall_seconds() - start);
+  }
+  const double elapsed = wall_seconds() - start;
+
+  grid_stats_t stats;
+  grid_stats(&stats);
+
+  const unsigned workers = config.jobs ? config.jobs : 1;
+  printf("grid %ux%u, %u B of firmware state per junction, %u worker%s\n",
+         config.rows, config.cols, grid_context_size(), workers, (workers > 1) ? "s" : "");
+  printf("simulated %.2f h in %.1f s\n", hours, elapsed);
+  printf("vehicles: %llu entered, %llu left, %llu in the grid, %llu turned away\n",
+         (unsigned long long)stats.entered, (unsigned long long)stats.exited,
+         (unsigned long long)(stats.entered - stats.exited), (unsigned long long)stats.dropped);
+  printf("stop lines: %llu passed, mean wait %.1f s, max %.1f s, %llu held by full links\n",
+         (unsigned long long)stats.departures,
+         stats.departures ? stats.delay_us / 1e6 / stats.departures : 0.0,
+         stats.max_delay_us / 1e6, (unsigned long long)stats.blocked);
+  printf("controllers: %llu phase changes, %llu button presses, %llu activations\n",
+         (unsigned long long)stats.phase_changes, (unsigned long long)stats.presses,
+         (unsigned long long)stats.activations);
+
+  if (csv) {
+    FILE *out = fopen(csv, "w");
+
+    if (out == NULL) {
+      perror(csv);
+      grid_free();
+      return 1;
+    }
+    grid_write_csv(out);
+    fclose(out);
+  }
+
+  grid_free();
+  return 0;
+}
@@ -0,0 +1,46 @@
+/**************************************************************************//**
+ * @file     grid_stubs.c
+ * @brief    Firmware outputs left out of the grid build.
+ *
+ * @details  The grid runs only the control part of the firmware (GRID_SRC in
+ *           the Makefile). The OLED, the status page and the telemetry
+ *           stream have no reader there and would only add to the state
+ *           swapped per junction, so their entry points do nothing.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ssd1306_config.h"
+#include "status_page.h"
+#include "telemetry.h"
+
+/* Functions ----------------------------------------------------------------*/
+
+void display_start(void) {
+}
+
+void display_service(void) {
+}
+
+void clear_screen(void) {
+}
+
+void status_page_service(void) {
+}
+
+bool telemetry_event(uint8_t type, uint16_t id, uint32_t value) {
+  (void)type;
+  (void)id;
+  (void)value;
+  return true;
+}
+
+void telemetry_kick(void) {
+}
@@ -0,0 +1,458 @@
+/**************************************************************************//**
+ * @file     road.c
+ * @brief    Vehicles on the junction approaches, a cellular automaton.
+ *
+ * @details  A group of ROAD_VECTOR lanes is one block of rows, a row holds
+ *           one cell of every lane of the group (road.h). Behind the last
+ *           cell come 'speed' more rows, so looking ahead needs no bounds
+ *           check: the first one is the stop line, all ones in the lanes
+ *           whose signal is not green, the others stay empty.
+ *
+ *           The vector kernel works row by row with the vector types of
+ *           GCC, one byte per lane and no branches on the cells: the speed
+ *           is computed for every lane and the occupied ones are masked.
+ *           A vehicle moves to one of the next 'speed' + 1 rows, so it is
+ *           written into each of them under the mask of its speed; the
+ *           rule of the model keeps two vehicles out of the same cell, so
+ *           the rows of the new step are just or-ed together. Like the
+ *           batched controllers (batch.c) the kernel is compiled for the
+ *           baseline instruction set and for AVX2, chosen at run time.
+ *
+ *           The random numbers are one xorshift64 per 8 lanes, a byte per
+ *           lane, row and step; the scalar kernel draws them the same way.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ * @see      road.h
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "road.h"
+
+/* Defines ------------------------------------------------------------------*/
+#if defined(__x86_64__) || defined(__i386__)
+#define ROAD_X86            1
+#else
+#define ROAD_X86            0
+#endif
+
+#define INLINE              static inline __attribute__((always_inline))
+
+/* Lane operations as in batch.c: every lane set to a value, lane-wise
+ * select (all ones in the mask takes 'a'), all ones in the non-zero lanes,
+ * lane-wise minimum; for the vector type vec_t of the kernel */
+#define SPLAT(value)        ((vec_t){0} + (uint8_t)(value))
+#define SEL(mask, a, b)     (((a) & (mask)) | ((b) & ~(mask)))
+#define ANY(value)          ((vec_t)((value) != 0))
+#define MIN(a, b)           SEL((vec_t)((a) < (b)), (a), (b))
+
+#define RANDOM_WORDS        (ROAD_VECTOR / 8)
+
+/* Types --------------------------------------------------------------------*/
+typedef uint8_t vec16_t __attribute__((vector_size(16), may_alias));
+typedef uint8_t vec32_t __attribute__((vector_size(32), may_alias));
+typedef uint64_t random16_t __attribute__((vector_size(16), may_alias));
+typedef uint64_t random32_t __attribute__((vector_size(32), may_alias));
+
+/* Functions: kernels -------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Returns the first row of a group.
+ * @version 1.0
+ * @param   const road_t *road, The lanes.
+ * @param   uint8_t *cells, cells or next.
+ * @param   uint32_t group, The group.
+ * @return  uint8_t *, The row.
+ *****************************************************************************/
+INLINE uint8_t *group_rows(const road_t *road, uint8_t *cells, uint32_t group) {
+  return &cells[(size_t)group * road->rows * ROAD_VECTOR];
+}
+
+/**************************************************************************//**
+ * @brief   Prepares a group for a step: the stop line row and empty cells
+ *          in the new step.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @param   uint32_t group, The group.
+ * @return  None
+ *****************************************************************************/
+INLINE void begin_group(road_t *road, uint32_t group) {
+  const uint16_t cells = road->config.cells;
+
+  memcpy(group_rows(road, road->cells, group) + cells * ROAD_VECTOR,
+         &road->stop[group * ROAD_VECTOR], ROAD_VECTOR);
+  memset(group_rows(road, road->next, group), 0, cells * ROAD_VECTOR);
+}
+
+/**************************************************************************//**
+ * @brief   Defines the kernel for one vector type.
+ * @details GCC splits vector operations wider than the instruction set into
+ *          halves, except compares: those it splits into bytes. So the
+ *          kernel exists for 16-byte vectors, run twice per group with the
+ *          baseline instruction set, and for 32-byte vectors, run once with
+ *          AVX2. The function defined advances the lanes first ... first +
+ *          sizeof(V) - 1 of a group by one step:
+ *
+ *            void name(road_t *road, uint32_t group, uint32_t first)
+ *
+ *          The generators of the lanes are the RANDOM_WORDS of the group
+ *          from first / 8 on, which gives the same bytes for either size.
+ * @version 1.0
+ * @param   name, The function.
+ * @param   V, The vector of bytes.
+ * @param   R, The vector of 64-bit words of the same size.
+ *****************************************************************************/
+#define DEFINE_STEP(name, V, R)                                                \
+INLINE V name##_draw(R *state) {                                              \
+  R x = *state;                                                                \
+                                                                               \
+  x ^= x << 13;                                                                \
+  x ^= x >> 7;                                                                 \
+  x ^= x << 17;                                                                \
+  *state = x;                                                                  \
+  return (V)x;                                                                 \
+}                                                                              \
+                                                                               \
+INLINE void name(road_t *road, uint32_t group, uint32_t first) {              \
+  typedef V vec_t;                                                             \
+  const road_config_t *config = &road->config;                                 \
+  const uint8_t *in = group_rows(road, road->cells, group) + first;            \
+  uint8_t *out = group_rows(road, road->next, group) + first;                  \
+  const uint32_t lane = group * ROAD_VECTOR + first;                           \
+  R *const state = (R *)&road->random[(group * ROAD_VECTOR + first) / 8];      \
+  R random = *state;                                                           \
+  const V top = SPLAT(config->speed);                                          \
+  const V slowdown = SPLAT(config->slowdown);                                  \
+  V departed = {0};                                                            \
+                                                                               \
+  for (uint32_t c = 0; c < config->cells; c++) {                              \
+    const V cell = *(const V *)&in[c * ROAD_VECTOR];                           \
+    const V occupied = ANY(cell);                                              \
+                                                                               \
+    /* Speed up, stored as speed + 1, and keep behind the next vehicle */      \
+    V speed = MIN(cell, top);                                                  \
+    V gap = top;                                                               \
+    for (uint32_t k = config->speed; k > 0; k--) {                            \
+      gap = SEL(ANY(*(const V *)&in[(c + k) * ROAD_VECTOR]), SPLAT(k - 1), gap); \
+    }                                                                          \
+    speed = MIN(speed, gap);                                                   \
+                                                                               \
+    /* Random slowdown, not below 0 */                                         \
+    speed -= (V)(name##_draw(&random) < slowdown) & ANY(speed) & 1;            \
+                                                                               \
+    for (uint32_t d = 0; d <= config->speed; d++) {                           \
+      const V moved = occupied & (V)(speed == SPLAT(d));                       \
+                                                                               \
+      if (c + d < config->cells) {                                             \
+        *(V *)&out[(c + d) * ROAD_VECTOR] |= moved & (speed + 1);              \
+      } else {                                                                 \
+        departed |= moved;                                                     \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* A vehicle enters at full speed if the first cell is free */               \
+  const V enter = ~ANY(*(V *)out) & (V)(name##_draw(&random) < SPLAT(config->inflow)); \
+  *(V *)out |= enter & (top + 1);                                              \
+                                                                               \
+  V present = {0};                                                             \
+  for (uint32_t c = config->cells - config->detector; c < config->cells; c++) { \
+    present |= *(const V *)&out[c * ROAD_VECTOR];                              \
+  }                                                                            \
+  *(V *)&road->present[lane] = ANY(present);                                   \
+  *state = random;                                                             \
+                                                                               \
+  for (uint32_t l = 0; l < sizeof(V); l++) {                                   \
+    road->entered[lane + l] += enter[l] & 1;                                   \
+    road->departed[lane + l] += departed[l] & 1;                               \
+  }                                                                            \
+}
+
+DEFINE_STEP(step_half, vec16_t, random16_t)
+DEFINE_STEP(step_full, vec32_t, random32_t)
+
+/**************************************************************************//**
+ * @brief   Advances all lanes by one step, baseline instruction set.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @return  None
+ *****************************************************************************/
+static void step_baseline(road_t *road) {
+  for (uint32_t g = 0; g < road->groups; g++) {
+    begin_group(road, g);
+    step_half(road, g, 0);
+    step_half(road, g, ROAD_VECTOR / 2);
+  }
+}
+
+#if ROAD_X86
+/**************************************************************************//**
+ * @brief   Advances all lanes by one step with AVX2.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @return  None
+ *****************************************************************************/
+__attribute__((target("avx2")))
+static void step_avx2(road_t *road) {
+  for (uint32_t g = 0; g < road->groups; g++) {
+    begin_group(road, g);
+    step_full(road, g, 0);
+  }
+}
+#endif
+
+/**************************************************************************//**
+ * @brief   Draws the random bytes of a row like the kernels do.
+ * @version 1.0
+ * @param   uint64_t *state, The RANDOM_WORDS generators of the group.
+ * @param   uint8_t *bytes, ROAD_VECTOR bytes, one per lane.
+ * @return  None
+ *****************************************************************************/
+static void draw_scalar(uint64_t *state, uint8_t *bytes) {
+  for (uint32_t w = 0; w < RANDOM_WORDS; w++) {
+    uint64_t x = state[w];
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    state[w] = x;
+    for (uint32_t b = 0; b < 8; b++) {
+      bytes[w * 8 + b] = (uint8_t)(x >> (8 * b));
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Advances all lanes by one step, vehicle by vehicle.
+ * @details The model as it is usually written, the reference for the
+ *          vector kernel. Counts the vehicles it moves.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @return  None
+ *****************************************************************************/
+static void step_scalar(road_t *road) {
+  const road_config_t *config = &road->config;
+
+  for (uint32_t g = 0; g < road->groups; g++) {
+    const uint8_t *in = group_rows(road, road->cells, g);
+    uint8_t *out = group_rows(road, road->next, g);
+    uint64_t *random = &road->random[g * RANDOM_WORDS];
+    uint8_t bytes[ROAD_VECTOR];
+
+    begin_group(road, g);
+
+    for (uint32_t c = 0; c < config->cells; c++) {
+      draw_scalar(random, bytes);
+
+      for (uint32_t l = 0; l < ROAD_VECTOR; l++) {
+        const uint32_t lane = g * ROAD_VECTOR + l;
+
+        if (in[c * ROAD_VECTOR + l] == 0) {
+          continue;
+        }
+        if (lane < road->count) {
+          road->updates++;
+        }
+
+        uint32_t speed = in[c * ROAD_VECTOR + l];   // Speed + 1
+        if (speed > config->speed) {
+          speed = config->speed;
+        }
+        for (uint32_t k = 1; k <= speed; k++) {
+          if (in[(c + k) * ROAD_VECTOR + l] != 0) {
+            speed = k - 1;
+            break;
+          }
+        }
+        if (speed > 0 && bytes[l] < config->slowdown) {
+          speed--;
+        }
+
+        if (c + speed < config->cells) {
+          out[(c + speed) * ROAD_VECTOR + l] = speed + 1;
+        } else {
+          road->departed[lane]++;
+        }
+      }
+    }
+
+    draw_scalar(random, bytes);
+    for (uint32_t l = 0; l < ROAD_VECTOR; l++) {
+      const uint32_t lane = g * ROAD_VECTOR + l;
+
+      if (out[l] == 0 && bytes[l] < config->inflow) {
+        out[l] = config->speed + 1;
+        road->entered[lane]++;
+      }
+
+      road->present[lane] = 0;
+      for (uint32_t c = config->cells - config->detector; c < config->cells; c++) {
+        if (out[c * ROAD_VECTOR + l] != 0) {
+          road->present[lane] = 0xFF;
+        }
+      }
+    }
+  }
+}
+
+/* Functions ----------------------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Allocates empty lanes, all signals green.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @param   uint32_t count, Number of lanes.
+ * @param   const road_config_t *config, The model, the same for all.
+ * @return  boolean, false for an unusable model or out of memory.
+ *****************************************************************************/
+bool road_init(road_t *road, uint32_t count, const road_config_t *config) {
+  memset(road, 0, sizeof(*road));
+  if (count == 0 || config->speed < 1 || config->speed > ROAD_MAX_SPEED
+      || config->detector < 1 || config->detector > config->cells) {
+    return false;
+  }
+  road->config = *config;
+  road->count = count;
+  road->groups = (count + ROAD_VECTOR - 1) / ROAD_VECTOR;
+  road->rows = config->cells + config->speed;
+
+  const size_t lanes = (size_t)road->groups * ROAD_VECTOR;
+  const size_t cells = lanes * road->rows;
+  road->cells = aligned_alloc(ROAD_VECTOR, cells);
+  road->next = aligned_alloc(ROAD_VECTOR, cells);
+  road->stop = aligned_alloc(ROAD_VECTOR, lanes);
+  road->present = aligned_alloc(ROAD_VECTOR, lanes);
+  road->entered = calloc(lanes, sizeof(uint32_t));
+  road->departed = calloc(lanes, sizeof(uint32_t));
+  road->random = aligned_alloc(ROAD_VECTOR, lanes / 8 * sizeof(uint64_t));
+  if (!road->cells || !road->next || !road->stop || !road->present
+      || !road->entered || !road->departed || !road->random) {
+    road_free(road);
+    return false;
+  }
+  memset(road->cells, 0, cells);
+  memset(road->next, 0, cells);
+  memset(road->stop, 0, lanes);
+  memset(road->present, 0, lanes);
+  for (size_t w = 0; w < lanes / 8; w++) {
+    road->random[w] = (config->seed + w + 1) * 0x9E3779B97F4A7C15ull | 1;
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief   Frees the lanes.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @return  None
+ *****************************************************************************/
+void road_free(road_t *road) {
+  free(road->cells);
+  free(road->next);
+  free(road->stop);
+  free(road->present);
+  free(road->entered);
+  free(road->departed);
+  free(road->random);
+  memset(road, 0, sizeof(*road));
+}
+
+/**************************************************************************//**
+ * @brief   Sets the signal of a lane for the next steps.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @param   uint32_t lane, The lane.
+ * @param   bool green, Vehicles may pass the stop line.
+ * @return  None
+ *****************************************************************************/
+void road_set_green(road_t *road, uint32_t lane, bool green) {
+  road->stop[lane] = green ? 0 : 0xFF;
+}
+
+/**************************************************************************//**
+ * @brief   Advances all lanes by one step.
+ * @version 1.0
+ * @param   road_t *road, The lanes.
+ * @param   road_kernel_t kernel, The kernel, see road_kernel_supported.
+ * @return  None
+ *****************************************************************************/
+void road_step(road_t *road, road_kernel_t kernel) {
+  if (kernel == ROAD_KERNEL_SCALAR) {
+    step_scalar(road);
+#if ROAD_X86
+  } else if (kernel == ROAD_KERNEL_AVX2) {
+    step_avx2(road);
+#endif
+  } else {
+    step_baseline(road);
+  }
+
+  uint8_t *const cells = road->cells;
+  road->cells = road->next;
+  road->next = cells;
+}
+
+/**************************************************************************//**
+ * @brief   Reads the car sensor of a lane.
+ * @version 1.0
+ * @param   const road_t *road, The lanes.
+ * @param   uint32_t lane, The lane.
+ * @return  boolean, true while a vehicle is on the detector cells.
+ *****************************************************************************/
+bool road_present(const road_t *road, uint32_t lane) {
+  return road->present[lane] != 0;
+}
+
+/**************************************************************************//**
+ * @brief   Returns the vehicles on a lane.
+ * @version 1.0
+ * @param   const road_t *road, The lanes.
+ * @param   uint32_t lane, The lane.
+ * @return  uint32_t, Entered and not departed.
+ *****************************************************************************/
+uint32_t road_vehicles(const road_t *road, uint32_t lane) {
+  return road->entered[lane] - road->departed[lane];
+}
+
+/**************************************************************************//**
+ * @brief   Compares two sets of lanes of the same size and model.
+ * @version 1.0
+ * @param   const road_t *a, The first.
+ * @param   const road_t *b, The second.
+ * @return  boolean, true if every cell, sensor and counter is the same.
+ *****************************************************************************/
+bool road_equal(const road_t *a, const road_t *b) {
+  const size_t lanes = (size_t)a->groups * ROAD_VECTOR;
+
+  for (uint32_t g = 0; g < a->groups; g++) {
+    if (memcmp(group_rows(a, a->cells, g), group_rows(b, b->cells, g),
+               a->config.cells * ROAD_VECTOR) != 0) {
+      return false;
+    }
+  }
+  return memcmp(a->present, b->present, lanes) == 0
+         && memcmp(a->entered, b->entered, lanes * sizeof(uint32_t)) == 0
+         && memcmp(a->departed, b->departed, lanes * sizeof(uint32_t)) == 0;
+}
+
+/**************************************************************************//**
+ * @brief   Checks whether the CPU can run a kernel.
+ * @version 1.0
+ * @param   road_kernel_t kernel, The kernel.
+ * @return  boolean, true if it can.
+ *****************************************************************************/
+bool road_kernel_supported(road_kernel_t kernel) {
+  if (kernel == ROAD_KERNEL_AVX2) {
+#if ROAD_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return true;
+}
@@ -0,0 +1,305 @@
+/**************************************************************************//**
+ * @file     road_main.c
+ * @brief    Main program of the vehicle model, its check and benchmark.
+ *
+ * @details  Three runs on the four approaches of every junction:
+ *
+ *           - check: the scalar and the vector kernels step the same lanes
+ *             with fixed-time signals and are compared after every step,
+ *           - timing: each kernel alone on the same lanes, in vehicle
+ *             updates per second (vehicles moved, counted by the scalar
+ *             kernel),
+ *           - coupled: the firmware of every junction (grid_tick) drives
+ *             the signals, green where its output word has the approach's
+ *             green lamp, and the vehicles on the detector cells drive its
+ *             car sensors TL1_Car..TL4_Car. The firmware ticks every
+ *             10 ms, event driven (grid_step): a junction only runs when
+ *             its sensors change, it is pressed or one of its timers is
+ *             due, and then until it is stable again.
+ *
+ *             build/traffic_road [--junctions N] [--steps N] [--cells N]
+ *                                [--speed N] [--inflow N] [--seed N]
+ *                                [--no-check]
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "595_shiftreg.h"
+#include "grid.h"
+#include "road.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define CELL_M              7.5
+#define FIXED_GREEN_S       30
+#define TICKS_PER_STEP      100                   // Of the firmware, 10 ms
+#define TICK_US             (1000000 / TICKS_PER_STEP)
+#define NEVER               UINT64_MAX
+#define PRESS_CHANCE        (UINT32_MAX / 300)    // Every 5 minutes
+
+/* Variables ----------------------------------------------------------------*/
+static const char *const kernel_names[] = {"scalar", "baseline", "avx2"};
+
+static const uint32_t green_lamps[GRID_APPROACHES] = {
+  TL1_Green, TL2_Green, TL3_Green, TL4_Green,
+};
+
+/* Functions ----------------------------------------------------------------*/
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--junctions N] [--steps N] [--cells N] [--speed N]\n"
+                  "       [--inflow N] [--seed N] [--no-check]\n", name);
+  exit(2);
+}
+
+static double wall_seconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/* Runs a junction's firmware up to a tick, from the tick it is due */
+static uint64_t run_junction(uint32_t junction, uint64_t due, uint64_t end, uint64_t *last,
+                             uint32_t cars, uint32_t buttons) {
+  uint64_t t = due;
+
+  while (t <= end) {
+    const uint64_t idle = t - *last - 1;
+    uint64_t wake;
+    const bool changed = grid_step(junction, idle * TICK_US, TICK_US, cars,
+                                   (t == due) ? buttons : 0, &wake);
+
+    *last = t;
+    if (changed) {
+      t++;
+    } else {
+      t = (wake == NEVER) ? NEVER : t + wake;
+    }
+  }
+  return t;
+}
+
+/* North-south and west-east green in turn, shifted per junction */
+static void fixed_signals(road_t *road, uint32_t step) {
+  for (uint32_t lane = 0; lane < road->count; lane++) {
+    const uint32_t junction = lane / GRID_APPROACHES;
+    const uint32_t phase = (step + 7 * junction) / FIXED_GREEN_S;
+
+    road_set_green(road, lane, (phase + lane) % 2 == 0);
+  }
+}
+
+int main(int argc, char **argv) {
+  road_config_t model = {
+    .cells = 64,
+    .speed = 2,
+    .slowdown = 64,
+    .detector = 2,
+    .seed = 1,
+  };
+  uint32_t junctions = 1024;
+  uint32_t steps = 3600;
+  uint32_t inflow = 240;
+  bool check = true;
+
+  for (int i = 1; i < argc; i++) {
+    const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (strcmp(argv[i], "--no-check") == 0) {
+      check = false;
+      continue;
+    } else if (value == NULL) {
+      usage(argv[0]);
+    } else if (strcmp(argv[i], "--junctions") == 0) {
+      junctions = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--steps") == 0) {
+      steps = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--cells") == 0) {
+      model.cells = atoi(value);
+    } else if (strcmp(argv[i], "--speed") == 0) {
+      model.speed = atoi(value);
+    } else if (strcmp(argv[i], "--inflow") == 0) {
+      inflow = strtoul(value, NULL, 0);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      model.seed = strtoull(value, NULL, 0);
+    } else {
+      usage(argv[0]);
+    }
+    i++;
+  }
+
+  /* Vehicles per hour and lane as the chance per step, in 1/256 */
+  model.inflow = (inflow >= 3600) ? 255 : inflow * 256 / 3600;
+
+  const uint32_t lanes = junctions * GRID_APPROACHES;
+  const int kernels = road_kernel_supported(ROAD_KERNEL_AVX2) ? 3 : 2;
+  road_t roads[3];
+
+  for (int k = 0; k < kernels; k++) {
+    if (!road_init(&roads[k], lanes, &model)) {
+      fprintf(stderr, "road: no lanes, speed not 1 to %u or out of memory\n", ROAD_MAX_SPEED);
+      return 1;
+    }
+  }
+  printf("%u lanes of %u cells (%.0f m), top speed %u (%.0f km/h), %u vehicles/h per lane,\n"
+         "%u steps, kernels: scalar, baseline%s\n",
+         lanes, model.cells, model.cells * CELL_M, model.speed, model.speed * CELL_M * 3.6,
+         inflow, steps, (kernels > 2) ? ", avx2" : "");
+
+  /* Lockstep */
+  if (check) {
+    for (uint32_t s = 0; s < steps; s++) {
+      for (int k = 0; k < kernels; k++) {
+        fixed_signals(&roads[k], s);
+        road_step(&roads[k], (road_kernel_t)k);
+      }
+      for (int k = 1; k < kernels; k++) {
+        if (!road_equal(&roads[0], &roads[k])) {
+          fprintf(stderr, "road: %s differs from scalar after step %u\n", kernel_names[k], s + 1);
+          return 1;
+        }
+      }
+    }
+    printf("check: %u steps identical\n", steps);
+  }
+
+  /* Timing, from empty lanes; only the steps are timed */
+  double seconds[3] = {0};
+  for (int k = 0; k < kernels; k++) {
+    road_free(&roads[k]);
+    road_init(&roads[k], lanes, &model);
+    for (uint32_t s = 0; s < steps; s++) {
+      fixed_signals(&roads[k], s);
+
+      const double start = wall_seconds();
+      road_step(&roads[k], (road_kernel_t)k);
+      seconds[k] += wall_seconds() - start;
+    }
+  }
+  const double updates = (double)roads[0].updates;
+  for (int k = 0; k < kernels; k++) {
+    printf("%-9s %10.1f M vehicle-updates/s", kernel_names[k], updates / seconds[k] / 1e6);
+    if (k > 0) {
+      printf("  %6.1fx", seconds[0] / seconds[k]);
+    }
+    printf("\n");
+  }
+
+  /* Coupled to the firmware */
+  grid_config_t config = {
+    .rows = 1,
+    .cols = junctions,
+    .travel_ms = 30000,
+    .headway_ms = 2000,
+    .seed = model.seed,
+  };
+  road_t *road = &roads[kernels - 1];
+  uint32_t *cars = calloc(junctions, sizeof(uint32_t));
+  uint32_t *buttons = calloc(junctions, sizeof(uint32_t));
+  uint32_t *sensed_cars = calloc(junctions, sizeof(uint32_t));
+  uint64_t *due = malloc(junctions * sizeof(uint64_t));
+  uint64_t *last = calloc(junctions, sizeof(uint64_t));
+  uint64_t random = model.seed * 0x9E3779B97F4A7C15ull | 1;
+  uint64_t sensed = 0;
+
+  if (!cars || !buttons || !sensed_cars || !due || !last || !grid_init(&config)) {
+    fprintf(stderr, "road: out of memory\n");
+    return 1;
+  }
+  road_free(road);
+  road_init(road, lanes, &model);
+
+  /* Every junction starts with a tick to find its timers */
+  for (uint32_t j = 0; j < junctions; j++) {
+    due[j] = 1;
+  }
+
+  const double start = wall_seconds();
+  for (uint32_t s = 0; s < steps; s++) {
+    for (uint32_t j = 0; j < junctions; j++) {
+      batch_junction_t controller;
+
+      grid_controller(j, &controller);
+      sensed_cars[j] = 0;
+      buttons[j] = 0;
+      for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+        road_set_green(road, j * GRID_APPROACHES + a, controller.lamps & green_lamps[a]);
+      }
+    }
+
+    road_step(road, (road_kernel_t)(kernels - 1));
+
+    for (uint32_t j = 0; j < junctions; j++) {
+      for (uint8_t a = 0; a < GRID_APPROACHES; a++) {
+        if (road_present(road, j * GRID_APPROACHES + a)) {
+          sensed_cars[j] |= 1u << a;
+          sensed++;
+        }
+      }
+      for (uint8_t c = 0; c < GRID_CROSSWALKS; c++) {
+        if ((uint32_t)next_random(&random) < PRESS_CHANCE) {
+          buttons[j] |= 1u << c;
+        }
+      }
+    }
+
+    /* The ticks of the step, a junction with new inputs runs from the first */
+    const uint64_t first = (uint64_t)s * TICKS_PER_STEP + 1;
+    for (uint32_t j = 0; j < junctions; j++) {
+      if (sensed_cars[j] != cars[j] || buttons[j] != 0) {
+        cars[j] = sensed_cars[j];
+        due[j] = first;
+      }
+      due[j] = run_junction(j, due[j], first + TICKS_PER_STEP - 1, &last[j], cars[j], buttons[j]);
+    }
+  }
+  const double coupled_seconds = wall_seconds() - start;
+
+  uint64_t entered = 0, departed = 0, phase_changes = 0;
+  for (uint32_t lane = 0; lane < lanes; lane++) {
+    entered += road->entered[lane];
+    departed += road->departed[lane];
+  }
+  for (uint32_t j = 0; j < junctions; j++) {
+    batch_junction_t controller;
+
+    grid_controller(j, &controller);
+    phase_changes += controller.phase_changes;
+  }
+  const double hours = steps / 3600.0;
+  printf("coupled: %u junctions with their firmware, %.2f h in %.2f s\n"
+         "  %llu vehicles in, %llu out over the stop lines, %llu on the approaches\n"
+         "  car sensors active %.1f%% of the time, %.1f phase changes per junction and hour\n",
+         junctions, hours, coupled_seconds, (unsigned long long)entered,
+         (unsigned long long)departed, (unsigned long long)(entered - departed),
+         100.0 * sensed / ((double)lanes * steps), phase_changes / (junctions * hours));
+
+  for (int k = 0; k < kernels; k++) {
+    road_free(&roads[k]);
+  }
+  grid_free();
+  free(cars);
+  free(buttons);
+  free(sensed_cars);
+  free(due);
+  free(last);
+  return 0;
+}
@@ -0,0 +1,509 @@
+/**************************************************************************//**
+ * @file     sim_hal.c
+ * @brief    Simulated HAL and peripherals for the host build.
+ *
+ * @details  Implements the HAL functions declared in Inc/stm32l4xx_hal.h on
+ *           top of a simulated clock:
+ *           - TIM3/4/5/15 count with their prescaler and Auto-Reload
+ *             register, an overflow sets the update flag and, if enabled,
+ *             calls HAL_TIM_PeriodElapsedCallback.
+ *           - EXTI lines raised through SWIER1 (HIL injection) call
+ *             HAL_GPIO_EXTI_Callback.
+ *           - USART2 is a pseudo terminal. DMA transmissions are written to
+ *             it, received bytes are copied into the DMA ring and reported
+ *             with HAL_UARTEx_RxEventCallback, like the idle line event.
+ *           - SPI3 transfers are latched as the lamp word on the rising edge
+ *             of the 595 STCP pin, SPI2 (OLED) transfers are discarded.
+ *
+ *           The peripheral handles and MX_xxx_Init functions replace the
+ *           CubeMX generated gpio.c, dma.c, spi.c, tim.c and usart.c.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+/* Includes -----------------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* termios.h output flags clash with the TIM register names */
+#undef CR1
+#undef CR2
+#undef CR3
+
+#include "main.h"
+#include "dma.h"
+#include "gpio.h"
+#include "spi.h"
+#include "tim.h"
+#include "usart.h"
+
+#include "telemetry.h"
+#include "595_shiftreg.h"
+#include "sim.h"
+
+/* Variables ----------------------------------------------------------------*/
+GPIO_TypeDef sim_gpio[3];
+EXTI_TypeDef sim_exti;
+TIM_TypeDef sim_tim[5];
+SPI_TypeDef sim_spi[2];
+USART_TypeDef sim_usart2;
+volatile uint32_t sim_ipsr = 0;
+
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim4;
+TIM_HandleTypeDef htim5;
+TIM_HandleTypeDef htim15;
+SPI_HandleTypeDef hspi2;
+SPI_HandleTypeDef hspi3;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
+
+/* Timers in NVIC priority order, with their prescaler remainders */
+static TIM_HandleTypeDef *const timers[] = {&htim3, &htim4, &htim5, &htim15};
+static uint64_t timer_cycles[sizeof(timers) / sizeof(timers[0])];
+
+static uint64_t now_us = 0;
+static struct timespec wall_start;
+
+static uint8_t shift_data[3];
+static uint32_t lamps = 0;
+
+static struct {
+  int fd;                       // pty master, -1 when closed
+  int slave;                    // Kept open so the master never reads EIO
+  char link[256];
+  UART_HandleTypeDef *tx_done;  // Transmission waiting for its complete interrupt
+  UART_HandleTypeDef *rx;       // Reception started by ReceiveToIdle_DMA
+  uint8_t *rx_ring;
+  uint16_t rx_size;
+  uint16_t rx_pos;
+} uart = {.fd = -1, .slave = -1};
+
+/* Functions: interrupts ----------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Counts the running timers up by a number of microseconds.
+ * @version 1.0
+ * @param   uint32_t us, Elapsed time.
+ * @return  None
+ *****************************************************************************/
+static void count_timers(uint32_t us) {
+  for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+    TIM_TypeDef *tim = timers[i]->Instance;
+    uint64_t ticks;
+
+    tim->EGR = 0;   // The prescaler is used right away, no update event needed
+    if (!(tim->CR1 & TIM_CR1_CEN)) {
+      continue;
+    }
+
+    timer_cycles[i] += (uint64_t)us * SIM_TIMER_CLOCK_MHZ;
+    ticks = timer_cycles[i] / (tim->PSC + 1);
+    timer_cycles[i] %= (tim->PSC + 1);
+
+    ticks += tim->CNT;
+    if (ticks > tim->ARR) {
+      ticks %= (uint64_t)tim->ARR + 1;
+      tim->SR |= TIM_SR_UIF;
+    }
+    tim->CNT = ticks;
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Reads the pty and hands new bytes to the DMA receive ring.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void uart_receive(void) {
+  uint8_t data[256];
+  ssize_t len;
+
+  if (uart.fd < 0 || uart.rx == NULL) {
+    return;
+  }
+
+  len = read(uart.fd, data, sizeof(data));
+  for (ssize_t i = 0; i < len; ) {
+    uint32_t chunk = uart.rx_size - uart.rx_pos;
+    if (chunk > (uint32_t)(len - i)) {
+      chunk = len - i;
+    }
+    memcpy(&uart.rx_ring[uart.rx_pos], &data[i], chunk);
+    uart.rx_pos += chunk;
+    i += chunk;
+
+    /* Transfer complete at the end of the ring, idle line after the last byte */
+    HAL_UARTEx_RxEventCallback(uart.rx, uart.rx_pos);
+    if (uart.rx_pos == uart.rx_size) {
+      uart.rx_pos = 0;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Runs every pending interrupt, highest priority first.
+ * @details Mirrors the NVIC priorities: SysTick and EXTI (0), the timers
+ *          (1) and USART2 with its DMA channels (2).
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+static void deliver_interrupts(void) {
+  static uint32_t last_tick = 0;
+  bool pending = true;
+
+  sim_ipsr = 1;
+  while (pending) {
+    pending = false;
+
+    if (HAL_GetTick() != last_tick) {
+      last_tick = HAL_GetTick();
+      telemetry_kick();  // SysTick_Handler
+    }
+
+    uint32_t lines = EXTI->SWIER1 & EXTI->IMR1;
+    if (lines) {
+      uint16_t pin = lines & -lines;
+      EXTI->SWIER1 &= ~pin;
+      HAL_GPIO_EXTI_Callback(pin);
+      pending = true;
+      continue;
+    }
+
+    for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+      TIM_TypeDef *tim = timers[i]->Instance;
+      if ((tim->SR & TIM_SR_UIF) && (tim->DIER & TIM_DIER_UIE)) {
+        tim->SR &= ~TIM_SR_UIF;
+        HAL_TIM_PeriodElapsedCallback(timers[i]);
+        pending = true;
+        break;
+      }
+    }
+    if (pending) {
+      continue;
+    }
+
+    if (uart.tx_done) {
+      UART_HandleTypeDef *huart = uart.tx_done;
+      uart.tx_done = NULL;
+      huart->gState = HAL_UART_STATE_READY;
+      HAL_UART_TxCpltCallback(huart);
+      pending = true;
+      continue;
+    }
+
+    uart_receive();
+  }
+  sim_ipsr = 0;
+}
+
+/**************************************************************************//**
+ * @brief   Advances the simulated time.
+ * @details Interrupts become pending while the time passes and are run at
+ *          the end, unless the caller is an interrupt itself (HAL_Delay in
+ *          an ISR), then they wait for the next call from the main loop.
+ * @version 1.0
+ * @param   uint32_t us, Time to advance in microseconds.
+ * @return  None
+ *****************************************************************************/
+void sim_advance(uint32_t us) {
+  now_us += us;
+  count_timers(us);
+
+  if (sim_ipsr == 0) {
+    deliver_interrupts();
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the simulated time since start-up.
+ * @version 1.0
+ * @param   None
+ * @return  uint64_t, Time in microseconds.
+ *****************************************************************************/
+uint64_t sim_time_us(void) {
+  return now_us;
+}
+
+/**************************************************************************//**
+ * @brief   Waits until the wall clock has caught up with the simulated time.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void sim_pace(void) {
+  struct timespec now;
+  int64_t wall_us, ahead;
+
+  if (wall_start.tv_sec == 0 && wall_start.tv_nsec == 0) {
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  wall_us = (now.tv_sec - wall_start.tv_sec) * 1000000LL + (now.tv_nsec - wall_start.tv_nsec) / 1000;
+
+  ahead = (int64_t)now_us - wall_us;
+  if (ahead > 1000) {
+    struct timespec pause = {0, (long)ahead * 1000};
+    nanosleep(&pause, NULL);
+  }
+}
+
+/**************************************************************************//**
+ * @brief   Returns the lamp word last latched into the shift registers.
+ * @version 1.0
+ * @param   None
+ * @return  uint32_t, 24-bit lamp word (see 595_shiftreg.h).
+ *****************************************************************************/
+uint32_t sim_lamps(void) {
+  return lamps;
+}
+
+/* Functions: USART2 pty ----------------------------------------------------*/
+
+/**************************************************************************//**
+ * @brief   Creates the pty that stands in for the ST-LINK virtual COM port.
+ * @version 1.0
+ * @param   const char *link, Path of a symlink to the pty, may be NULL.
+ * @return  int, 0 on success, -1 on failure.
+ *****************************************************************************/
+int sim_uart_open(const char *link) {
+  struct termios attrs;
+  const char *name;
+
+  uart.fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (uart.fd < 0 || grantpt(uart.fd) != 0 || unlockpt(uart.fd) != 0) {
+    return -1;
+  }
+  name = ptsname(uart.fd);
+  uart.slave = open(name, O_RDWR | O_NOCTTY);
+  if (uart.slave < 0) {
+    return -1;
+  }
+  tcgetattr(uart.slave, &attrs);
+  cfmakeraw(&attrs);
+  tcsetattr(uart.slave, TCSANOW, &attrs);
+  fcntl(uart.fd, F_SETFL, fcntl(uart.fd, F_GETFL) | O_NONBLOCK);
+
+  if (link != NULL) {
+    unlink(link);
+    if (symlink(name, link) != 0) {
+      return -1;
+    }
+    snprintf(uart.link, sizeof(uart.link), "%s", link);
+  }
+  fprintf(stderr, "USART2 on %s\n", link ? link : name);
+  return 0;
+}
+
+/**************************************************************************//**
+ * @brief   Closes the pty and removes its symlink.
+ * @version 1.0
+ * @param   None
+ * @return  None
+ *****************************************************************************/
+void sim_uart_close(void) {
+  if (uart.link[0]) {
+    unlink(uart.link);
+  }
+  if (uart.fd >= 0) {
+    close(uart.fd);
+    close(uart.slave);
+  }
+  uart.fd = -1;
+}
+
+/* Functions: HAL -----------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void) {
+  return (uint32_t)(now_us / 1000);
+}
+
+void HAL_Delay(uint32_t Delay) {
+  sim_advance(Delay * 1000);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+  /* Rising edge of the storage register clock latches the shifted bytes */
+  if (GPIOx == _595_STCP_GPIO_Port && GPIO_Pin == _595_STCP_Pin
+      && PinState == GPIO_PIN_SET && !(GPIOx->ODR & GPIO_Pin)) {
+    lamps = (shift_data[U1] << 16) | (shift_data[U2] << 8) | shift_data[U3];
+  }
+
+  if (PinState == GPIO_PIN_SET) {
+    GPIOx->ODR |= GPIO_Pin;
+  } else {
+    GPIOx->ODR &= ~GPIO_Pin;
+  }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim) {
+  htim->Instance->CR1 |= TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim) {
+  htim->Instance->CR1 &= ~TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
+  htim->Instance->DIER |= TIM_DIER_UIE;
+  htim->Instance->CR1 |= TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
+  htim->Instance->DIER &= ~TIM_DIER_UIE;
+  htim->Instance->CR1 &= ~TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+  (void)Timeout;
+  if (hspi->Instance == SPI3 && Size == sizeof(shift_data)) {
+    memcpy(shift_data, pData, sizeof(shift_data));
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+  (void)huart;
+  (void)Timeout;
+  if (uart.fd >= 0 && write(uart.fd, pData, Size) < 0 && errno != EAGAIN) {
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+  if (huart->gState != HAL_UART_STATE_READY) {
+    return HAL_BUSY;
+  }
+
+  /* Nobody listening is like an unplugged cable, the bytes are lost */
+  if (uart.fd >= 0 && write(uart.fd, pData, Size) < 0 && errno != EAGAIN && errno != EIO) {
+    return HAL_ERROR;
+  }
+  huart->gState = HAL_UART_STATE_BUSY_TX;
+  uart.tx_done = huart;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+  uart.rx = huart;
+  uart.rx_ring = pData;
+  uart.rx_size = Size;
+  uart.rx_pos = 0;
+  huart->RxState = HAL_UART_STATE_BUSY_RX;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_PWREx_ControlVoltageScaling(uint32_t VoltageScaling) {
+  (void)VoltageScaling;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct) {
+  (void)RCC_OscInitStruct;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency) {
+  (void)RCC_ClkInitStruct;
+  (void)FLatency;
+  return HAL_OK;
+}
+
+/* Weak defaults, the firmware overrides the callbacks it uses */
+__attribute__((weak)) void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) { (void)huart; }
+__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) { (void)huart; (void)Size; }
+
+/* Functions: peripheral initialization (CubeMX replacements) ---------------*/
+
+void MX_GPIO_Init(void) {
+  /* Inputs have pull-ups, nothing pressed and no cars */
+  GPIOA->IDR = TL4_Car_Pin | PL1_Switch_Pin;
+  GPIOB->IDR = TL2_Car_Pin | TL3_Car_Pin | PL2_Switch_Pin;
+  GPIOC->IDR = TL1_Car_Pin;
+
+  EXTI->IMR1 = TL1_Car_Pin | TL2_Car_Pin | TL3_Car_Pin | TL4_Car_Pin | PL1_Switch_Pin | PL2_Switch_Pin;
+  EXTI->RTSR1 = EXTI->IMR1;
+  EXTI->FTSR1 = TL1_Car_Pin | TL2_Car_Pin | TL3_Car_Pin | TL4_Car_Pin;
+}
+
+void MX_DMA_Init(void) {
+}
+
+void MX_USART2_UART_Init(void) {
+  huart2.Instance = USART2;
+  huart2.hdmarx = &hdma_usart2_rx;
+  huart2.hdmatx = &hdma_usart2_tx;
+  huart2.gState = HAL_UART_STATE_READY;
+  huart2.RxState = HAL_UART_STATE_READY;
+}
+
+void MX_SPI2_Init(void) {
+  hspi2.Instance = SPI2;
+}
+
+void MX_SPI3_Init(void) {
+  hspi3.Instance = SPI3;
+}
+
+/**************************************************************************//**
+ * @brief   Sets up a timer like the CubeMX generated tim.c does.
+ * @version 1.0
+ * @param   TIM_HandleTypeDef *htim, The timer handle.
+ * @param   TIM_TypeDef *instance, The timer.
+ * @param   uint32_t period, The Auto-Reload value.
+ * @return  None
+ *****************************************************************************/
+static void timer_init(TIM_HandleTypeDef *htim, TIM_TypeDef *instance, uint32_t period) {
+  htim->Instance = instance;
+  htim->Init.Prescaler = 40000 - 1;
+  htim->Init.Period = period;
+  instance->PSC = htim->Init.Prescaler;
+  instance->ARR = period;
+  instance->CNT = 0;
+  instance->SR = 0;
+}
+
+void MX_TIM3_Init(void) {
+  timer_init(&htim3, TIM3, 250 - 1);
+}
+
+void MX_TIM4_Init(void) {
+  timer_init(&htim4, TIM4, 10000 - 1);
+}
+
+void MX_TIM5_Init(void) {
+  timer_init(&htim5, TIM5, 30000 - 1);
+}
+
+void MX_TIM15_Init(void) {
+  timer_init(&htim15, TIM15, 60000 - 1);
+}
@@ -0,0 +1,127 @@
+/**************************************************************************//**
+ * @file     sim_main.c
+ * @brief    Main program of the host-simulated firmware.
+ *
+ * @details  Runs the unmodified traffic light firmware on a PC. Start-up
+ *           follows main.c, then the state machine is stepped in a loop
+ *           while the simulated time advances SIM_STEP_US per pass, paced
+ *           to the wall clock.
+ *
+ *           USART2 is a pseudo terminal, so every host tool (traffic_cli.py,
+ *           trace_decode.py, hil_standin.py) works against the simulation
+ *           the same way it does against the board:
+ *
+ *             build/traffic_sim --link /tmp/traffic.pty [--time SECONDS]
+ *
+ *           --screen prints the OLED framebuffer as text on exit, to check
+ *           the status page without a board.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Includes -----------------------------------------------------------------*/
+#include "main.h"
+#include "dma.h"
+#include "spi.h"
+#include "tim.h"
+#include "usart.h"
+#include "gpio.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "traffic_functions.h"
+#include "clock.h"
+#include "telemetry.h"
+#include "uart_stdio.h"
+#include "cmd_protocol.h"
+#include "sim.h"
+#include "ssd1306_config.h"
+
+/* Variables ----------------------------------------------------------------*/
+static volatile sig_atomic_t running = 1;
+
+/* Functions ----------------------------------------------------------------*/
+
+static void stop(int signum) {
+  (void)signum;
+  running = 0;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [--link PATH] [--time SECONDS] [--screen]\n", name);
+  exit(2);
+}
+
+static void print_screen(void) {
+  for (uint8_t y = 0; y < OLED_HEIGHT; y++) {
+    char row[OLED_WIDTH + 1];
+
+    for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+      const uint8_t column = OLED_framebuffer[(y / 8) * OLED_WIDTH + x];
+      row[x] = ((column >> (y % 8)) & 1u) ? '#' : '.';
+    }
+    row[OLED_WIDTH] = '\0';
+    printf("%s\n", row);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *link = NULL;
+  uint64_t end_us = 0;
+  bool screen = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+      link = argv[++i];
+    } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      end_us = (uint64_t)(atof(argv[++i]) * 1e6);
+    } else if (strcmp(argv[i], "--screen") == 0) {
+      screen = true;
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  SystemClock_Config();
+
+  MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_USART2_UART_Init();
+  telemetry_init();
+  uart_stdio_init();
+
+  MX_SPI3_Init();
+  MX_SPI2_Init();
+  MX_TIM3_Init();
+  MX_TIM4_Init();
+  MX_TIM5_Init();
+  MX_TIM15_Init();
+  cmd_protocol_init();
+
+  if (sim_uart_open(link) != 0) {
+    perror("USART2 pty");
+    return 1;
+  }
+
+  Traffic_init();
+  while (running && (end_us == 0 || sim_time_us() < end_us)) {
+    Traffic_step();
+    sim_advance(SIM_STEP_US);
+    sim_pace();
+  }
+
+  sim_uart_close();
+  if (screen) {
+    print_screen();
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Collects and compares benchmark results of the traffic light firmware.
+
+    bench_report.py capture /dev/ttyACM0 -o board.json
+    bench_report.py compare baseline.json board.json --metric p50 --threshold 5
+
+'capture' reads the USART2 telemetry stream of the benchmark firmware
+(BENCHMARK_ENABLED, see Core/Inc/benchmark.h) until the suite is done and
+saves the results. 'compare' prints the change of every benchmark between
+two result files and exits with 1 if one got slower by more than the
+threshold (percent).
+
+The host micro-benchmarks (make -C Host bench, see Host/Src/bench_main.c)
+write a result file directly, in nanoseconds per call instead of cycles.
+
+Result files hold {"suite": ..., "results": [{"bench": name, "unit": ...,
+"n": ..., "min": ..., "p50": ..., "p90": ..., "p99": ..., "max": ...,
+"mean": ...}, ...]}. Only the Python standard library is used.
+"""
+
+import argparse
+import json
+import os
+import select
+import sys
+import time
+
+from trace_decode import StreamDecoder, TELEMETRY_TEXT
+from cmd_protocol import open_port
+
+
+def capture(port, baud, timeout):
+    """Returns the result file contents for one run of the board suite."""
+    fd = open_port(port, baud)
+    decoder = StreamDecoder({})
+    text = ""
+    suite = {"suite": "board", "results": []}
+    deadline = time.monotonic() + timeout
+
+    while time.monotonic() < deadline:
+        ready, _, _ = select.select([fd], [], [], 0.5)
+        if not ready:
+            continue
+        for rtype, payload, _ in decoder.feed(os.read(fd, 4096)):
+            if rtype != TELEMETRY_TEXT:
+                continue
+            # Long lines arrive split over several records
+            text += payload.decode(errors="replace")
+            while "\n" in text:
+                line, text = text.split("\n", 1)
+                try:
+                    record = json.loads(line)
+                except ValueError:
+                    continue
+                if record.get("status") == "start":
+                    suite.update({k: v for k, v in record.items() if k != "status"})
+                    suite["results"] = []
+                elif record.get("status") == "done":
+                    return suite
+                elif "bench" in record:
+                    print("%-16s p50 %10s %s" % (record["bench"], record.get("p50", "-"), record.get("unit", "")),
+                          file=sys.stderr)
+                    suite["results"].append(record)
+    raise TimeoutError("benchmark suite did not finish within %d s" % timeout)
+
+
+def compare(old, new, metric, threshold):
+    """Prints the changes, returns the number of regressions."""
+    before = {r["bench"]: r for r in old["results"]}
+    regressions = 0
+
+    print("%-24s %12s %12s %9s  %s" % ("benchmark", "before", "after", "change", "unit"))
+    for result in new["results"]:
+        name = result["bench"]
+        if name not in before or metric not in result or metric not in before[name]:
+            print("%-24s %12s %12s %9s  %s" % (name, "-", result.get(metric, "-"), "new", result.get("unit", "")))
+            continue
+        a, b = before[name][metric], result[metric]
+        change = (b - a) * 100.0 / a if a else 0.0
+        mark = ""
+        if change > threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-24s %12g %12g %+8.1f%%  %s%s" % (name, a, b, change, result.get("unit", ""), mark))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+    cap = sub.add_parser("capture", help="record the results of the board suite")
+    cap.add_argument("port")
+    cap.add_argument("-b", "--baud", type=int, default=115200)
+    cap.add_argument("-o", "--output", default="-")
+    cap.add_argument("-t", "--timeout", type=int, default=120, help="seconds")
+    cmp = sub.add_parser("compare", help="compare two result files")
+    cmp.add_argument("before")
+    cmp.add_argument("after")
+    cmp.add_argument("-m", "--metric", default="p50")
+    cmp.add_argument("-t", "--threshold", type=float, default=5.0, help="percent")
+    args = parser.parse_args()
+
+    if args.command == "capture":
+        suite = capture(args.port, args.baud, args.timeout)
+        out = sys.stdout if args.output == "-" else open(args.output, "w")
+        json.dump(suite, out, indent=2)
+        out.write("\n")
+        return 0
+
+    with open(args.before) as before, open(args.after) as after:
+        regressions = compare(json.load(before), json.load(after), args.metric, args.threshold)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
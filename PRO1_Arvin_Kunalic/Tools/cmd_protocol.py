@@ -0,0 +1,235 @@
+"""
+Host side of the USART2 command protocol (see Core/Inc/cmd_protocol.h).
+
+Requests are COBS frames terminated by 0x00:
+
+    COBS( | seq | cmd | args ... | crc16 (LE) | ) 0x00
+
+Responses arrive on the telemetry stream as TELEMETRY_RESPONSE records:
+
+    | 0xA5 | 0x06 | len | seq | cmd | status | data ... | crc16 (LE) |
+
+Shared by traffic_cli.py, cmd_standin.py and hil_standin.py. Only the Python standard
+library is used.
+"""
+
+import os
+import select
+import struct
+
+from trace_decode import StreamDecoder, SYNC
+
+TELEMETRY_RESPONSE = 0x06
+
+PROTOCOL_VERSION = 1
+
+CMD_PING = 0x01
+CMD_STATUS = 0x02
+CMD_COUNTERS = 0x03
+CMD_GET_PARAM = 0x04
+CMD_SET_PARAM = 0x05
+CMD_RESET_PARAMS = 0x06
+CMD_LAMP_TEST = 0x07
+CMD_HIL_MODE = 0x08
+CMD_INJECT = 0x09
+CMD_PROFILE = 0x0A
+CMD_MEMORY = 0x0B
+
+PROFILE_READ = 0x00
+PROFILE_RESET = 0x01
+PROFILE_SHOW = 0x02
+
+# profile_probe_t, see Core/Inc/profile.h
+PROBES = ["exti", "tim3", "tim5", "traffic_step", "status_page"]
+
+STATUS_TEXT = {
+    0x00: "ok",
+    0x01: "unknown command",
+    0x02: "wrong argument length",
+    0x03: "unknown parameter",
+    0x04: "value out of range",
+    0x05: "not possible in this state",
+}
+
+# timer_param_t, see Core/Inc/timer_config.h: (name, default, min, max)
+PARAMS = [
+    ("step_delay", 3999 - 100, 200, 9999),
+    ("orange_delay", 5999 - 100, 200, 9999),
+    ("red_delay_max", 40000 - 30000 - 1 - 100, 0, 59999 - 201),
+    ("green_delay", 60000 - 30000 - 1 - 100, 0, 59999 - 201),
+    ("toggle_freq", 249, 24, 3999),
+    ("walk_time", 29999, 1999, 65535),
+]
+TIM4_PERIOD = 9999
+TIM4_MARGIN = 201
+SPEEDUP_MAX = 10
+
+# Input pins accepted by CMD_INJECT (GPIO_PIN_x of the EXTI line), active low
+INPUT_PINS = {
+    "car1": 1 << 4,
+    "car2": 1 << 13,
+    "car3": 1 << 14,
+    "car4": 1 << 10,
+    "PL1": 1 << 15,
+    "PL2": 1 << 7,
+}
+
+# Response data layouts (cmd_ping_t, cmd_status_t, ...)
+PING = struct.Struct("<BI")
+STATUS = struct.Struct("<BBBII")
+COUNTERS = struct.Struct("<7I")
+PARAM = struct.Struct("<BHHH")
+HIL = struct.Struct("<BB")
+INJECT = struct.Struct("<HB")
+PROFILE = struct.Struct("<BIIIIQ32I")
+
+COUNTER_NAMES = ["frames", "crc_errors", "frame_errors", "uart_errors",
+                 "telemetry_dropped", "stdio_dropped", "phase_changes"]
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("invalid COBS frame")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def with_crc(body):
+    return body + struct.pack("<H", crc16(body))
+
+
+def encode_request(seq, cmd, args=b""):
+    """Returns the bytes to send for one request, delimiter included."""
+    return cobs_encode(with_crc(bytes([seq, cmd]) + args)) + b"\0"
+
+
+def encode_response(seq, cmd, status, data=b""):
+    """Returns a complete TELEMETRY_RESPONSE record (used by the stand-in)."""
+    payload = with_crc(bytes([seq, cmd, status]) + data)
+    return bytes([SYNC, TELEMETRY_RESPONSE, len(payload)]) + payload
+
+
+def decode_response(payload):
+    """Splits a TELEMETRY_RESPONSE payload into (seq, cmd, status, data)."""
+    if len(payload) < 5 or crc16(payload[:-2]) != struct.unpack_from("<H", payload, len(payload) - 2)[0]:
+        raise ValueError("bad response CRC")
+    return payload[0], payload[1], payload[2], payload[3:-2]
+
+
+def param_id(name):
+    """Accepts a parameter name or number."""
+    if name.isdigit():
+        return int(name)
+    for index, param in enumerate(PARAMS):
+        if param[0] == name:
+            return index
+    raise ValueError("unknown parameter '%s'" % name)
+
+
+def open_port(path, baud=115200):
+    """Opens a serial device or pty for reading and writing, configured raw."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        import termios
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = 0
+        attrs[1] = 0
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0
+        attrs[4] = attrs[5] = getattr(termios, "B%d" % baud)
+        attrs[6][termios.VMIN] = 1
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+class Link:
+    """Sends requests and waits for the matching response on the telemetry stream.
+
+    Other records are passed to on_record(type, payload, text) as they arrive.
+    """
+
+    def __init__(self, fd, timeout=0.5, retries=3, on_record=None):
+        self.fd = fd
+        self.timeout = timeout
+        self.retries = retries
+        self.on_record = on_record
+        self.decoder = StreamDecoder({})
+        self.seq = 0
+
+    def request(self, cmd, args=b""):
+        """Returns (status, data), raises TimeoutError if the board does not answer."""
+        for _ in range(self.retries):
+            self.seq = (self.seq + 1) & 0xFF
+            os.write(self.fd, encode_request(self.seq, cmd, args))
+            reply = self._wait(self.seq, cmd)
+            if reply is not None:
+                return reply
+        raise TimeoutError("no response to command 0x%02x" % cmd)
+
+    def _wait(self, seq, cmd):
+        while True:
+            ready, _, _ = select.select([self.fd], [], [], self.timeout)
+            if not ready:
+                return None
+            data = os.read(self.fd, 4096)
+            if not data:
+                return None
+            for rtype, payload, text in self.decoder.feed(data):
+                if rtype != TELEMETRY_RESPONSE:
+                    if self.on_record:
+                        self.on_record(rtype, payload, text)
+                    continue
+                try:
+                    r_seq, r_cmd, status, body = decode_response(payload)
+                except ValueError:
+                    continue
+                if r_seq == seq and r_cmd == cmd:
+                    return status, body
+
+    def poll(self, timeout):
+        """Passes the records arriving within 'timeout' seconds to on_record."""
+        ready, _, _ = select.select([self.fd], [], [], max(timeout, 0))
+        if not ready:
+            return
+        for rtype, payload, text in self.decoder.feed(os.read(self.fd, 4096)):
+            if rtype != TELEMETRY_RESPONSE and self.on_record:
+                self.on_record(rtype, payload, text)
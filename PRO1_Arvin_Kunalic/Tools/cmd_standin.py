@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the board, answers the USART2 command protocol on a pty.
+
+Creates a pseudo terminal and behaves like the firmware on the other end:
+requests are COBS decoded and CRC checked, timing parameters are validated
+with the same limits as Core/Src/timer_config.c, and the responses are
+written as TELEMETRY_RESPONSE records. Useful to try traffic_cli.py (or
+any other host tool) without hardware.
+
+Examples:
+    cmd_standin.py --link /tmp/traffic.pty &
+    traffic_cli.py /tmp/traffic.pty params
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import tty
+
+import cmd_protocol as proto
+
+# Initial lamp word of the firmware (init_state in 595_shiftreg.c)
+INIT_LAMPS = 0x000400 | 0x000020 | 0x000800 | 0x010000 | 0x000001 | 0x100000
+
+
+class Board:
+    """State of the emulated firmware."""
+
+    def __init__(self):
+        self.start = time.monotonic()
+        self.params = [p[1] for p in proto.PARAMS]
+        self.counters = dict.fromkeys(proto.COUNTER_NAMES, 0)
+        self.lamps = INIT_LAMPS
+        self.test_until = 0.0
+        self.test_pattern = 0
+
+    def tick(self):
+        return int((time.monotonic() - self.start) * 1000) & 0xFFFFFFFF
+
+    def set_param(self, ident, value):
+        """Same rules as timer_param_set."""
+        _, _, low, high = proto.PARAMS[ident]
+        if not low <= value <= high:
+            return False
+        step, orange = self.params[0], self.params[1]
+        if ident == 0 and value + orange > proto.TIM4_PERIOD - proto.TIM4_MARGIN:
+            return False
+        if ident == 1 and value + step > proto.TIM4_PERIOD - proto.TIM4_MARGIN:
+            return False
+        self.params[ident] = value
+        return True
+
+    def handle(self, frame):
+        """Returns the response record for one decoded frame, or None."""
+        if len(frame) < 4:
+            self.counters["frame_errors"] += 1
+            return None
+        if proto.crc16(frame[:-2]) != struct.unpack_from("<H", frame, len(frame) - 2)[0]:
+            self.counters["crc_errors"] += 1
+            return None
+        self.counters["frames"] += 1
+
+        seq, cmd, args = frame[0], frame[1], frame[2:-2]
+
+        def reply(status, data=b""):
+            return proto.encode_response(seq, cmd, status, data)
+
+        if cmd == proto.CMD_PING:
+            return reply(0, proto.PING.pack(proto.PROTOCOL_VERSION, self.tick()))
+        if cmd == proto.CMD_STATUS:
+            testing = time.monotonic() < self.test_until
+            flags = 0b0110 | (testing << 4)       # TL2 and PL1 green, as after reset
+            return reply(0, proto.STATUS.pack(1, 0, flags, self.lamps, self.tick()))
+        if cmd == proto.CMD_COUNTERS:
+            return reply(0, proto.COUNTERS.pack(*(self.counters[n] for n in proto.COUNTER_NAMES)))
+        if cmd in (proto.CMD_GET_PARAM, proto.CMD_SET_PARAM):
+            if len(args) != (1 if cmd == proto.CMD_GET_PARAM else 3):
+                return reply(2)
+            ident = args[0]
+            if ident >= len(self.params):
+                return reply(3)
+            _, _, low, high = proto.PARAMS[ident]
+            status = 0
+            if cmd == proto.CMD_SET_PARAM and not self.set_param(ident, args[1] | (args[2] << 8)):
+                status = 4
+            return reply(status, proto.PARAM.pack(ident, self.params[ident], low, high))
+        if cmd == proto.CMD_RESET_PARAMS:
+            if args:
+                return reply(2)
+            self.params = [p[1] for p in proto.PARAMS]
+            return reply(0)
+        if cmd == proto.CMD_LAMP_TEST:
+            if len(args) != 6:
+                return reply(2)
+            self.test_pattern, ms = struct.unpack("<IH", args)
+            self.test_until = time.monotonic() + ms / 1000
+            return reply(0)
+        return reply(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--link", help="create a symlink to the pty at this path")
+    args = parser.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    name = os.ttyname(slave)
+    if args.link:
+        if os.path.islink(args.link):
+            os.unlink(args.link)
+        os.symlink(name, args.link)
+    print("stand-in listening on %s" % (args.link or name), flush=True)
+
+    board = Board()
+    frame = bytearray()
+    try:
+        while True:
+            for byte in os.read(master, 4096):
+                if byte:
+                    frame.append(byte)
+                    continue
+                if not frame:
+                    continue
+                try:
+                    response = board.handle(proto.cobs_decode(bytes(frame)))
+                except ValueError:
+                    board.counters["frame_errors"] += 1
+                    response = None
+                frame.clear()
+                if response:
+                    os.write(master, response)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.link and os.path.islink(args.link):
+            os.unlink(args.link)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+Decodes the crash dumps of the traffic light firmware.
+
+After a fault (or an Error_Handler call) the firmware resets and sends the
+dump saved in .noinit RAM as TELEMETRY_CRASH records early in the next boot
+(see Core/Inc/crash_dump.h). This tool waits for the records, puts the dump
+back together and prints it with the addresses symbolized against the ELF
+file: fault cause (CFSR/HFSR bits), registers, backtrace and the last
+telemetry events before the crash.
+
+Examples:
+    crash_decode.py -e Debug/PRO1_Arvin_Kunalic.elf /dev/ttyACM0
+    crash_decode.py -e Debug/PRO1_Arvin_Kunalic.elf /dev/ttyACM0 -o crash.bin
+    crash_decode.py -e Debug/PRO1_Arvin_Kunalic.elf --dump crash.bin
+
+File and line numbers are added when arm-none-eabi-addr2line is found
+(--addr2line). Otherwise only the Python standard library is used.
+"""
+
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+from trace_decode import (StreamDecoder, decode_record, format_table_from_elf, open_source,
+                          read_elf_section)
+
+TELEMETRY_CRASH = 0x08
+
+CRASH_MAGIC = 0xDEADC0DE
+CRASH_EVENTS = 16
+CRASH_EVENT_SIZE = 22
+
+# crash_dump_t without the events and the checksum
+HEADER = struct.Struct("<IHBBI8I2I4I8I")
+EVENT = struct.Struct("<BB%ds" % CRASH_EVENT_SIZE)
+DUMP_SIZE = HEADER.size + CRASH_EVENTS * EVENT.size + 4
+
+REASONS = {
+    3: "HardFault",
+    4: "MemManage fault",
+    5: "BusFault",
+    6: "UsageFault",
+    0x80: "Error_Handler",
+}
+
+# SCB->CFSR bits (MMFSR, BFSR, UFSR) and SCB->HFSR bits
+CFSR_BITS = [
+    (0, "IACCVIOL: instruction access violation"),
+    (1, "DACCVIOL: data access violation"),
+    (3, "MUNSTKERR: MemManage fault on exception return"),
+    (4, "MSTKERR: MemManage fault on exception entry (stack overflow?)"),
+    (5, "MLSPERR: MemManage fault during FPU lazy state preservation"),
+    (7, "MMARVALID: MMFAR holds the fault address"),
+    (8, "IBUSERR: instruction bus error"),
+    (9, "PRECISERR: precise data bus error"),
+    (10, "IMPRECISERR: imprecise data bus error"),
+    (11, "UNSTKERR: BusFault on exception return"),
+    (12, "STKERR: BusFault on exception entry (stack overflow?)"),
+    (13, "LSPERR: BusFault during FPU lazy state preservation"),
+    (15, "BFARVALID: BFAR holds the fault address"),
+    (16, "UNDEFINSTR: undefined instruction"),
+    (17, "INVSTATE: invalid state (Thumb bit clear, bad function pointer?)"),
+    (18, "INVPC: invalid EXC_RETURN"),
+    (19, "NOCP: coprocessor access (FPU disabled?)"),
+    (24, "UNALIGNED: unaligned access"),
+    (25, "DIVBYZERO: division by zero"),
+]
+HFSR_BITS = [
+    (1, "VECTTBL: vector table read fault"),
+    (30, "FORCED: escalated from a configurable fault"),
+    (31, "DEBUGEVT: debug event"),
+]
+
+
+def checksum(data):
+    """32-bit FNV-1a, as in crash_dump.c."""
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+# --- Symbols ----------------------------------------------------------------
+
+class Symbolizer:
+    """Maps code addresses to function+offset, and file:line with addr2line."""
+
+    def __init__(self, elf, addr2line=None):
+        self.elf = elf
+        self.addr2line = addr2line
+        self.functions = read_functions(elf) if elf else []
+
+    def name(self, addr):
+        addr &= ~1
+        for start, size, name in self.functions:
+            if start <= addr < start + max(size, 1):
+                return "%s+0x%x" % (name, addr - start)
+        return "?"
+
+    def line(self, addr):
+        if not self.addr2line:
+            return ""
+        try:
+            out = subprocess.run([self.addr2line, "-e", self.elf, "0x%x" % (addr & ~1)],
+                                 capture_output=True, text=True, check=True).stdout.strip()
+        except (OSError, subprocess.CalledProcessError):
+            return ""
+        return "" if out.startswith("??") else out
+
+    def describe(self, addr):
+        text = "0x%08x %s" % (addr, self.name(addr))
+        line = self.line(addr)
+        return text + ("  " + line if line else "")
+
+
+def read_functions(path):
+    """Returns the sorted (address, size, name) of every function in the ELF."""
+    symtab = read_elf_section(path, ".symtab")
+    strtab = read_elf_section(path, ".strtab")
+    functions = []
+    for offset in range(0, len(symtab), 16):
+        st_name, st_value, st_size, st_info = struct.unpack_from("<IIIB", symtab, offset)
+        if st_info & 0x0F != 2:     # STT_FUNC
+            continue
+        name = strtab[st_name:strtab.index(b"\0", st_name)].decode(errors="replace")
+        functions.append((st_value & ~1, st_size, name))
+    functions.sort()
+    return functions
+
+
+# --- Dump -------------------------------------------------------------------
+
+def bits(value, table):
+    return [text for bit, text in table if value & (1 << bit)]
+
+
+def print_dump(raw, symbols, table, out=sys.stdout):
+    """Prints a complete dump."""
+    if len(raw) != DUMP_SIZE:
+        print("warning: dump has %d bytes, expected %d" % (len(raw), DUMP_SIZE), file=out)
+        raw = raw[:DUMP_SIZE].ljust(DUMP_SIZE, b"\0")
+
+    fields = HEADER.unpack_from(raw)
+    magic, size, reason, events, tick = fields[:5]
+    r0, r1, r2, r3, r12, lr, pc, xpsr = fields[5:13]
+    sp, exc_return, cfsr, hfsr, mmfar, bfar = fields[13:19]
+    backtrace = fields[19:]
+    check, = struct.unpack_from("<I", raw, DUMP_SIZE - 4)
+
+    if magic != CRASH_MAGIC or checksum(raw[:-4]) != check:
+        print("warning: bad magic or checksum, the dump may be damaged", file=out)
+
+    print("CRASH %s at %d ms" % (REASONS.get(reason, "reason %d" % reason), tick), file=out)
+    if reason == 0x80:
+        print("  called from %s" % symbols.describe(pc), file=out)
+    else:
+        print("  pc   %s" % symbols.describe(pc), file=out)
+        print("  lr   %s" % symbols.describe(lr), file=out)
+        print("  r0 %08x  r1 %08x  r2 %08x  r3 %08x  r12 %08x" % (r0, r1, r2, r3, r12), file=out)
+        print("  xpsr %08x  sp %08x  exc_return %08x (%s stack%s)" % (
+            xpsr, sp, exc_return, "process" if exc_return & 4 else "main",
+            "" if exc_return & 0x10 else ", FPU frame"), file=out)
+
+    print("  cfsr %08x  hfsr %08x" % (cfsr, hfsr), file=out)
+    for text in bits(cfsr, CFSR_BITS) + bits(hfsr, HFSR_BITS):
+        print("    %s" % text, file=out)
+    if cfsr & (1 << 7):
+        print("    fault address (MMFAR) 0x%08x" % mmfar, file=out)
+    if cfsr & (1 << 15):
+        print("    fault address (BFAR) 0x%08x" % bfar, file=out)
+
+    print("backtrace (stack scan, may hold stale frames)", file=out)
+    for n, addr in enumerate(a for a in backtrace if a):
+        print("  #%d %s" % (n, symbols.describe(addr)), file=out)
+
+    print("last %d events" % events, file=out)
+    for n in range(min(events, CRASH_EVENTS)):
+        rtype, length, payload = EVENT.unpack_from(raw, HEADER.size + n * EVENT.size)
+        print("  %s" % decode_record(rtype, payload[:length], table).strip(), file=out)
+
+
+class DumpCollector:
+    """Puts the TELEMETRY_CRASH records of one dump back together."""
+
+    def __init__(self):
+        self.data = bytearray()
+
+    def feed(self, payload):
+        """Takes one record payload, returns the dump once it is complete."""
+        offset, = struct.unpack_from("<H", payload)
+        if offset == 0:
+            self.data = bytearray()
+        if offset != len(self.data):
+            self.data = bytearray()     # A record was lost
+            return None
+        self.data += payload[2:]
+        if len(self.data) >= DUMP_SIZE:
+            dump, self.data = bytes(self.data[:DUMP_SIZE]), bytearray()
+            return dump
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", nargs="?", help="serial device, capture file or '-'")
+    parser.add_argument("-e", "--elf", help="firmware ELF file for the symbols")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-o", "--output", help="also save the raw dump to this file")
+    parser.add_argument("--dump", help="decode a raw dump saved with -o")
+    parser.add_argument("--follow", action="store_true", help="keep waiting for further dumps")
+    parser.add_argument("--addr2line", default=shutil.which("arm-none-eabi-addr2line"),
+                        help="addr2line of the ARM toolchain, for file:line")
+    args = parser.parse_args()
+
+    symbols = Symbolizer(args.elf, args.addr2line if args.elf else None)
+    table = {}
+    if args.elf:
+        try:
+            table = format_table_from_elf(args.elf)
+        except ValueError:
+            pass
+
+    if args.dump:
+        with open(args.dump, "rb") as f:
+            print_dump(f.read(), symbols, table)
+        return 0
+
+    if not args.source:
+        parser.error("a source or --dump is required")
+
+    fd = open_source(args.source, args.baud)
+    decoder = StreamDecoder(table)
+    collector = DumpCollector()
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for rtype, payload, _ in decoder.feed(data):
+                if rtype != TELEMETRY_CRASH or len(payload) < 2:
+                    continue
+                dump = collector.feed(payload)
+                if dump is None:
+                    continue
+                if args.output:
+                    with open(args.output, "wb") as f:
+                        f.write(dump)
+                print_dump(dump, symbols, table)
+                sys.stdout.flush()
+                if not args.follow:
+                    return 0
+    except KeyboardInterrupt:
+        pass
+    return 1 if not args.follow else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
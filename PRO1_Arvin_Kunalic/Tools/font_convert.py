@@ -0,0 +1,434 @@
+#!/usr/bin/env python3
+"""
+Converts the display assets into flash-resident C tables.
+
+Reads Assets/assets.txt, converts every BDF font and PBM bitmap listed in
+it and writes Core/Src/assets.c and Core/Inc/assets.h, the font_t and
+bitmap_t tables of Core/Inc/glyph.h:
+
+    font_convert.py             regenerate assets.c and assets.h
+    font_convert.py --check     exit with 1 if they are out of date
+
+Each asset is stored raw (framebuffer layout), bit-packed or run-length
+coded (see glyph.h); 'auto' picks the smallest, glyph table included. A
+font can be scaled up by an integer factor for large digits, limited to a
+range of characters so only the glyphs used take flash, and made
+proportional by trimming the empty columns of every glyph. A size summary
+is printed per asset.
+
+TrueType fonts are rasterized to BDF first at the wanted pixel size, e.g.
+with otf2bdf (otf2bdf -p 16 -r 72 font.ttf -o font16.bdf) or FontForge.
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MANIFEST = os.path.join(ROOT, "Assets", "assets.txt")
+SOURCE = os.path.join(ROOT, "Core", "Src", "assets.c")
+HEADER = os.path.join(ROOT, "Core", "Inc", "assets.h")
+
+ENCODINGS = ("raw", "packed", "rle")
+GLYPH_SIZE = 4                  # sizeof(glyph_t)
+
+BANNER = """\
+/**************************************************************************//**
+ * @file     %s
+ * @brief    Fonts and bitmaps of the OLED, generated from Assets/assets.txt.
+ *
+ * @details  Generated by Tools/font_convert.py, do not edit. Rerun the script
+ *           after changing an asset or the list.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+"""
+
+
+class Asset:
+    """A font or bitmap: glyphs of pixel columns, bit 0 = top row."""
+
+    def __init__(self, kind, name, height):
+        self.kind = kind
+        self.name = name
+        self.height = height
+        self.glyphs = []        # [(character or None, [column, ...])]
+        self.spacing = 0
+        self.encoding = None
+        self.data = b""
+        self.offsets = []
+
+
+def parse_bdf(path):
+    """Returns the cell height and {code: [column, ...]} of a BDF font."""
+    ascent = descent = None
+    glyphs = {}
+    with open(path) as f:
+        lines = [line.strip() for line in f]
+
+    bbox = None
+    i = 0
+    while i < len(lines):
+        words = lines[i].split()
+        i += 1
+        if not words:
+            continue
+        if words[0] == "FONTBOUNDINGBOX":
+            bbox = [int(w) for w in words[1:5]]
+        elif words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "STARTCHAR":
+            code = advance = box = None
+            rows = []
+            while i < len(lines) and lines[i] != "ENDCHAR":
+                words = lines[i].split()
+                i += 1
+                if not words:
+                    continue
+                if words[0] == "ENCODING":
+                    code = int(words[1])
+                elif words[0] == "DWIDTH":
+                    advance = int(words[1])
+                elif words[0] == "BBX":
+                    box = [int(w) for w in words[1:5]]
+                elif words[0] == "BITMAP":
+                    while i < len(lines) and lines[i] != "ENDCHAR":
+                        rows.append(lines[i])
+                        i += 1
+            i += 1
+            if code is not None and code >= 0 and box:
+                glyphs[code] = (advance if advance is not None else box[0], box, rows)
+
+    if ascent is None or descent is None:
+        if not bbox:
+            sys.exit("%s: no FONT_ASCENT/FONT_DESCENT or FONTBOUNDINGBOX" % path)
+        ascent, descent = bbox[1] + bbox[3], -bbox[3]
+    height = ascent + descent
+
+    columns = {}
+    for code, (advance, (w, h, xoff, yoff), rows) in glyphs.items():
+        cols = [0] * max(advance, xoff + w, 0)
+        for r, text in enumerate(rows):
+            bits = int(text, 16) if text else 0
+            top = ascent - (yoff + h) + r
+            for c in range(w):
+                x = xoff + c
+                if 0 <= x < len(cols) and 0 <= top < height and bits >> (len(text) * 4 - 1 - c) & 1:
+                    cols[x] |= 1 << top
+        columns[code] = cols
+    return height, columns
+
+
+def pbm_tokens(data):
+    """Splits the header of a PBM file, comments removed; returns the tokens
+    and the offset of the raster."""
+    tokens = []
+    pos = 0
+    while len(tokens) < 3:
+        while pos < len(data) and chr(data[pos]).isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            while pos < len(data) and data[pos:pos + 1] != b"\n":
+                pos += 1
+            continue
+        start = pos
+        while pos < len(data) and not chr(data[pos]).isspace():
+            pos += 1
+        tokens.append(data[start:pos].decode())
+    return tokens, pos + 1
+
+
+def parse_pbm(path):
+    """Returns the width, height and columns of a PBM image (P1 or P4)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    (magic, width, height), pos = pbm_tokens(data)
+    width, height = int(width), int(height)
+
+    if magic == "P1":
+        text = re.sub(rb"#[^\n]*", b"", data[pos:])
+        bits = [int(chr(b)) for b in text if chr(b) in "01"]
+    elif magic == "P4":
+        stride = (width + 7) // 8
+        bits = []
+        for y in range(height):
+            row = data[pos + y * stride:pos + (y + 1) * stride]
+            bits += [row[x // 8] >> (7 - x % 8) & 1 for x in range(width)]
+    else:
+        sys.exit("%s: not a PBM file (P1 or P4)" % path)
+    if len(bits) < width * height:
+        sys.exit("%s: image data too short" % path)
+
+    columns = [0] * width
+    for y in range(height):
+        for x in range(width):
+            if bits[y * width + x]:
+                columns[x] |= 1 << y
+    return width, height, columns
+
+
+def trim_columns(columns, space):
+    """Removes the empty columns left and right of a glyph; an empty glyph
+    (the space) gets 'space' empty columns."""
+    used = [i for i, column in enumerate(columns) if column]
+    if not used:
+        return [0] * space
+    return columns[used[0]:used[-1] + 1]
+
+
+def scale_columns(columns, height, factor):
+    """Scales glyph columns up by an integer factor."""
+    scaled = []
+    for column in columns:
+        big = 0
+        for y in range(height):
+            if column >> y & 1:
+                big |= ((1 << factor) - 1) << (y * factor)
+        scaled += [big] * factor
+    return scaled
+
+
+def encode_raw(columns, height):
+    out = bytearray()
+    for page in range((height + 7) // 8):
+        out += bytes(column >> (page * 8) & 0xFF for column in columns)
+    return bytes(out)
+
+
+def encode_packed(columns, height):
+    out = bytearray()
+    bits = count = 0
+    for column in columns:
+        bits |= (column & ((1 << height) - 1)) << count
+        count += height
+        while count >= 8:
+            out.append(bits & 0xFF)
+            bits >>= 8
+            count -= 8
+    if count:
+        out.append(bits & 0xFF)
+    return bytes(out)
+
+
+def encode_rle(columns, height):
+    """Run-length codes the raw bytes: c < 0x80 is followed by c + 1 bytes,
+    c >= 0x80 by one byte repeated c - 0x7E times."""
+    raw = encode_raw(columns, height)
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    while i < len(raw):
+        run = 1
+        while i + run < len(raw) and raw[i + run] == raw[i] and run < 129:
+            run += 1
+        if run >= 2:
+            while literal:
+                out.append(len(literal[:128]) - 1)
+                out += literal[:128]
+                literal = literal[128:]
+            out += bytes((0x7E + run, raw[i]))
+            i += run
+        else:
+            literal.append(raw[i])
+            i += 1
+    while literal:
+        out.append(len(literal[:128]) - 1)
+        out += literal[:128]
+        literal = literal[128:]
+    return bytes(out)
+
+
+ENCODERS = {"raw": encode_raw, "packed": encode_packed, "rle": encode_rle}
+
+
+def fixed_width(asset):
+    widths = {len(columns) for _, columns in asset.glyphs}
+    return len(widths) == 1 and asset.kind == "font"
+
+
+def encode(asset, encoding):
+    """Encodes every glyph, returns the data, offsets and total size."""
+    data = bytearray()
+    offsets = []
+    for _, columns in asset.glyphs:
+        offsets.append(len(data))
+        data += ENCODERS[encoding](columns, asset.height)
+    size = len(data)
+    if asset.kind == "font" and (encoding == "rle" or not fixed_width(asset)):
+        size += GLYPH_SIZE * len(asset.glyphs)
+    return bytes(data), offsets, size
+
+
+def load(kind, name, path, options):
+    """Loads one manifest entry."""
+    encoding = options.get("encoding", "auto")
+    if encoding not in ENCODINGS + ("auto",):
+        sys.exit("%s: unknown encoding '%s'" % (name, encoding))
+
+    if kind == "font":
+        height, glyphs = parse_bdf(path)
+        first, last = 0x20, 0x7E
+        if "range" in options:
+            first, last = (int(v, 0) for v in options["range"].split("-"))
+        factor = int(options.get("scale", 1))
+        asset = Asset(kind, name, height * factor)
+        asset.spacing = int(options.get("spacing", 1))
+        space = int(options.get("space", (len(glyphs.get(0x20, [0] * 4)) + 1) // 2))
+        for code in range(first, last + 1):
+            if code not in glyphs:
+                sys.exit("%s: character 0x%02X is not in %s" % (name, code, path))
+            columns = glyphs[code]
+            if "proportional" in options:
+                columns = trim_columns(columns, space)
+            asset.glyphs.append((code, scale_columns(columns, height, factor)))
+    elif kind == "bitmap":
+        width, height, columns = parse_pbm(path)
+        asset = Asset(kind, name, height)
+        asset.glyphs.append((None, columns))
+    else:
+        sys.exit("unknown asset kind '%s'" % kind)
+
+    if asset.height > 64 or any(len(c) > 255 for _, c in asset.glyphs):
+        sys.exit("%s: larger than the display" % name)
+
+    candidates = ENCODINGS if encoding == "auto" else (encoding,)
+    sizes = {e: encode(asset, e) for e in candidates}
+    asset.encoding = min(candidates, key=lambda e: sizes[e][2])
+    asset.data, asset.offsets, asset.size = sizes[asset.encoding]
+    asset.raw_size = encode(asset, "raw")[2]
+    return asset
+
+
+def read_manifest(path):
+    assets = []
+    base = os.path.dirname(path)
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            if len(words) < 3:
+                sys.exit("%s:%d: expected '<kind> <name> <file> [option=value ...]'" % (path, number))
+            options = dict((w.split("=", 1) + ["1"])[:2] for w in words[3:])
+            assets.append(load(words[0], words[1], os.path.join(base, words[2]), options))
+    return assets
+
+
+def c_bytes(data, indent="    "):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + 12]) + ",")
+    return lines
+
+
+def char_comment(code):
+    return "'\\''" if code == 0x27 else "'%s'" % chr(code)
+
+
+def generate(assets):
+    header = [BANNER % "assets.h",
+              "/* Define to prevent recursive inclusion ------------------------------------*/",
+              "#ifndef ASSETS_H", "#define ASSETS_H", "",
+              "/* Includes -----------------------------------------------------------------*/",
+              '#include "glyph.h"', "",
+              "/* Exported variables -------------------------------------------------------*/"]
+    source = [BANNER % "assets.c",
+              "/* Includes -----------------------------------------------------------------*/",
+              "#include <stdint.h>", "", '#include "assets.h"', "",
+              "/* Variables ----------------------------------------------------------------*/"]
+
+    for asset in assets:
+        encoding = "GLYPH_" + asset.encoding.upper()
+        if asset.kind == "font":
+            widths = [len(columns) for _, columns in asset.glyphs]
+            first, last = asset.glyphs[0][0], asset.glyphs[-1][0]
+            table = asset.encoding == "rle" or not fixed_width(asset)
+            header.append("extern const font_t %s;%s/* %d rows, %s */" % (
+                asset.name, " " * max(1, 24 - len(asset.name)), asset.height, asset.encoding))
+
+            source.append("static const uint8_t %s_data[] = {" % asset.name)
+            for i, (code, _) in enumerate(asset.glyphs):
+                end = asset.offsets[i + 1] if i + 1 < len(asset.offsets) else len(asset.data)
+                source.append("    /* %s */" % char_comment(code))
+                source += c_bytes(asset.data[asset.offsets[i]:end])
+            source.append("};")
+            if table:
+                source.append("")
+                source.append("static const glyph_t %s_glyphs[] = {" % asset.name)
+                for (code, _), offset, width in zip(asset.glyphs, asset.offsets, widths):
+                    source.append("    {%5d, %3d}, // %s" % (offset, width, char_comment(code)))
+                source.append("};")
+            source += ["",
+                       "const font_t %s = {" % asset.name,
+                       "    .data = %s_data," % asset.name,
+                       "    .glyphs = %s," % ("%s_glyphs" % asset.name if table else "NULL"),
+                       "    .first = 0x%02X," % first,
+                       "    .last = 0x%02X," % last,
+                       "    .width = %d," % max(widths),
+                       "    .height = %d," % asset.height,
+                       "    .spacing = %d," % asset.spacing,
+                       "    .encoding = %s," % encoding,
+                       "};", ""]
+        else:
+            width = len(asset.glyphs[0][1])
+            header.append("extern const bitmap_t %s;%s/* %dx%d, %s */" % (
+                asset.name, " " * max(1, 22 - len(asset.name)), width, asset.height, asset.encoding))
+            source.append("static const uint8_t %s_data[] = {" % asset.name)
+            source += c_bytes(asset.data)
+            source += ["};", "",
+                       "const bitmap_t %s = {" % asset.name,
+                       "    .data = %s_data," % asset.name,
+                       "    .width = %d," % width,
+                       "    .height = %d," % asset.height,
+                       "    .encoding = %s," % encoding,
+                       "};", ""]
+
+    header += ["", "#endif"]
+    return "\n".join(source).rstrip("\n") + "\n", "\n".join(header) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--manifest", default=MANIFEST, help="list of the assets")
+    parser.add_argument("--source", default=SOURCE, help="C file to write")
+    parser.add_argument("--header", default=HEADER, help="header to write")
+    parser.add_argument("--check", action="store_true",
+                        help="only check that the files are up to date")
+    args = parser.parse_args()
+
+    assets = read_manifest(args.manifest)
+    source, header = generate(assets)
+
+    if args.check:
+        stale = []
+        for path, text in ((args.source, source), (args.header, header)):
+            try:
+                with open(path, newline="") as f:
+                    current = f.read()
+            except OSError:
+                current = None
+            if current != text:
+                stale.append(path)
+        for path in stale:
+            print("%s is out of date, run Tools/font_convert.py" % path, file=sys.stderr)
+        return 1 if stale else 0
+
+    for asset in assets:
+        print("%-20s %-6s %3d glyphs %2d rows  %-6s %5d bytes (raw %d)" % (
+            asset.name, asset.kind, len(asset.glyphs), asset.height, asset.encoding,
+            asset.size, asset.raw_size))
+    for path, text in ((args.source, source), (args.header, header)):
+        with open(path, "w", newline="") as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""
+Generates Core/Inc/gpio_pins.h from the CubeMX project file.
+
+Every pin of the .ioc file with a GPIO signal (output, input or EXTI) and a
+user label becomes a compile-time pin: its port, port index and bit mask as
+macros, used by the PIN_SET/PIN_RESET/PIN_WRITE/PIN_READ macros of the
+header. With constant arguments each one compiles to a single BSRR, BRR or
+IDR access, PIN_WRITE2/PIN_WRITE3 write pins of one port in one BSRR store.
+
+    gen_pins.py                 regenerate the header
+    gen_pins.py --check         exit with 1 if the header is out of date
+
+Run it after changing pins in CubeMX. Labels are turned into names the way
+CubeMX does for main.h ("LD2 [green Led]" -> LD2, "Disp_Data/Instr" ->
+Disp_Data_Instr). Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+IOC = os.path.join(ROOT, "PRO1_Arvin_Kunalic.ioc")
+HEADER = os.path.join(ROOT, "Core", "Inc", "gpio_pins.h")
+
+GPIO_SIGNAL = re.compile(r"^(GPIO_Output|GPIO_Input|GPXTI\d+)$")
+PIN_NAME = re.compile(r"^P([A-H])(\d+)")
+
+PROLOGUE = """\
+/**************************************************************************//**
+ * @file     gpio_pins.h
+ * @brief    Compile-time GPIO pins, generated from PRO1_Arvin_Kunalic.ioc.
+ *
+ * @details  Generated by Tools/gen_pins.py, do not edit. Rerun the script
+ *           after changing pins in CubeMX.
+ *
+ *           A pin is named by its CubeMX label, e.g. PIN_SET(Disp_CS). The
+ *           port and mask are constants, so with FAST_IO_ENABLED (see
+ *           fast_io.h) every macro is one store to BSRR/BRR or one load of
+ *           IDR. PIN_WRITE2 and PIN_WRITE3 set and clear pins of the same
+ *           port in one BSRR store, pins on different ports do not compile.
+ *
+ *           With FAST_IO_ENABLED set to 0 the macros call the HAL instead,
+ *           one call per pin.
+ *
+ ******************************************************************************
+ * @author   Arvin Kunalic
+ * @version  1.0
+ * @date     17-October-2026
+ *****************************************************************************/
+
+/* Define to prevent recursive inclusion ------------------------------------*/
+#ifndef GPIO_PINS_H
+#define GPIO_PINS_H
+
+/* Includes -----------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "main.h"
+#include "fast_io.h"
+
+/* Exported constants -------------------------------------------------------*/
+/* Labelled GPIO pins, by port and pin number */
+"""
+
+EPILOGUE = """
+/* Exported macros ----------------------------------------------------------*/
+
+/* BSRR word that sets (value != 0) or clears a pin */
+#define PIN_BSRR(p, value)      ((value) ? PIN_##p##_MASK : PIN_##p##_MASK << 16)
+
+#define PIN_SAME_PORT(a, b) \\
+  _Static_assert(PIN_##a##_PORT_ID == PIN_##b##_PORT_ID, #a " and " #b " are on different ports")
+
+#if FAST_IO_ENABLED
+
+#define PIN_SET(p)              (PIN_##p##_PORT->BSRR = PIN_##p##_MASK)
+#define PIN_RESET(p)            (PIN_##p##_PORT->BRR = PIN_##p##_MASK)
+#define PIN_WRITE(p, value)     (PIN_##p##_PORT->BSRR = PIN_BSRR(p, value))
+#define PIN_READ(p)             ((PIN_##p##_PORT->IDR & PIN_##p##_MASK) != 0u)
+
+#define PIN_WRITE2(a, va, b, vb) do { \\
+    PIN_SAME_PORT(a, b); \\
+    PIN_##a##_PORT->BSRR = PIN_BSRR(a, va) | PIN_BSRR(b, vb); \\
+  } while (0)
+
+#define PIN_WRITE3(a, va, b, vb, c, vc) do { \\
+    PIN_SAME_PORT(a, b); \\
+    PIN_SAME_PORT(a, c); \\
+    PIN_##a##_PORT->BSRR = PIN_BSRR(a, va) | PIN_BSRR(b, vb) | PIN_BSRR(c, vc); \\
+  } while (0)
+
+#else
+
+#define PIN_SET(p)              HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, GPIO_PIN_SET)
+#define PIN_RESET(p)            HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, GPIO_PIN_RESET)
+#define PIN_WRITE(p, value) \\
+  HAL_GPIO_WritePin(PIN_##p##_PORT, PIN_##p##_MASK, (value) ? GPIO_PIN_SET : GPIO_PIN_RESET)
+#define PIN_READ(p)             (HAL_GPIO_ReadPin(PIN_##p##_PORT, PIN_##p##_MASK) == GPIO_PIN_SET)
+
+#define PIN_WRITE2(a, va, b, vb) do { \\
+    PIN_SAME_PORT(a, b); \\
+    PIN_WRITE(a, va); \\
+    PIN_WRITE(b, vb); \\
+  } while (0)
+
+#define PIN_WRITE3(a, va, b, vb, c, vc) do { \\
+    PIN_SAME_PORT(a, b); \\
+    PIN_SAME_PORT(a, c); \\
+    PIN_WRITE(a, va); \\
+    PIN_WRITE(b, vb); \\
+    PIN_WRITE(c, vc); \\
+  } while (0)
+
+#endif
+
+#endif
+"""
+
+
+def read_ioc(path):
+    """Returns the key/value pairs of a CubeMX project file."""
+    pairs = {}
+    with open(path) as f:
+        for line in f:
+            key, sep, value = line.rstrip("\r\n").partition("=")
+            if sep and not key.startswith("#"):
+                pairs[key.replace("\\ ", " ")] = value
+    return pairs
+
+
+def label_name(label):
+    """Turns a GPIO label into the C name CubeMX uses in main.h."""
+    return re.sub(r"[^A-Za-z0-9_]", "_", label.split(" ")[0])
+
+
+def gpio_pins(pairs):
+    """Returns the sorted (name, port letter, pin number) of the labelled GPIOs."""
+    pins = []
+    for key, signal in pairs.items():
+        pin, _, field = key.rpartition(".")
+        if field != "Signal" or not GPIO_SIGNAL.match(signal):
+            continue
+        label = pairs.get(pin + ".GPIO_Label")
+        match = PIN_NAME.match(pin)
+        if not label or not match:
+            continue
+        pins.append((label_name(label), match.group(1), int(match.group(2))))
+    return sorted(pins, key=lambda p: (p[1], p[2]))
+
+
+def generate(pins):
+    lines = [PROLOGUE]
+    for name, port, number in pins:
+        lines.append("#define %-32s GPIO%s\n" % ("PIN_%s_PORT" % name, port))
+        lines.append("#define %-32s %d\n" % ("PIN_%s_PORT_ID" % name, ord(port) - ord("A")))
+        lines.append("#define %-32s (1u << %d)\n" % ("PIN_%s_MASK" % name, number))
+    return "".join(lines) + EPILOGUE
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--ioc", default=IOC, help="CubeMX project file")
+    parser.add_argument("-o", "--output", default=HEADER, help="header to write")
+    parser.add_argument("--check", action="store_true",
+                        help="only check that the header is up to date")
+    args = parser.parse_args()
+
+    text = generate(gpio_pins(read_ioc(args.ioc)))
+
+    if args.check:
+        try:
+            with open(args.output, newline="") as f:
+                current = f.read()
+        except OSError:
+            current = None
+        if current != text:
+            print("%s is out of date, run Tools/gen_pins.py" % args.output, file=sys.stderr)
+            return 1
+        return 0
+
+    with open(args.output, "w", newline="") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
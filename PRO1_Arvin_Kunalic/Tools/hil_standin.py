@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+Hardware-in-the-loop stand-in for the sensors and buttons of the traffic
+light board.
+
+Puts the firmware in HIL mode (see Core/Inc/hil.h), plays a scenario of car
+sensor and pedestrian button changes over the USART2 command protocol and
+checks the lamp words reported on the telemetry stream:
+
+    hil_standin.py /dev/ttyACM0 scenarios/pedestrian_pl1.txt --speedup 10
+    hil_standin.py /tmp/traffic.pty scenarios/car_priority.txt --log run.json
+
+The port can be the board or the pty of the host-simulated firmware
+(Host/build/traffic_sim). Scenario lines are '<time> <action>', the time
+is in seconds of firmware time since the start of the scenario:
+
+    0     car 1 on              car sensor 1-4 on (car present) or off
+    2.5   button PL1            pedestrian button PL1 or PL2 pressed
+    2.5   button PL1 down       pedestrian button held down, or released
+                                ('up'); the board sees the request on
+                                release
+    0     set orange_delay 5000
+                                timing parameter in timer ticks (names as
+                                in cmd_protocol.py), it has to be accepted
+    8     expect TL1_Green !PL1_Green
+                                lamp word at that time (names as printed
+                                by trace_decode.py, '!' = off)
+    8     expect PL1_Green within 4
+                                lamp word has to match at some time in
+                                the following 4 seconds
+    30    end
+
+'#' starts a comment. Parameters that were set are reset at the end. With
+--speedup the timers of the firmware run that many times faster and the
+scenario is played faster by the same factor.
+The HAL tick is not sped up, so the 10ms shift register latch delay and
+the OLED updates grow relative to the scenario; keep 'within' windows
+generous at high factors.
+
+The exit status is 1 if any expectation failed. Only the Python standard
+library is used.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+import cmd_protocol as proto
+from trace_decode import LAMPS, TELEMETRY_LAMPS, TELEMETRY_PHASE, STATES, EVENT, lamp_names
+
+LAMP_MASKS = {name: mask for mask, name in LAMPS}
+CARS = ["car1", "car2", "car3", "car4"]
+BUTTON_PRESS = 0.1  # Seconds of firmware time a button is held down
+
+
+class ScenarioError(Exception):
+    pass
+
+
+def parse_condition(tokens, line_no):
+    """Returns (mask, value) for tokens such as ['TL1_Green', '!TL1_Red']."""
+    mask = value = 0
+    for token in tokens:
+        name = token.lstrip("!")
+        if name not in LAMP_MASKS:
+            raise ScenarioError("line %d: unknown lamp '%s'" % (line_no, name))
+        mask |= LAMP_MASKS[name]
+        if not token.startswith("!"):
+            value |= LAMP_MASKS[name]
+    if not mask:
+        raise ScenarioError("line %d: empty expectation" % line_no)
+    return mask, value
+
+
+def parse_scenario(path):
+    """Returns the actions sorted by time and the end time."""
+    actions = []
+    end = None
+    with open(path) as source:
+        for line_no, line in enumerate(source, 1):
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            try:
+                at = float(words[0])
+            except ValueError:
+                raise ScenarioError("line %d: bad time '%s'" % (line_no, words[0]))
+            kind, args = (words[1], words[2:]) if len(words) > 1 else ("", [])
+
+            if kind == "car" and len(args) == 2 and args[0] in "1234" and args[1] in ("on", "off"):
+                actions.append((at, "inject", (CARS[int(args[0]) - 1], args[1] == "on"), line_no))
+            elif kind == "button" and len(args) == 1 and args[0] in ("PL1", "PL2"):
+                actions.append((at, "inject", (args[0], True), line_no))
+                actions.append((at + BUTTON_PRESS, "inject", (args[0], False), line_no))
+            elif kind == "button" and len(args) == 2 and args[0] in ("PL1", "PL2") and args[1] in ("down", "up"):
+                actions.append((at, "inject", (args[0], args[1] == "down"), line_no))
+            elif kind == "set" and len(args) == 2 and args[1].isdigit():
+                try:
+                    actions.append((at, "set", (proto.param_id(args[0]), int(args[1])), line_no))
+                except ValueError as error:
+                    raise ScenarioError("line %d: %s" % (line_no, error))
+            elif kind == "expect" and args:
+                window = 0.0
+                if len(args) >= 2 and args[-2] == "within":
+                    window = float(args[-1])
+                    args = args[:-2]
+                actions.append((at, "expect", parse_condition(args, line_no) + (window, " ".join(args)), line_no))
+            elif kind == "end" and not args:
+                end = at
+            else:
+                raise ScenarioError("line %d: cannot parse '%s'" % (line_no, line.strip()))
+
+    actions.sort(key=lambda action: action[0])  # Stable, so sets keep their order
+    if end is None:
+        end = max((a[0] + (a[2][2] if a[1] == "expect" else 0) for a in actions), default=0) + 1
+    return actions, end
+
+
+class Recorder:
+    """Collects LAMPS and PHASE records, time stamped in scenario seconds."""
+
+    def __init__(self, tick0, lamps0, speedup):
+        self.tick0 = tick0
+        self.speedup = speedup
+        self.lamps = [(0.0, lamps0)]
+        self.phases = []
+
+    def scenario_time(self, tick):
+        return (tick - self.tick0) * self.speedup / 1000.0
+
+    def __call__(self, rtype, payload, text):
+        if rtype not in (TELEMETRY_LAMPS, TELEMETRY_PHASE) or len(payload) != EVENT.size:
+            return
+        tick, value, ident = EVENT.unpack(payload)
+        at = self.scenario_time(tick)
+        if rtype == TELEMETRY_LAMPS and ident == 0:
+            self.lamps.append((at, value))
+        elif rtype == TELEMETRY_PHASE:
+            self.phases.append((at, STATES[value] if value < len(STATES) else value,
+                                STATES[ident] if ident < len(STATES) else ident))
+
+    def words_between(self, start, stop):
+        """Lamp words shown at any time in [start, stop]."""
+        words = [self.lamps[0][1]]
+        for at, word in self.lamps:
+            if at <= start:
+                words = [word]
+            elif at <= stop:
+                words.append(word)
+        return words
+
+
+def inject(link, name, active):
+    level = 0 if active else 1  # Inputs are active low
+    status, _ = link.request(proto.CMD_INJECT, proto.INJECT.pack(proto.INPUT_PINS[name], level))
+    if status != 0:
+        raise RuntimeError("inject %s: %s" % (name, proto.STATUS_TEXT.get(status, status)))
+
+
+def set_param(link, ident, value):
+    status, _ = link.request(proto.CMD_SET_PARAM, struct.pack("<BH", ident, value))
+    if status != 0:
+        raise RuntimeError("set %s %d: %s" % (proto.PARAMS[ident][0], value,
+                                              proto.STATUS_TEXT.get(status, status)))
+
+
+def run(link, actions, end, speedup):
+    """Plays the scenario, returns the Recorder with everything reported."""
+    status, data = link.request(proto.CMD_HIL_MODE, proto.HIL.pack(1, speedup))
+    if status != 0:
+        raise RuntimeError("HIL mode: %s (speed-up has to divide 40000, at most %d)"
+                           % (proto.STATUS_TEXT.get(status, status), proto.SPEEDUP_MAX))
+
+    status, data = link.request(proto.CMD_STATUS)
+    _, _, _, lamps0, tick0 = proto.STATUS.unpack(data)
+    recorder = Recorder(tick0, lamps0, speedup)
+    link.on_record = recorder
+    start = time.monotonic()
+
+    try:
+        for at, kind, args, _ in actions:
+            while True:
+                remaining = at / speedup - (time.monotonic() - start)
+                if remaining <= 0:
+                    break
+                link.poll(remaining)
+            if kind == "inject":
+                inject(link, *args)
+            elif kind == "set":
+                set_param(link, *args)
+        while time.monotonic() - start < end / speedup:
+            link.poll(end / speedup - (time.monotonic() - start))
+    finally:
+        link.request(proto.CMD_HIL_MODE, proto.HIL.pack(0, 1))
+        if any(action[1] == "set" for action in actions):
+            link.request(proto.CMD_RESET_PARAMS)
+    return recorder
+
+
+def check(actions, recorder):
+    """Returns a list of (line, time, condition, passed, words) for every expectation."""
+    results = []
+    for at, kind, args, line_no in actions:
+        if kind != "expect":
+            continue
+        mask, value, window, text = args
+        words = recorder.words_between(at, at + window)
+        passed = any((word & mask) == value for word in words)
+        results.append((line_no, at, text + (" within %g" % window if window else ""), passed, words))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("port", help="serial device of the board or pty of the host simulation")
+    parser.add_argument("scenario")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-s", "--speedup", type=int, default=1, help="timer speed-up factor")
+    parser.add_argument("-q", "--quiet", action="store_true", help="only print failures")
+    parser.add_argument("--log", help="write the reported lamps, phases and results as JSON")
+    args = parser.parse_args()
+
+    try:
+        actions, end = parse_scenario(args.scenario)
+    except (OSError, ScenarioError) as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 2
+
+    link = proto.Link(proto.open_port(args.port, args.baud))
+    recorder = run(link, actions, end, args.speedup)
+    results = check(actions, recorder)
+
+    if not args.quiet:
+        for at, old, new in recorder.phases:
+            print("%8.2f PHASE %s -> %s" % (at, old, new))
+    for line_no, at, text, passed, words in results:
+        if not passed or not args.quiet:
+            print("%8.2f %s  expect %s (line %d)" % (at, "ok  " if passed else "FAIL", text, line_no))
+            if not passed:
+                for word in words:
+                    print("               seen %06x %s" % (word, lamp_names(word)))
+
+    failed = sum(not r[3] for r in results)
+    print("%d of %d expectations passed" % (len(results) - failed, len(results)))
+
+    if args.log:
+        with open(args.log, "w") as log:
+            json.dump({
+                "scenario": args.scenario,
+                "speedup": args.speedup,
+                "lamps": [{"time": at, "word": word} for at, word in recorder.lamps],
+                "phases": [{"time": at, "from": old, "to": new} for at, old, new in recorder.phases],
+                "expectations": [{"line": l, "time": at, "condition": text, "passed": passed}
+                                 for l, at, text, passed, _ in results],
+            }, log, indent=2)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+"""
+Reports what the linker placed where, from the GNU ld map file.
+
+    map_report.py Debug/PRO1_Arvin_Kunalic.map
+    map_report.py Debug/PRO1_Arvin_Kunalic.map --section .text --top 20
+    map_report.py Debug/PRO1_Arvin_Kunalic.map --expect HAL_GPIO_EXTI_Callback draw_char
+    map_report.py Debug/PRO1_Arvin_Kunalic.map --ram
+
+Prints the use of every memory region (FLASH, RAM, RAM2), the output
+sections in each and the functions of the .ramfunc section, which run
+from SRAM2 (see Core/Inc/ramfunc.h). --section lists another section,
+--top limits the list to the largest entries. --expect exits with 1 if a
+function is not in .ramfunc, e.g. after a refactoring dropped its RAMFUNC
+mark. --ram prints the RAM budget report instead: the static RAM of every
+module (object file or library) per region, against the _Ram_Budget and
+_Ram2_Budget of the linker script, and exits with 1 if one is exceeded.
+Only the Python standard library is used.
+"""
+
+import argparse
+import re
+import sys
+
+REGION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+\S+)?$")
+SECTION = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?")
+SECTION_NAME = re.compile(r"^(\.\S+)$")
+SECTION_WRAPPED = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?$")
+INPUT = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME = re.compile(r"^ (\.\S+)$")
+INPUT_WRAPPED = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_]\w*)$")
+BUDGET = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+_(\w+)_Budget = ")
+
+# Regions holding static RAM, the budget symbol of each
+RAM_BUDGETS = {"RAM": "Ram", "RAM2": "Ram2"}
+
+# Reserved for the heap and the stack, not part of the budgets
+HEAP_STACK = "._user_heap_stack"
+
+
+class Section:
+    def __init__(self, name, address, size, load):
+        self.name = name
+        self.address = address
+        self.size = size
+        self.load = load
+        self.entries = []       # [input section, address, size, object, [symbols]]
+
+    def loaded(self):
+        """True if the section has an image in another region, copied at start-up."""
+        if self.load is None or self.load == self.address:
+            return False
+        return any(not e[0].startswith((".bss", "COMMON", ".noinit")) for e in self.entries)
+
+
+def parse_map(path):
+    """Returns the memory regions {name: (origin, length)}, output sections
+    and the budgets {region: bytes} of the linker script."""
+    regions = {}
+    sections = []
+    budgets = {}
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    part = None
+    pending = None              # Input section name on a line of its own
+    pending_section = None      # Output section name on a line of its own
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            part = "memory"
+            continue
+        if line.startswith("Linker script and memory map"):
+            part = "map"
+            continue
+        if part == "memory":
+            match = REGION.match(line)
+            if match and match.group(1) not in ("Name", "*default*"):
+                regions[match.group(1)] = (int(match.group(2), 16), int(match.group(3), 16))
+            continue
+        if part != "map":
+            continue
+
+        match = BUDGET.match(line)
+        if match:
+            for region, name in RAM_BUDGETS.items():
+                if name == match.group(2):
+                    budgets[region] = int(match.group(1), 16)
+            continue
+
+        match = SECTION.match(line)
+        if match:
+            load = int(match.group(4), 16) if match.group(4) else None
+            sections.append(Section(match.group(1), int(match.group(2), 16),
+                                    int(match.group(3), 16), load))
+            pending = pending_section = None
+            continue
+        match = SECTION_NAME.match(line)
+        if match:
+            pending_section = match.group(1)
+            continue
+        match = SECTION_WRAPPED.match(line)
+        if match and pending_section:
+            load = int(match.group(3), 16) if match.group(3) else None
+            sections.append(Section(pending_section, int(match.group(1), 16),
+                                    int(match.group(2), 16), load))
+            pending = pending_section = None
+            continue
+        pending_section = None
+        if not sections:
+            continue
+        current = sections[-1]
+
+        match = INPUT.match(line)
+        if match:
+            current.entries.append([match.group(1), int(match.group(2), 16),
+                                    int(match.group(3), 16), match.group(4), []])
+            pending = None
+            continue
+        match = INPUT_NAME.match(line)
+        if match:
+            pending = match.group(1)
+            continue
+        match = INPUT_WRAPPED.match(line)
+        if match and pending:
+            current.entries.append([pending, int(match.group(1), 16),
+                                    int(match.group(2), 16), match.group(3), []])
+            pending = None
+            continue
+        match = SYMBOL.match(line)
+        if match and current.entries:
+            current.entries[-1][4].append(match.group(2))
+    return regions, sections, budgets
+
+
+def region_of(regions, address):
+    for name, (origin, length) in regions.items():
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+def object_name(path):
+    """Shortens an object path, 'libc.a(memcpy.o)' or '595_shiftreg.o'."""
+    return re.sub(r"^.*/", "", path)
+
+
+def module_name(path):
+    """The module of an object path, the library for library members."""
+    return re.sub(r"\(.*\)$", "", object_name(path))
+
+
+def print_regions(regions, sections):
+    print("%-8s %10s %10s %10s %6s" % ("region", "origin", "size", "used", "%"))
+    for name, (origin, length) in regions.items():
+        used = 0
+        for section in sections:
+            if region_of(regions, section.address) == name:
+                used += section.size
+            if section.loaded() and region_of(regions, section.load) == name:
+                used += section.size
+        print("%-8s 0x%08x %10d %10d %5.1f%%" % (name, origin, length, used,
+                                               100.0 * used / length if length else 0))
+    print()
+
+
+def print_sections(regions, sections):
+    print("%-20s %-8s %10s %10s  %s" % ("section", "region", "address", "size", "load"))
+    for section in sections:
+        region = region_of(regions, section.address)
+        if region is None or section.size == 0:
+            continue
+        load = ""
+        if section.loaded():
+            load = "0x%08x (%s)" % (section.load, region_of(regions, section.load))
+        print("%-20s %-8s 0x%08x %10d  %s" % (section.name, region, section.address,
+                                             section.size, load))
+    print()
+
+
+def print_entries(section, top):
+    entries = [e for e in section.entries if e[2]]
+    if top:
+        entries = sorted(entries, key=lambda e: -e[2])[:top]
+    print("%s: %d bytes in %d input sections" % (section.name, section.size, len(entries)))
+    for name, address, size, obj, symbols in entries:
+        label = ", ".join(symbols) if symbols else name
+        print("  0x%08x %6d  %-36s %s" % (address, size, label, object_name(obj)))
+    print()
+
+
+def ram_use(regions, sections):
+    """Returns the static RAM {module: {region: bytes}}; alignment gaps
+    between input sections are counted as module '(fill)'."""
+    use = {}
+    for section in sections:
+        region = region_of(regions, section.address)
+        if region not in RAM_BUDGETS or section.name == HEAP_STACK:
+            continue
+        placed = 0
+        for name, address, size, obj, symbols in section.entries:
+            if size:
+                module = use.setdefault(module_name(obj), {})
+                module[region] = module.get(region, 0) + size
+                placed += size
+        if section.size > placed:
+            module = use.setdefault("(fill)", {})
+            module[region] = module.get(region, 0) + section.size - placed
+    return use
+
+
+def print_ram(regions, sections, budgets, top):
+    """Prints the RAM budget report, returns False if a budget is exceeded."""
+    use = ram_use(regions, sections)
+    columns = [region for region in RAM_BUDGETS if region in regions]
+    rows = sorted(use.items(), key=lambda item: -sum(item[1].values()))
+    if top:
+        rows = rows[:top]
+
+    print("%-28s" % "module" + "".join("%10s" % c for c in columns) + "%10s" % "total")
+    for module, sizes in rows:
+        print("%-28s" % module + "".join("%10d" % sizes.get(c, 0) for c in columns)
+              + "%10d" % sum(sizes.values()))
+
+    totals = {c: sum(sizes.get(c, 0) for sizes in use.values()) for c in columns}
+    print("%-28s" % "total" + "".join("%10d" % totals[c] for c in columns)
+          + "%10d" % sum(totals.values()))
+    if budgets:
+        print("%-28s" % "budget" + "".join("%10s" % budgets.get(c, "-") for c in columns))
+
+    ok = True
+    for region in columns:
+        if region in budgets and totals[region] > budgets[region]:
+            print("error: %s uses %d bytes, budget %d" % (region, totals[region], budgets[region]),
+                  file=sys.stderr)
+            ok = False
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("map", help="map file written by the linker (-Wl,-Map)")
+    parser.add_argument("-s", "--section", action="append",
+                        help="list the contents of this section (default .ramfunc)")
+    parser.add_argument("-t", "--top", type=int, default=0,
+                        help="only the N largest entries of each listed section")
+    parser.add_argument("--expect", nargs="+", default=[], metavar="FUNCTION",
+                        help="exit with 1 unless these functions are in .ramfunc")
+    parser.add_argument("--ram", action="store_true",
+                        help="RAM budget report per module, exit with 1 if over budget")
+    args = parser.parse_args()
+
+    regions, sections, budgets = parse_map(args.map)
+    by_name = {section.name: section for section in sections}
+
+    if args.ram:
+        return 0 if print_ram(regions, sections, budgets, args.top) else 1
+
+    print_regions(regions, sections)
+    print_sections(regions, sections)
+
+    for name in args.section or [".ramfunc"]:
+        if name in by_name:
+            print_entries(by_name[name], args.top)
+        else:
+            print("%s: not in the map file" % name)
+            print()
+
+    if args.expect:
+        ramfunc = by_name.get(".ramfunc")
+        placed = set()
+        if ramfunc:
+            for entry in ramfunc.entries:
+                placed.update(entry[4])
+        missing = [name for name in args.expect if name not in placed]
+        for name in missing:
+            print("error: %s is not in .ramfunc" % name, file=sys.stderr)
+        return 1 if missing else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
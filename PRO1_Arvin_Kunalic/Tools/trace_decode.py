@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+"""
+Decodes the USART2 telemetry stream of the traffic light firmware.
+
+The firmware writes records of the form
+
+    | 0xA5 | type | len | payload (len bytes) |
+
+(see Core/Inc/telemetry.h). Event records and printf text are printed
+directly, TRACE records are formatted on the host with the format strings
+from the '.trace_fmt' section of the firmware ELF file (see
+Core/Inc/trace.h).
+
+Examples:
+    trace_decode.py -e Debug/PRO1_Arvin_Kunalic.elf /dev/ttyACM0
+    trace_decode.py -e Debug/PRO1_Arvin_Kunalic.elf --export-table fmt.json
+    trace_decode.py -t fmt.json capture.bin
+
+The source can be a serial device, a capture file or '-' for stdin.
+Only the Python standard library is used.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+
+TELEMETRY_PHASE = 0x01
+TELEMETRY_INPUT = 0x02
+TELEMETRY_LAMPS = 0x03
+TELEMETRY_TRACE = 0x04
+TELEMETRY_TEXT = 0x05
+TELEMETRY_RESPONSE = 0x06
+TELEMETRY_MEMORY = 0x07
+TELEMETRY_CRASH = 0x08
+
+STATES = ["Intersection1", "Intersection2", "Wait20s", "Wait30s"]
+
+# Shift register output word, see Core/Inc/595_shiftreg.h
+LAMPS = [
+    (0x010000, "TL1_Red"), (0x020000, "TL1_Yellow"), (0x040000, "TL1_Green"),
+    (0x080000, "PL1_Red"), (0x100000, "PL1_Green"), (0x200000, "PL1_Blue"),
+    (0x000100, "TL2_Red"), (0x000200, "TL2_Yellow"), (0x000400, "TL2_Green"),
+    (0x000800, "PL2_Red"), (0x001000, "PL2_Green"), (0x002000, "PL2_Blue"),
+    (0x000001, "TL3_Red"), (0x000002, "TL3_Yellow"), (0x000004, "TL3_Green"),
+    (0x000008, "TL4_Red"), (0x000010, "TL4_Yellow"), (0x000020, "TL4_Green"),
+]
+
+INPUTS = ["car1", "car2", "car3", "car4", "PL1", "PL2"]
+
+EVENT = struct.Struct("<IIH")       # telemetry_event_t
+TRACE_HEADER = struct.Struct("<IH")  # tick, id
+MEMORY = struct.Struct("<6IHB")     # mem_usage_t
+
+# mem_usage_t flags, see Core/Inc/mem_monitor.h
+MEMORY_FLAGS = ["STACK_RESERVE", "HEAP_RESERVE", "GUARD", "SBRK_FAILED"]
+
+
+# --- ELF format table ------------------------------------------------------
+
+def read_elf_section(path, name):
+    """Returns the contents of a named section of a 32-bit little endian ELF."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        raise ValueError("%s is not a 32-bit little endian ELF file" % path)
+    e_shoff, = struct.unpack_from("<I", data, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", data, e_shoff + index * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    for i in range(e_shnum):
+        sh_name, _, _, _, sh_offset, sh_size = section(i)
+        start = strtab[4] + sh_name
+        if data[start:data.index(b"\0", start)].decode() == name:
+            return data[sh_offset:sh_offset + sh_size]
+    raise ValueError("%s has no %s section" % (path, name))
+
+
+def format_table_from_elf(path):
+    """Maps each format string offset in '.trace_fmt' to its string."""
+    raw = read_elf_section(path, ".trace_fmt")
+    table = {}
+    offset = 0
+    while offset < len(raw):
+        end = raw.index(b"\0", offset)
+        table[offset] = raw[offset:end].decode(errors="replace")
+        offset = end + 1
+    return table
+
+
+# --- printf emulation -------------------------------------------------------
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXcp%])")
+
+
+def format_message(fmt, args):
+    """Formats a C printf format string with raw 32-bit arguments."""
+    args = list(args)
+    out = []
+    last = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, precision, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        value = args.pop(0) if args else 0
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            out.append((spec + "d") % value)
+        elif conv == "u":
+            out.append((spec + "d") % value)
+        elif conv == "c":
+            out.append((spec + "c") % chr(value & 0xFF))
+        elif conv == "p":
+            out.append("0x%08x" % value)
+        else:
+            out.append((spec + conv) % value)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+# --- Record decoding --------------------------------------------------------
+
+def lamp_names(word):
+    return " ".join(name for mask, name in LAMPS if word & mask) or "(all off)"
+
+
+def memory_text(payload):
+    """Returns the text of a mem_usage_t, without the tick."""
+    _, stack_reserve, stack_peak, heap_reserve, heap_used, free, failures, flags = MEMORY.unpack(payload)
+    names = ",".join(n for i, n in enumerate(MEMORY_FLAGS) if flags & (1 << i)) or "-"
+    return "stack %d/%d, heap %d/%d, free %d bytes, sbrk failures %d, flags %s" % (
+        stack_peak, stack_reserve, heap_used, heap_reserve, free, failures, names)
+
+
+def decode_record(rtype, payload, table):
+    """Returns one line of text for a record."""
+    if rtype in (TELEMETRY_PHASE, TELEMETRY_INPUT, TELEMETRY_LAMPS) and len(payload) == EVENT.size:
+        tick, value, ident = EVENT.unpack(payload)
+        if rtype == TELEMETRY_PHASE:
+            old = STATES[value] if value < len(STATES) else str(value)
+            new = STATES[ident] if ident < len(STATES) else str(ident)
+            return "%10d PHASE %s -> %s" % (tick, old, new)
+        if rtype == TELEMETRY_INPUT:
+            active = ",".join(n for i, n in enumerate(INPUTS) if value & (1 << i)) or "-"
+            return "%10d INPUT pin 0x%04x, active: %s" % (tick, ident, active)
+        test = " (lamp test)" if ident == 1 else ""
+        return "%10d LAMPS %06x %s%s" % (tick, value, lamp_names(value), test)
+
+    if rtype == TELEMETRY_TRACE and len(payload) >= TRACE_HEADER.size:
+        tick, ident = TRACE_HEADER.unpack_from(payload)
+        argc = (len(payload) - TRACE_HEADER.size) // 4
+        args = struct.unpack_from("<%dI" % argc, payload, TRACE_HEADER.size)
+        fmt = table.get(ident)
+        if fmt is None:
+            return "%10d TRACE <unknown id %d> %s" % (tick, ident, " ".join("%08x" % a for a in args))
+        return "%10d TRACE %s" % (tick, format_message(fmt, args))
+
+    if rtype == TELEMETRY_MEMORY and len(payload) == MEMORY.size:
+        return "%10d MEMORY %s" % (MEMORY.unpack(payload)[0], memory_text(payload))
+
+    if rtype == TELEMETRY_CRASH and len(payload) >= 2:
+        return "           CRASH dump bytes %d-%d (decode with crash_decode.py)" % (
+            payload[0] | payload[1] << 8, (payload[0] | payload[1] << 8) + len(payload) - 3)
+
+    if rtype == TELEMETRY_TEXT:
+        return payload.decode(errors="replace").rstrip("\r\n")
+
+    if rtype == TELEMETRY_RESPONSE and len(payload) >= 5:
+        return "           RESPONSE seq %d cmd 0x%02x status %d %s" % (
+            payload[0], payload[1], payload[2], payload[3:-2].hex())
+
+    return "           TYPE 0x%02x %s" % (rtype, payload.hex())
+
+
+class StreamDecoder:
+    """Incremental parser of the telemetry byte stream."""
+
+    def __init__(self, table):
+        self.table = table
+        self.buffer = bytearray()
+        self.resyncs = 0
+
+    def feed(self, data):
+        """Consumes bytes and yields (type, payload, text) for every complete record."""
+        self.buffer += data
+        while True:
+            start = self.buffer.find(bytes([SYNC]))
+            if start < 0:
+                self.resyncs += bool(self.buffer)
+                self.buffer.clear()
+                return
+            if start > 0:
+                self.resyncs += 1
+                del self.buffer[:start]
+            if len(self.buffer) < 3:
+                return
+            rtype, length = self.buffer[1], self.buffer[2]
+            if len(self.buffer) < 3 + length:
+                return
+            payload = bytes(self.buffer[3:3 + length])
+            del self.buffer[:3 + length]
+            yield rtype, payload, decode_record(rtype, payload, self.table)
+
+
+# --- Input sources ----------------------------------------------------------
+
+def open_source(path, baud):
+    """Opens a serial device (configured raw) or a file, returns a file descriptor."""
+    if path == "-":
+        return sys.stdin.fileno()
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        import termios
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = 0                                        # iflag
+        attrs[1] = 0                                        # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                        # lflag
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        attrs[6][termios.VMIN] = 1
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("source", nargs="?", help="serial device, capture file or '-'")
+    parser.add_argument("-e", "--elf", help="firmware ELF file with the .trace_fmt section")
+    parser.add_argument("-t", "--table", help="format table exported with --export-table")
+    parser.add_argument("--export-table", metavar="OUT", help="write the format table as JSON and exit")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    table = {}
+    if args.elf:
+        table = format_table_from_elf(args.elf)
+    elif args.table:
+        with open(args.table) as f:
+            table = {int(k): v for k, v in json.load(f).items()}
+
+    if args.export_table:
+        with open(args.export_table, "w") as f:
+            json.dump({str(k): v for k, v in sorted(table.items())}, f, indent=1)
+        return 0
+
+    if not args.source:
+        parser.error("a source is required unless --export-table is given")
+
+    fd = open_source(args.source, args.baud)
+    decoder = StreamDecoder(table)
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            for _, _, text in decoder.feed(data):
+                print(text, flush=True)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Command line client for the USART2 command protocol of the traffic light
+firmware (see Core/Inc/cmd_protocol.h).
+
+Examples:
+    traffic_cli.py /dev/ttyACM0 status
+    traffic_cli.py /dev/ttyACM0 params
+    traffic_cli.py /dev/ttyACM0 set orange_delay 2500ms
+    traffic_cli.py /dev/ttyACM0 lamp-test 0x3f3f3f 2000
+    traffic_cli.py /dev/ttyACM0 hil on --speedup 10
+    traffic_cli.py /dev/ttyACM0 inject car1 on
+    traffic_cli.py /dev/ttyACM0 profile exti --histogram
+    traffic_cli.py $(cat /tmp/standin.pty) counters
+
+Timing values are timer ticks (0.5ms), a value with an 'ms' suffix is
+converted. Telemetry records that arrive while waiting for a response are
+printed with -v. Only the Python standard library is used.
+"""
+
+import argparse
+import struct
+import sys
+
+import cmd_protocol as proto
+from trace_decode import STATES, INPUTS, MEMORY, lamp_names, memory_text
+
+FLAGS = ["TL1_green", "TL2_green", "PL1_green", "PL2_green", "lamp_test", "hil"]
+
+
+def ticks(text):
+    """Parses a timer value, '1500ms' is converted to ticks."""
+    if text.endswith("ms"):
+        return max(int(text[:-2]) * 2 - 1, 0)
+    return int(text, 0)
+
+
+def show_param(data):
+    ident, value, low, high = proto.PARAM.unpack(data)
+    name = proto.PARAMS[ident][0] if ident < len(proto.PARAMS) else str(ident)
+    print("%-14s %6d ticks (%7.1f ms)  range %d..%d" % (name, value, (value + 1) / 2, low, high))
+
+
+def show_profile(data, histogram):
+    fields = proto.PROFILE.unpack(data)
+    probe, core_hz, count, low, high, total = fields[:6]
+    name = proto.PROBES[probe] if probe < len(proto.PROBES) else str(probe)
+    if count == 0:
+        print("%-13s no passes" % name)
+        return
+    us = 1e6 / core_hz
+    mean = total / count
+    print("%-13s %8d passes  min %7d  mean %9.1f  max %8d cycles  (%.2f / %.2f / %.2f us)"
+          % (name, count, low, mean, high, low * us, mean * us, high * us))
+    if histogram:
+        buckets = fields[6:]
+        widest = max(buckets)
+        for n, hits in enumerate(buckets):
+            if hits:
+                print("    %10d-%-10d %8d %s" % (1 << n if n else 0, (1 << (n + 1)) - 1, hits,
+                                               "#" * max(1, hits * 40 // widest)))
+
+
+def check(status, data=b""):
+    if status != 0:
+        print("error: %s" % proto.STATUS_TEXT.get(status, "status %d" % status), file=sys.stderr)
+        if len(data) == proto.PARAM.size:
+            show_param(data)
+        sys.exit(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("port", help="serial device or pty of the stand-in")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-v", "--verbose", action="store_true", help="print other telemetry records")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("ping")
+    sub.add_parser("status")
+    sub.add_parser("counters")
+    sub.add_parser("params", help="list every timing parameter")
+    get = sub.add_parser("get")
+    get.add_argument("name")
+    put = sub.add_parser("set")
+    put.add_argument("name")
+    put.add_argument("value")
+    sub.add_parser("reset", help="restore the default timing")
+    test = sub.add_parser("lamp-test", help="show a lamp pattern, 0 ms ends the test")
+    test.add_argument("pattern", type=lambda s: int(s, 0))
+    test.add_argument("ms", type=int)
+    hil = sub.add_parser("hil", help="hardware-in-the-loop mode, inputs come from 'inject'")
+    hil.add_argument("mode", choices=["on", "off"])
+    hil.add_argument("--speedup", type=int, default=1, help="timer speed-up factor")
+    inject = sub.add_parser("inject", help="set an input in HIL mode")
+    inject.add_argument("input", choices=sorted(proto.INPUT_PINS))
+    inject.add_argument("level", choices=["on", "off"], help="car present / button pressed")
+    profile = sub.add_parser("profile", help="execution time of the ISRs and the main loop (cycles)")
+    profile.add_argument("probe", nargs="?", default="all", choices=proto.PROBES + ["all"])
+    profile.add_argument("--histogram", action="store_true", help="print the log2 histogram")
+    profile.add_argument("--reset", action="store_true", help="start the statistics over")
+    profile.add_argument("--show", action="store_true", help="also show the table on the OLED")
+    sub.add_parser("memory", help="stack and heap high-water marks (bytes)")
+    args = parser.parse_args()
+
+    link = proto.Link(proto.open_port(args.port, args.baud),
+                      on_record=(lambda rtype, payload, text: print(text)) if args.verbose else None)
+
+    if args.command == "ping":
+        status, data = link.request(proto.CMD_PING)
+        check(status)
+        version, tick = proto.PING.unpack(data)
+        print("protocol version %d, uptime %d ms" % (version, tick))
+
+    elif args.command == "status":
+        status, data = link.request(proto.CMD_STATUS)
+        check(status)
+        state, inputs, flags, lamps, tick = proto.STATUS.unpack(data)
+        print("tick    %d" % tick)
+        print("state   %s" % (STATES[state] if state < len(STATES) else state))
+        print("inputs  %s" % (",".join(n for i, n in enumerate(INPUTS) if inputs & (1 << i)) or "-"))
+        print("flags   %s" % (",".join(n for i, n in enumerate(FLAGS) if flags & (1 << i)) or "-"))
+        print("lamps   %06x %s" % (lamps, lamp_names(lamps)))
+
+    elif args.command == "counters":
+        status, data = link.request(proto.CMD_COUNTERS)
+        check(status)
+        for name, value in zip(proto.COUNTER_NAMES, proto.COUNTERS.unpack(data)):
+            print("%-18s %d" % (name, value))
+
+    elif args.command == "params":
+        for ident in range(len(proto.PARAMS)):
+            status, data = link.request(proto.CMD_GET_PARAM, bytes([ident]))
+            check(status)
+            show_param(data)
+
+    elif args.command == "get":
+        status, data = link.request(proto.CMD_GET_PARAM, bytes([proto.param_id(args.name)]))
+        check(status, data)
+        show_param(data)
+
+    elif args.command == "set":
+        request = struct.pack("<BH", proto.param_id(args.name), ticks(args.value))
+        status, data = link.request(proto.CMD_SET_PARAM, request)
+        check(status, data)
+        show_param(data)
+
+    elif args.command == "reset":
+        check(link.request(proto.CMD_RESET_PARAMS)[0])
+
+    elif args.command == "lamp-test":
+        check(link.request(proto.CMD_LAMP_TEST, struct.pack("<IH", args.pattern, args.ms))[0])
+
+    elif args.command == "hil":
+        status, data = link.request(proto.CMD_HIL_MODE, proto.HIL.pack(args.mode == "on", args.speedup))
+        check(status)
+        enabled, speedup = proto.HIL.unpack(data)
+        print("HIL mode %s, speed-up %dx" % ("on" if enabled else "off", speedup))
+
+    elif args.command == "inject":
+        # Inputs are active low
+        level = 0 if args.level == "on" else 1
+        check(link.request(proto.CMD_INJECT, proto.INJECT.pack(proto.INPUT_PINS[args.input], level))[0])
+
+    elif args.command == "profile":
+        probes = range(len(proto.PROBES)) if args.probe == "all" else [proto.PROBES.index(args.probe)]
+        action = proto.PROFILE_RESET if args.reset else proto.PROFILE_READ
+        for probe in probes:
+            status, data = link.request(proto.CMD_PROFILE, bytes([probe, action]))
+            if status == 0x01:
+                print("error: profiling is compiled out (PROFILE_ENABLED=0)", file=sys.stderr)
+                sys.exit(1)
+            check(status)
+            show_profile(data, args.histogram)
+        if args.show:
+            check(link.request(proto.CMD_PROFILE, bytes([0, proto.PROFILE_SHOW]))[0])
+
+    elif args.command == "memory":
+        status, data = link.request(proto.CMD_MEMORY)
+        if status == 0x01:
+            print("error: the memory monitor is compiled out (MEM_MONITOR_ENABLED=0)", file=sys.stderr)
+            sys.exit(1)
+        check(status)
+        print("scanned at %d ms: %s" % (MEMORY.unpack(data)[0], memory_text(data)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())